@@ -64,6 +64,11 @@
 #define LR11XX_BUSY_PORT GPIOB
 #define LR11XX_BUSY_PIN LL_GPIO_PIN_3
 
+/*!
+ * @brief SPI clock of the LR11xx before the link qualification of an update: 10 MHz, the datasheet allows 16 MHz
+ */
+#define LR11XX_SPI_PRESCALER LL_SPI_BAUDRATEPRESCALER_DIV8
+
 #define LR11XX_LED_SCAN_PORT GPIOB
 #define LR11XX_LED_SCAN_PIN LL_GPIO_PIN_5
 #define LR11XX_LED_TX_PORT GPIOC
@@ -79,6 +84,11 @@
 #define DISPLAY_DC_PORT GPIOC
 #define DISPLAY_DC_PIN LL_GPIO_PIN_7
 
+/*!
+ * @brief SPI clock of the display: 10 MHz, the ILI9341 write cycle is 100 ns minimum
+ */
+#define DISPLAY_SPI_PRESCALER LL_SPI_BAUDRATEPRESCALER_DIV8
+
 #define TOUCH_IRQ_PORT GPIOA
 #define TOUCH_IRQ_PIN LL_GPIO_PIN_10
 
@@ -106,10 +116,21 @@ typedef struct configuration
     uint32_t      pin;
 } gpio_t;
 
+/*!
+ * @brief Device on a shared SPI bus, with the settings applied by system_spi_bus_select
+ */
 typedef struct
 {
     SPI_TypeDef* spi;
     gpio_t       nss;
+    uint32_t     prescaler;   //!< SPI clock of the device, LL_SPI_BAUDRATEPRESCALER_DIVx
+    uint32_t     data_width;  //!< Size of the frames once selected, LL_SPI_DATAWIDTH_8BIT or LL_SPI_DATAWIDTH_16BIT
+    bool         is_crc_on;   //!< Device expecting a CRC byte after each frame, tracked by its driver
+} spi_device_t;
+
+typedef struct
+{
+    spi_device_t spi_device;  //!< Clock set by the link qualification, CRC cleared on reset
     gpio_t       reset;
     gpio_t       irq;
     gpio_t       busy;
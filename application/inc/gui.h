@@ -68,11 +68,16 @@ extern "C" {
 
 /*!
  * @brief Initialize the GUI
+ */
+void gui_init( void );
+
+/*!
+ * @brief Display the firmware to be flashed
  *
  * @param [in] update Chip type to be updated
  * @param [in] fw_expected Expected LR11xx firmware version
  */
-void gui_init( lr11xx_fw_update_t update, uint32_t fw_expected );
+void gui_set_firmware( lr11xx_fw_update_t update, uint32_t fw_expected );
 
 /*!
  * @brief Update the GUI
@@ -81,6 +86,20 @@ void gui_init( lr11xx_fw_update_t update, uint32_t fw_expected );
  */
 void gui_update( const char* txt );
 
+/*!
+ * @brief Display the progress and the throughput of the flash write
+ *
+ * @param [in] progress Progress given to the progress callback of the update
+ */
+void gui_show_progress( const lr11xx_bootloader_progress_t* progress );
+
+/*!
+ * @brief Display the duration of the main update phases
+ *
+ * @param [in] timing Timing filled by lr11xx_update_firmware
+ */
+void gui_show_timing( const lr11xx_fw_update_timing_t* timing );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,282 @@
+/*!
+ * @file      lr11xx_bootloader_dma.h
+ *
+ * @brief     LR11XX bootloader flash write pipeline over SPI DMA definition
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_BOOTLOADER_DMA_H
+#define LR11XX_BOOTLOADER_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lr11xx_types.h"
+#include "lr11xx_firmware_image.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief Time to wait for the chip to raise BUSY once NSS is released, in us
+ *
+ * @remark BUSY rises well below a microsecond after NSS: the bound only keeps a chip that dropped the command from
+ * blocking the transfer, and does not depend on the core clock as a number of GPIO reads would.
+ */
+#define LR11XX_BOOTLOADER_DMA_BUSY_RISE_TIMEOUT_US ( 2 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Time spent writing the flash, split between the SPI transfers and the BUSY waits
+ */
+typedef struct lr11xx_bootloader_write_timing_s
+{
+    uint64_t spi_cycles;        //!< Cycles spent with NSS low, sending the blocks
+    uint64_t busy_cycles;       //!< Cycles spent waiting for BUSY to fall before each block
+    uint32_t block_max_cycles;  //!< Longest BUSY wait plus transfer of a single block
+    uint32_t block_count;       //!< Number of blocks sent
+} lr11xx_bootloader_write_timing_t;
+
+/*!
+ * @brief Progress of an image write, as given to a progress callback
+ */
+typedef struct
+{
+    uint32_t written_in_byte;        //!< Bytes sent so far
+    uint32_t total_in_byte;          //!< Bytes to send
+    uint32_t elapsed_ms;             //!< Time since the write started, in system ticker ms
+    uint32_t rate_in_byte_per_s;     //!< Throughput since the previous report
+    uint32_t average_in_byte_per_s;  //!< Throughput since the write started
+    uint32_t eta_ms;                 //!< Time left at the average throughput
+} lr11xx_bootloader_progress_t;
+
+/*!
+ * @brief Function called with the progress of an image write
+ *
+ * @param [in] progress Progress of the write
+ * @param [in] context Context given along with the callback
+ */
+typedef void ( *lr11xx_bootloader_progress_callback_t )( const lr11xx_bootloader_progress_t* progress,
+                                                         void*                               context );
+
+/*!
+ * @brief Progress reporting of an image write, rate-limited to one report per period
+ *
+ * The callback, its context and the period are set by the caller, the other fields are private to the reporting.
+ */
+typedef struct
+{
+    lr11xx_bootloader_progress_callback_t callback;        //!< Function called with the progress, NULL for none
+    void*                                 context;         //!< Context given to the callback
+    uint32_t                              period_ms;       //!< Minimum time between two reports
+    uint32_t                              total_in_byte;   //!< Bytes to send
+    uint32_t                              start_ms;        //!< Ticker when the write started
+    uint32_t                              report_ms;       //!< Ticker at the previous report
+    uint32_t                              report_in_byte;  //!< Bytes sent at the previous report
+} lr11xx_bootloader_progress_reporter_t;
+
+/*!
+ * @brief Image being sent block per block, for a caller interleaving the blocks with other work
+ *
+ * Only one transfer can be in progress at a time: the blocks are prepared in buffers private to the module.
+ */
+typedef struct
+{
+    const lr11xx_firmware_image_t* image;           //!< Firmware image
+    uint16_t                       opcode;          //!< Command carrying the blocks
+    uint32_t                       offset_in_word;  //!< Offset of the next block to prepare
+    uint8_t                        current;         //!< Buffer holding the block to send next
+    uint32_t                       start_cycles;    //!< Cycle counter when the previous block was over
+} lr11xx_bootloader_dma_transfer_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Write a firmware image in program flash memory of the chip - pipelined version of
+ * lr11xx_bootloader_write_flash_encrypted_full
+ *
+ * Each 64-word block is sent within a single NSS frame, its data through SPI DMA. The next block is prepared while
+ * the current one is on the wire, and the MCU sleeps until the BUSY falling edge signals that the chip committed it.
+ *
+ * A wire-order image is sent straight from the memory holding it: only the 6-byte command goes through a RAM buffer.
+ * A host-order image is byte-swapped block per block into two alternating RAM buffers.
+ *
+ * @remark Returns before the last block is committed: BUSY is still high at that point.
+ *
+ * @param [in] context Chip implementation context
+ * @param [in] image Firmware image to write from the start of the flash
+ * @param [inout] timing Timing accumulated over the blocks sent, can be NULL
+ * @param [inout] progress Progress reporting of the write, can be NULL
+ *
+ * @returns Operation status, LR11XX_STATUS_ERROR if a streamed image failed to provide a block
+ */
+lr11xx_status_t lr11xx_bootloader_dma_write_image( const void* context, const lr11xx_firmware_image_t* image,
+                                                   lr11xx_bootloader_write_timing_t*      timing,
+                                                   lr11xx_bootloader_progress_reporter_t* progress );
+
+/*!
+ * @brief Have the chip check a firmware image - pipelined version of lr11xx_crypto_check_encrypted_firmware_image_full
+ *
+ * The blocks go through the same pipeline as lr11xx_bootloader_dma_write_image. The check is handled by a running
+ * transceiver firmware, not by the bootloader, and its result is read with
+ * lr11xx_crypto_get_check_encrypted_firmware_image_result.
+ *
+ * @remark Returns before the last block is processed: BUSY is still high at that point.
+ *
+ * @param [in] context Chip implementation context
+ * @param [in] image Firmware image to check
+ * @param [inout] timing Timing accumulated over the blocks sent, can be NULL
+ *
+ * @returns Operation status, LR11XX_STATUS_ERROR if a streamed image failed to provide a block
+ */
+lr11xx_status_t lr11xx_bootloader_dma_check_image( const void* context, const lr11xx_firmware_image_t* image,
+                                                   lr11xx_bootloader_write_timing_t* timing );
+
+/*!
+ * @brief Start writing a firmware image block per block, see lr11xx_bootloader_dma_write_image
+ *
+ * The first block is prepared, to be sent by lr11xx_bootloader_dma_send_block.
+ *
+ * @param [out] transfer Transfer to start
+ * @param [in] image Firmware image to write from the start of the flash
+ *
+ * @returns Operation status, LR11XX_STATUS_ERROR if a streamed image failed to provide the first block
+ */
+lr11xx_status_t lr11xx_bootloader_dma_start_write( lr11xx_bootloader_dma_transfer_t* transfer,
+                                                   const lr11xx_firmware_image_t*    image );
+
+/*!
+ * @brief Start having the chip check a firmware image block per block, see lr11xx_bootloader_dma_check_image
+ *
+ * @param [out] transfer Transfer to start
+ * @param [in] image Firmware image to check
+ *
+ * @returns Operation status, LR11XX_STATUS_ERROR if a streamed image failed to provide the first block
+ */
+lr11xx_status_t lr11xx_bootloader_dma_start_check( lr11xx_bootloader_dma_transfer_t* transfer,
+                                                   const lr11xx_firmware_image_t*    image );
+
+/*!
+ * @brief Check whether all the blocks of a transfer were sent
+ *
+ * @param [in] transfer Transfer started by lr11xx_bootloader_dma_start_write or lr11xx_bootloader_dma_start_check
+ *
+ * @returns True once the last block is sent
+ */
+bool lr11xx_bootloader_dma_is_done( const lr11xx_bootloader_dma_transfer_t* transfer );
+
+/*!
+ * @brief Send the next block of a transfer to a chip whose BUSY is low
+ *
+ * The block following it is prepared while this one is on the wire. The transfer is over on return, the bus being
+ * free for other devices until the next block. The BUSY wait accounted for the block starts when the previous block
+ * was over.
+ *
+ * @param [in] context Chip implementation context
+ * @param [inout] transfer Transfer whose next block is to be sent
+ * @param [inout] timing Timing accumulated over the blocks sent, can be NULL
+ *
+ * @returns Operation status, LR11XX_STATUS_ERROR if a streamed image failed to provide the following block
+ */
+lr11xx_status_t lr11xx_bootloader_dma_send_block( const void* context, lr11xx_bootloader_dma_transfer_t* transfer,
+                                                  lr11xx_bootloader_write_timing_t* timing );
+
+/*!
+ * @brief Send again the block sent last by lr11xx_bootloader_dma_send_block, to a chip whose BUSY is low
+ *
+ * Meant for a block the bootloader reported as failed: the block prepared next is left untouched, and so is the
+ * offset of the transfer. A streamed image is not read again, its block being still held by the module.
+ *
+ * @param [in] context Chip implementation context
+ * @param [inout] transfer Transfer whose last block is to be sent again
+ * @param [inout] timing Timing accumulated over the blocks sent, can be NULL
+ */
+void lr11xx_bootloader_dma_resend_block( const void* context, lr11xx_bootloader_dma_transfer_t* transfer,
+                                         lr11xx_bootloader_write_timing_t* timing );
+
+/*!
+ * @brief Account for one block in a write timing
+ *
+ * @param [inout] timing Timing to update, can be NULL
+ * @param [in] start_cycles Cycle counter when the wait for BUSY started
+ * @param [in] spi_start_cycles Cycle counter when NSS went low
+ * @param [in] end_cycles Cycle counter when NSS went high
+ */
+void lr11xx_bootloader_write_timing_add_block( lr11xx_bootloader_write_timing_t* timing, uint32_t start_cycles,
+                                               uint32_t spi_start_cycles, uint32_t end_cycles );
+
+/*!
+ * @brief Start reporting the progress of an image write
+ *
+ * @param [inout] reporter Progress reporting, whose callback, context and period are set, can be NULL
+ * @param [in] total_in_byte Bytes to send
+ */
+void lr11xx_bootloader_progress_start( lr11xx_bootloader_progress_reporter_t* reporter, uint32_t total_in_byte );
+
+/*!
+ * @brief Report the progress of an image write, if the period since the previous report is over
+ *
+ * Once every byte is sent, the progress is reported whatever the period, and only once.
+ *
+ * @param [inout] reporter Progress reporting started by lr11xx_bootloader_progress_start, can be NULL
+ * @param [in] written_in_byte Bytes sent so far
+ */
+void lr11xx_bootloader_progress_update( lr11xx_bootloader_progress_reporter_t* reporter, uint32_t written_in_byte );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LR11XX_BOOTLOADER_DMA_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,219 @@
+/*!
+ * @file      lr11xx_firmware_image.h
+ *
+ * @brief     LR11XX firmware image access definition
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_FIRMWARE_IMAGE_H
+#define LR11XX_FIRMWARE_IMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief Byte order of the image header included by the application
+ *
+ * Image headers converted by tools/lr11xx_image_to_wire_order.py define it to LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER.
+ */
+#ifndef LR11XX_FIRMWARE_IMAGE_FORMAT
+#define LR11XX_FIRMWARE_IMAGE_FORMAT LR11XX_FIRMWARE_IMAGE_FORMAT_HOST_ORDER
+#endif
+
+/*!
+ * @brief Number of words sent per encrypted write command
+ */
+#define LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD ( 64 )
+
+/*!
+ * @brief Number of bytes sent per encrypted write command
+ */
+#define LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE ( LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD * 4 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Layout of a firmware image
+ */
+typedef enum
+{
+    LR11XX_FIRMWARE_IMAGE_FORMAT_HOST_ORDER,  //!< Words as released, byte-swapped on the fly before being sent
+    LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER,  //!< Words pre-swapped so that memory holds the SPI byte stream
+    LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM,      //!< Blocks obtained one after the other from read_block, in SPI order
+} lr11xx_firmware_image_format_t;
+
+/*!
+ * @brief Get the next block of a streamed image
+ *
+ * Blocks are requested in order. A block must stay available until the block following the next one is requested:
+ * the previous block may still be on the wire while the next one is being obtained.
+ *
+ * @param [in] context Context of the image source
+ * @param [in] offset_in_word Offset of the block in the image
+ * @param [in] length_in_word Length of the block in word
+ *
+ * @returns Pointer to the block in SPI byte order, NULL if the source failed to provide it
+ */
+typedef const uint8_t* ( *lr11xx_firmware_image_read_block_t )( void* context, uint32_t offset_in_word,
+                                                                 uint32_t length_in_word );
+
+/*!
+ * @brief Restart a streamed image, the next block requested being the first one again
+ *
+ * @param [in] context Context of the image source
+ */
+typedef void ( *lr11xx_firmware_image_rewind_t )( void* context );
+
+/*!
+ * @brief Firmware image to flash
+ */
+typedef struct
+{
+    const uint32_t*                    words;           //!< Content of the image, unused by streamed images
+    uint32_t                           length_in_word;  //!< Length of the image in word
+    lr11xx_firmware_image_format_t     format;          //!< Layout of the image
+    lr11xx_firmware_image_read_block_t read_block;      //!< Block source of a streamed image
+    lr11xx_firmware_image_rewind_t     rewind;          //!< Restart of a streamed image, NULL if read once only
+    void*                              context;         //!< Context given to read_block and rewind
+} lr11xx_firmware_image_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Get the length of the block starting at a given offset
+ *
+ * @param [in] image Firmware image
+ * @param [in] offset_in_word Offset of the block in the image
+ *
+ * @returns Length of the block in word, 0 past the end of the image
+ */
+uint32_t lr11xx_firmware_image_get_block_length( const lr11xx_firmware_image_t* image, uint32_t offset_in_word );
+
+/*!
+ * @brief Get a block of the image as the byte stream to send over SPI
+ *
+ * A wire-order image is returned in place, straight from the memory holding it. A host-order image is byte-swapped
+ * into the scratch buffer. A streamed image is returned from the buffer its source received it in.
+ *
+ * @remark The wire-order format relies on the MCU being little-endian
+ *
+ * @param [in] image Firmware image
+ * @param [in] offset_in_word Offset of the block in the image
+ * @param [in] length_in_word Length of the block, at most LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD
+ * @param [out] scratch Buffer of LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE bytes, used only if a copy is needed
+ *
+ * @returns Pointer to the block in SPI byte order, NULL if a streamed image failed to provide it
+ */
+const uint8_t* lr11xx_firmware_image_get_block( const lr11xx_firmware_image_t* image, uint32_t offset_in_word,
+                                                uint32_t length_in_word, uint8_t* scratch );
+
+/*!
+ * @brief Check whether the image can be read more than once
+ *
+ * @param [in] image Firmware image
+ *
+ * @returns True if the image is held in memory, or streamed from a source that can restart it
+ */
+bool lr11xx_firmware_image_can_rewind( const lr11xx_firmware_image_t* image );
+
+/*!
+ * @brief Get the image ready to be read from its first block
+ *
+ * A streamed image is restarted if its source can do it, and is otherwise expected not to have been read yet. Nothing
+ * is done for an image held in memory.
+ *
+ * @param [in] image Firmware image
+ */
+void lr11xx_firmware_image_rewind( const lr11xx_firmware_image_t* image );
+
+/*!
+ * @brief Compute the CRC-32 of the image as sent over SPI
+ *
+ * The result is the CRC-32 (as computed by zlib) of the released firmware binary, whatever the byte order of the
+ * image in memory.
+ *
+ * @remark Not applicable to streamed images, whose blocks can only be read once
+ *
+ * @param [in] image Firmware image
+ * @param [out] crc CRC-32 of the image
+ *
+ * @returns true if the CRC is computed, false if a block of the image could not be read
+ */
+bool lr11xx_firmware_image_get_crc( const lr11xx_firmware_image_t* image, uint32_t* crc );
+
+/*!
+ * @brief Compute the CRC-32 of a part of the image as sent over SPI
+ *
+ * The range is clipped to the end of the image.
+ *
+ * @remark Not applicable to streamed images, whose blocks can only be read once
+ *
+ * @param [in] image Firmware image
+ * @param [in] offset_in_word Start of the range in the image
+ * @param [in] length_in_word Length of the range in word
+ * @param [out] crc CRC-32 of the range, as computed by zlib on the same bytes
+ *
+ * @returns true if the CRC is computed, false if a block of the range could not be read
+ */
+bool lr11xx_firmware_image_get_range_crc( const lr11xx_firmware_image_t* image, uint32_t offset_in_word,
+                                          uint32_t length_in_word, uint32_t* crc );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LR11XX_FIRMWARE_IMAGE_H
+
+/* --- EOF ------------------------------------------------------------------ */
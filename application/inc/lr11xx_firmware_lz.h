@@ -0,0 +1,152 @@
+/*!
+ * @file      lr11xx_firmware_lz.h
+ *
+ * @brief     LR11XX compressed firmware image definition
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_FIRMWARE_LZ_H
+#define LR11XX_FIRMWARE_LZ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lr11xx_firmware_image.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief Container header: magic "LRLZ", format version, reserved byte, then little-endian window size (16-bit),
+ * image length in byte and CRC-32 of the image
+ */
+#define LR11XX_FIRMWARE_LZ_HEADER_LENGTH ( 16 )
+
+/*!
+ * @brief Format version of the container
+ */
+#define LR11XX_FIRMWARE_LZ_FORMAT_VERSION ( 1 )
+
+/*!
+ * @brief Size of the decode window in byte
+ *
+ * Matches reach back at most this many bytes. The window also holds the decoded blocks handed over to the flash
+ * write: it spans four of them, so that the block on the wire and the one being decoded never overlap.
+ */
+#define LR11XX_FIRMWARE_LZ_WINDOW_SIZE ( 4 * LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE )
+
+/*!
+ * @brief Shortest match encoded in a sequence
+ */
+#define LR11XX_FIRMWARE_LZ_MATCH_MIN_LENGTH ( 4 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Decoder of a compressed image
+ *
+ * The container, built by tools/lr11xx_image_compress.py, holds the image in SPI byte order as a series of
+ * sequences: a token whose high and low nibbles are the literal length and the match length minus
+ * LR11XX_FIRMWARE_LZ_MATCH_MIN_LENGTH, each extended by the following bytes when equal to 15, then the literals,
+ * then the little-endian match offset. The last sequence of the image holds literals only.
+ */
+typedef struct
+{
+    const uint8_t* input;                                   //!< Container
+    uint32_t       input_length;                            //!< Length of the container in byte
+    uint32_t       input_offset;                            //!< Next byte of the container to decode
+    uint32_t       output_length;                           //!< Length of the image in byte
+    uint32_t       output_offset;                           //!< Next byte of the image to decode
+    uint32_t       literal_count;                           //!< Literals left to copy in the current sequence
+    uint32_t       match_count;                             //!< Bytes left to copy in the current match
+    uint16_t       match_offset;                            //!< Distance of the current match
+    uint8_t        token;                                   //!< Token of the current sequence
+    bool           is_match_next;                           //!< Literals of the sequence done, match to read
+    uint8_t        window[LR11XX_FIRMWARE_LZ_WINDOW_SIZE];  //!< Last decoded bytes, blocks handed over included
+} lr11xx_firmware_lz_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Check a container and get the streamed image decoding it
+ *
+ * Blocks are decoded on demand, as the flash write requests them: the decoding of the next block overlaps with the
+ * transfer of the current one and with the time the chip spends writing it. The image can be rewound, the decoding
+ * then restarting from the beginning of the image, so that it can be checked by the chip before being flashed and
+ * flashed again after a failed write.
+ *
+ * @param [out] lz Decoder, to be kept until the image is flashed
+ * @param [in] container Compressed image
+ * @param [in] container_length Length of the compressed image in byte
+ * @param [out] image Streamed image, to be given to lr11xx_update_firmware
+ *
+ * @returns True if the container header is valid
+ */
+bool lr11xx_firmware_lz_init( lr11xx_firmware_lz_t* lz, const uint8_t* container, uint32_t container_length,
+                              lr11xx_firmware_image_t* image );
+
+/*!
+ * @brief Get the CRC-32 of the image stored in the container
+ *
+ * @param [in] lz Decoder
+ *
+ * @returns CRC-32 of the image as sent over SPI, as computed by zlib
+ */
+uint32_t lr11xx_firmware_lz_get_crc( const lr11xx_firmware_lz_t* lz );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LR11XX_FIRMWARE_LZ_H
+
+/* --- EOF ------------------------------------------------------------------ */
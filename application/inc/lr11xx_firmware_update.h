@@ -44,8 +44,13 @@ extern "C" {
  * --- DEPENDENCIES ------------------------------------------------------------
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include "lr11xx_bootloader_dma.h"
+#include "lr11xx_bootloader_types.h"
+#include "lr11xx_firmware_image.h"
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC MACROS -----------------------------------------------------------
@@ -56,6 +61,64 @@ extern "C" {
  * --- PUBLIC CONSTANTS --------------------------------------------------------
  */
 
+/*!
+ * @brief Kind of firmware picked from a bundle by the application
+ *
+ * Set at build time with BUNDLE_KIND when a bundle holds both transceiver and modem images of the same chip.
+ */
+#ifndef LR11XX_FW_BUNDLE_KIND
+#define LR11XX_FW_BUNDLE_KIND LR11XX_FW_BUNDLE_KIND_ANY
+#endif
+
+/*!
+ * @brief Maximum number of chips updated together by lr11xx_update_firmware_gang
+ */
+#define LR11XX_FW_GANG_TARGET_COUNT_MAX ( 8 )
+
+/*!
+ * @brief Flash page of the LR1110, the unit a differential update erases and rewrites
+ */
+#define LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD ( 256 )
+
+/*!
+ * @brief Number of flash pages a page index of the LR1110 bootloader can address
+ */
+#define LR11XX_FW_DIFF_PAGE_COUNT_MAX ( 256 )
+
+/*!
+ * @brief Minimum time between two reports of the flash write progress
+ *
+ * A progress line of about 70 characters takes 0.8 ms on the COM port at 921600 baud, 0.3 % of the period.
+ */
+#ifndef LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS
+#define LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS ( 250 )
+#endif
+
+/*!
+ * @brief Number of times a flash erase or a block the bootloader reports as failed is sent again, before giving up
+ *
+ * A block failing every retry has the whole flash erased and written again, once, unless the image is streamed.
+ */
+#ifndef LR11XX_FW_UPDATE_RETRY_COUNT_MAX
+#define LR11XX_FW_UPDATE_RETRY_COUNT_MAX ( 3 )
+#endif
+
+/*!
+ * @brief Fastest SPI clock the link qualification of an update may lock in, in Hz
+ *
+ * 16 MHz is the LR11xx datasheet limit. The SPI prescalers give 10 MHz then 20 MHz at 80 MHz PCLK2: under 20 MHz, the
+ * qualification only confirms the 10 MHz default clock or falls back to a slower one, and never speeds the update up.
+ * A higher value lets a short, clean wiring run faster, beyond the datasheet.
+ */
+#ifndef LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ
+#define LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ ( 16000000 )
+#endif
+
+/*!
+ * @brief Length of the flash hash reported by the LR1110 bootloader
+ */
+#define LR11XX_FW_FLASH_HASH_LENGTH ( 16 )
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
@@ -72,18 +135,407 @@ typedef enum
 
 typedef enum
 {
-    LR11XX_FW_UPDATE_OK              = 0,
-    LR11XX_FW_UPDATE_WRONG_CHIP_TYPE = 1,
-    LR11XX_FW_UPDATE_ERROR           = 2,
+    LR11XX_FW_UPDATE_OK                  = 0,
+    LR11XX_FW_UPDATE_WRONG_CHIP_TYPE     = 1,
+    LR11XX_FW_UPDATE_ERROR               = 2,
+    LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE  = 3,  //!< The chip runs the expected firmware: nothing flashed
 } lr11xx_fw_update_status_t;
 
+/*!
+ * @brief Duration of the update phases, in us
+ */
+typedef struct
+{
+    uint32_t probe_us;            //!< Running firmware check, before any update
+    uint32_t boot_ready_us;       //!< Part of the probe spent waiting for the running firmware to get ready
+    uint32_t validate_us;         //!< Image check by the running firmware, before the flash erase
+    uint32_t reset_us;            //!< Reset into bootloader mode
+    uint32_t reset_ready_us;      //!< Part of the reset spent waiting for the bootloader to release BUSY
+    uint32_t handshake_us;        //!< Bootloader version check, SPI link qualification, image check, PIN / EUI reads
+    uint32_t spi_clock_hz;        //!< SPI clock locked in by the link qualification, in Hz
+    uint32_t erase_us;            //!< Flash erase, until BUSY falls
+    uint32_t erase_page_count;    //!< Pages erased one by one by a differential update, 0 after a full erase
+    uint32_t erase_retry_count;   //!< Erases sent again after the bootloader reported them failed
+    uint32_t write_us;            //!< Flash write, until the last block is committed
+    uint32_t write_spi_us;        //!< Part of the flash write spent sending the blocks
+    uint32_t write_busy_us;       //!< Part of the flash write spent waiting for BUSY
+    uint32_t write_block_max_us;  //!< Slowest block, BUSY wait included
+    uint32_t write_block_count;   //!< Number of blocks written, retries included
+    uint32_t block_retry_count;   //!< Blocks sent again after the bootloader reported them failed
+    uint32_t hash_us;             //!< Flash hash check by the LR1110 bootloader, before the reboot
+    uint32_t reflash_count;       //!< Erase and write runs repeated after a flash hash mismatch or a failed block
+    uint32_t reboot_us;           //!< Reboot, until the firmware is ready
+    uint32_t reboot_ready_us;     //!< Part of the reboot spent waiting for the firmware to get ready
+    uint32_t verify_us;           //!< Firmware version check
+    uint32_t total_us;            //!< Whole update
+} lr11xx_fw_update_timing_t;
+
+/*!
+ * @brief Kind of firmware to take from a bundle, for chips the bundle has both a transceiver and a modem image for
+ */
+typedef enum
+{
+    LR11XX_FW_BUNDLE_KIND_ANY,          //!< First entry compatible with the chip
+    LR11XX_FW_BUNDLE_KIND_TRANSCEIVER,  //!< Transceiver firmware only
+    LR11XX_FW_BUNDLE_KIND_MODEM,        //!< LoRa Basics Modem-E firmware only
+} lr11xx_fw_bundle_kind_t;
+
+/*!
+ * @brief Entry of a firmware bundle: one image along with what the updater needs to select and check it
+ */
+typedef struct
+{
+    lr11xx_fw_update_t      update;       //!< Chip family and firmware kind, selects the entry for a bootloader
+    uint32_t                fw_expected;  //!< Version reported by the firmware once flashed
+    lr11xx_firmware_image_t image;        //!< Firmware image
+    uint32_t                crc;          //!< CRC-32 of the image as sent over SPI, that is of the released binary
+    const uint8_t*          flash_hash;   //!< Flash hash the LR1110 bootloader reports once written, NULL if unknown
+} lr11xx_fw_bundle_entry_t;
+
+/*!
+ * @brief Firmware a differential update starts from
+ *
+ * Generated by tools/lr11xx_firmware_diff.py from the image header of the base firmware.
+ */
+typedef struct
+{
+    lr11xx_fw_update_t update;           //!< Chip family and firmware kind of the base firmware
+    uint32_t           base_version;     //!< Version reported by the base firmware
+    const uint32_t*    base_page_crc;    //!< CRC-32 of each flash page of the base image, as sent over SPI
+    uint16_t           base_page_count;  //!< Number of flash pages of the base image
+    uint8_t hash[LR11XX_FW_FLASH_HASH_LENGTH];  //!< Flash hash once the new image is written, all zeros if unknown
+} lr11xx_fw_diff_t;
+
+/*!
+ * @brief Chip of a gang update, along with its own outcome
+ */
+typedef struct
+{
+    void*                            radio;               //!< Chip implementation context, on the bus of the gang
+    lr11xx_fw_update_status_t        status;              //!< Update status of the chip
+    const lr11xx_fw_bundle_entry_t*  selected;            //!< Entry selected, NULL if the chip stopped before
+    uint16_t                         bootloader_version;  //!< Version reported by the bootloader, 0 if not reached
+    uint32_t                         write_block_count;   //!< Number of blocks written to the chip
+} lr11xx_fw_gang_target_t;
+
+/*!
+ * @brief Phase of an update run step by step
+ */
+typedef enum
+{
+    LR11XX_FW_UPDATE_STATE_BOOT,       //!< Reset into the firmware the chip holds
+    LR11XX_FW_UPDATE_STATE_PROBE,      //!< Running firmware check
+    LR11XX_FW_UPDATE_STATE_VALIDATE,   //!< Image check by the running firmware
+    LR11XX_FW_UPDATE_STATE_BASE,       //!< Base firmware check of a differential update
+    LR11XX_FW_UPDATE_STATE_RESET,      //!< Reset into bootloader mode
+    LR11XX_FW_UPDATE_STATE_HANDSHAKE,  //!< Bootloader version check, image selection and check
+    LR11XX_FW_UPDATE_STATE_ERASE,      //!< Flash erase, or erase of the next page of a differential update
+    LR11XX_FW_UPDATE_STATE_WRITE,      //!< Flash write, one block per step
+    LR11XX_FW_UPDATE_STATE_COMMIT,     //!< Wait for the last block to be committed
+    LR11XX_FW_UPDATE_STATE_HASH,       //!< Flash hash check by the LR1110 bootloader
+    LR11XX_FW_UPDATE_STATE_REBOOT,     //!< Reboot, until the firmware is ready
+    LR11XX_FW_UPDATE_STATE_VERIFY,     //!< Firmware version check
+    LR11XX_FW_UPDATE_STATE_DONE,       //!< Update over, its status being final
+} lr11xx_fw_update_state_t;
+
+/*!
+ * @brief Event a step of an update waits for before going on
+ */
+typedef enum
+{
+    LR11XX_FW_UPDATE_WAIT_NONE,      //!< Nothing to wait for: the next step goes on at once
+    LR11XX_FW_UPDATE_WAIT_BUSY_LOW,  //!< BUSY to fall, or the timeout to elapse
+    LR11XX_FW_UPDATE_WAIT_DELAY,     //!< Timeout to elapse
+    LR11XX_FW_UPDATE_WAIT_BOOT,      //!< BUSY to fall or the EVENT line of a modem to rise, or the timeout to elapse
+} lr11xx_fw_update_wait_t;
+
+/*!
+ * @brief Update run step by step from the application main loop
+ *
+ * Set up by lr11xx_update_firmware_start, lr11xx_update_firmware_start_diff or
+ * lr11xx_update_firmware_start_from_bundle, then advanced by lr11xx_update_firmware_step. The session refers to
+ * itself: it must stay where it was set up until the update is over. Its fields are private to the firmware update.
+ */
+typedef struct
+{
+    void*                                 radio;               //!< Chip implementation context
+    const lr11xx_fw_bundle_entry_t*       bundle;              //!< Bundle entries
+    uint8_t                               entry_count;         //!< Number of entries
+    lr11xx_fw_bundle_kind_t               kind;                //!< Kind of firmware to flash
+    bool                                  is_crc_checked;      //!< Whether to check the CRC of the selected entry
+    const lr11xx_fw_diff_t*               diff;                //!< Base of a differential update, NULL if full
+    lr11xx_fw_bundle_entry_t              single;              //!< Bundle of one entry holding a single image
+    lr11xx_fw_update_timing_t*            timing;              //!< Duration of the update phases
+    lr11xx_fw_update_timing_t             timing_local;        //!< Timing filled when the caller has none
+    lr11xx_fw_update_state_t              state;               //!< Current phase
+    uint8_t                               phase;               //!< Progress within the current phase
+    lr11xx_fw_update_status_t             status;              //!< Update status, final once the state is done
+    const lr11xx_fw_bundle_entry_t*       selected;            //!< Selected entry, NULL until the selection
+    lr11xx_bootloader_version_t           version;             //!< Version reported by the bootloader
+    bool                                  is_modem;            //!< Whether a modem firmware ran before the update
+    bool                                  is_base_running;     //!< Whether the base firmware of the update ran
+    bool                                  is_diff;             //!< Whether only the changed pages are rewritten
+    bool                                  is_hash_read;        //!< Whether the bootloader reports a flash hash
+    uint32_t                              hold_ms;             //!< Time BUSY is held low by the current reset
+    uint8_t page_map[LR11XX_FW_DIFF_PAGE_COUNT_MAX / 8];  //!< Pages a differential update erases
+    uint16_t                              page_count;          //!< Number of pages a differential update erases
+    uint16_t                              page;                //!< Next page to look for in the page map
+    const lr11xx_firmware_image_t*        image;               //!< Image being sent
+    uint16_t                              opcode;              //!< Command carrying the blocks
+    uint32_t                              offset_in_word;      //!< Next block to send, when not sent through the DMA
+    uint32_t                              end_in_word;         //!< End of the blocks to send
+    uint32_t                              written_in_byte;     //!< Bytes sent to the flash by the current write
+    const uint8_t*                        block_data;          //!< Block sent last, when not sent through the DMA
+    uint32_t                              block_length;        //!< Length in word of the block sent last
+    bool                                  is_block_pending;    //!< Whether the status of the last block is unread
+    uint8_t                               retry_count;         //!< Retries of the current block or erase
+    lr11xx_bootloader_dma_transfer_t      transfer;            //!< Image sent through the DMA
+    lr11xx_bootloader_write_timing_t      write_timing;        //!< Time spent sending the blocks and waiting for BUSY
+    lr11xx_bootloader_progress_reporter_t progress;            //!< Progress reporting of the flash write
+    uint8_t scratch[LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE];  //!< Block byte-swapped or read from a stream
+    uint32_t                              erase_us;            //!< Duration of the full erase
+    uint32_t                              erase_cycles;        //!< Time erasing the pages of a differential update
+    uint32_t                              erase_start_cycles;  //!< Cycle counter at the start of the page erase
+    uint32_t                              block_start_cycles;  //!< Cycle counter when the previous block was over
+    uint32_t                              ready_start_cycles;  //!< Cycle counter when the wait for readiness started
+    uint32_t                              reboot_start_ms;     //!< Ticker at the reboot
+    uint32_t                              write_start_ms;      //!< Ticker at the start of the write
+    uint32_t                              start_ms;            //!< Ticker at the start of the update
+    uint32_t                              lap_cycles;          //!< Cycle counter at the start of the current phase
+    lr11xx_fw_update_wait_t               wait;                //!< Event waited for
+    uint32_t                              wait_start_ms;       //!< Ticker at the start of the wait
+    uint32_t                              wait_timeout_ms;     //!< Maximum time to wait
+} lr11xx_fw_update_session_t;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
  */
 
 lr11xx_fw_update_status_t lr11xx_update_firmware( void* radio, lr11xx_fw_update_t fw_update_direction,
-                                                  uint32_t fw_expected, const uint32_t* buffer, uint32_t length );
+                                                  uint32_t fw_expected, const lr11xx_firmware_image_t* image,
+                                                  lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Update a chip and check the flash hash of an LR1110 before the reboot
+ *
+ * Once the image is written, the LR1110 bootloader reports the hash of the flash, compared with the expected one: on
+ * a mismatch, the flash is erased and written again in the same session, without the reboot round trip. The chips
+ * of the other families, whose bootloader has no such command, only get the firmware version check after the reboot.
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] fw_update_direction Chip family and firmware kind of the image
+ * @param [in] fw_expected Version reported by the firmware once flashed
+ * @param [in] image Firmware image
+ * @param [in] flash_hash Flash hash the LR1110 bootloader reports once the image is written, NULL if unknown
+ * @param [out] timing Duration of the update phases, can be NULL
+ *
+ * @returns Update status
+ */
+lr11xx_fw_update_status_t lr11xx_update_firmware_with_hash( void* radio, lr11xx_fw_update_t fw_update_direction,
+                                                            uint32_t fw_expected, const lr11xx_firmware_image_t* image,
+                                                            const uint8_t*             flash_hash,
+                                                            lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Update the chip with the image of a bundle selected from its bootloader version
+ *
+ * The first entry of the requested kind compatible with the chip is selected, so that one binary updates any chip
+ * family the bundle covers. The image of the selected entry is checked against its CRC before the flash is erased.
+ * An entry the chip already runs is selected without any update, the status being then
+ * LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE.
+ *
+ * @remark Streamed images are refused: their CRC cannot be checked before the flash erase
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] bundle Bundle entries
+ * @param [in] entry_count Number of entries
+ * @param [in] kind Kind of firmware to flash
+ * @param [out] selected Selected entry, NULL if the update stopped before the selection
+ * @param [out] timing Duration of the update phases, can be NULL
+ *
+ * @returns Update status, LR11XX_FW_UPDATE_WRONG_CHIP_TYPE if no entry is compatible with the chip
+ */
+lr11xx_fw_update_status_t lr11xx_update_firmware_from_bundle( void* radio, const lr11xx_fw_bundle_entry_t* bundle,
+                                                              uint8_t entry_count, lr11xx_fw_bundle_kind_t kind,
+                                                              const lr11xx_fw_bundle_entry_t** selected,
+                                                              lr11xx_fw_update_timing_t*       timing );
+
+/*!
+ * @brief Update an LR1110 running a known firmware by rewriting only the flash pages that changed
+ *
+ * When the chip runs the base firmware of the differential update, the CRC of each flash page of the image is
+ * compared with the one of the base image, and only the pages that differ are erased and rewritten. The flash hash
+ * then reported by the bootloader is compared with the expected one. The whole flash is erased and rewritten instead
+ * when the expected hash is unknown, the untouched pages being checked by it only, when the chip runs another firmware,
+ * when most pages changed, or when the hash does not match.
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] fw_update_direction Chip family and firmware kind of the image, LR1110 only
+ * @param [in] fw_expected Version reported by the firmware once flashed
+ * @param [in] image Firmware image, not streamed
+ * @param [in] diff Firmware the chip is expected to run
+ * @param [out] timing Duration of the update phases, can be NULL
+ *
+ * @returns Update status
+ */
+lr11xx_fw_update_status_t lr11xx_update_firmware_diff( void* radio, lr11xx_fw_update_t fw_update_direction,
+                                                       uint32_t fw_expected, const lr11xx_firmware_image_t* image,
+                                                       const lr11xx_fw_diff_t*    diff,
+                                                       lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Set up an update from a single image, see lr11xx_update_firmware_with_hash, to be run step by step
+ *
+ * Nothing is sent to the chip before the first call to lr11xx_update_firmware_step.
+ *
+ * @param [out] session Update to set up
+ * @param [in] radio Chip implementation context
+ * @param [in] fw_update_direction Chip family and firmware kind of the image
+ * @param [in] fw_expected Version reported by the firmware once flashed
+ * @param [in] image Firmware image, kept until the update is over
+ * @param [in] flash_hash Flash hash the LR1110 bootloader reports once the image is written, NULL if unknown
+ * @param [out] timing Duration of the update phases, can be NULL
+ */
+void lr11xx_update_firmware_start( lr11xx_fw_update_session_t* session, void* radio,
+                                   lr11xx_fw_update_t fw_update_direction, uint32_t fw_expected,
+                                   const lr11xx_firmware_image_t* image, const uint8_t* flash_hash,
+                                   lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Set up a differential update, see lr11xx_update_firmware_diff, to be run step by step
+ *
+ * @param [out] session Update to set up
+ * @param [in] radio Chip implementation context
+ * @param [in] fw_update_direction Chip family and firmware kind of the image, LR1110 only
+ * @param [in] fw_expected Version reported by the firmware once flashed
+ * @param [in] image Firmware image, not streamed, kept until the update is over
+ * @param [in] diff Firmware the chip is expected to run
+ * @param [out] timing Duration of the update phases, can be NULL
+ */
+void lr11xx_update_firmware_start_diff( lr11xx_fw_update_session_t* session, void* radio,
+                                        lr11xx_fw_update_t fw_update_direction, uint32_t fw_expected,
+                                        const lr11xx_firmware_image_t* image, const lr11xx_fw_diff_t* diff,
+                                        lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Set up an update from a bundle, see lr11xx_update_firmware_from_bundle, to be run step by step
+ *
+ * @param [out] session Update to set up
+ * @param [in] radio Chip implementation context
+ * @param [in] bundle Bundle entries
+ * @param [in] entry_count Number of entries
+ * @param [in] kind Kind of firmware to flash
+ * @param [out] timing Duration of the update phases, can be NULL
+ */
+void lr11xx_update_firmware_start_from_bundle( lr11xx_fw_update_session_t* session, void* radio,
+                                               const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                               lr11xx_fw_bundle_kind_t kind, lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Run the next step of an update
+ *
+ * A step sends one command or one flash block, or checks whether the chip is done with the previous one: it never
+ * waits for the chip, the SPI bus being free on return. Between two steps, the caller is free to refresh the display
+ * or serve the UART. The phase timing includes the time spent between the steps.
+ *
+ * @param [inout] session Update set up by one of the lr11xx_update_firmware_start functions
+ *
+ * @returns True while the update is in progress, false once it is over
+ */
+bool lr11xx_update_firmware_step( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Get the outcome of an update run step by step
+ *
+ * @param [in] session Update
+ * @param [out] selected Selected entry, NULL if the update stopped before the selection, can be NULL
+ *
+ * @returns Update status, meaningful once lr11xx_update_firmware_step returned false
+ */
+lr11xx_fw_update_status_t lr11xx_update_firmware_get_status( const lr11xx_fw_update_session_t* session,
+                                                             const lr11xx_fw_bundle_entry_t**  selected );
+
+/*!
+ * @brief Check whether an update run step by step is waiting for the chip
+ *
+ * True while the chip is busy with the last command, an erase or a block write, or while a delay runs: the update does
+ * not need the SPI bus before its next step finds the wait over, and the bus is free for the display meanwhile. The
+ * display sends its areas in segments of about 1 kB, so that the next step never waits for more than one of them.
+ *
+ * @param [in] session Update
+ *
+ * @returns True if the update is waiting for the chip, false if its next step uses the bus
+ */
+bool lr11xx_update_firmware_is_waiting( const lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Have the progress of the flash write reported by the updates started from now on
+ *
+ * The callback is called from the update, step by step or blocking, once every LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS
+ * at most and once more with the last block, while the chip writes a block: it must return well within a block
+ * write. The erase, the image check and the gang update are not reported.
+ *
+ * @param [in] callback Function called with the progress, NULL to stop reporting
+ * @param [in] context Context given to the callback
+ */
+void lr11xx_update_firmware_set_progress_callback( lr11xx_bootloader_progress_callback_t callback, void* context );
+
+/*!
+ * @brief Update several chips sharing one SPI bus with the images of a bundle
+ *
+ * Each chip goes through the steps of lr11xx_update_firmware_from_bundle, every step being run on all chips at once:
+ * the resets, erases and reboots overlap, and the flash write sends the blocks round-robin, a chip getting its next
+ * block while the others commit theirs. Each image is read once per block whatever the number of chips it goes to.
+ * A chip failing a step is left out of the next ones, without stopping the others.
+ *
+ * @remark Streamed images are refused: their CRC cannot be checked before the flash erase
+ *
+ * @param [inout] targets Chips to update, their status and outcome being filled
+ * @param [in] target_count Number of chips, at most LR11XX_FW_GANG_TARGET_COUNT_MAX
+ * @param [in] bundle Bundle entries
+ * @param [in] entry_count Number of entries
+ * @param [in] kind Kind of firmware to flash
+ * @param [out] timing Duration of the update phases, for all chips together, can be NULL
+ *
+ * @returns Number of chips updated or already up to date
+ */
+uint8_t lr11xx_update_firmware_gang( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                     const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                     lr11xx_fw_bundle_kind_t kind, lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Check whether the chip type reported by the bootloader is the one of a production chip
+ *
+ * @param [in] type Chip type reported by the bootloader
+ *
+ * @returns True for a production chip, the only one the images can be flashed on
+ */
+bool lr11xx_is_chip_in_production_mode( uint8_t type );
+
+/*!
+ * @brief Check whether a firmware can be flashed on a chip
+ *
+ * @param [in] update Chip family and firmware kind
+ * @param [in] bootloader_version Version reported by the bootloader of the chip
+ *
+ * @returns True if the firmware is meant for the chip family of the bootloader
+ */
+bool lr11xx_is_fw_compatible_with_chip( lr11xx_fw_update_t update, uint16_t bootloader_version );
+
+/*!
+ * @brief Print the duration of the update phases
+ *
+ * @param [in] timing Timing filled by lr11xx_update_firmware
+ */
+void lr11xx_update_firmware_print_timing( const lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Print the progress of the flash write on a single line
+ *
+ * @param [in] progress Progress given to the progress callback
+ */
+void lr11xx_update_firmware_print_progress( const lr11xx_bootloader_progress_t* progress );
 
 #ifdef __cplusplus
 }
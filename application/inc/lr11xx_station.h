@@ -0,0 +1,210 @@
+/*!
+ * @file      lr11xx_station.h
+ *
+ * @brief     LR11XX factory station definition: units flashed one after the other without any reset of the MCU
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_STATION_H
+#define LR11XX_STATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lr11xx_firmware_update.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief Number of probes in a row that must see a module inserted, or removed, for the change to be reported
+ */
+#ifndef LR11XX_STATION_DEBOUNCE_COUNT
+#define LR11XX_STATION_DEBOUNCE_COUNT ( 2 )
+#endif
+
+/*!
+ * @brief Number of update durations kept for the 95th percentile: the last units only
+ */
+#ifndef LR11XX_STATION_DURATION_COUNT_MAX
+#define LR11XX_STATION_DURATION_COUNT_MAX ( 64 )
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Event reported by lr11xx_station_step
+ */
+typedef enum
+{
+    LR11XX_STATION_EVENT_NONE,      //!< Nothing changed
+    LR11XX_STATION_EVENT_INSERTED,  //!< A module is inserted: update it, then call lr11xx_station_end_update
+    LR11XX_STATION_EVENT_REMOVED,   //!< The module is removed: the station waits for the next one
+} lr11xx_station_event_t;
+
+/*!
+ * @brief Station phases
+ */
+typedef enum
+{
+    LR11XX_STATION_STATE_WAIT_INSERTION,  //!< No module, or a module not seen long enough yet
+    LR11XX_STATION_STATE_UPDATING,        //!< Module inserted, update run by the application
+    LR11XX_STATION_STATE_WAIT_REMOVAL,    //!< Module updated, still in place
+} lr11xx_station_state_t;
+
+/*!
+ * @brief Presence probe phases
+ */
+typedef enum
+{
+    LR11XX_STATION_PROBE_IDLE,   //!< Waiting for the next probe
+    LR11XX_STATION_PROBE_RESET,  //!< Chip reset with BUSY held low
+    LR11XX_STATION_PROBE_READY,  //!< BUSY released, waiting for the bootloader
+} lr11xx_station_probe_t;
+
+/*!
+ * @brief Statistics of the units updated since the start of the station, kept in RAM
+ */
+typedef struct
+{
+    uint32_t unit_count;       //!< Number of units updated
+    uint32_t pass_count;       //!< Number of units running the expected firmware, updated or already up to date
+    uint32_t fail_count;       //!< Number of units left without the expected firmware
+    uint64_t duration_sum_ms;  //!< Sum of the update durations, for the mean
+    uint32_t durations_ms[LR11XX_STATION_DURATION_COUNT_MAX];  //!< Durations of the last units, for the percentile
+    uint16_t duration_next;    //!< Slot of the next duration
+} lr11xx_station_stats_t;
+
+/*!
+ * @brief Station run step by step from the application main loop, next to the update
+ *
+ * Set up by lr11xx_station_init, then advanced by lr11xx_station_step whenever no update is running. Its fields are
+ * private to the station, except the statistics.
+ */
+typedef struct
+{
+    void*                       radio;           //!< Chip implementation context
+    lr11xx_station_state_t      state;           //!< Current phase
+    lr11xx_station_probe_t      probe;           //!< Progress of the presence probe
+    uint32_t                    probe_start_ms;  //!< Ticker at the start of the last probe
+    uint32_t                    wait_start_ms;   //!< Ticker at the start of the current probe phase
+    uint32_t                    hold_ms;         //!< Time BUSY is held low by the current probe
+    uint8_t                     match_count;     //!< Consecutive probes seeing the change waited for
+    lr11xx_bootloader_version_t version;         //!< Version reported by the bootloader of the last module seen
+    lr11xx_station_stats_t      stats;           //!< Statistics of the units updated
+} lr11xx_station_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Set up a station waiting for its first module
+ *
+ * @param [out] station Station to set up
+ * @param [in] radio Chip implementation context
+ */
+void lr11xx_station_init( lr11xx_station_t* station, void* radio );
+
+/*!
+ * @brief Run one step of the module detection, never waiting for the chip
+ *
+ * A module is seen in place when, reset with BUSY held low, it releases BUSY and its bootloader reports a production
+ * chip of a known family. The change is reported once seen by LR11XX_STATION_DEBOUNCE_COUNT probes in a row. Nothing is
+ * done while the update runs.
+ *
+ * @param [in] station Station
+ *
+ * @returns Change of the module presence, if any
+ */
+lr11xx_station_event_t lr11xx_station_step( lr11xx_station_t* station );
+
+/*!
+ * @brief Record the outcome of the update of the inserted module and wait for its removal
+ *
+ * @param [in] station Station
+ * @param [in] status Update status
+ * @param [in] timing Timing filled by the update
+ */
+void lr11xx_station_end_update( lr11xx_station_t* station, lr11xx_fw_update_status_t status,
+                                const lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Get the mean update duration since the start of the station
+ *
+ * @param [in] stats Statistics
+ *
+ * @returns Mean duration in ms, 0 if no unit was updated
+ */
+uint32_t lr11xx_station_get_mean_ms( const lr11xx_station_stats_t* stats );
+
+/*!
+ * @brief Get the 95th percentile of the update durations of the last LR11XX_STATION_DURATION_COUNT_MAX units
+ *
+ * @param [in] stats Statistics
+ *
+ * @returns Duration in ms, nearest rank, 0 if no unit was updated
+ */
+uint32_t lr11xx_station_get_p95_ms( const lr11xx_station_stats_t* stats );
+
+/*!
+ * @brief Print the statistics on a single line
+ *
+ * @param [in] stats Statistics
+ */
+void lr11xx_station_print_stats( const lr11xx_station_stats_t* stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LR11XX_STATION_H
+
+/* --- EOF ------------------------------------------------------------------ */
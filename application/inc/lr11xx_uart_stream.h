@@ -0,0 +1,181 @@
+/*!
+ * @file      lr11xx_uart_stream.h
+ *
+ * @brief     LR11XX firmware image streaming over UART definition
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_UART_STREAM_H
+#define LR11XX_UART_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lr11xx_firmware_image.h"
+#include "lr11xx_firmware_update.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief First byte of every frame, in both directions
+ *
+ * The console output shares the UART with the frames sent to the host: being outside of the ASCII range, this byte
+ * lets the host tell them apart.
+ */
+#define LR11XX_UART_STREAM_SOF ( 0xA5 )
+
+/*!
+ * @brief Frame header: SOF, type, sequence number and big-endian payload length
+ */
+#define LR11XX_UART_STREAM_HEADER_LENGTH ( 5 )
+
+/*!
+ * @brief Frame trailer: big-endian CRC-16/CCITT-FALSE of the type, sequence number, length and payload
+ */
+#define LR11XX_UART_STREAM_CRC_LENGTH ( 2 )
+
+/*!
+ * @brief Largest payload: one block of the image
+ */
+#define LR11XX_UART_STREAM_PAYLOAD_MAX_LENGTH ( LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE )
+
+/*!
+ * @brief Payload of the START frame: update type, expected firmware version and image length in word
+ */
+#define LR11XX_UART_STREAM_START_LENGTH ( 1 + 4 + 4 )
+
+/*!
+ * @brief Number of DATA frames the host may send ahead of the last acknowledged one
+ */
+#define LR11XX_UART_STREAM_WINDOW ( 8 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Frame types
+ *
+ * The host opens a session with START (sequence number 0), then sends the image block per block in DATA frames
+ * numbered from 1, modulo 256. The chip acknowledges START once ready for the data, with the window size as payload,
+ * then acknowledges the blocks as they are written with cumulative ACKs. A frame received corrupted or out of
+ * sequence is answered by a NAK carrying the sequence number expected next: the host resends from there. DONE
+ * carries the update status and closes the session.
+ */
+typedef enum
+{
+    LR11XX_UART_STREAM_FRAME_START = 0x01,  //!< Host to chip: update type, firmware version and image length
+    LR11XX_UART_STREAM_FRAME_DATA  = 0x02,  //!< Host to chip: image block in SPI byte order
+    LR11XX_UART_STREAM_FRAME_ACK   = 0x81,  //!< Chip to host: frames up to the sequence number are consumed
+    LR11XX_UART_STREAM_FRAME_NAK   = 0x82,  //!< Chip to host: resend from the sequence number
+    LR11XX_UART_STREAM_FRAME_DONE  = 0x83,  //!< Chip to host: update status
+} lr11xx_uart_stream_frame_type_t;
+
+/*!
+ * @brief Update requested by the host
+ */
+typedef struct
+{
+    lr11xx_fw_update_t update;          //!< Type of firmware
+    uint32_t           fw_expected;     //!< Version reported by the firmware once flashed
+    uint32_t           length_in_word;  //!< Length of the image in word
+} lr11xx_uart_stream_start_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Start listening for frames on the UART
+ */
+void lr11xx_uart_stream_init( void );
+
+/*!
+ * @brief Check whether the host opened a session
+ *
+ * @param [out] start Update requested by the host
+ *
+ * @returns True if a session is open, false if no valid START frame was received yet
+ */
+bool lr11xx_uart_stream_get_start( lr11xx_uart_stream_start_t* start );
+
+/*!
+ * @brief Get the image of the open session, to be given to lr11xx_update_firmware
+ *
+ * The START frame is acknowledged when the first block is requested, that is once the flash is erased.
+ *
+ * @param [in] start Update requested by the host
+ * @param [out] image Streamed image
+ */
+void lr11xx_uart_stream_get_image( const lr11xx_uart_stream_start_t* start, lr11xx_firmware_image_t* image );
+
+/*!
+ * @brief Report the update status to the host and close the session
+ *
+ * @param [in] status Status returned by lr11xx_update_firmware
+ */
+void lr11xx_uart_stream_finish( lr11xx_fw_update_status_t status );
+
+/*!
+ * @brief Update a CRC-16/CCITT-FALSE with one byte
+ *
+ * @param [in] crc Current CRC, 0xFFFF for the first byte
+ * @param [in] data Byte to add
+ *
+ * @returns Updated CRC
+ */
+uint16_t lr11xx_uart_stream_crc_update( uint16_t crc, uint8_t data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LR11XX_UART_STREAM_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -38,7 +38,9 @@
  */
 
 #include "semtech_logo.h"
+#include "display_image_rle.h"
 #include "stdio.h"
+#include "string.h"
 #include "version.h"
 #include "gui.h"
 
@@ -46,8 +48,11 @@ static lv_obj_t* screen;
 static lv_obj_t* icon;
 static lv_obj_t* lbl_title;
 static lv_obj_t* lbl_version;
+static lv_obj_t* lbl_fw;
 static lv_obj_t* preload;
 static lv_obj_t* lbl_status;
+static lv_obj_t* bar_progress;
+static lv_obj_t* lbl_timing;
 
 static lv_style_t screen_style;
 static lv_style_t title_style;
@@ -63,6 +68,24 @@ static lv_style_t preloader_style;
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
+/*!
+ * @brief Screen layout, in pixels
+ *
+ * The objects changing at run time each have a fixed area, which no text resizes or moves: an update only invalidates
+ * its own area, so that the logo and the title, drawn once, stay in the display memory and are never flushed again.
+ */
+#define GUI_WIDTH 240
+#define GUI_TEXT_LINE_HEIGHT 21  //!< Roboto 16 line height and the 2-pixel line spacing of lv_style_scr
+#define GUI_TEXT_HEIGHT( lines ) ( ( lines ) * GUI_TEXT_LINE_HEIGHT - 2 )
+#define GUI_TITLE_Y 80
+#define GUI_FW_Y 164
+#define GUI_FW_LINES 2
+#define GUI_PROGRESS_Y 206
+#define GUI_STATUS_Y 218
+#define GUI_STATUS_LINES 3
+#define GUI_TIMING_Y 280
+#define GUI_TIMING_LINES 2
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -78,12 +101,31 @@ static lv_style_t preloader_style;
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
  */
 
+/*!
+ * @brief Create a label of fixed area, centered text being cropped to it
+ *
+ * @param [in] parent Screen
+ * @param [in] y Top of the label
+ * @param [in] line_count Number of lines of text the label holds
+ *
+ * @returns Label
+ */
+static lv_obj_t* gui_create_fixed_label( lv_obj_t* parent, lv_coord_t y, uint8_t line_count );
+
+/*!
+ * @brief Set the text of a label, leaving it untouched - and not invalidated - if the text is the same
+ *
+ * @param [in] label Label
+ * @param [in] text Text
+ */
+static void gui_set_text( lv_obj_t* label, const char* text );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
  */
 
-void gui_init( lr11xx_fw_update_t update, uint32_t fw_expected )
+void gui_init( void )
 {
     char buffer[30] = { 0 };
 
@@ -98,6 +140,9 @@ void gui_init( lr11xx_fw_update_t update, uint32_t fw_expected )
     title_style.text.color      = LV_COLOR_WHITE;
     title_style.text.font       = &lv_font_roboto_22;
 
+    /* The logo is stored compressed, and decoded line by line while drawn */
+    display_image_rle_init( );
+
     screen = lv_obj_create( NULL, NULL );
     lv_obj_set_style( screen, &( screen_style ) );
 
@@ -112,8 +157,29 @@ void gui_init( lr11xx_fw_update_t update, uint32_t fw_expected )
     lv_label_set_long_mode( lbl_title, LV_LABEL_LONG_BREAK );
     lv_label_set_align( lbl_title, LV_LABEL_ALIGN_CENTER );
     lv_label_set_text( lbl_title, buffer );
-    lv_obj_set_width( lbl_title, 240 );
-    lv_obj_align( lbl_title, NULL, LV_ALIGN_CENTER, 0, -30 );
+    lv_obj_set_width( lbl_title, GUI_WIDTH );
+    lv_obj_set_pos( lbl_title, 0, GUI_TITLE_Y );
+
+    lbl_fw = gui_create_fixed_label( screen, GUI_FW_Y, GUI_FW_LINES );
+
+    /* Shown once the flash write starts */
+    bar_progress = lv_bar_create( screen, NULL );
+    lv_obj_set_size( bar_progress, 200, 10 );
+    lv_obj_set_pos( bar_progress, ( GUI_WIDTH - 200 ) / 2, GUI_PROGRESS_Y );
+    lv_bar_set_range( bar_progress, 0, 100 );
+    lv_obj_set_hidden( bar_progress, true );
+
+    lbl_status = gui_create_fixed_label( screen, GUI_STATUS_Y, GUI_STATUS_LINES );
+    lv_label_set_text( lbl_status, "UPDATE ON GOING..." );
+
+    lbl_timing = gui_create_fixed_label( screen, GUI_TIMING_Y, GUI_TIMING_LINES );
+
+    lv_scr_load( screen );
+}
+
+void gui_set_firmware( lr11xx_fw_update_t update, uint32_t fw_expected )
+{
+    char buffer[30] = { 0 };
 
     switch( update )
     {
@@ -146,28 +212,43 @@ void gui_init( lr11xx_fw_update_t update, uint32_t fw_expected )
     break;
     }
 
-    lv_obj_t* lbl_fw = lv_label_create( screen, NULL );
-    lv_obj_set_style( lbl_fw, &( screen_style ) );
-    lv_label_set_long_mode( lbl_fw, LV_LABEL_LONG_BREAK );
-    lv_label_set_align( lbl_fw, LV_LABEL_ALIGN_CENTER );
-    lv_label_set_text( lbl_fw, buffer );
-    lv_obj_set_width( lbl_fw, 240 );
-    lv_obj_align( lbl_fw, NULL, LV_ALIGN_CENTER, 0, 30 );
-
-    lbl_status = lv_label_create( screen, NULL );
-    lv_obj_set_style( lbl_status, &( screen_style ) );
-    lv_label_set_long_mode( lbl_status, LV_LABEL_LONG_BREAK );
-    lv_label_set_align( lbl_status, LV_LABEL_ALIGN_CENTER );
-    lv_label_set_text( lbl_status, "UPDATE ON GOING..." );
-    lv_obj_set_width( lbl_status, 240 );
-    lv_obj_align( lbl_status, NULL, LV_ALIGN_CENTER, 0, 80 );
-
-    lv_scr_load( screen );
+    gui_set_text( lbl_fw, buffer );
 }
 
 void gui_update( const char* txt )
 {
-    lv_label_set_text( lbl_status, txt );
+    gui_set_text( lbl_status, txt );
+}
+
+void gui_show_progress( const lr11xx_bootloader_progress_t* progress )
+{
+    char buffer[64] = { 0 };
+
+    const uint32_t percent =
+        ( progress->total_in_byte != 0 )
+            ? ( uint32_t ) ( ( ( uint64_t ) progress->written_in_byte * 100 ) / progress->total_in_byte )
+            : 100;
+
+    lv_obj_set_hidden( bar_progress, false );
+    lv_bar_set_value( bar_progress, ( int16_t ) percent, LV_ANIM_OFF );
+
+    /* Shown in place of the timing, which comes once the update is over */
+    sprintf( buffer, "%u%% - %u kB/s - %u.%us left", percent, progress->rate_in_byte_per_s / 1000,
+             progress->eta_ms / 1000, ( progress->eta_ms / 100 ) % 10 );
+
+    gui_set_text( lbl_timing, buffer );
+}
+
+void gui_show_timing( const lr11xx_fw_update_timing_t* timing )
+{
+    char buffer[64] = { 0 };
+
+    sprintf( buffer, "Erase %u.%us - Write %u.%us\nTotal %u.%us - SPI %u.%us", timing->erase_us / 1000000,
+             ( timing->erase_us / 100000 ) % 10, timing->write_us / 1000000, ( timing->write_us / 100000 ) % 10,
+             timing->total_us / 1000000, ( timing->total_us / 100000 ) % 10, timing->write_spi_us / 1000000,
+             ( timing->write_spi_us / 100000 ) % 10 );
+
+    gui_set_text( lbl_timing, buffer );
 }
 
 /*
@@ -175,4 +256,28 @@ void gui_update( const char* txt )
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
  */
 
+static lv_obj_t* gui_create_fixed_label( lv_obj_t* parent, lv_coord_t y, uint8_t line_count )
+{
+    lv_obj_t* label = lv_label_create( parent, NULL );
+
+    lv_obj_set_style( label, &( screen_style ) );
+    lv_label_set_long_mode( label, LV_LABEL_LONG_CROP );
+    lv_label_set_align( label, LV_LABEL_ALIGN_CENTER );
+    lv_label_set_text( label, "" );
+    lv_obj_set_size( label, GUI_WIDTH, GUI_TEXT_HEIGHT( line_count ) );
+    lv_obj_set_pos( label, 0, y );
+
+    return label;
+}
+
+static void gui_set_text( lv_obj_t* label, const char* text )
+{
+    if( strcmp( lv_label_get_text( label ), text ) == 0 )
+    {
+        return;
+    }
+
+    lv_label_set_text( label, text );
+}
+
 /* --- EOF ------------------------------------------------------------------ */
@@ -38,6 +38,7 @@
  */
 
 #include "lr1110_modem_hal.h"
+#include "lr11xx_modem_crc.h"
 #include "configuration.h"
 #include "system.h"
 
@@ -81,28 +82,28 @@ lr1110_modem_hal_status_t lr1110_modem_hal_write( const void* context, const uin
 
     if( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_HIGH )
     {
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-        system_spi_write( radio_local->spi, &crc, 1 );
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_select( &radio_local->spi_device );
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
+        system_spi_bus_deselect( &radio_local->spi_device );
     }
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
 
-    crc = lr1110_modem_compute_crc( 0xFF, command, command_length );
-    crc = lr1110_modem_compute_crc( crc, data, data_length );
+    crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, command, command_length );
+    crc = lr11xx_modem_crc_update( crc, data, data_length );
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_write( radio_local->spi, command, command_length );
-    system_spi_write( radio_local->spi, data, data_length );
-    system_spi_write( radio_local->spi, &crc, 1 );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_write( radio_local->spi_device.spi, command, command_length );
+    system_spi_write( radio_local->spi_device.spi, data, data_length );
+    system_spi_write( radio_local->spi_device.spi, &crc, 1 );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_HIGH );
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &rc, 1, 0x00 );
-    system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &crc, 1, 0x00 );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &rc, 1, 0x00 );
+    system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &crc, 1, 0x00 );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     return LR1110_MODEM_HAL_STATUS_OK;
 }
@@ -118,22 +119,22 @@ lr1110_modem_hal_status_t lr1110_modem_hal_write_without_rc( const void* radio,
         lr1110_modem_hal_status_t status = LR1110_MODEM_HAL_STATUS_OK;
 
         /* NSS low */
-        system_gpio_set_pin_state( radio_local->nss, 0 );
+        system_spi_bus_select( &radio_local->spi_device );
 
         /* Send CMD */
-        system_spi_write( radio_local->spi, cbuffer, cbuffer_length );
+        system_spi_write( radio_local->spi_device.spi, cbuffer, cbuffer_length );
 
         /* Send Data */
-        system_spi_write( radio_local->spi, cdata, cdata_length );
+        system_spi_write( radio_local->spi_device.spi, cdata, cdata_length );
 
         /* Compute and send CRC */
-        crc = lr1110_modem_compute_crc( 0xFF, cbuffer, cbuffer_length );
-        crc = lr1110_modem_compute_crc( crc, cdata, cdata_length );
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, cbuffer, cbuffer_length );
+        crc = lr11xx_modem_crc_update( crc, cdata, cdata_length );
 
-        system_spi_write( radio_local->spi, &crc, 1 );
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
 
         /* NSS high */
-        system_gpio_set_pin_state( radio_local->nss, 1 );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         return status;
     }
@@ -158,29 +159,29 @@ lr1110_modem_hal_status_t lr1110_modem_hal_read( const void* context, const uint
 
     if( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_HIGH )
     {
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-        system_spi_write( radio_local->spi, &crc, 1 );
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_select( &radio_local->spi_device );
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
+        system_spi_bus_deselect( &radio_local->spi_device );
     }
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
 
-    crc = lr1110_modem_compute_crc( 0xFF, command, command_length );
+    crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, command, command_length );
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_write( radio_local->spi, command, command_length );
-    system_spi_write( radio_local->spi, &crc, 1 );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_write( radio_local->spi_device.spi, command, command_length );
+    system_spi_write( radio_local->spi_device.spi, &crc, 1 );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_HIGH );
 
     crc = 0;
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &rc, 1, 0x00 );
-    system_spi_read_with_dummy_byte( radio_local->spi, data, data_length, 0x00 );
-    system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &crc, 1, 0x00 );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &rc, 1, 0x00 );
+    system_spi_read_with_dummy_byte( radio_local->spi_device.spi, data, data_length, 0x00 );
+    system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &crc, 1, 0x00 );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     return LR1110_MODEM_HAL_STATUS_OK;
 }
@@ -42,6 +42,7 @@
 #include "lr1121_hal.h"
 #include "lr1121_modem_hal.h"
 #include "lr1121_modem_system.h"
+#include "lr11xx_modem_crc.h"
 #include "system.h"
 #include "system_time.h"
 
@@ -123,20 +124,20 @@ lr1121_modem_hal_status_t lr1121_modem_hal_write( const void* context, const uin
         lr1121_modem_hal_status_t status;
 
         /* NSS low */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+        system_spi_bus_select( &radio_local->spi_device );
 
         /* Send CMD */
-        system_spi_write( radio_local->spi, command, command_length );
+        system_spi_write( radio_local->spi_device.spi, command, command_length );
         /* Send Data */
-        system_spi_write( radio_local->spi, data, data_length );
+        system_spi_write( radio_local->spi_device.spi, data, data_length );
         /* Compute and send CRC */
-        crc = lr1121_modem_compute_crc( 0xFF, command, command_length );
-        crc = lr1121_modem_compute_crc( crc, data, data_length );
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, command, command_length );
+        crc = lr11xx_modem_crc_update( crc, data, data_length );
         /* Send CRC */
-        system_spi_write( radio_local->spi, &crc, 1 );
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
 
         /* NSS high */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         /* Wait on busy pin up to 1000 ms */
         if( lr1121_modem_hal_wait_on_busy( context, 1000 ) != LR1121_MODEM_HAL_STATUS_OK )
@@ -147,16 +148,16 @@ lr1121_modem_hal_status_t lr1121_modem_hal_write( const void* context, const uin
         /* Send dummy byte to retrieve RC & CRC */
 
         /* NSS low */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+        system_spi_bus_select( &radio_local->spi_device );
 
         /* read RC */
-        system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &status, 1, 0x00 );
-        system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &crc_received, 1, 0x00 );
+        system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &status, 1, 0x00 );
+        system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &crc_received, 1, 0x00 );
         /* Compute response crc */
-        crc = lr1121_modem_compute_crc( 0xFF, ( uint8_t* ) &status, 1 );
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, ( uint8_t* ) &status, 1 );
 
         /* NSS high */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         if( crc != crc_received )
         {
@@ -187,20 +188,20 @@ lr1121_modem_hal_status_t lr1121_modem_hal_write_without_rc( const void* context
         lr1121_modem_hal_status_t status      = LR1121_MODEM_HAL_STATUS_OK;
 
         /* NSS low */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+        system_spi_bus_select( &radio_local->spi_device );
 
         /* Send CMD */
-        system_spi_write( radio_local->spi, command, command_length );
+        system_spi_write( radio_local->spi_device.spi, command, command_length );
         /* Send Data */
-        system_spi_write( radio_local->spi, data, data_length );
+        system_spi_write( radio_local->spi_device.spi, data, data_length );
         /* Compute and send CRC */
-        crc = lr1121_modem_compute_crc( 0xFF, command, command_length );
-        crc = lr1121_modem_compute_crc( crc, data, data_length );
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, command, command_length );
+        crc = lr11xx_modem_crc_update( crc, data, data_length );
         /* Send CRC */
-        system_spi_write( radio_local->spi, &crc, 1 );
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
 
         /* NSS high */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         return status;
     }
@@ -220,17 +221,17 @@ lr1121_modem_hal_status_t lr1121_modem_hal_read( const void* context, const uint
         lr1121_modem_hal_status_t status;
 
         /* NSS low */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+        system_spi_bus_select( &radio_local->spi_device );
 
         /* Send CMD */
-        system_spi_write( radio_local->spi, command, command_length );
+        system_spi_write( radio_local->spi_device.spi, command, command_length );
         /* Compute and send CRC */
-        crc = lr1121_modem_compute_crc( 0xFF, command, command_length );
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, command, command_length );
         /* Send CRC */
-        system_spi_write( radio_local->spi, &crc, 1 );
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
 
         /* NSS high */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         /* Wait on busy pin up to 1000 ms */
         if( lr1121_modem_hal_wait_on_busy( context, 1000 ) != LR1121_MODEM_HAL_STATUS_OK )
@@ -241,26 +242,26 @@ lr1121_modem_hal_status_t lr1121_modem_hal_read( const void* context, const uint
         /* Send dummy byte to retrieve RC & CRC */
 
         /* NSS low */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+        system_spi_bus_select( &radio_local->spi_device );
 
         /* read RC */
-        system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &status, 1, 0x00 );
+        system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &status, 1, 0x00 );
 
         if( status == LR1121_MODEM_HAL_STATUS_OK )
         {
-            system_spi_read_with_dummy_byte( radio_local->spi, data, data_length, 0x00 );
+            system_spi_read_with_dummy_byte( radio_local->spi_device.spi, data, data_length, 0x00 );
         }
 
-        system_spi_read_with_dummy_byte( radio_local->spi, ( uint8_t* ) &crc_received, 1, 0x00 );
+        system_spi_read_with_dummy_byte( radio_local->spi_device.spi, ( uint8_t* ) &crc_received, 1, 0x00 );
 
         /* NSS high */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         /* Compute response crc */
-        crc = lr1121_modem_compute_crc( 0xFF, ( uint8_t* ) &status, 1 );
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, ( uint8_t* ) &status, 1 );
         if( status == LR1121_MODEM_HAL_STATUS_OK )
         {
-            crc = lr1121_modem_compute_crc( crc, data, data_length );
+            crc = lr11xx_modem_crc_update( crc, data, data_length );
         }
 
         if( crc != crc_received )
@@ -302,8 +303,8 @@ lr1121_modem_hal_status_t lr1121_modem_hal_wakeup( const void* context )
     {
         radio_t* radio_local = ( radio_t* ) context;
         /* Wakeup radio */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_select( &radio_local->spi_device );
+        system_spi_bus_deselect( &radio_local->spi_device );
     }
     else
     {
@@ -324,10 +325,10 @@ lr1121_hal_status_t lr1121_hal_write( const void* context, const uint8_t* comman
     if( lr1121_hal_wakeup( context ) == LR1121_HAL_STATUS_OK )
     {
         radio_t* radio_local = ( radio_t* ) context;
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-        system_spi_write( radio_local->spi, command, command_length );
-        system_spi_write( radio_local->spi, data, data_length );
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_select( &radio_local->spi_device );
+        system_spi_write( radio_local->spi_device.spi, command, command_length );
+        system_spi_write( radio_local->spi_device.spi, data, data_length );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         return lr1121_hal_wait_on_busy( context, 5000 );
     }
@@ -340,11 +341,11 @@ lr1121_hal_status_t lr1121_hal_read( const void* context, const uint8_t* command
     if( lr1121_hal_wakeup( context ) == LR1121_HAL_STATUS_OK )
     {
         radio_t* radio_local = ( radio_t* ) context;
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+        system_spi_bus_select( &radio_local->spi_device );
 
-        system_spi_write( radio_local->spi, command, command_length );
+        system_spi_write( radio_local->spi_device.spi, command, command_length );
 
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         if( lr1121_hal_wait_on_busy( context, 5000 ) != LR1121_HAL_STATUS_OK )
         {
@@ -352,12 +353,12 @@ lr1121_hal_status_t lr1121_hal_read( const void* context, const uint8_t* command
         }
 
         /* Send dummy byte */
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+        system_spi_bus_select( &radio_local->spi_device );
 
         const uint8_t dummy_byte = 0;
-        system_spi_write( radio_local->spi, &dummy_byte, 1 );
-        system_spi_read_with_dummy_byte( radio_local->spi, data, data_length, 0x00 );
-        system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+        system_spi_write( radio_local->spi_device.spi, &dummy_byte, 1 );
+        system_spi_read_with_dummy_byte( radio_local->spi_device.spi, data, data_length, 0x00 );
+        system_spi_bus_deselect( &radio_local->spi_device );
 
         return lr1121_hal_wait_on_busy( context, 5000 );
     }
@@ -368,8 +369,8 @@ lr1121_hal_status_t lr1121_hal_wakeup( const void* context )
 {
     radio_t* radio_local = ( radio_t* ) context;
     /* Wakeup radio */
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     /* Wait on busy pin for 5000 ms */
     return lr1121_hal_wait_on_busy( context, 5000 );
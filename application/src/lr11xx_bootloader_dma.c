@@ -0,0 +1,431 @@
+/*!
+ * @file      lr11xx_bootloader_dma.c
+ *
+ * @brief     LR11XX bootloader flash write pipeline over SPI DMA implementation
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "lr11xx_bootloader_dma.h"
+#include "configuration.h"
+#include "lr11xx_modem_crc.h"
+#include "system.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define LR11XX_BL_WRITE_FLASH_ENCRYPTED_OC ( 0x8003 )
+#define LR11XX_BL_WRITE_FLASH_ENCRYPTED_CMD_LENGTH ( 2 + 4 )
+
+/*!
+ * @brief Image check of the crypto engine: same layout as the encrypted write, handled by the transceiver firmware
+ */
+#define LR11XX_CRYPTO_CHECK_ENCRYPTED_FW_IMAGE_OC ( 0x050F )
+
+/*!
+ * @brief Size of a complete write transaction: command followed by the data block
+ */
+#define LR11XX_BOOTLOADER_DMA_BLOCK_LENGTH \
+    ( LR11XX_BL_WRITE_FLASH_ENCRYPTED_CMD_LENGTH + LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*!
+ * @brief Write transaction ready to be sent
+ */
+typedef struct
+{
+    uint8_t        buffer[LR11XX_BOOTLOADER_DMA_BLOCK_LENGTH];  //!< Command, followed by the data if copied
+    const uint8_t* data;                                        //!< Data block in SPI byte order
+    uint16_t       data_length;                                 //!< Length of the data block in byte, 0 if none
+} lr11xx_bootloader_dma_block_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief Transactions - one is on the wire while the other one is being prepared
+ */
+static lr11xx_bootloader_dma_block_t lr11xx_bootloader_dma_blocks[2];
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Send a whole image, one command per block
+ *
+ * @param [in] context Chip implementation context
+ * @param [in] opcode Command carrying the blocks
+ * @param [in] image Firmware image
+ * @param [inout] timing Timing accumulated over the blocks sent, can be NULL
+ * @param [inout] progress Progress reporting of the blocks sent, can be NULL
+ *
+ * @returns Operation status, LR11XX_STATUS_ERROR if a streamed image failed to provide a block
+ */
+static lr11xx_status_t lr11xx_bootloader_dma_send_image( const void* context, uint16_t opcode,
+                                                         const lr11xx_firmware_image_t*         image,
+                                                         lr11xx_bootloader_write_timing_t*      timing,
+                                                         lr11xx_bootloader_progress_reporter_t* progress );
+
+/*!
+ * @brief Start sending an image, one command per block
+ *
+ * @param [out] transfer Transfer to start
+ * @param [in] opcode Command carrying the blocks
+ * @param [in] image Firmware image
+ *
+ * @returns Operation status, LR11XX_STATUS_ERROR if a streamed image failed to provide the first block
+ */
+static lr11xx_status_t lr11xx_bootloader_dma_start( lr11xx_bootloader_dma_transfer_t* transfer, uint16_t opcode,
+                                                    const lr11xx_firmware_image_t* image );
+
+/*!
+ * @brief Start sending a prepared block: NSS goes low and the DMA starts
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] block Transaction to send
+ *
+ * @returns Cycle counter when NSS went low
+ */
+static uint32_t lr11xx_bootloader_dma_start_block( const radio_t* radio, const lr11xx_bootloader_dma_block_t* block );
+
+/*!
+ * @brief Wait for the end of the block on the wire, then for the chip to raise BUSY
+ *
+ * A transceiver firmware with the SPI CRC on gets the CRC of the block right after it, computed while the DMA sends
+ * the block.
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] block Transaction on the wire
+ * @param [inout] transfer Transfer the block belongs to
+ * @param [inout] timing Timing accumulated over the blocks sent, can be NULL
+ * @param [in] spi_start_cycles Cycle counter when NSS went low
+ */
+static void lr11xx_bootloader_dma_end_block( const radio_t* radio, const lr11xx_bootloader_dma_block_t* block,
+                                             lr11xx_bootloader_dma_transfer_t* transfer,
+                                             lr11xx_bootloader_write_timing_t* timing, uint32_t spi_start_cycles );
+
+/*!
+ * @brief Prepare the command carrying the block starting at a given offset of the image
+ *
+ * @param [out] block Transaction to prepare
+ * @param [in] opcode Command carrying the block
+ * @param [in] image Firmware image
+ * @param [in] offset_in_word Offset of the block in the image
+ *
+ * @returns True if the block is ready or if the end of the image is reached, false if the image failed to provide it
+ */
+static bool lr11xx_bootloader_dma_prepare_block( lr11xx_bootloader_dma_block_t* block, uint16_t opcode,
+                                                 const lr11xx_firmware_image_t* image, uint32_t offset_in_word );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+lr11xx_status_t lr11xx_bootloader_dma_write_image( const void* context, const lr11xx_firmware_image_t* image,
+                                                   lr11xx_bootloader_write_timing_t*      timing,
+                                                   lr11xx_bootloader_progress_reporter_t* progress )
+{
+    return lr11xx_bootloader_dma_send_image( context, LR11XX_BL_WRITE_FLASH_ENCRYPTED_OC, image, timing, progress );
+}
+
+lr11xx_status_t lr11xx_bootloader_dma_check_image( const void* context, const lr11xx_firmware_image_t* image,
+                                                   lr11xx_bootloader_write_timing_t* timing )
+{
+    return lr11xx_bootloader_dma_send_image( context, LR11XX_CRYPTO_CHECK_ENCRYPTED_FW_IMAGE_OC, image, timing, NULL );
+}
+
+lr11xx_status_t lr11xx_bootloader_dma_start_write( lr11xx_bootloader_dma_transfer_t* transfer,
+                                                   const lr11xx_firmware_image_t*    image )
+{
+    return lr11xx_bootloader_dma_start( transfer, LR11XX_BL_WRITE_FLASH_ENCRYPTED_OC, image );
+}
+
+lr11xx_status_t lr11xx_bootloader_dma_start_check( lr11xx_bootloader_dma_transfer_t* transfer,
+                                                   const lr11xx_firmware_image_t*    image )
+{
+    return lr11xx_bootloader_dma_start( transfer, LR11XX_CRYPTO_CHECK_ENCRYPTED_FW_IMAGE_OC, image );
+}
+
+bool lr11xx_bootloader_dma_is_done( const lr11xx_bootloader_dma_transfer_t* transfer )
+{
+    return ( lr11xx_bootloader_dma_blocks[transfer->current].data_length == 0 );
+}
+
+lr11xx_status_t lr11xx_bootloader_dma_send_block( const void* context, lr11xx_bootloader_dma_transfer_t* transfer,
+                                                  lr11xx_bootloader_write_timing_t* timing )
+{
+    const radio_t*                       radio_local = ( const radio_t* ) context;
+    const lr11xx_bootloader_dma_block_t* block       = &lr11xx_bootloader_dma_blocks[transfer->current];
+
+    transfer->offset_in_word += block->data_length / sizeof( uint32_t );
+
+    const uint32_t spi_start_cycles = lr11xx_bootloader_dma_start_block( radio_local, block );
+
+    const bool is_ready = lr11xx_bootloader_dma_prepare_block( &lr11xx_bootloader_dma_blocks[transfer->current ^ 1],
+                                                               transfer->opcode, transfer->image,
+                                                               transfer->offset_in_word );
+
+    lr11xx_bootloader_dma_end_block( radio_local, block, transfer, timing, spi_start_cycles );
+
+    transfer->current ^= 1;
+
+    return ( is_ready == true ) ? LR11XX_STATUS_OK : LR11XX_STATUS_ERROR;
+}
+
+void lr11xx_bootloader_dma_resend_block( const void* context, lr11xx_bootloader_dma_transfer_t* transfer,
+                                         lr11xx_bootloader_write_timing_t* timing )
+{
+    const radio_t*                       radio_local = ( const radio_t* ) context;
+    const lr11xx_bootloader_dma_block_t* block       = &lr11xx_bootloader_dma_blocks[transfer->current ^ 1];
+
+    /* The buffer of the block sent last is only reused once the next block is sent */
+    const uint32_t spi_start_cycles = lr11xx_bootloader_dma_start_block( radio_local, block );
+
+    lr11xx_bootloader_dma_end_block( radio_local, block, transfer, timing, spi_start_cycles );
+}
+
+void lr11xx_bootloader_write_timing_add_block( lr11xx_bootloader_write_timing_t* timing, uint32_t start_cycles,
+                                               uint32_t spi_start_cycles, uint32_t end_cycles )
+{
+    if( timing == NULL )
+    {
+        return;
+    }
+
+    timing->busy_cycles += spi_start_cycles - start_cycles;
+    timing->spi_cycles += end_cycles - spi_start_cycles;
+    timing->block_count++;
+
+    if( ( end_cycles - start_cycles ) > timing->block_max_cycles )
+    {
+        timing->block_max_cycles = end_cycles - start_cycles;
+    }
+}
+
+void lr11xx_bootloader_progress_start( lr11xx_bootloader_progress_reporter_t* reporter, uint32_t total_in_byte )
+{
+    if( ( reporter == NULL ) || ( reporter->callback == NULL ) )
+    {
+        return;
+    }
+
+    reporter->total_in_byte  = total_in_byte;
+    reporter->start_ms       = system_time_GetTicker( );
+    reporter->report_ms      = reporter->start_ms;
+    reporter->report_in_byte = 0;
+}
+
+void lr11xx_bootloader_progress_update( lr11xx_bootloader_progress_reporter_t* reporter, uint32_t written_in_byte )
+{
+    if( ( reporter == NULL ) || ( reporter->callback == NULL ) || ( written_in_byte == reporter->report_in_byte ) )
+    {
+        return;
+    }
+
+    const uint32_t now_ms = system_time_GetTicker( );
+
+    /* Called for every block: only the ticker is read until the period is over */
+    if( ( ( now_ms - reporter->report_ms ) < reporter->period_ms ) && ( written_in_byte < reporter->total_in_byte ) )
+    {
+        return;
+    }
+
+    const uint32_t elapsed_ms  = now_ms - reporter->start_ms;
+    const uint32_t interval_ms = now_ms - reporter->report_ms;
+    const uint32_t left_in_byte =
+        ( written_in_byte < reporter->total_in_byte ) ? ( reporter->total_in_byte - written_in_byte ) : 0;
+
+    const lr11xx_bootloader_progress_t progress = {
+        .written_in_byte = written_in_byte,
+        .total_in_byte   = reporter->total_in_byte,
+        .elapsed_ms      = elapsed_ms,
+        .rate_in_byte_per_s =
+            ( interval_ms != 0 )
+                ? ( uint32_t ) ( ( ( uint64_t ) ( written_in_byte - reporter->report_in_byte ) * 1000 ) / interval_ms )
+                : 0,
+        .average_in_byte_per_s =
+            ( elapsed_ms != 0 ) ? ( uint32_t ) ( ( ( uint64_t ) written_in_byte * 1000 ) / elapsed_ms ) : 0,
+        .eta_ms = ( uint32_t ) ( ( ( uint64_t ) left_in_byte * elapsed_ms ) / written_in_byte ),
+    };
+
+    reporter->report_ms      = now_ms;
+    reporter->report_in_byte = written_in_byte;
+
+    reporter->callback( &progress, reporter->context );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static lr11xx_status_t lr11xx_bootloader_dma_send_image( const void* context, uint16_t opcode,
+                                                         const lr11xx_firmware_image_t*         image,
+                                                         lr11xx_bootloader_write_timing_t*      timing,
+                                                         lr11xx_bootloader_progress_reporter_t* progress )
+{
+    const radio_t*                   radio_local = ( const radio_t* ) context;
+    lr11xx_bootloader_dma_transfer_t transfer;
+    lr11xx_status_t                  status = lr11xx_bootloader_dma_start( &transfer, opcode, image );
+
+    lr11xx_bootloader_progress_start( progress, image->length_in_word * sizeof( uint32_t ) );
+
+    while( ( status == LR11XX_STATUS_OK ) && ( lr11xx_bootloader_dma_is_done( &transfer ) == false ) )
+    {
+        /* BUSY falls once the chip has committed the previous block */
+        system_gpio_wait_for_state_irq( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
+
+        status = lr11xx_bootloader_dma_send_block( context, &transfer, timing );
+
+        /* Reported while the chip writes the block */
+        lr11xx_bootloader_progress_update( progress, transfer.offset_in_word * sizeof( uint32_t ) );
+    }
+
+    return status;
+}
+
+static lr11xx_status_t lr11xx_bootloader_dma_start( lr11xx_bootloader_dma_transfer_t* transfer, uint16_t opcode,
+                                                    const lr11xx_firmware_image_t* image )
+{
+    transfer->image          = image;
+    transfer->opcode         = opcode;
+    transfer->offset_in_word = 0;
+    transfer->current        = 0;
+
+    const bool is_ready = lr11xx_bootloader_dma_prepare_block( &lr11xx_bootloader_dma_blocks[0], opcode, image, 0 );
+
+    transfer->start_cycles = system_time_get_cycles( );
+
+    return ( is_ready == true ) ? LR11XX_STATUS_OK : LR11XX_STATUS_ERROR;
+}
+
+static uint32_t lr11xx_bootloader_dma_start_block( const radio_t* radio, const lr11xx_bootloader_dma_block_t* block )
+{
+    const uint32_t spi_start_cycles = system_time_get_cycles( );
+
+    system_spi_bus_select( &radio->spi_device );
+
+    if( block->data == &block->buffer[LR11XX_BL_WRITE_FLASH_ENCRYPTED_CMD_LENGTH] )
+    {
+        /* Data copied right after the command: one transfer for the whole transaction */
+        system_spi_write_dma( radio->spi_device.spi, block->buffer,
+                              LR11XX_BL_WRITE_FLASH_ENCRYPTED_CMD_LENGTH + block->data_length );
+    }
+    else
+    {
+        system_spi_write( radio->spi_device.spi, block->buffer, LR11XX_BL_WRITE_FLASH_ENCRYPTED_CMD_LENGTH );
+        system_spi_write_dma( radio->spi_device.spi, block->data, block->data_length );
+    }
+
+    return spi_start_cycles;
+}
+
+static void lr11xx_bootloader_dma_end_block( const radio_t* radio, const lr11xx_bootloader_dma_block_t* block,
+                                             lr11xx_bootloader_dma_transfer_t* transfer,
+                                             lr11xx_bootloader_write_timing_t* timing, uint32_t spi_start_cycles )
+{
+    uint8_t crc = 0;
+
+    if( radio->spi_device.is_crc_on == true )
+    {
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, block->buffer,
+                                       LR11XX_BL_WRITE_FLASH_ENCRYPTED_CMD_LENGTH );
+        crc = lr11xx_modem_crc_update( crc, block->data, block->data_length );
+    }
+
+    system_spi_wait_dma( radio->spi_device.spi );
+    if( radio->spi_device.is_crc_on == true )
+    {
+        system_spi_write( radio->spi_device.spi, &crc, 1 );
+    }
+    system_spi_bus_deselect( &radio->spi_device );
+
+    lr11xx_bootloader_write_timing_add_block( timing, transfer->start_cycles, spi_start_cycles,
+                                              system_time_get_cycles( ) );
+
+    /* The next block is already prepared: make sure BUSY went high before waiting for it to fall */
+    transfer->start_cycles = system_time_get_cycles( );
+    while( ( system_gpio_get_pin_state( radio->busy ) == SYSTEM_GPIO_PIN_STATE_LOW ) &&
+           ( system_time_cycles_to_us( system_time_get_cycles( ) - transfer->start_cycles ) <
+             LR11XX_BOOTLOADER_DMA_BUSY_RISE_TIMEOUT_US ) )
+    {
+    }
+}
+
+static bool lr11xx_bootloader_dma_prepare_block( lr11xx_bootloader_dma_block_t* block, uint16_t opcode,
+                                                 const lr11xx_firmware_image_t* image, uint32_t offset_in_word )
+{
+    const uint32_t length_in_word = lr11xx_firmware_image_get_block_length( image, offset_in_word );
+    const uint32_t offset_in_byte = offset_in_word * sizeof( uint32_t );
+
+    block->data_length = ( uint16_t ) ( length_in_word * sizeof( uint32_t ) );
+
+    if( length_in_word == 0 )
+    {
+        return true;
+    }
+
+    block->buffer[0] = ( uint8_t ) ( opcode >> 8 );
+    block->buffer[1] = ( uint8_t ) ( opcode >> 0 );
+    block->buffer[2] = ( uint8_t ) ( offset_in_byte >> 24 );
+    block->buffer[3] = ( uint8_t ) ( offset_in_byte >> 16 );
+    block->buffer[4] = ( uint8_t ) ( offset_in_byte >> 8 );
+    block->buffer[5] = ( uint8_t ) ( offset_in_byte >> 0 );
+
+    block->data = lr11xx_firmware_image_get_block( image, offset_in_word, length_in_word,
+                                                   &block->buffer[LR11XX_BL_WRITE_FLASH_ENCRYPTED_CMD_LENGTH] );
+
+    return ( block->data != NULL );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
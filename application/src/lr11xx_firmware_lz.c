@@ -0,0 +1,294 @@
+/*!
+ * @file      lr11xx_firmware_lz.c
+ *
+ * @brief     LR11XX compressed firmware image implementation
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "lr11xx_firmware_lz.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief First bytes of a container
+ */
+static const uint8_t lr11xx_firmware_lz_magic[4] = { 'L', 'R', 'L', 'Z' };
+
+/*!
+ * @brief Nibble value announcing extension bytes
+ */
+#define LR11XX_FIRMWARE_LZ_NIBBLE_EXTENDED ( 15 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Streamed image source, see lr11xx_firmware_image_read_block_t
+ */
+static const uint8_t* lr11xx_firmware_lz_read_block( void* context, uint32_t offset_in_word, uint32_t length_in_word );
+
+/*!
+ * @brief Streamed image restart, see lr11xx_firmware_image_rewind_t
+ */
+static void lr11xx_firmware_lz_rewind( void* context );
+
+/*!
+ * @brief Decode bytes of the image into the window
+ *
+ * @param [in,out] lz Decoder
+ * @param [out] output Destination in the window, not crossing its end
+ * @param [in] length Number of bytes to decode
+ *
+ * @returns True if the bytes were decoded, false if the container is corrupted
+ */
+static bool lr11xx_firmware_lz_decode( lr11xx_firmware_lz_t* lz, uint8_t* output, uint32_t length );
+
+/*!
+ * @brief Read a length: the nibble of the token, extended by the following bytes when saturated
+ *
+ * @param [in,out] lz Decoder
+ * @param [in] nibble Value from the token
+ * @param [out] length Decoded length
+ *
+ * @returns True if the length was read, false if the container ended
+ */
+static bool lr11xx_firmware_lz_read_length( lr11xx_firmware_lz_t* lz, uint8_t nibble, uint32_t* length );
+
+/*!
+ * @brief Read a little-endian 32-bit field of the container header
+ */
+static uint32_t lr11xx_firmware_lz_get_u32( const uint8_t* buffer );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+bool lr11xx_firmware_lz_init( lr11xx_firmware_lz_t* lz, const uint8_t* container, uint32_t container_length,
+                              lr11xx_firmware_image_t* image )
+{
+    if( ( container_length < LR11XX_FIRMWARE_LZ_HEADER_LENGTH ) ||
+        ( memcmp( container, lr11xx_firmware_lz_magic, sizeof( lr11xx_firmware_lz_magic ) ) != 0 ) ||
+        ( container[4] != LR11XX_FIRMWARE_LZ_FORMAT_VERSION ) ||
+        ( ( container[6] | ( container[7] << 8 ) ) > LR11XX_FIRMWARE_LZ_WINDOW_SIZE ) ||
+        ( ( lr11xx_firmware_lz_get_u32( &container[8] ) % sizeof( uint32_t ) ) != 0 ) )
+    {
+        return false;
+    }
+
+    lz->input         = container;
+    lz->input_length  = container_length;
+    lz->output_length = lr11xx_firmware_lz_get_u32( &container[8] );
+    lr11xx_firmware_lz_rewind( lz );
+
+    image->words          = NULL;
+    image->length_in_word = lz->output_length / sizeof( uint32_t );
+    image->format         = LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM;
+    image->read_block     = lr11xx_firmware_lz_read_block;
+    image->rewind         = lr11xx_firmware_lz_rewind;
+    image->context        = lz;
+
+    return true;
+}
+
+uint32_t lr11xx_firmware_lz_get_crc( const lr11xx_firmware_lz_t* lz )
+{
+    return lr11xx_firmware_lz_get_u32( &lz->input[12] );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static const uint8_t* lr11xx_firmware_lz_read_block( void* context, uint32_t offset_in_word, uint32_t length_in_word )
+{
+    lr11xx_firmware_lz_t* lz     = ( lr11xx_firmware_lz_t* ) context;
+    const uint32_t        length = length_in_word * sizeof( uint32_t );
+
+    /* Blocks start on a block boundary, so that a block never wraps around the end of the window */
+    uint8_t* output = &lz->window[lz->output_offset % LR11XX_FIRMWARE_LZ_WINDOW_SIZE];
+
+    if( ( ( offset_in_word * sizeof( uint32_t ) ) != lz->output_offset ) ||
+        ( length > LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE ) || ( length > lz->output_length - lz->output_offset ) )
+    {
+        return NULL;
+    }
+
+    return ( lr11xx_firmware_lz_decode( lz, output, length ) == true ) ? output : NULL;
+}
+
+static void lr11xx_firmware_lz_rewind( void* context )
+{
+    lr11xx_firmware_lz_t* lz = ( lr11xx_firmware_lz_t* ) context;
+
+    /* The window is left as it is: a match never reaches before the first byte decoded */
+    lz->input_offset  = LR11XX_FIRMWARE_LZ_HEADER_LENGTH;
+    lz->output_offset = 0;
+    lz->literal_count = 0;
+    lz->match_count   = 0;
+    lz->match_offset  = 0;
+    lz->token         = 0;
+    lz->is_match_next = false;
+}
+
+static bool lr11xx_firmware_lz_decode( lr11xx_firmware_lz_t* lz, uint8_t* output, uint32_t length )
+{
+    while( length != 0 )
+    {
+        if( lz->literal_count != 0 )
+        {
+            const uint32_t count = ( lz->literal_count < length ) ? lz->literal_count : length;
+
+            if( count > ( lz->input_length - lz->input_offset ) )
+            {
+                return false;
+            }
+
+            memcpy( output, &lz->input[lz->input_offset], count );
+            lz->input_offset += count;
+            lz->literal_count -= count;
+            lz->output_offset += count;
+            output += count;
+            length -= count;
+        }
+        else if( lz->match_count != 0 )
+        {
+            const uint32_t count = ( lz->match_count < length ) ? lz->match_count : length;
+
+            /* Byte per byte: the match may overlap the bytes it produces */
+            for( uint32_t index = 0; index < count; index++ )
+            {
+                *output++ = lz->window[( lz->output_offset - lz->match_offset ) % LR11XX_FIRMWARE_LZ_WINDOW_SIZE];
+                lz->output_offset++;
+            }
+            lz->match_count -= count;
+            length -= count;
+        }
+        else if( lz->is_match_next == true )
+        {
+            if( ( lz->input_length - lz->input_offset ) < 2 )
+            {
+                return false;
+            }
+
+            lz->match_offset = ( uint16_t ) ( lz->input[lz->input_offset] | ( lz->input[lz->input_offset + 1] << 8 ) );
+            lz->input_offset += 2;
+
+            if( ( lz->match_offset == 0 ) || ( lz->match_offset > LR11XX_FIRMWARE_LZ_WINDOW_SIZE ) ||
+                ( lz->match_offset > lz->output_offset ) ||
+                ( lr11xx_firmware_lz_read_length( lz, lz->token & 0x0F, &lz->match_count ) == false ) )
+            {
+                return false;
+            }
+
+            lz->match_count += LR11XX_FIRMWARE_LZ_MATCH_MIN_LENGTH;
+            lz->is_match_next = false;
+        }
+        else
+        {
+            if( lz->input_offset >= lz->input_length )
+            {
+                return false;
+            }
+
+            lz->token = lz->input[lz->input_offset++];
+            if( lr11xx_firmware_lz_read_length( lz, lz->token >> 4, &lz->literal_count ) == false )
+            {
+                return false;
+            }
+
+            lz->is_match_next = true;
+        }
+    }
+
+    return true;
+}
+
+static bool lr11xx_firmware_lz_read_length( lr11xx_firmware_lz_t* lz, uint8_t nibble, uint32_t* length )
+{
+    uint8_t extension = 255;
+
+    *length = nibble;
+
+    if( nibble != LR11XX_FIRMWARE_LZ_NIBBLE_EXTENDED )
+    {
+        return true;
+    }
+
+    while( extension == 255 )
+    {
+        if( lz->input_offset >= lz->input_length )
+        {
+            return false;
+        }
+
+        extension = lz->input[lz->input_offset++];
+        *length += extension;
+    }
+
+    return true;
+}
+
+static uint32_t lr11xx_firmware_lz_get_u32( const uint8_t* buffer )
+{
+    return ( ( uint32_t ) buffer[0] << 0 ) | ( ( uint32_t ) buffer[1] << 8 ) | ( ( uint32_t ) buffer[2] << 16 ) |
+           ( ( uint32_t ) buffer[3] << 24 );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -38,10 +38,16 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "lr11xx_bootloader.h"
+#include "lr11xx_bootloader_dma.h"
+#include "lr11xx_crypto_engine.h"
+#include "lr11xx_hal.h"
 #include "lr11xx_system.h"
 #include "lr11xx_firmware_update.h"
+#include "lr11xx_modem_crc.h"
+#include "lr1110_bootloader.h"
 #include "lr1110_modem_lorawan.h"
 #include "lr1121_modem_modem.h"
 #include "system.h"
@@ -54,210 +60,3211 @@
 
 #define LR11XX_TYPE_PRODUCTION_MODE 0xDF
 
+/*!
+ * @brief Bit of a chip in the masks of a gang update
+ */
+#define LR11XX_FW_GANG_BIT( index ) ( ( uint32_t ) 1 << ( index ) )
+
+/*!
+ * @brief Select the flash write path: 1 for the SPI DMA pipeline, 0 for the polled driver implementation
+ */
+#ifndef LR11XX_FW_UPDATE_USE_DMA
+#define LR11XX_FW_UPDATE_USE_DMA 1
+#endif
+
+/*!
+ * @brief Check the running firmware first and leave an up-to-date chip untouched: 1 to enable, 0 to always reflash
+ */
+#ifndef LR11XX_FW_UPDATE_SKIP_IF_CURRENT
+#define LR11XX_FW_UPDATE_SKIP_IF_CURRENT 1
+#endif
+
+/*!
+ * @brief Have the running transceiver firmware check the image before the flash is erased: 1 to enable, 0 to skip
+ */
+#ifndef LR11XX_FW_UPDATE_VALIDATE
+#define LR11XX_FW_UPDATE_VALIDATE 0
+#endif
+
+/*!
+ * @brief Exchange a CRC byte with a running transceiver firmware on every command and response: 1 to enable, 0 to
+ * leave the SPI unchecked
+ */
+#ifndef LR11XX_FW_UPDATE_SPI_CRC
+#define LR11XX_FW_UPDATE_SPI_CRC 0
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
-/*
- * -----------------------------------------------------------------------------
- * --- PRIVATE TYPES -----------------------------------------------------------
- */
+#define LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_OC ( 0x8003 )
+#define LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_CMD_LENGTH ( 2 + 4 )
+#define LR11XX_FW_UPDATE_CHECK_ENCRYPTED_FW_IMAGE_OC ( 0x050F )
+
+/*!
+ * @brief Time for the firmware to get ready after a reset
+ *
+ * A transceiver firmware or the bootloader releases BUSY. A modem firmware goes to sleep once booted, with BUSY left
+ * high, and raises its EVENT line (IRQ) for the reset event. A chip doing neither within this delay is assumed to run
+ * a modem firmware, which is then only sent commands if it answers a wake-up.
+ */
+#define LR11XX_FW_UPDATE_PROBE_BOOT_TIMEOUT_MS ( 500 )
+
+/*!
+ * @brief Time BUSY is held low once the chip leaves reset, for the bootloader to sample it
+ *
+ * The retry time is used whenever the chip booted its firmware anyway.
+ */
+#define LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_MS ( 10 )
+#define LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_RETRY_MS ( 500 )
+
+/*!
+ * @brief Maximum time for the bootloader or a transceiver firmware to release BUSY after a reset or a reboot
+ */
+#define LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS ( 1000 )
+
+/*!
+ * @brief Maximum time for a modem firmware to answer a wake-up after a reboot, and period of the wake-ups
+ */
+#define LR11XX_FW_UPDATE_MODEM_BOOT_TIMEOUT_MS ( 5000 )
+#define LR11XX_FW_UPDATE_MODEM_WAKEUP_PERIOD_MS ( 10 )
+
+/*!
+ * @brief Maximum time for the flash erase, and for a chip to get ready for its next block, in a gang update
+ */
+#define LR11XX_FW_UPDATE_GANG_ERASE_TIMEOUT_MS ( 5000 )
+#define LR11XX_FW_UPDATE_GANG_BLOCK_TIMEOUT_MS ( 100 )
+
+/*!
+ * @brief Bootloader version of the LR1110, the only chip a differential update applies to
+ */
+#define LR11XX_FW_UPDATE_LR1110_BOOTLOADER_VERSION ( 0x6500 )
+
+/*!
+ * @brief Largest share of changed pages, in percent, for which erasing and rewriting them one by one beats a full
+ * erase and rewrite
+ */
+#define LR11XX_FW_UPDATE_DIFF_PAGE_PERCENT_MAX ( 50 )
+
+/*!
+ * @brief Number of times the flash is erased and written again after a flash hash mismatch, before giving up
+ */
+#define LR11XX_FW_UPDATE_REFLASH_COUNT_MAX ( 1 )
+
+/*!
+ * @brief Timeout of the waits bounded only by the chip, such as the flash erase
+ */
+#define LR11XX_FW_UPDATE_WAIT_FOREVER ( UINT32_MAX )
+
+/*!
+ * @brief Number of version reads that must all match the reference for a SPI clock to be qualified
+ */
+#define LR11XX_FW_UPDATE_SPI_QUALIFY_READ_COUNT ( 16 )
+
+/*!
+ * @brief Step of lr11xx_update_firmware_spi_prescalers the link qualification starts from: the 10 MHz default clock
+ */
+#define LR11XX_FW_UPDATE_SPI_QUALIFY_FIRST_STEP ( 2 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*!
+ * @brief Outcome of the check of the event a step waits for
+ */
+typedef enum
+{
+    LR11XX_FW_UPDATE_WAIT_PENDING,  //!< Event still to come
+    LR11XX_FW_UPDATE_WAIT_READY,    //!< Event come, or delay elapsed
+    LR11XX_FW_UPDATE_WAIT_TIMEOUT,  //!< Timeout elapsed before the event
+} lr11xx_fw_update_wait_result_t;
+
+/*!
+ * @brief Progress of an image sent block per block
+ */
+typedef enum
+{
+    LR11XX_FW_UPDATE_SEND_PENDING,   //!< Blocks left to send
+    LR11XX_FW_UPDATE_SEND_DONE,      //!< All blocks sent
+    LR11XX_FW_UPDATE_SEND_FAILED,    //!< A streamed image failed to provide a block
+    LR11XX_FW_UPDATE_SEND_REJECTED,  //!< The bootloader failed a block every time it was sent
+} lr11xx_fw_update_send_t;
+
+/*!
+ * @brief Outcome of the check of the status the bootloader reports for a flash erase or a block
+ */
+typedef enum
+{
+    LR11XX_FW_UPDATE_CHECK_DONE,     //!< Command carried out, or nothing to check
+    LR11XX_FW_UPDATE_CHECK_RETRIED,  //!< Command failed and sent again: BUSY is to fall again
+    LR11XX_FW_UPDATE_CHECK_FAILED,   //!< Command failed every retry, or the chip left bootloader mode
+} lr11xx_fw_update_check_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief SPI clocks of the link qualification, slowest first: 2.5, 5, 10, 20 and 40 MHz at 80 MHz PCLK2
+ *
+ * The first one only reads the reference version, right after the reset. PCLK2 has no divider between 10 and 20 MHz:
+ * under the default 16 MHz LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ, the qualification only confirms the 10 MHz default clock
+ * or falls back to a slower one, and never speeds the update up.
+ */
+static const uint32_t lr11xx_update_firmware_spi_prescalers[] = {
+    LL_SPI_BAUDRATEPRESCALER_DIV32, LL_SPI_BAUDRATEPRESCALER_DIV16, LL_SPI_BAUDRATEPRESCALER_DIV8,
+    LL_SPI_BAUDRATEPRESCALER_DIV4,  LL_SPI_BAUDRATEPRESCALER_DIV2,
+};
+
+/*!
+ * @brief Blocks of host-order images byte-swapped during a gang update, two per chip
+ *
+ * The block of an offset is read in the buffer of its parity, keeping the previous block valid until the chip reports
+ * its status, to send it again on a failure.
+ */
+static uint8_t lr11xx_update_firmware_gang_scratch[LR11XX_FW_GANG_TARGET_COUNT_MAX][2]
+                                                  [LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE];
+
+/*!
+ * @brief Progress callback given to the updates, see lr11xx_update_firmware_set_progress_callback
+ */
+static lr11xx_bootloader_progress_callback_t lr11xx_update_firmware_progress_callback = NULL;
+static void*                                 lr11xx_update_firmware_progress_context  = NULL;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Check whether a firmware is of the requested kind
+ *
+ * @param [in] update Chip family and firmware kind
+ * @param [in] kind Requested kind
+ *
+ * @returns True if the firmware is of the requested kind
+ */
+static bool lr11xx_is_fw_of_kind( lr11xx_fw_update_t update, lr11xx_fw_bundle_kind_t kind );
+
+/*!
+ * @brief Set up an update, see lr11xx_update_firmware_start_from_bundle
+ *
+ * @param [in] is_crc_checked Whether the CRC of the selected entry is to be checked
+ * @param [in] diff Firmware a differential update starts from, NULL for a full update
+ */
+static void lr11xx_update_firmware_start_session( lr11xx_fw_update_session_t* session, void* radio,
+                                                  const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                                  lr11xx_fw_bundle_kind_t kind, bool is_crc_checked,
+                                                  const lr11xx_fw_diff_t* diff, lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Run an update to its end, waiting for the chip between the steps
+ *
+ * @param [inout] session Update set up by one of the lr11xx_update_firmware_start functions
+ *
+ * @returns Update status
+ */
+static lr11xx_fw_update_status_t lr11xx_update_firmware_run( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Wait for the event the last step of an update is waiting for, the MCU sleeping whenever it can
+ *
+ * @param [in] session Update
+ */
+static void lr11xx_update_firmware_wait( const lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Check the event a step waits for, the wait starting if none is in progress
+ *
+ * @param [inout] session Update
+ * @param [in] wait Event to wait for
+ * @param [in] timeout_ms Maximum time to wait, LR11XX_FW_UPDATE_WAIT_FOREVER for none
+ *
+ * @returns Outcome of the wait, which is over unless pending
+ */
+static lr11xx_fw_update_wait_result_t lr11xx_update_firmware_wait_for( lr11xx_fw_update_session_t* session,
+                                                                       lr11xx_fw_update_wait_t     wait,
+                                                                       uint32_t                    timeout_ms );
+
+/*!
+ * @brief Move an update to the start of a phase
+ *
+ * @param [inout] session Update
+ * @param [in] state Phase to start
+ */
+static void lr11xx_update_firmware_set_state( lr11xx_fw_update_session_t* session, lr11xx_fw_update_state_t state );
+
+/*!
+ * @brief End an update
+ *
+ * @param [inout] session Update
+ * @param [in] status Update status
+ */
+static void lr11xx_update_firmware_finish( lr11xx_fw_update_session_t* session, lr11xx_fw_update_status_t status );
+
+/*!
+ * @brief Reset the chip into the firmware it holds, if any, and find out whether it is a modem firmware
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_boot( lr11xx_fw_update_session_t* session );
+
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 )
+/*!
+ * @brief Stop the update if the chip already runs a bundle entry
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_probe( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Look for a bundle entry the chip already runs, before any reset into bootloader mode
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] is_modem Whether a modem firmware is running, as found by lr11xx_update_firmware_step_boot
+ * @param [in] bundle Bundle entries
+ * @param [in] entry_count Number of entries
+ * @param [in] kind Kind of firmware to flash
+ *
+ * @returns Entry whose firmware is running, NULL if the chip is to be updated
+ */
+static const lr11xx_fw_bundle_entry_t* lr11xx_update_firmware_probe( void* radio, bool is_modem,
+                                                                      const lr11xx_fw_bundle_entry_t* bundle,
+                                                                      uint8_t                         entry_count,
+                                                                      lr11xx_fw_bundle_kind_t         kind );
+#endif
+
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 )
+/*!
+ * @brief Get the bootloader version of the chip family a transceiver firmware reports
+ *
+ * @param [in] type Chip type reported by the transceiver firmware
+ *
+ * @returns Bootloader version, 0 if the type is not the one of a transceiver firmware
+ */
+static uint16_t lr11xx_update_firmware_get_bootloader_version( uint8_t type );
+
+/*!
+ * @brief Have the running transceiver firmware check the image the chip is about to be flashed with, one block per
+ * step
+ *
+ * The entry is selected from the chip type the way the bootloader version selects it afterwards. The check is
+ * skipped, and the image assumed valid, when no transceiver firmware runs or when the image is streamed.
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_validate( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief End the image check, the update stopping if the chip refused the image
+ *
+ * @param [inout] session Update
+ * @param [in] is_valid Whether the image passed the check
+ */
+static void lr11xx_update_firmware_end_validate( lr11xx_fw_update_session_t* session, bool is_valid );
+#endif
+
+#if( LR11XX_FW_UPDATE_SPI_CRC == 1 )
+/*!
+ * @brief Turn the SPI CRC on if a transceiver firmware runs, the bootloader and the modem firmwares having none
+ *
+ * The HAL appends the CRC to the commands and checks the one of the responses from then on, until the next reset.
+ *
+ * @param [in] radio Chip implementation context
+ */
+static void lr11xx_update_firmware_enable_spi_crc( void* radio );
+#endif
+
+/*!
+ * @brief Check whether the chip runs the base firmware of a differential update, then start the reset
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_base( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Reset the chip into bootloader mode, BUSY being held low while it leaves reset, and read its version
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_reset( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Select the entry meant for the chip, read the PIN and EUIs, check the image and find the pages to rewrite
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_handshake( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Wait for the flash erase, or erase the next page of a differential update
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_erase( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Send the next block to the flash
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_write( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Wait for the last block to be committed
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_commit( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Check the flash hash, the flash being erased and written again on a mismatch
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_hash( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Reboot the chip and wait for the flashed firmware to be ready
+ *
+ * A transceiver firmware releases BUSY once booted. A modem firmware sleeps with BUSY high: it is woken up until it
+ * answers by releasing BUSY.
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_reboot( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Check the version of the flashed firmware
+ *
+ * @param [inout] session Update
+ */
+static void lr11xx_update_firmware_step_verify( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Start the erase of the flash, whole or page per page, followed by the write
+ *
+ * @param [inout] session Update, whose entry is selected
+ */
+static void lr11xx_update_firmware_start_write( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief End the flash write and account for its duration
+ *
+ * @param [inout] session Update
+ * @param [in] send Outcome of the write: all blocks sent, image source failure or block failing every retry
+ */
+static void lr11xx_update_firmware_end_write( lr11xx_fw_update_session_t* session, lr11xx_fw_update_send_t send );
+
+/*!
+ * @brief Erase the whole flash and write it again in the same session, if the image can be read again
+ *
+ * @param [inout] session Update
+ * @param [in] cause What went wrong with the flash, for the log
+ */
+static void lr11xx_update_firmware_rewrite( lr11xx_fw_update_session_t* session, const char* cause );
+
+/*!
+ * @brief Get the number of bytes a differential update writes, pages beyond the image being erased only
+ *
+ * @param [in] session Update, whose page map is filled
+ *
+ * @returns Number of bytes to write
+ */
+static uint32_t lr11xx_update_firmware_get_diff_length( const lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Start sending an image, block per block, to be written to flash or checked
+ *
+ * @param [inout] session Update
+ * @param [in] opcode Command carrying the blocks: encrypted flash write or image check
+ * @param [in] image Firmware image
+ *
+ * @returns False if a streamed image failed to provide the first block
+ */
+static bool lr11xx_update_firmware_start_send( lr11xx_fw_update_session_t* session, uint16_t opcode,
+                                               const lr11xx_firmware_image_t* image );
+
+/*!
+ * @brief Send the next block once the chip is done with the previous one
+ *
+ * The blocks of a differential update are sent from the current page up to its end only.
+ *
+ * @param [inout] session Update
+ *
+ * @returns Progress of the image
+ */
+static lr11xx_fw_update_send_t lr11xx_update_firmware_send( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Send a block of the image being sent, without the DMA pipeline, and account for it in the write timing
+ *
+ * @param [inout] session Update
+ * @param [in] offset_in_word Offset of the block in the image
+ * @param [in] data Block in SPI byte order
+ * @param [in] length_in_word Length of the block in word
+ */
+static void lr11xx_update_firmware_write_block( lr11xx_fw_update_session_t* session, uint32_t offset_in_word,
+                                                const uint8_t* data, uint32_t length_in_word );
+
+/*!
+ * @brief Check the status the bootloader reports for the block written last, and send it again if it failed
+ *
+ * @param [inout] session Update, the chip being done with the block
+ *
+ * @returns Outcome of the check, LR11XX_FW_UPDATE_CHECK_DONE if no block is waiting for its check
+ */
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_block( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Check the status the bootloader reports for the flash or page erase, and erase again if it failed
+ *
+ * @param [inout] session Update, the chip being done with the erase
+ *
+ * @returns Outcome of the check
+ */
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_erase( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Check the status the bootloader reports for the last command, once the chip is done with it
+ *
+ * stat1 tells whether the command failed. stat2 tells whether the chip still runs the bootloader: a chip reset
+ * during the update boots whatever the flash holds, sending the command again being then pointless.
+ *
+ * @param [inout] session Update
+ * @param [inout] retry_count Retry counter of the update timing, incremented if the command is to be sent again
+ *
+ * @returns Outcome of the check, the caller sending the command again on LR11XX_FW_UPDATE_CHECK_RETRIED
+ */
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_command( lr11xx_fw_update_session_t* session,
+                                                                      uint32_t*                   retry_count );
+
+/*!
+ * @brief Check the status the bootloader reports for the last command sent to a chip, see
+ * lr11xx_update_firmware_check_command
+ *
+ * @param [in] radio Chip implementation context
+ * @param [inout] retry_count Retries of the command so far, reset once it succeeds
+ * @param [inout] total_retry_count Retry counter of the update timing, incremented if the command is to be sent again
+ *
+ * @returns Outcome of the check, the caller sending the command again on LR11XX_FW_UPDATE_CHECK_RETRIED
+ */
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_status( const void* radio, uint8_t* retry_count,
+                                                                     uint32_t* total_retry_count );
+
+/*!
+ * @brief Check whether the chip committed the last block sent, the wait being accounted for in the write timing
+ *
+ * @param [inout] session Update
+ *
+ * @returns True once BUSY fell
+ */
+static bool lr11xx_update_firmware_is_committed( lr11xx_fw_update_session_t* session );
+
+/*!
+ * @brief Reset the chip into bootloader mode, BUSY being held low while it leaves reset, for the gang update
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] hold_ms Time BUSY is held low once the chip leaves reset
+ * @param [out] version Version reported by the chip
+ * @param [out] ready_us Time the chip took to release BUSY once released by the MCU
+ *
+ * @returns True if the chip released BUSY in time
+ */
+static bool lr11xx_update_firmware_reset( void* radio, uint32_t hold_ms, lr11xx_bootloader_version_t* version,
+                                          uint32_t* ready_us );
+
+/*!
+ * @brief Get the first bundle entry of a kind meant for a chip family
+ *
+ * @param [in] bundle Bundle entries
+ * @param [in] entry_count Number of entries
+ * @param [in] kind Kind of firmware to flash
+ * @param [in] bootloader_version Bootloader version of the chip
+ *
+ * @returns Selected entry, NULL if none is compatible with the chip
+ */
+static const lr11xx_fw_bundle_entry_t* lr11xx_update_firmware_select( const lr11xx_fw_bundle_entry_t* bundle,
+                                                                       uint8_t                         entry_count,
+                                                                       lr11xx_fw_bundle_kind_t         kind,
+                                                                       uint16_t bootloader_version );
+
+/*!
+ * @brief Read the version of the running firmware, in the form of the expected version
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] update Firmware the chip is expected to run
+ * @param [out] version Version of the running firmware
+ *
+ * @returns True if the chip runs a firmware of the family and kind of update
+ */
+static bool lr11xx_update_firmware_read_version( void* radio, lr11xx_fw_update_t update, uint32_t* version );
+
+/*!
+ * @brief Wake a modem firmware up and wait for it to release BUSY, for a bounded time
+ *
+ * The modem HALs wait for BUSY with no timeout: a chip not answering the wake-up is not probed.
+ *
+ * @param [in] radio Chip implementation context
+ *
+ * @returns True if the modem released BUSY in time
+ */
+static bool lr11xx_update_firmware_wake_modem( void* radio );
+
+/*!
+ * @brief Check whether the chip runs the base firmware of a differential update
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] is_modem Whether a modem firmware is running, as found by lr11xx_update_firmware_step_boot
+ * @param [in] diff Firmware the differential update starts from
+ *
+ * @returns True if the chip runs the base firmware
+ */
+static bool lr11xx_update_firmware_is_base_running( void* radio, bool is_modem, const lr11xx_fw_diff_t* diff );
+
+/*!
+ * @brief Find the flash pages a differential update has to erase
+ *
+ * A page is erased when its CRC differs from the one of the base image, or when it is only part of one of the two
+ * images.
+ *
+ * @param [in] diff Firmware the differential update starts from
+ * @param [in] image Firmware image to flash
+ * @param [out] page_map One bit per page, set for the pages to erase
+ *
+ * @returns Number of pages to erase
+ */
+static uint16_t lr11xx_update_firmware_diff_pages( const lr11xx_fw_diff_t* diff, const lr11xx_firmware_image_t* image,
+                                                   uint8_t page_map[LR11XX_FW_DIFF_PAGE_COUNT_MAX / 8] );
+
+/*!
+ * @brief Read the flash hash from the LR1110 bootloader and compare it with the one expected once the image is written
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] flash_hash Expected hash, NULL if unknown
+ *
+ * @returns False if the hash differs from the expected one, true if it matches or if none is expected
+ */
+static bool lr11xx_update_firmware_check_hash( void* radio, const uint8_t* flash_hash );
+
+/*!
+ * @brief Try the next SPI clock of the link qualification, the fastest one the chip answers reliably on being locked
+ * in for the rest of the update
+ *
+ * The first call tries the default clock, LR11XX_FW_UPDATE_SPI_QUALIFY_FIRST_STEP. Once it passes, the clock is raised
+ * one prescaler step per call up to LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ, the first step failing leaving the previous one
+ * in place. If it fails, the clock is lowered one step per call down to the first one passing, the reference clock
+ * being kept if none does. A step passes if it returns the reference version on every one of
+ * LR11XX_FW_UPDATE_SPI_QUALIFY_READ_COUNT reads.
+ *
+ * @param [in] radio Pointer to the radio structure, the chip being in bootloader mode
+ * @param [in] reference Bootloader version read at the slowest clock
+ * @param [inout] step Prescaler step to try next, 0 on the first call
+ *
+ * @returns True once the clock is locked in
+ */
+static bool lr11xx_update_firmware_qualify_spi( void* radio, const lr11xx_bootloader_version_t* reference,
+                                                uint8_t* step );
+
+/*!
+ * @brief Run the phases of a gang update, see lr11xx_update_firmware_gang
+ *
+ * @returns Mask of the chips updated
+ */
+static uint32_t lr11xx_update_firmware_gang_run( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                 const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                                 lr11xx_fw_bundle_kind_t kind, lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Leave chips out of the next phases of a gang update
+ *
+ * @param [inout] targets Chips of the gang
+ * @param [in] target_count Number of chips
+ * @param [in] active Mask of the chips still updated
+ * @param [in] failed Mask of the chips to leave out
+ * @param [in] status Status of the chips left out
+ * @param [in] reason Reason printed for each chip left out
+ *
+ * @returns Mask of the chips still updated
+ */
+static uint32_t lr11xx_update_firmware_gang_drop( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                  uint32_t active, uint32_t failed, lr11xx_fw_update_status_t status,
+                                                  const char* reason );
+
+/*!
+ * @brief Count the chips of a gang mask
+ *
+ * @param [in] mask Mask of chips
+ *
+ * @returns Number of chips in the mask
+ */
+static uint8_t lr11xx_update_firmware_gang_count( uint32_t mask );
+
+/*!
+ * @brief Wait for the BUSY line of several chips to fall, for a bounded time common to all of them
+ *
+ * @param [in] targets Chips of the gang
+ * @param [in] target_count Number of chips
+ * @param [in] mask Mask of the chips to wait for
+ * @param [in] timeout_ms Maximum time to wait
+ *
+ * @returns Mask of the chips whose BUSY fell in time
+ */
+static uint32_t lr11xx_update_firmware_gang_wait( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                  uint32_t mask, uint32_t timeout_ms );
+
+/*!
+ * @brief Wait for several chips reset into their firmware to get ready, see lr11xx_update_firmware_step_boot
+ *
+ * @param [in] targets Chips of the gang
+ * @param [in] target_count Number of chips
+ * @param [in] mask Mask of the chips to wait for
+ *
+ * @returns Mask of the chips whose BUSY fell in time, the others running a modem firmware or not answering
+ */
+static uint32_t lr11xx_update_firmware_gang_wait_boot( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                       uint32_t mask );
+
+/*!
+ * @brief Reset several chips at once
+ *
+ * @param [in] targets Chips of the gang
+ * @param [in] target_count Number of chips
+ * @param [in] mask Mask of the chips to reset
+ * @param [in] is_bootloader True to hold BUSY low while the chips leave reset, so that they stay in bootloader mode
+ */
+static void lr11xx_update_firmware_gang_reset( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                               uint32_t mask, bool is_bootloader );
+
+/*!
+ * @brief Wait for the firmware flashed on several chips to be ready after the reboot, see
+ * lr11xx_update_firmware_step_reboot
+ *
+ * @param [in] targets Chips of the gang, with their selected entry
+ * @param [in] target_count Number of chips
+ * @param [in] mask Mask of the chips to wait for
+ *
+ * @returns Mask of the chips whose firmware got ready in time
+ */
+static uint32_t lr11xx_update_firmware_gang_wait_ready( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                        uint32_t mask );
+
+/*!
+ * @brief Send images to several chips, block per block and round-robin
+ *
+ * The blocks of a given offset are sent to all chips before the next offset is read, each chip getting its block as
+ * soon as it is done with the previous one. An image going to several chips is read once per block.
+ *
+ * A chip is only seen ready once its BUSY went high after the last block, or LR11XX_BOOTLOADER_DMA_BUSY_RISE_TIMEOUT_US
+ * elapsed. The status of each flash write is then checked as for a single chip, the block being sent again or the chip
+ * dropped on a failure.
+ *
+ * @param [inout] targets Chips of the gang, their block count being updated
+ * @param [in] target_count Number of chips
+ * @param [in] mask Mask of the chips to send to
+ * @param [in] opcode Command carrying the blocks: encrypted flash write or image check
+ * @param [in] entries Entry to send to each chip
+ * @param [out] write_timing Time spent with the bus busy sending the blocks, and idle waiting for a chip
+ * @param [inout] retry_count Retry counter of the update timing, incremented for each block sent again
+ *
+ * @returns Mask of the chips which got and processed all their blocks
+ */
+static uint32_t lr11xx_update_firmware_gang_send( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                  uint32_t mask, uint16_t opcode,
+                                                  const lr11xx_fw_bundle_entry_t* const* entries,
+                                                  lr11xx_bootloader_write_timing_t*      write_timing,
+                                                  uint32_t*                              retry_count );
+
+/*!
+ * @brief Tell whether a chip of the gang is done with the last command, see lr11xx_update_firmware_gang_send
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] bit Bit of the chip in the masks
+ * @param [inout] rising Mask of the chips whose BUSY was not seen high yet since the last command
+ * @param [in] sent_cycles Cycle counter at the end of the last command sent to the chip
+ *
+ * @returns True if the chip BUSY is low and the chip saw the last command
+ */
+static bool lr11xx_update_firmware_gang_is_ready( const void* radio, uint32_t bit, uint32_t* rising,
+                                                  uint32_t sent_cycles );
+
+/*!
+ * @brief Send one block to a chip whose BUSY is low, the transfer being over on return, for the gang and differential
+ * updates and the polled flash write
+ *
+ * @param [in] radio Chip implementation context
+ * @param [in] opcode Command carrying the block
+ * @param [in] offset_in_word Offset of the block in the image
+ * @param [in] data Block in SPI byte order
+ * @param [in] length_in_word Length of the block in word
+ */
+static void lr11xx_update_firmware_send_block( const void* radio, uint16_t opcode, uint32_t offset_in_word,
+                                               const uint8_t* data, uint32_t length_in_word );
+
+/*!
+ * @brief Get the time elapsed since the previous lap and start a new one
+ *
+ * @param [inout] lap_cycles Cycle counter at the start of the lap, updated to the current one
+ *
+ * @returns Duration of the lap in us
+ */
+static uint32_t lr11xx_update_firmware_lap_us( uint32_t* lap_cycles );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+lr11xx_fw_update_status_t lr11xx_update_firmware( void* radio, lr11xx_fw_update_t fw_update_direction,
+                                                  uint32_t fw_expected, const lr11xx_firmware_image_t* image,
+                                                  lr11xx_fw_update_timing_t* timing )
+{
+    return lr11xx_update_firmware_with_hash( radio, fw_update_direction, fw_expected, image, NULL, timing );
+}
+
+lr11xx_fw_update_status_t lr11xx_update_firmware_with_hash( void* radio, lr11xx_fw_update_t fw_update_direction,
+                                                            uint32_t fw_expected, const lr11xx_firmware_image_t* image,
+                                                            const uint8_t*             flash_hash,
+                                                            lr11xx_fw_update_timing_t* timing )
+{
+    lr11xx_fw_update_session_t session;
+
+    lr11xx_update_firmware_start( &session, radio, fw_update_direction, fw_expected, image, flash_hash, timing );
+
+    return lr11xx_update_firmware_run( &session );
+}
+
+lr11xx_fw_update_status_t lr11xx_update_firmware_diff( void* radio, lr11xx_fw_update_t fw_update_direction,
+                                                       uint32_t fw_expected, const lr11xx_firmware_image_t* image,
+                                                       const lr11xx_fw_diff_t*    diff,
+                                                       lr11xx_fw_update_timing_t* timing )
+{
+    lr11xx_fw_update_session_t session;
+
+    lr11xx_update_firmware_start_diff( &session, radio, fw_update_direction, fw_expected, image, diff, timing );
+
+    return lr11xx_update_firmware_run( &session );
+}
+
+lr11xx_fw_update_status_t lr11xx_update_firmware_from_bundle( void* radio, const lr11xx_fw_bundle_entry_t* bundle,
+                                                              uint8_t entry_count, lr11xx_fw_bundle_kind_t kind,
+                                                              const lr11xx_fw_bundle_entry_t** selected,
+                                                              lr11xx_fw_update_timing_t*       timing )
+{
+    lr11xx_fw_update_session_t session;
+
+    lr11xx_update_firmware_start_from_bundle( &session, radio, bundle, entry_count, kind, timing );
+
+    const lr11xx_fw_update_status_t status = lr11xx_update_firmware_run( &session );
+
+    *selected = session.selected;
+
+    return status;
+}
+
+void lr11xx_update_firmware_start( lr11xx_fw_update_session_t* session, void* radio,
+                                   lr11xx_fw_update_t fw_update_direction, uint32_t fw_expected,
+                                   const lr11xx_firmware_image_t* image, const uint8_t* flash_hash,
+                                   lr11xx_fw_update_timing_t* timing )
+{
+    /* A single image is a bundle of one entry, without any reference CRC */
+    const lr11xx_fw_bundle_entry_t entry = {
+        .update      = fw_update_direction,
+        .fw_expected = fw_expected,
+        .image       = *image,
+        .crc         = 0,
+        .flash_hash  = flash_hash,
+    };
+
+    /* The entry is held by the session, which is cleared first */
+    lr11xx_update_firmware_start_session( session, radio, NULL, 1, LR11XX_FW_BUNDLE_KIND_ANY, false, NULL, timing );
+    session->single = entry;
+    session->bundle = &session->single;
+}
+
+void lr11xx_update_firmware_start_diff( lr11xx_fw_update_session_t* session, void* radio,
+                                        lr11xx_fw_update_t fw_update_direction, uint32_t fw_expected,
+                                        const lr11xx_firmware_image_t* image, const lr11xx_fw_diff_t* diff,
+                                        lr11xx_fw_update_timing_t* timing )
+{
+    const uint8_t                  no_hash[LR11XX_FW_FLASH_HASH_LENGTH] = { 0 };
+    const lr11xx_fw_bundle_entry_t entry                                = {
+        .update      = fw_update_direction,
+        .fw_expected = fw_expected,
+        .image       = *image,
+        .crc         = 0,
+        .flash_hash  = ( memcmp( diff->hash, no_hash, LR11XX_FW_FLASH_HASH_LENGTH ) != 0 ) ? diff->hash : NULL,
+    };
+
+    /* The pages left untouched are only checked by the flash hash: without it, the whole flash is written */
+    if( entry.flash_hash == NULL )
+    {
+        printf( "> No expected flash hash (FLASH_HASH) for the differential update, full update\n" );
+        diff = NULL;
+    }
+    /* Pages are compared on an image read in place, and erased one by one by the LR1110 bootloader only */
+    else if( ( image->format == LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM ) ||
+             ( image->length_in_word > ( LR11XX_FW_DIFF_PAGE_COUNT_MAX * LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD ) ) ||
+             ( diff->base_page_count > LR11XX_FW_DIFF_PAGE_COUNT_MAX ) ||
+             ( lr11xx_is_fw_compatible_with_chip( fw_update_direction, LR11XX_FW_UPDATE_LR1110_BOOTLOADER_VERSION ) ==
+               false ) ||
+             ( lr11xx_is_fw_compatible_with_chip( diff->update, LR11XX_FW_UPDATE_LR1110_BOOTLOADER_VERSION ) ==
+               false ) )
+    {
+        printf( "> Differential update not applicable to this image, full update\n" );
+        diff = NULL;
+    }
+
+    /* The entry is held by the session, which is cleared first */
+    lr11xx_update_firmware_start_session( session, radio, NULL, 1, LR11XX_FW_BUNDLE_KIND_ANY, false, diff, timing );
+    session->single = entry;
+    session->bundle = &session->single;
+}
+
+void lr11xx_update_firmware_start_from_bundle( lr11xx_fw_update_session_t* session, void* radio,
+                                               const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                               lr11xx_fw_bundle_kind_t kind, lr11xx_fw_update_timing_t* timing )
+{
+    lr11xx_update_firmware_start_session( session, radio, bundle, entry_count, kind, true, NULL, timing );
+}
+
+bool lr11xx_update_firmware_step( lr11xx_fw_update_session_t* session )
+{
+    switch( session->state )
+    {
+    case LR11XX_FW_UPDATE_STATE_BOOT:
+        lr11xx_update_firmware_step_boot( session );
+        break;
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 )
+    case LR11XX_FW_UPDATE_STATE_PROBE:
+        lr11xx_update_firmware_step_probe( session );
+        break;
+#endif
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 )
+    case LR11XX_FW_UPDATE_STATE_VALIDATE:
+        lr11xx_update_firmware_step_validate( session );
+        break;
+#endif
+    case LR11XX_FW_UPDATE_STATE_BASE:
+        lr11xx_update_firmware_step_base( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_RESET:
+        lr11xx_update_firmware_step_reset( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_HANDSHAKE:
+        lr11xx_update_firmware_step_handshake( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_ERASE:
+        lr11xx_update_firmware_step_erase( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_WRITE:
+        lr11xx_update_firmware_step_write( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_COMMIT:
+        lr11xx_update_firmware_step_commit( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_HASH:
+        lr11xx_update_firmware_step_hash( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_REBOOT:
+        lr11xx_update_firmware_step_reboot( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_VERIFY:
+        lr11xx_update_firmware_step_verify( session );
+        break;
+    case LR11XX_FW_UPDATE_STATE_DONE:
+    default:
+        break;
+    }
+
+    return ( session->state != LR11XX_FW_UPDATE_STATE_DONE );
+}
+
+lr11xx_fw_update_status_t lr11xx_update_firmware_get_status( const lr11xx_fw_update_session_t* session,
+                                                             const lr11xx_fw_bundle_entry_t**  selected )
+{
+    if( selected != NULL )
+    {
+        *selected = session->selected;
+    }
+
+    return session->status;
+}
+
+bool lr11xx_update_firmware_is_waiting( const lr11xx_fw_update_session_t* session )
+{
+    const radio_t* radio_local = ( const radio_t* ) session->radio;
+
+    return ( session->wait == LR11XX_FW_UPDATE_WAIT_DELAY ) ||
+           ( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_HIGH );
+}
+
+uint8_t lr11xx_update_firmware_gang( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                     const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                     lr11xx_fw_bundle_kind_t kind, lr11xx_fw_update_timing_t* timing )
+{
+    lr11xx_fw_update_timing_t timing_local;
+    uint8_t                   done_count = 0;
+
+    if( timing == NULL )
+    {
+        timing = &timing_local;
+    }
+    memset( timing, 0, sizeof( lr11xx_fw_update_timing_t ) );
+
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        targets[index].status             = LR11XX_FW_UPDATE_ERROR;
+        targets[index].selected           = NULL;
+        targets[index].bootloader_version = 0;
+        targets[index].write_block_count  = 0;
+    }
+
+    if( target_count > LR11XX_FW_GANG_TARGET_COUNT_MAX )
+    {
+        printf( "> Gang of %u chips, at most %u supported\n", target_count, LR11XX_FW_GANG_TARGET_COUNT_MAX );
+        return 0;
+    }
+
+    const uint32_t start_ms = system_time_GetTicker( );
+    const uint32_t updated =
+        lr11xx_update_firmware_gang_run( targets, target_count, bundle, entry_count, kind, timing );
+
+    timing->total_us = ( system_time_GetTicker( ) - start_ms ) * 1000;
+
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        if( ( updated & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+        {
+            targets[index].status = LR11XX_FW_UPDATE_OK;
+        }
+        if( ( targets[index].status == LR11XX_FW_UPDATE_OK ) ||
+            ( targets[index].status == LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE ) )
+        {
+            done_count++;
+        }
+    }
+
+    return done_count;
+}
+
+void lr11xx_update_firmware_set_progress_callback( lr11xx_bootloader_progress_callback_t callback, void* context )
+{
+    lr11xx_update_firmware_progress_callback = callback;
+    lr11xx_update_firmware_progress_context  = context;
+}
+
+void lr11xx_update_firmware_print_timing( const lr11xx_fw_update_timing_t* timing )
+{
+    printf( "Update timing:\n" );
+    printf( " - Probe     = %u ms (firmware ready after %u us, timeout %u ms)\n", timing->probe_us / 1000,
+            timing->boot_ready_us, LR11XX_FW_UPDATE_PROBE_BOOT_TIMEOUT_MS );
+    printf( " - Validate  = %u ms\n", timing->validate_us / 1000 );
+    printf( " - Reset     = %u ms (bootloader ready after %u us, timeout %u ms)\n", timing->reset_us / 1000,
+            timing->reset_ready_us, LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS );
+    printf( " - Handshake = %u ms (SPI qualified at %u kHz, max %u kHz)\n", timing->handshake_us / 1000,
+            timing->spi_clock_hz / 1000, LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ / 1000 );
+    if( timing->erase_page_count != 0 )
+    {
+        printf( " - Erase     = %u ms (%u pages)\n", timing->erase_us / 1000, timing->erase_page_count );
+    }
+    else
+    {
+        printf( " - Erase     = %u ms\n", timing->erase_us / 1000 );
+    }
+    printf( " - Write     = %u ms (SPI %u ms, BUSY %u ms, %u blocks, slowest %u us)\n", timing->write_us / 1000,
+            timing->write_spi_us / 1000, timing->write_busy_us / 1000, timing->write_block_count,
+            timing->write_block_max_us );
+    printf( " - Retries   = %u erase, %u block\n", timing->erase_retry_count, timing->block_retry_count );
+    printf( " - Hash      = %u ms (%u re-flash)\n", timing->hash_us / 1000, timing->reflash_count );
+    printf( " - Reboot    = %u ms (firmware ready after %u us)\n", timing->reboot_us / 1000,
+            timing->reboot_ready_us );
+    printf( " - Verify    = %u ms\n", timing->verify_us / 1000 );
+    printf( " - Total     = %u ms\n", timing->total_us / 1000 );
+}
+
+void lr11xx_update_firmware_print_progress( const lr11xx_bootloader_progress_t* progress )
+{
+    const uint32_t percent =
+        ( progress->total_in_byte != 0 )
+            ? ( uint32_t ) ( ( ( uint64_t ) progress->written_in_byte * 100 ) / progress->total_in_byte )
+            : 100;
+
+    printf( "> %3u%% %u/%u bytes, %u bytes/s (avg %u), %u ms left\n", percent, progress->written_in_byte,
+            progress->total_in_byte, progress->rate_in_byte_per_s, progress->average_in_byte_per_s, progress->eta_ms );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void lr11xx_update_firmware_start_session( lr11xx_fw_update_session_t* session, void* radio,
+                                                  const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                                  lr11xx_fw_bundle_kind_t kind, bool is_crc_checked,
+                                                  const lr11xx_fw_diff_t* diff, lr11xx_fw_update_timing_t* timing )
+{
+    memset( session, 0, sizeof( lr11xx_fw_update_session_t ) );
+
+    session->radio          = radio;
+    session->bundle         = bundle;
+    session->entry_count    = entry_count;
+    session->kind           = kind;
+    session->is_crc_checked = is_crc_checked;
+    session->diff           = diff;
+    session->timing         = ( timing != NULL ) ? timing : &session->timing_local;
+    session->status         = LR11XX_FW_UPDATE_ERROR;
+
+    /* A clock qualified on the previous chip says nothing of this one */
+    ( ( radio_t* ) radio )->spi_device.prescaler = LR11XX_SPI_PRESCALER;
+
+    session->progress.callback  = lr11xx_update_firmware_progress_callback;
+    session->progress.context   = lr11xx_update_firmware_progress_context;
+    session->progress.period_ms = LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS;
+
+    memset( session->timing, 0, sizeof( lr11xx_fw_update_timing_t ) );
+
+    /* The whole update may last longer than a turn of the cycle counter: use the ms ticker */
+    session->start_ms   = system_time_GetTicker( );
+    session->lap_cycles = system_time_get_cycles( );
+
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 ) || ( LR11XX_FW_UPDATE_VALIDATE == 1 )
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_BOOT );
+#else
+    /* Only a differential update needs to know what the chip runs */
+    lr11xx_update_firmware_set_state(
+        session, ( diff != NULL ) ? LR11XX_FW_UPDATE_STATE_BOOT : LR11XX_FW_UPDATE_STATE_BASE );
+#endif
+}
+
+static lr11xx_fw_update_status_t lr11xx_update_firmware_run( lr11xx_fw_update_session_t* session )
+{
+    while( lr11xx_update_firmware_step( session ) == true )
+    {
+        lr11xx_update_firmware_wait( session );
+    }
+
+    return lr11xx_update_firmware_get_status( session, NULL );
+}
+
+static void lr11xx_update_firmware_wait( const lr11xx_fw_update_session_t* session )
+{
+    const radio_t* radio_local = ( const radio_t* ) session->radio;
+    const uint32_t elapsed_ms  = system_time_GetTicker( ) - session->wait_start_ms;
+    const uint32_t left_ms =
+        ( elapsed_ms < session->wait_timeout_ms ) ? ( session->wait_timeout_ms - elapsed_ms ) : 0;
+
+    switch( session->wait )
+    {
+    case LR11XX_FW_UPDATE_WAIT_BUSY_LOW:
+        if( session->wait_timeout_ms != LR11XX_FW_UPDATE_WAIT_FOREVER )
+        {
+            ( void ) system_gpio_wait_for_state_timeout( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW, left_ms );
+        }
+        else
+        {
+#if( LR11XX_FW_UPDATE_USE_DMA == 1 )
+            system_gpio_wait_for_state_irq( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
+#else
+            system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
+#endif
+        }
+        break;
+    case LR11XX_FW_UPDATE_WAIT_DELAY:
+        system_time_wait_ms( left_ms );
+        break;
+    case LR11XX_FW_UPDATE_WAIT_BOOT:
+        /* Two lines to watch: checked once per ms, a boot lasting hundreds of ms */
+        system_time_wait_ms( ( left_ms != 0 ) ? 1 : 0 );
+        break;
+    case LR11XX_FW_UPDATE_WAIT_NONE:
+    default:
+        break;
+    }
+}
+
+static lr11xx_fw_update_wait_result_t lr11xx_update_firmware_wait_for( lr11xx_fw_update_session_t* session,
+                                                                       lr11xx_fw_update_wait_t     wait,
+                                                                       uint32_t                    timeout_ms )
+{
+    const radio_t* radio_local = ( const radio_t* ) session->radio;
+
+    if( session->wait == LR11XX_FW_UPDATE_WAIT_NONE )
+    {
+        session->wait            = wait;
+        session->wait_start_ms   = system_time_GetTicker( );
+        session->wait_timeout_ms = timeout_ms;
+    }
+
+    if( ( ( wait == LR11XX_FW_UPDATE_WAIT_BUSY_LOW ) || ( wait == LR11XX_FW_UPDATE_WAIT_BOOT ) ) &&
+        ( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_LOW ) )
+    {
+        session->wait = LR11XX_FW_UPDATE_WAIT_NONE;
+        return LR11XX_FW_UPDATE_WAIT_READY;
+    }
+
+    if( ( wait == LR11XX_FW_UPDATE_WAIT_BOOT ) &&
+        ( system_gpio_get_pin_state( radio_local->irq ) == SYSTEM_GPIO_PIN_STATE_HIGH ) )
+    {
+        session->wait = LR11XX_FW_UPDATE_WAIT_NONE;
+        return LR11XX_FW_UPDATE_WAIT_READY;
+    }
+
+    if( ( system_time_GetTicker( ) - session->wait_start_ms ) >= session->wait_timeout_ms )
+    {
+        session->wait = LR11XX_FW_UPDATE_WAIT_NONE;
+        return ( wait == LR11XX_FW_UPDATE_WAIT_DELAY ) ? LR11XX_FW_UPDATE_WAIT_READY : LR11XX_FW_UPDATE_WAIT_TIMEOUT;
+    }
+
+    return LR11XX_FW_UPDATE_WAIT_PENDING;
+}
+
+static void lr11xx_update_firmware_set_state( lr11xx_fw_update_session_t* session, lr11xx_fw_update_state_t state )
+{
+    session->state = state;
+    session->phase = 0;
+}
+
+static void lr11xx_update_firmware_finish( lr11xx_fw_update_session_t* session, lr11xx_fw_update_status_t status )
+{
+    session->status           = status;
+    session->wait             = LR11XX_FW_UPDATE_WAIT_NONE;
+    session->timing->total_us = ( system_time_GetTicker( ) - session->start_ms ) * 1000;
+
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_DONE );
+}
+
+bool lr11xx_is_chip_in_production_mode( uint8_t type )
+{
+    return ( type == LR11XX_TYPE_PRODUCTION_MODE ) ? true : false;
+}
+
+bool lr11xx_is_fw_compatible_with_chip( lr11xx_fw_update_t update, uint16_t bootloader_version )
+{
+    if( ( ( update == LR1110_FIRMWARE_UPDATE_TO_TRX ) || ( update == LR1110_FIRMWARE_UPDATE_TO_MODEM_V1 ) ) &&
+        ( bootloader_version != 0x6500 ) )
+    {
+        return false;
+    }
+    else if( ( update == LR1120_FIRMWARE_UPDATE_TO_TRX ) && ( bootloader_version != 0x2000 ) )
+    {
+        return false;
+    }
+    else if( ( ( update == LR1121_FIRMWARE_UPDATE_TO_TRX ) || ( update == LR1121_FIRMWARE_UPDATE_TO_MODEM_V2 ) ) &&
+             ( bootloader_version != 0x2100 ) )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+static bool lr11xx_is_fw_of_kind( lr11xx_fw_update_t update, lr11xx_fw_bundle_kind_t kind )
+{
+    const bool is_modem =
+        ( update == LR1110_FIRMWARE_UPDATE_TO_MODEM_V1 ) || ( update == LR1121_FIRMWARE_UPDATE_TO_MODEM_V2 );
+
+    switch( kind )
+    {
+    case LR11XX_FW_BUNDLE_KIND_TRANSCEIVER:
+        return ( is_modem == false );
+    case LR11XX_FW_BUNDLE_KIND_MODEM:
+        return ( is_modem == true );
+    case LR11XX_FW_BUNDLE_KIND_ANY:
+    default:
+        return true;
+    }
+}
+
+static void lr11xx_update_firmware_step_boot( lr11xx_fw_update_session_t* session )
+{
+    const radio_t* radio_local = ( const radio_t* ) session->radio;
+
+    if( session->phase == 0 )
+    {
+        printf( "Reset the chip into its firmware...\n" );
+
+        system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_INPUT,
+                                          SYSTEM_GPIO_PIN_STATE_LOW );
+        lr11xx_system_reset( session->radio );
+        session->ready_start_cycles = system_time_get_cycles( );
+        session->phase              = 1;
+    }
+
+    /* The modem HAL has no timeout: tell a modem firmware apart before sending any command */
+    const lr11xx_fw_update_wait_result_t result = lr11xx_update_firmware_wait_for(
+        session, LR11XX_FW_UPDATE_WAIT_BOOT, LR11XX_FW_UPDATE_PROBE_BOOT_TIMEOUT_MS );
+
+    if( result == LR11XX_FW_UPDATE_WAIT_PENDING )
+    {
+        return;
+    }
+
+    session->is_modem = ( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_HIGH );
+
+    session->timing->boot_ready_us = system_time_cycles_to_us( system_time_get_cycles( ) -
+                                                               session->ready_start_cycles );
+
+#if( LR11XX_FW_UPDATE_SPI_CRC == 1 )
+    if( session->is_modem == false )
+    {
+        lr11xx_update_firmware_enable_spi_crc( session->radio );
+    }
+#endif
+
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 )
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_PROBE );
+#elif( LR11XX_FW_UPDATE_VALIDATE == 1 )
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_VALIDATE );
+#else
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_BASE );
+#endif
+}
+
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 )
+static void lr11xx_update_firmware_step_probe( lr11xx_fw_update_session_t* session )
+{
+    /* Most chips of a re-run are up to date already: spare them the erase and the write */
+    const lr11xx_fw_bundle_entry_t* current = lr11xx_update_firmware_probe(
+        session->radio, session->is_modem, session->bundle, session->entry_count, session->kind );
+
+    session->timing->probe_us = lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    if( current != NULL )
+    {
+        session->selected = current;
+        printf( "> Firmware 0x%08x already running, update skipped\n", current->fw_expected );
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE );
+        return;
+    }
+
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 )
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_VALIDATE );
+#else
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_BASE );
+#endif
+}
+
+static const lr11xx_fw_bundle_entry_t* lr11xx_update_firmware_probe( void* radio, bool is_modem,
+                                                                      const lr11xx_fw_bundle_entry_t* bundle,
+                                                                      uint8_t                         entry_count,
+                                                                      lr11xx_fw_bundle_kind_t         kind )
+{
+    const lr11xx_fw_bundle_kind_t running_kind =
+        ( is_modem == true ) ? LR11XX_FW_BUNDLE_KIND_MODEM : LR11XX_FW_BUNDLE_KIND_TRANSCEIVER;
+
+    if( ( is_modem == true ) && ( lr11xx_update_firmware_wake_modem( radio ) == false ) )
+    {
+        return NULL;
+    }
+
+    for( uint8_t index = 0; index < entry_count; index++ )
+    {
+        uint32_t fw_version = 0;
+
+        if( ( lr11xx_is_fw_of_kind( bundle[index].update, kind ) == true ) &&
+            ( lr11xx_is_fw_of_kind( bundle[index].update, running_kind ) == true ) &&
+            ( lr11xx_update_firmware_read_version( radio, bundle[index].update, &fw_version ) == true ) &&
+            ( fw_version == bundle[index].fw_expected ) )
+        {
+            return &bundle[index];
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 )
+static uint16_t lr11xx_update_firmware_get_bootloader_version( uint8_t type )
+{
+    switch( type )
+    {
+    case LR11XX_SYSTEM_VERSION_TYPE_LR1110:
+        return 0x6500;
+    case LR11XX_SYSTEM_VERSION_TYPE_LR1120:
+        return 0x2000;
+    case LR11XX_SYSTEM_VERSION_TYPE_LR1121:
+        return 0x2100;
+    default:
+        return 0;
+    }
+}
+
+static void lr11xx_update_firmware_step_validate( lr11xx_fw_update_session_t* session )
+{
+    if( session->phase == 0 )
+    {
+        lr11xx_system_version_t         version_trx = { 0x00 };
+        const lr11xx_fw_bundle_entry_t* entry       = NULL;
+
+        if( session->is_modem == false )
+        {
+            lr11xx_system_get_version( session->radio, &version_trx );
+        }
+
+        const uint16_t bootloader_version = lr11xx_update_firmware_get_bootloader_version( version_trx.type );
+
+        if( ( session->is_modem == true ) || ( bootloader_version == 0 ) )
+        {
+            printf( "> Image check skipped: no transceiver firmware running\n" );
+        }
+        else
+        {
+            /* No entry meant for the chip is reported by the bootloader stage */
+            entry = lr11xx_update_firmware_select( session->bundle, session->entry_count, session->kind,
+                                                   bootloader_version );
+            if( ( entry != NULL ) && ( lr11xx_firmware_image_can_rewind( &entry->image ) == false ) )
+            {
+                printf( "> Image check skipped: this streamed image can only be read once\n" );
+                entry = NULL;
+            }
+        }
+
+        if( entry == NULL )
+        {
+            lr11xx_update_firmware_end_validate( session, true );
+            return;
+        }
+
+        printf( "Check the image...\n" );
+        session->phase = 1;
+        if( lr11xx_update_firmware_start_send( session, LR11XX_FW_UPDATE_CHECK_ENCRYPTED_FW_IMAGE_OC, &entry->image ) ==
+            false )
+        {
+            lr11xx_update_firmware_end_validate( session, false );
+        }
+        return;
+    }
+
+    if( session->phase == 1 )
+    {
+        const lr11xx_fw_update_send_t progress = lr11xx_update_firmware_send( session );
+
+        if( progress == LR11XX_FW_UPDATE_SEND_FAILED )
+        {
+            lr11xx_update_firmware_end_validate( session, false );
+        }
+        if( progress != LR11XX_FW_UPDATE_SEND_DONE )
+        {
+            return;
+        }
+        session->phase = 2;
+    }
+
+    if( lr11xx_update_firmware_is_committed( session ) == false )
+    {
+        return;
+    }
+
+    bool is_valid = false;
+
+    lr11xx_crypto_get_check_encrypted_firmware_image_result( session->radio, &is_valid );
+    printf( "> Image check %s: %u blocks, SPI %u ms, BUSY %u ms\n", ( is_valid == true ) ? "passed" : "failed",
+            session->write_timing.block_count, system_time_cycles_to_us( session->write_timing.spi_cycles ) / 1000,
+            system_time_cycles_to_us( session->write_timing.busy_cycles ) / 1000 );
+
+    lr11xx_update_firmware_end_validate( session, is_valid );
+}
+
+static void lr11xx_update_firmware_end_validate( lr11xx_fw_update_session_t* session, bool is_valid )
+{
+    session->timing->validate_us = lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    /* The write timing only accounts for the flash write */
+    memset( &session->write_timing, 0, sizeof( lr11xx_bootloader_write_timing_t ) );
+
+    if( is_valid == false )
+    {
+        /* An image the chip refuses would leave it blank once erased: keep its current firmware instead */
+        printf( "> Image refused by the chip, flash left untouched\n" );
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+        return;
+    }
+
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_BASE );
+}
+#endif
+
+#if( LR11XX_FW_UPDATE_SPI_CRC == 1 )
+static void lr11xx_update_firmware_enable_spi_crc( void* radio )
+{
+    radio_t*              radio_local = ( radio_t* ) radio;
+    const uint32_t        prescaler   = radio_local->spi_device.prescaler;
+    lr11xx_system_stat1_t stat1;
+    lr11xx_system_stat2_t stat2;
+
+    /* Read at the slowest clock of the link qualification: the status carries no CRC */
+    radio_local->spi_device.prescaler = lr11xx_update_firmware_spi_prescalers[0];
+    const lr11xx_status_t status = lr11xx_system_get_status( radio, &stat1, &stat2, NULL );
+    radio_local->spi_device.prescaler = prescaler;
+
+    /* The bootloader runs from ROM and does not know the command */
+    if( ( status == LR11XX_STATUS_OK ) && ( stat2.is_running_from_flash == true ) )
+    {
+        lr11xx_system_enable_spi_crc( radio, true );
+        printf( "> SPI CRC enabled\n" );
+    }
+}
+#endif
+
+static bool lr11xx_update_firmware_reset( void* radio, uint32_t hold_ms, lr11xx_bootloader_version_t* version,
+                                          uint32_t* ready_us )
+{
+    const radio_t* radio_local = ( const radio_t* ) radio;
+
+    system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_OUTPUT, SYSTEM_GPIO_PIN_STATE_LOW );
+
+    lr11xx_system_reset( radio );
+
+    system_time_wait_ms( hold_ms );
+    system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_INPUT, SYSTEM_GPIO_PIN_STATE_LOW );
+
+    const uint32_t start_cycles = system_time_get_cycles( );
+    const bool     is_ready     = system_gpio_wait_for_state_timeout( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW,
+                                                                      LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS );
+
+    *ready_us = system_time_cycles_to_us( system_time_get_cycles( ) - start_cycles );
+
+    if( is_ready == true )
+    {
+        lr11xx_bootloader_get_version( radio, version );
+    }
+
+    return is_ready;
+}
+
+static void lr11xx_update_firmware_step_base( lr11xx_fw_update_session_t* session )
+{
+    /* The flash content is known from the running firmware only: any other chip gets a full update */
+    session->is_base_running =
+        ( session->diff != NULL ) &&
+        ( lr11xx_update_firmware_is_base_running( session->radio, session->is_modem, session->diff ) == true );
+
+    session->timing->probe_us += lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    /* The bootloader version read once reset is the reference of the SPI link qualification: read it slowly */
+    ( ( radio_t* ) session->radio )->spi_device.prescaler = lr11xx_update_firmware_spi_prescalers[0];
+
+    printf( "Reset the chip...\n" );
+    session->hold_ms = LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_MS;
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_RESET );
+}
+
+static void lr11xx_update_firmware_step_reset( lr11xx_fw_update_session_t* session )
+{
+    const radio_t*                   radio_local = ( const radio_t* ) session->radio;
+    const lr11xx_bootloader_version_t* version   = &session->version;
+
+    if( session->phase == 0 )
+    {
+        system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_OUTPUT,
+                                          SYSTEM_GPIO_PIN_STATE_LOW );
+        lr11xx_system_reset( session->radio );
+        session->phase = 1;
+    }
+
+    if( session->phase == 1 )
+    {
+        if( lr11xx_update_firmware_wait_for( session, LR11XX_FW_UPDATE_WAIT_DELAY, session->hold_ms ) ==
+            LR11XX_FW_UPDATE_WAIT_PENDING )
+        {
+            return;
+        }
+
+        system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_INPUT,
+                                          SYSTEM_GPIO_PIN_STATE_LOW );
+        session->ready_start_cycles = system_time_get_cycles( );
+        session->phase              = 2;
+    }
+
+    const lr11xx_fw_update_wait_result_t result = lr11xx_update_firmware_wait_for(
+        session, LR11XX_FW_UPDATE_WAIT_BUSY_LOW, LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS );
+
+    if( result == LR11XX_FW_UPDATE_WAIT_PENDING )
+    {
+        return;
+    }
+
+    session->timing->reset_ready_us = system_time_cycles_to_us( system_time_get_cycles( ) -
+                                                                session->ready_start_cycles );
+    if( result == LR11XX_FW_UPDATE_WAIT_READY )
+    {
+        lr11xx_bootloader_get_version( session->radio, &session->version );
+    }
+
+    if( ( ( result != LR11XX_FW_UPDATE_WAIT_READY ) ||
+          ( lr11xx_is_chip_in_production_mode( version->type ) == false ) ) &&
+        ( session->hold_ms == LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_MS ) )
+    {
+        /* BUSY released before the bootloader sampled it: the chip booted its firmware */
+        printf( "> Bootloader not ready, reset again with BUSY held %u ms\n",
+                LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_RETRY_MS );
+        session->hold_ms = LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_RETRY_MS;
+        session->phase   = 0;
+        return;
+    }
+
+    session->timing->reset_us = lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    if( result != LR11XX_FW_UPDATE_WAIT_READY )
+    {
+        printf( "> Chip still busy %u ms after the reset\n", LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS );
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+        return;
+    }
+    printf( "> Reset done!\n" );
+
+    printf( "Chip in bootloader mode:\n" );
+    printf( " - Chip type               = 0x%02X (0xDF for production)\n", version->type );
+    printf( " - Chip hardware version   = 0x%02X (0x22 for V2C)\n", version->hw );
+    printf( " - Chip bootloader version = 0x%04X \n", version->fw );
+
+    if( lr11xx_is_chip_in_production_mode( version->type ) == false )
+    {
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_WRONG_CHIP_TYPE );
+        return;
+    }
+
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_HANDSHAKE );
+}
+
+static void lr11xx_update_firmware_step_handshake( lr11xx_fw_update_session_t* session )
+{
+    /* One SPI clock per step: the reads of the qualification take about 1 ms per clock */
+    if( lr11xx_update_firmware_qualify_spi( session->radio, &session->version, &session->phase ) == false )
+    {
+        return;
+    }
+
+    /* The bootloader version tells the chip family: take the first entry of the requested kind meant for it */
+    const lr11xx_fw_bundle_entry_t* entry =
+        lr11xx_update_firmware_select( session->bundle, session->entry_count, session->kind, session->version.fw );
+
+    if( entry == NULL )
+    {
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_WRONG_CHIP_TYPE );
+        return;
+    }
+
+    const lr11xx_firmware_image_t* image = &entry->image;
+
+    session->selected = entry;
+    if( session->entry_count > 1 )
+    {
+        printf( "Bundle image %u selected: firmware 0x%08x, %u bytes\n", ( unsigned int ) ( entry - session->bundle ),
+                entry->fw_expected, ( unsigned int ) ( image->length_in_word * sizeof( uint32_t ) ) );
+    }
+
+    session->timing->spi_clock_hz =
+        system_spi_get_clock_hz( ( ( const radio_t* ) session->radio )->spi_device.prescaler );
+    printf( "SPI link qualified at %u kHz\n", session->timing->spi_clock_hz / 1000 );
+
+    lr11xx_bootloader_pin_t      pin      = { 0x00 };
+    lr11xx_bootloader_chip_eui_t chip_eui = { 0x00 };
+    lr11xx_bootloader_join_eui_t join_eui = { 0x00 };
+
+    lr11xx_bootloader_read_pin( session->radio, pin );
+    lr11xx_bootloader_read_chip_eui( session->radio, chip_eui );
+    lr11xx_bootloader_read_join_eui( session->radio, join_eui );
+
+    printf( "PIN is     0x%02X%02X%02X%02X\n", pin[0], pin[1], pin[2], pin[3] );
+    printf( "ChipEUI is 0x%02X%02X%02X%02X%02X%02X%02X%02X\n", chip_eui[0], chip_eui[1], chip_eui[2], chip_eui[3],
+            chip_eui[4], chip_eui[5], chip_eui[6], chip_eui[7] );
+    printf( "JoinEUI is 0x%02X%02X%02X%02X%02X%02X%02X%02X\n", join_eui[0], join_eui[1], join_eui[2], join_eui[3],
+            join_eui[4], join_eui[5], join_eui[6], join_eui[7] );
+
+    /* Nothing is erased until the image to flash is known to be intact, which a streamed image cannot be */
+    if( session->is_crc_checked == true )
+    {
+        uint32_t crc = 0;
+
+        if( image->format == LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM )
+        {
+            printf( "> Streamed bundle image cannot be checked, flash left untouched\n" );
+            lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+            return;
+        }
+
+        if( ( lr11xx_firmware_image_get_crc( image, &crc ) == false ) || ( crc != entry->crc ) )
+        {
+            printf( "> Image CRC mismatch, flash left untouched\n" );
+            lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+            return;
+        }
+    }
+
+    if( session->is_base_running == true )
+    {
+        const uint32_t image_page_count =
+            ( image->length_in_word + LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD - 1 ) / LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD;
+
+        session->page_count = lr11xx_update_firmware_diff_pages( session->diff, image, session->page_map );
+        session->is_diff =
+            ( ( session->page_count * 100 ) <= ( image_page_count * LR11XX_FW_UPDATE_DIFF_PAGE_PERCENT_MAX ) );
+        printf( "%u of %u flash pages changed since firmware 0x%08x%s\n", session->page_count, image_page_count,
+                session->diff->base_version, ( session->is_diff == true ) ? "" : ", full update" );
+    }
+
+    session->timing->handshake_us = lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    /* Only the LR1110 bootloader reports a flash hash */
+    session->is_hash_read = ( session->version.fw == LR11XX_FW_UPDATE_LR1110_BOOTLOADER_VERSION );
+
+    lr11xx_update_firmware_start_write( session );
+}
+
+static void lr11xx_update_firmware_step_erase( lr11xx_fw_update_session_t* session )
+{
+    const lr11xx_firmware_image_t* image = &session->selected->image;
+
+    if( session->is_diff == false )
+    {
+        if( lr11xx_update_firmware_wait_for( session, LR11XX_FW_UPDATE_WAIT_BUSY_LOW, LR11XX_FW_UPDATE_WAIT_FOREVER ) ==
+            LR11XX_FW_UPDATE_WAIT_PENDING )
+        {
+            return;
+        }
+
+        const lr11xx_fw_update_check_t check = lr11xx_update_firmware_check_erase( session );
+
+        if( check != LR11XX_FW_UPDATE_CHECK_DONE )
+        {
+            if( check == LR11XX_FW_UPDATE_CHECK_FAILED )
+            {
+                printf( "> Flash erase failed, chip left in bootloader mode\n" );
+                lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+            }
+            return;
+        }
+
+        printf( "> Flash erase done!\n" );
+        session->erase_us = lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+        printf( "Start flashing firmware...\n" );
+        session->write_start_ms = system_time_GetTicker( );
+        lr11xx_bootloader_progress_start( &session->progress, image->length_in_word * sizeof( uint32_t ) );
+        if( lr11xx_update_firmware_start_send( session, LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_OC, image ) == false )
+        {
+            lr11xx_update_firmware_end_write( session, LR11XX_FW_UPDATE_SEND_FAILED );
+            return;
+        }
+
+        lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_WRITE );
+        return;
+    }
+
+    /* Differential update: erase the next page of the map, once the chip is done with the previous one */
+    if( session->phase == 0 )
+    {
+        while( ( session->page < LR11XX_FW_DIFF_PAGE_COUNT_MAX ) &&
+               ( ( session->page_map[session->page / 8] & ( 1 << ( session->page % 8 ) ) ) == 0 ) )
+        {
+            session->page++;
+        }
+
+        if( session->page == LR11XX_FW_DIFF_PAGE_COUNT_MAX )
+        {
+            lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_COMMIT );
+            return;
+        }
+
+        session->erase_start_cycles = system_time_get_cycles( );
+        session->phase              = 1;
+    }
+
+    if( lr11xx_update_firmware_wait_for( session, LR11XX_FW_UPDATE_WAIT_BUSY_LOW, LR11XX_FW_UPDATE_WAIT_FOREVER ) ==
+        LR11XX_FW_UPDATE_WAIT_PENDING )
+    {
+        return;
+    }
+
+    if( session->phase == 1 )
+    {
+        lr1110_bootloader_erase_page( session->radio, ( uint8_t ) session->page );
+        session->phase = 2;
+        return;
+    }
+
+    const lr11xx_fw_update_check_t check = lr11xx_update_firmware_check_erase( session );
+
+    if( check != LR11XX_FW_UPDATE_CHECK_DONE )
+    {
+        if( check == LR11XX_FW_UPDATE_CHECK_FAILED )
+        {
+            printf( "> Page %u erase failed, chip left in bootloader mode\n", session->page );
+            lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+        }
+        return;
+    }
+
+    session->erase_cycles += system_time_get_cycles( ) - session->erase_start_cycles;
+
+    /* Pages beyond the new image are erased only, their blocks being out of it */
+    const uint32_t page_end = ( session->page + 1 ) * LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD;
+
+    session->image              = image;
+    session->opcode             = LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_OC;
+    session->offset_in_word     = session->page * LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD;
+    session->end_in_word        = ( page_end < image->length_in_word ) ? page_end : image->length_in_word;
+    session->block_start_cycles = system_time_get_cycles( );
+    session->page++;
+
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_WRITE );
+}
+
+static void lr11xx_update_firmware_step_write( lr11xx_fw_update_session_t* session )
+{
+    const lr11xx_fw_update_send_t send = lr11xx_update_firmware_send( session );
+
+    /* Rate-limited: a tick read per block until the period is over */
+    lr11xx_bootloader_progress_update( &session->progress, session->written_in_byte );
+
+    switch( send )
+    {
+    case LR11XX_FW_UPDATE_SEND_DONE:
+        /* The next page of a differential update is erased once the chip is done with this one */
+        lr11xx_update_firmware_set_state(
+            session, ( session->is_diff == true ) ? LR11XX_FW_UPDATE_STATE_ERASE : LR11XX_FW_UPDATE_STATE_COMMIT );
+        break;
+    case LR11XX_FW_UPDATE_SEND_FAILED:
+    case LR11XX_FW_UPDATE_SEND_REJECTED:
+        lr11xx_update_firmware_end_write( session, send );
+        break;
+    case LR11XX_FW_UPDATE_SEND_PENDING:
+    default:
+        break;
+    }
+}
+
+static void lr11xx_update_firmware_step_commit( lr11xx_fw_update_session_t* session )
+{
+    if( lr11xx_update_firmware_is_committed( session ) == true )
+    {
+        lr11xx_update_firmware_end_write( session, LR11XX_FW_UPDATE_SEND_DONE );
+    }
+}
+
+static void lr11xx_update_firmware_step_hash( lr11xx_fw_update_session_t* session )
+{
+    /* A block damaged on its way to the flash may still boot: catch it while the chip is in bootloader mode */
+    const bool is_hash_matching =
+        lr11xx_update_firmware_check_hash( session->radio, session->selected->flash_hash );
+
+    session->timing->hash_us += lr11xx_update_firmware_lap_us( &session->lap_cycles );
+    if( is_hash_matching == true )
+    {
+        lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_REBOOT );
+        return;
+    }
+
+    lr11xx_update_firmware_rewrite( session, "Flash hash mismatch" );
+}
+
+static void lr11xx_update_firmware_step_reboot( lr11xx_fw_update_session_t* session )
+{
+    const bool is_modem = lr11xx_is_fw_of_kind( session->selected->update, LR11XX_FW_BUNDLE_KIND_MODEM );
+
+    if( session->phase == 0 )
+    {
+        printf( "Rebooting...\n" );
+        lr11xx_bootloader_reboot( session->radio, false );
+
+        session->ready_start_cycles = system_time_get_cycles( );
+        session->reboot_start_ms    = system_time_GetTicker( );
+        session->phase              = 1;
+        if( is_modem == true )
+        {
+            lr11xx_hal_wakeup( session->radio );
+        }
+    }
+
+    const lr11xx_fw_update_wait_result_t result = lr11xx_update_firmware_wait_for(
+        session, LR11XX_FW_UPDATE_WAIT_BUSY_LOW,
+        ( is_modem == true ) ? LR11XX_FW_UPDATE_MODEM_WAKEUP_PERIOD_MS : LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS );
+
+    if( result == LR11XX_FW_UPDATE_WAIT_PENDING )
+    {
+        return;
+    }
+
+    if( ( result == LR11XX_FW_UPDATE_WAIT_TIMEOUT ) && ( is_modem == true ) &&
+        ( ( system_time_GetTicker( ) - session->reboot_start_ms ) < LR11XX_FW_UPDATE_MODEM_BOOT_TIMEOUT_MS ) )
+    {
+        /* A booting modem ignores the wake-ups */
+        lr11xx_hal_wakeup( session->radio );
+        return;
+    }
+
+    session->timing->reboot_ready_us = system_time_cycles_to_us( system_time_get_cycles( ) -
+                                                                 session->ready_start_cycles );
+    session->timing->reboot_us = lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    if( result != LR11XX_FW_UPDATE_WAIT_READY )
+    {
+        /* A modem command would wait for BUSY forever */
+        printf( "> Firmware not ready after the reboot\n" );
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+        return;
+    }
+    printf( "> Reboot done!\n" );
+
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_VERIFY );
+}
+
+static void lr11xx_update_firmware_step_verify( lr11xx_fw_update_session_t* session )
+{
+    uint32_t fw_version = 0;
+
+#if( LR11XX_FW_UPDATE_SPI_CRC == 1 )
+    if( lr11xx_is_fw_of_kind( session->selected->update, LR11XX_FW_BUNDLE_KIND_TRANSCEIVER ) == true )
+    {
+        lr11xx_update_firmware_enable_spi_crc( session->radio );
+    }
+#endif
+
+    const bool is_running =
+        lr11xx_update_firmware_read_version( session->radio, session->selected->update, &fw_version );
+
+    const bool is_expected = ( is_running == true ) && ( fw_version == session->selected->fw_expected );
+
+    session->timing->verify_us = lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    lr11xx_update_firmware_finish( session, ( is_expected == true ) ? LR11XX_FW_UPDATE_OK : LR11XX_FW_UPDATE_ERROR );
+}
+
+static void lr11xx_update_firmware_start_write( lr11xx_fw_update_session_t* session )
+{
+    session->erase_us         = 0;
+    session->erase_cycles     = 0;
+    session->written_in_byte  = 0;
+    session->page             = 0;
+    session->retry_count      = 0;
+    session->is_block_pending = false;
+    session->write_start_ms   = system_time_GetTicker( );
+
+    if( session->is_diff == true )
+    {
+        printf( "Start differential flashing...\n" );
+        session->timing->erase_page_count = session->page_count;
+        lr11xx_bootloader_progress_start( &session->progress, lr11xx_update_firmware_get_diff_length( session ) );
+    }
+    else
+    {
+        printf( "Start flash erase...\n" );
+        lr11xx_bootloader_erase_flash( session->radio );
+    }
+
+    lr11xx_update_firmware_set_state( session, LR11XX_FW_UPDATE_STATE_ERASE );
+}
+
+static void lr11xx_update_firmware_end_write( lr11xx_fw_update_session_t* session, lr11xx_fw_update_send_t send )
+{
+    lr11xx_fw_update_timing_t*              timing       = session->timing;
+    const lr11xx_bootloader_write_timing_t* write_timing = &session->write_timing;
+    uint32_t flash_size_in_byte = session->selected->image.length_in_word * sizeof( uint32_t );
+    uint32_t erase_us           = session->erase_us;
+
+    /* The write duration comes from the ms ticker below: only restart the lap */
+    lr11xx_update_firmware_lap_us( &session->lap_cycles );
+
+    /* The write is timed with the ms ticker, as it also includes the time a streamed image takes to provide the
+     * blocks, and the page erases of a differential update are taken out of it */
+    uint32_t write_us = ( system_time_GetTicker( ) - session->write_start_ms ) * 1000;
+
+    if( session->is_diff == true )
+    {
+        flash_size_in_byte = session->written_in_byte;
+        erase_us           = system_time_cycles_to_us( session->erase_cycles );
+        write_us           = ( write_us > erase_us ) ? ( write_us - erase_us ) : 0;
+    }
+    timing->erase_us += erase_us;
+    timing->write_us += write_us;
+
+    /* Sums of per-block durations over all the writes: free of the cycle counter wrap-around */
+    timing->write_spi_us       = system_time_cycles_to_us( write_timing->spi_cycles );
+    timing->write_busy_us      = system_time_cycles_to_us( write_timing->busy_cycles );
+    timing->write_block_max_us = system_time_cycles_to_us( write_timing->block_max_cycles );
+    timing->write_block_count  = write_timing->block_count;
+
+    if( send == LR11XX_FW_UPDATE_SEND_FAILED )
+    {
+        printf( "> Flashing aborted: image source failed after %u blocks\n", write_timing->block_count );
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+        return;
+    }
+    if( send == LR11XX_FW_UPDATE_SEND_REJECTED )
+    {
+        lr11xx_update_firmware_rewrite( session, "Flash write failed" );
+        return;
+    }
+
+    const uint32_t flash_duration_ms = write_us / 1000;
+    printf( "> Flashing done! %u bytes in %u ms (%u bytes/s)\n", flash_size_in_byte, flash_duration_ms,
+            ( flash_duration_ms != 0 ) ? ( flash_size_in_byte * 1000 ) / flash_duration_ms : 0 );
+
+    lr11xx_update_firmware_set_state(
+        session, ( session->is_hash_read == true ) ? LR11XX_FW_UPDATE_STATE_HASH : LR11XX_FW_UPDATE_STATE_REBOOT );
+}
+
+static void lr11xx_update_firmware_rewrite( lr11xx_fw_update_session_t* session, const char* cause )
+{
+    /* A streamed image is read again only if its source can restart it */
+    if( ( session->timing->reflash_count >= LR11XX_FW_UPDATE_REFLASH_COUNT_MAX ) ||
+        ( lr11xx_firmware_image_can_rewind( &session->selected->image ) == false ) )
+    {
+        printf( "> %s, chip left in bootloader mode\n", cause );
+        lr11xx_update_firmware_finish( session, LR11XX_FW_UPDATE_ERROR );
+        return;
+    }
+
+    /* The pages a differential update left untouched are only known to match the base image through their CRC:
+     * start again from a blank flash */
+    printf( "> %s, erase and write again\n", cause );
+    session->timing->reflash_count++;
+    session->timing->erase_page_count = 0;
+    session->is_diff                  = false;
+
+    lr11xx_update_firmware_start_write( session );
+}
+
+static uint32_t lr11xx_update_firmware_get_diff_length( const lr11xx_fw_update_session_t* session )
+{
+    const uint32_t length_in_word = session->selected->image.length_in_word;
+    uint32_t       total_in_word  = 0;
+
+    for( uint16_t page = 0; page < LR11XX_FW_DIFF_PAGE_COUNT_MAX; page++ )
+    {
+        const uint32_t page_start = page * LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD;
+
+        if( ( ( session->page_map[page / 8] & ( 1 << ( page % 8 ) ) ) != 0 ) && ( page_start < length_in_word ) )
+        {
+            const uint32_t page_end = page_start + LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD;
+
+            total_in_word += ( ( page_end < length_in_word ) ? page_end : length_in_word ) - page_start;
+        }
+    }
+
+    return total_in_word * sizeof( uint32_t );
+}
+
+static bool lr11xx_update_firmware_start_send( lr11xx_fw_update_session_t* session, uint16_t opcode,
+                                               const lr11xx_firmware_image_t* image )
+{
+    session->image          = image;
+    session->opcode         = opcode;
+    session->offset_in_word = 0;
+    session->end_in_word    = image->length_in_word;
+
+    /* The image may have been read by the check or by a failed write: the first block is read first again */
+    lr11xx_firmware_image_rewind( image );
+
+#if( LR11XX_FW_UPDATE_USE_DMA == 1 )
+    const lr11xx_status_t status = ( opcode == LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_OC )
+                                       ? lr11xx_bootloader_dma_start_write( &session->transfer, image )
+                                       : lr11xx_bootloader_dma_start_check( &session->transfer, image );
+
+    session->block_start_cycles = session->transfer.start_cycles;
+
+    return ( status == LR11XX_STATUS_OK );
+#else
+    session->block_start_cycles = system_time_get_cycles( );
+
+    return true;
+#endif
+}
+
+static lr11xx_fw_update_send_t lr11xx_update_firmware_send( lr11xx_fw_update_session_t* session )
+{
+    /* BUSY falls once the chip has committed the previous block, whose status is then checked: the last block of an
+     * image or of a page is checked before the image is over */
+    if( lr11xx_update_firmware_wait_for( session, LR11XX_FW_UPDATE_WAIT_BUSY_LOW, LR11XX_FW_UPDATE_WAIT_FOREVER ) ==
+        LR11XX_FW_UPDATE_WAIT_PENDING )
+    {
+        return LR11XX_FW_UPDATE_SEND_PENDING;
+    }
+
+    switch( lr11xx_update_firmware_check_block( session ) )
+    {
+    case LR11XX_FW_UPDATE_CHECK_RETRIED:
+        return LR11XX_FW_UPDATE_SEND_PENDING;
+    case LR11XX_FW_UPDATE_CHECK_FAILED:
+        return LR11XX_FW_UPDATE_SEND_REJECTED;
+    case LR11XX_FW_UPDATE_CHECK_DONE:
+    default:
+        break;
+    }
+
+#if( LR11XX_FW_UPDATE_USE_DMA == 1 )
+    /* Whole images go through the DMA pipeline, the pages of a differential update are sent block per block */
+    const bool is_sent = ( session->is_diff == false ) ? lr11xx_bootloader_dma_is_done( &session->transfer )
+                                                       : ( session->offset_in_word >= session->end_in_word );
+#else
+    const bool is_sent = ( session->offset_in_word >= session->end_in_word );
+#endif
+
+    if( is_sent == true )
+    {
+        return LR11XX_FW_UPDATE_SEND_DONE;
+    }
+
+    /* Only the bootloader reports the status of a block, the image check having a result of its own */
+    session->is_block_pending = ( session->opcode == LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_OC );
+
+#if( LR11XX_FW_UPDATE_USE_DMA == 1 )
+    if( session->is_diff == false )
+    {
+        const lr11xx_status_t status =
+            lr11xx_bootloader_dma_send_block( session->radio, &session->transfer, &session->write_timing );
+
+        session->block_start_cycles = session->transfer.start_cycles;
+        session->written_in_byte    = session->transfer.offset_in_word * sizeof( uint32_t );
+
+        return ( status == LR11XX_STATUS_OK ) ? LR11XX_FW_UPDATE_SEND_PENDING : LR11XX_FW_UPDATE_SEND_FAILED;
+    }
+#endif
+
+    /* Same sequence as lr11xx_bootloader_write_flash_encrypted_full (or its crypto engine counterpart for the image
+     * check), with the BUSY wait taken out of the HAL and the data sent from the image itself whenever it is already
+     * in SPI byte order */
+    const uint32_t block_length = lr11xx_firmware_image_get_block_length( session->image, session->offset_in_word );
+    const uint8_t* data =
+        lr11xx_firmware_image_get_block( session->image, session->offset_in_word, block_length, session->scratch );
+
+    if( data == NULL )
+    {
+        return LR11XX_FW_UPDATE_SEND_FAILED;
+    }
+
+    lr11xx_update_firmware_write_block( session, session->offset_in_word, data, block_length );
+
+    /* Kept for a retry: the scratch block and a streamed block stay available until the next block is obtained */
+    session->block_data   = data;
+    session->block_length = block_length;
+    session->offset_in_word += block_length;
+    session->written_in_byte += block_length * sizeof( uint32_t );
+
+    return LR11XX_FW_UPDATE_SEND_PENDING;
+}
+
+static void lr11xx_update_firmware_write_block( lr11xx_fw_update_session_t* session, uint32_t offset_in_word,
+                                                const uint8_t* data, uint32_t length_in_word )
+{
+    const uint32_t spi_start_cycles = system_time_get_cycles( );
+    lr11xx_update_firmware_send_block( session->radio, session->opcode, offset_in_word, data, length_in_word );
+    const uint32_t end_cycles = system_time_get_cycles( );
+
+    lr11xx_bootloader_write_timing_add_block( &session->write_timing, session->block_start_cycles, spi_start_cycles,
+                                              end_cycles );
+
+    session->block_start_cycles = end_cycles;
+}
+
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_block( lr11xx_fw_update_session_t* session )
+{
+    if( session->is_block_pending == false )
+    {
+        return LR11XX_FW_UPDATE_CHECK_DONE;
+    }
+
+    const lr11xx_fw_update_check_t check =
+        lr11xx_update_firmware_check_command( session, &session->timing->block_retry_count );
+
+    if( check != LR11XX_FW_UPDATE_CHECK_RETRIED )
+    {
+        session->is_block_pending = false;
+        return check;
+    }
+
+#if( LR11XX_FW_UPDATE_USE_DMA == 1 )
+    if( session->is_diff == false )
+    {
+        lr11xx_bootloader_dma_resend_block( session->radio, &session->transfer, &session->write_timing );
+        session->block_start_cycles = session->transfer.start_cycles;
+
+        return check;
+    }
+#endif
+
+    lr11xx_update_firmware_write_block( session, session->offset_in_word - session->block_length,
+                                        session->block_data, session->block_length );
+
+    return check;
+}
+
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_erase( lr11xx_fw_update_session_t* session )
+{
+    const lr11xx_fw_update_check_t check =
+        lr11xx_update_firmware_check_command( session, &session->timing->erase_retry_count );
+
+    if( check == LR11XX_FW_UPDATE_CHECK_RETRIED )
+    {
+        printf( "> Flash erase failed, erase again\n" );
+        if( session->is_diff == true )
+        {
+            lr1110_bootloader_erase_page( session->radio, ( uint8_t ) session->page );
+        }
+        else
+        {
+            lr11xx_bootloader_erase_flash( session->radio );
+        }
+    }
+
+    return check;
+}
+
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_command( lr11xx_fw_update_session_t* session,
+                                                                      uint32_t*                   retry_count )
+{
+    return lr11xx_update_firmware_check_status( session->radio, &session->retry_count, retry_count );
+}
+
+static lr11xx_fw_update_check_t lr11xx_update_firmware_check_status( const void* radio, uint8_t* retry_count,
+                                                                     uint32_t* total_retry_count )
+{
+    lr11xx_bootloader_stat1_t    stat1;
+    lr11xx_bootloader_stat2_t    stat2;
+    lr11xx_bootloader_irq_mask_t irq_status;
+
+    /* Direct read: the status of the last command is kept */
+    if( ( lr11xx_bootloader_get_status( radio, &stat1, &stat2, &irq_status ) != LR11XX_STATUS_OK ) ||
+        ( stat2.is_running_from_flash == true ) )
+    {
+        return LR11XX_FW_UPDATE_CHECK_FAILED;
+    }
+
+    if( ( stat1.command_status != LR11XX_BOOTLOADER_CMD_STATUS_FAIL ) &&
+        ( stat1.command_status != LR11XX_BOOTLOADER_CMD_STATUS_PERR ) )
+    {
+        *retry_count = 0;
+        return LR11XX_FW_UPDATE_CHECK_DONE;
+    }
+
+    if( *retry_count >= LR11XX_FW_UPDATE_RETRY_COUNT_MAX )
+    {
+        return LR11XX_FW_UPDATE_CHECK_FAILED;
+    }
+
+    ( *retry_count )++;
+    ( *total_retry_count )++;
+
+    return LR11XX_FW_UPDATE_CHECK_RETRIED;
+}
+
+static bool lr11xx_update_firmware_is_committed( lr11xx_fw_update_session_t* session )
+{
+    if( lr11xx_update_firmware_wait_for( session, LR11XX_FW_UPDATE_WAIT_BUSY_LOW, LR11XX_FW_UPDATE_WAIT_FOREVER ) ==
+        LR11XX_FW_UPDATE_WAIT_PENDING )
+    {
+        return false;
+    }
+
+    /* Measured from the end of the last block, the same way whatever the write path */
+    session->write_timing.busy_cycles += system_time_get_cycles( ) - session->block_start_cycles;
+
+    return true;
+}
+
+static const lr11xx_fw_bundle_entry_t* lr11xx_update_firmware_select( const lr11xx_fw_bundle_entry_t* bundle,
+                                                                       uint8_t                         entry_count,
+                                                                       lr11xx_fw_bundle_kind_t         kind,
+                                                                       uint16_t bootloader_version )
+{
+    for( uint8_t index = 0; index < entry_count; index++ )
+    {
+        if( ( lr11xx_is_fw_compatible_with_chip( bundle[index].update, bootloader_version ) == true ) &&
+            ( lr11xx_is_fw_of_kind( bundle[index].update, kind ) == true ) )
+        {
+            return &bundle[index];
+        }
+    }
+
+    return NULL;
+}
+
+static bool lr11xx_update_firmware_read_version( void* radio, lr11xx_fw_update_t update, uint32_t* version )
+{
+    switch( update )
+    {
+    case LR1110_FIRMWARE_UPDATE_TO_TRX:
+    case LR1120_FIRMWARE_UPDATE_TO_TRX:
+    case LR1121_FIRMWARE_UPDATE_TO_TRX:
+    {
+        const uint8_t type = ( update == LR1110_FIRMWARE_UPDATE_TO_TRX )   ? LR11XX_SYSTEM_VERSION_TYPE_LR1110
+                             : ( update == LR1120_FIRMWARE_UPDATE_TO_TRX ) ? LR11XX_SYSTEM_VERSION_TYPE_LR1120
+                                                                           : LR11XX_SYSTEM_VERSION_TYPE_LR1121;
+        lr11xx_system_version_t version_trx = { 0x00 };
+        lr11xx_system_uid_t     uid         = { 0x00 };
+
+        if( lr11xx_system_get_version( radio, &version_trx ) != LR11XX_STATUS_OK )
+        {
+            printf( "> Firmware version read failed the SPI CRC check\n" );
+            return false;
+        }
+        printf( "Chip in transceiver mode:\n" );
+        printf( " - Chip type             = 0x%02X\n", version_trx.type );
+        printf( " - Chip hardware version = 0x%02X\n", version_trx.hw );
+        printf( " - Chip firmware version = 0x%04X\n", version_trx.fw );
+
+        lr11xx_system_read_uid( radio, uid );
+
+        *version = version_trx.fw;
+
+        /* The bootloader answers with its own type: a chip left in bootloader mode runs no transceiver firmware */
+        return ( version_trx.type == type );
+    }
+    case LR1110_FIRMWARE_UPDATE_TO_MODEM_V1:
+    {
+        lr1110_modem_version_t version_modem = { 0 };
+
+        if( lr1110_modem_get_version( radio, &version_modem ) != LR1110_MODEM_RESPONSE_CODE_OK )
+        {
+            return false;
+        }
+        printf( "Chip in LoRa Basics Modem-E mode:\n" );
+        printf( " - Chip bootloader version = 0x%08x\n", version_modem.bootloader );
+        printf( " - Chip firmware version   = 0x%08x\n", version_modem.firmware );
+        printf( " - Chip LoRaWAN version    = 0x%04x\n", version_modem.lorawan );
+
+        *version = ( ( uint32_t )( version_modem.functionality ) << 24 ) + version_modem.firmware;
+
+        return true;
+    }
+    case LR1121_FIRMWARE_UPDATE_TO_MODEM_V2:
+    {
+        lr1121_modem_version_t version_modem = { 0 };
+
+        if( lr1121_modem_get_modem_version( radio, &version_modem ) != LR1121_MODEM_RESPONSE_CODE_OK )
+        {
+            return false;
+        }
+        printf( "Chip in LoRa Basics Modem-E mode:\n" );
+        printf( " - Chip use case version: 0x%02X\n", version_modem.use_case );
+        printf( " - Chip modem major version: 0x%02X\n", version_modem.modem_major );
+        printf( " - Chip modem minor version: 0x%02X\n", version_modem.modem_minor );
+        printf( " - Chip modem patch version: 0x%02X\n", version_modem.modem_patch );
+        printf( " - Chip lbm major version: 0x%02X\n", version_modem.lbm_major );
+        printf( " - Chip lbm minor version: 0x%02X\n", version_modem.lbm_minor );
+        printf( " - Chip lbm patch version: 0x%02X\n", version_modem.lbm_patch );
+
+        *version =
+            ( ( uint32_t )( version_modem.use_case ) << 24 ) + ( ( uint32_t )( version_modem.modem_major ) << 16 ) +
+            ( ( uint32_t )( version_modem.modem_minor << 8 ) ) + ( uint32_t )( version_modem.modem_patch );
+
+        return true;
+    }
+    }
+
+    return false;
+}
+
+static bool lr11xx_update_firmware_wake_modem( void* radio )
+{
+    const radio_t* radio_local = ( const radio_t* ) radio;
+    const uint8_t  wakeup      = 0x00;
+
+    if( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_HIGH )
+    {
+        system_spi_bus_select( &radio_local->spi_device );
+        system_spi_write( radio_local->spi_device.spi, &wakeup, 1 );
+        system_spi_bus_deselect( &radio_local->spi_device );
+    }
+
+    if( system_gpio_wait_for_state_timeout( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW,
+                                            LR11XX_FW_UPDATE_MODEM_WAKEUP_PERIOD_MS ) == false )
+    {
+        printf( "> No answer to the modem wake-up, running firmware not probed\n" );
+        return false;
+    }
+
+    return true;
+}
+
+static bool lr11xx_update_firmware_is_base_running( void* radio, bool is_modem, const lr11xx_fw_diff_t* diff )
+{
+    uint32_t version = 0;
+
+    if( ( is_modem != ( diff->update == LR1110_FIRMWARE_UPDATE_TO_MODEM_V1 ) ) ||
+        ( ( is_modem == true ) && ( lr11xx_update_firmware_wake_modem( radio ) == false ) ) )
+    {
+        return false;
+    }
+
+    return ( lr11xx_update_firmware_read_version( radio, diff->update, &version ) == true ) &&
+           ( version == diff->base_version );
+}
+
+static uint16_t lr11xx_update_firmware_diff_pages( const lr11xx_fw_diff_t* diff, const lr11xx_firmware_image_t* image,
+                                                   uint8_t page_map[LR11XX_FW_DIFF_PAGE_COUNT_MAX / 8] )
+{
+    const uint32_t image_page_count =
+        ( image->length_in_word + LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD - 1 ) / LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD;
+    const uint32_t page_count = ( image_page_count > diff->base_page_count ) ? image_page_count : diff->base_page_count;
+    uint16_t       changed    = 0;
+
+    for( uint32_t page = 0; page < page_count; page++ )
+    {
+        /* Pages beyond the new image are erased only, so that no trace of the base firmware is left behind */
+        uint32_t   crc = 0;
+        const bool is_changed =
+            ( page >= diff->base_page_count ) || ( page >= image_page_count ) ||
+            ( lr11xx_firmware_image_get_range_crc( image, page * LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD,
+                                                   LR11XX_FW_DIFF_PAGE_LENGTH_IN_WORD, &crc ) == false ) ||
+            ( crc != diff->base_page_crc[page] );
+
+        if( is_changed == true )
+        {
+            page_map[page / 8] |= ( uint8_t ) ( 1 << ( page % 8 ) );
+            changed++;
+        }
+    }
+
+    return changed;
+}
+
+static bool lr11xx_update_firmware_check_hash( void* radio, const uint8_t* flash_hash )
+{
+    lr1110_bootloader_hash_t hash = { 0 };
+
+    if( lr1110_bootloader_get_hash( radio, hash ) != LR1110_STATUS_OK )
+    {
+        return false;
+    }
+
+    printf( "Flash hash is 0x" );
+    for( uint8_t index = 0; index < LR1110_BL_HASH_LENGTH; index++ )
+    {
+        printf( "%02x", hash[index] );
+    }
+    printf( "\n" );
+
+    if( flash_hash == NULL )
+    {
+        printf( "> No expected flash hash (FLASH_HASH), left to the firmware version check\n" );
+        return true;
+    }
+
+    return ( memcmp( flash_hash, hash, LR11XX_FW_FLASH_HASH_LENGTH ) == 0 );
+}
+
+static bool lr11xx_update_firmware_qualify_spi( void* radio, const lr11xx_bootloader_version_t* reference,
+                                                uint8_t* step )
+{
+    radio_t* radio_local = ( radio_t* ) radio;
+    uint8_t  index       = ( *step == 0 ) ? LR11XX_FW_UPDATE_SPI_QUALIFY_FIRST_STEP : *step;
+
+    /* Raising: stop at the last clock or under the limit. Lowering: skip the clocks over the limit */
+    if( ( index >= ( sizeof( lr11xx_update_firmware_spi_prescalers ) / sizeof( uint32_t ) ) ) ||
+        ( system_spi_get_clock_hz( lr11xx_update_firmware_spi_prescalers[index] ) >
+          LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ ) )
+    {
+        if( index > LR11XX_FW_UPDATE_SPI_QUALIFY_FIRST_STEP )
+        {
+            return true;
+        }
+        while( ( index > 0 ) && ( system_spi_get_clock_hz( lr11xx_update_firmware_spi_prescalers[index] ) >
+                                  LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ ) )
+        {
+            index--;
+        }
+    }
+
+    radio_local->spi_device.prescaler = lr11xx_update_firmware_spi_prescalers[index];
+    if( index == 0 )
+    {
+        return true;
+    }
+
+    for( uint8_t read = 0; read < LR11XX_FW_UPDATE_SPI_QUALIFY_READ_COUNT; read++ )
+    {
+        lr11xx_bootloader_version_t version = { 0 };
+
+        if( ( lr11xx_bootloader_get_version( radio, &version ) != LR11XX_STATUS_OK ) ||
+            ( version.hw != reference->hw ) || ( version.type != reference->type ) || ( version.fw != reference->fw ) )
+        {
+            printf( "> SPI link unreliable at %u kHz\n",
+                    system_spi_get_clock_hz( radio_local->spi_device.prescaler ) / 1000 );
+            radio_local->spi_device.prescaler = lr11xx_update_firmware_spi_prescalers[index - 1];
+            if( ( index > LR11XX_FW_UPDATE_SPI_QUALIFY_FIRST_STEP ) || ( index == 1 ) )
+            {
+                return true;
+            }
+
+            *step = index - 1;
+            return false;
+        }
+    }
+
+    if( index < LR11XX_FW_UPDATE_SPI_QUALIFY_FIRST_STEP )
+    {
+        return true;
+    }
+
+    *step = index + 1;
+    return false;
+}
+
+static uint32_t lr11xx_update_firmware_gang_run( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                 const lr11xx_fw_bundle_entry_t* bundle, uint8_t entry_count,
+                                                 lr11xx_fw_bundle_kind_t kind, lr11xx_fw_update_timing_t* timing )
+{
+    const lr11xx_fw_bundle_entry_t*  entries[LR11XX_FW_GANG_TARGET_COUNT_MAX] = { NULL };
+    lr11xx_bootloader_write_timing_t write_timing                            = { 0 };
+    uint32_t                         lap_cycles                              = system_time_get_cycles( );
+    uint32_t                         active = LR11XX_FW_GANG_BIT( target_count ) - 1;
+    uint32_t                         failed = 0;
+    uint32_t                         wrong  = 0;
+
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 ) || ( LR11XX_FW_UPDATE_VALIDATE == 1 )
+    printf( "Reset %u chips into their firmware...\n", target_count );
+    lr11xx_update_firmware_gang_reset( targets, target_count, active, false );
+
+    /* The modem HAL has no timeout: tell the modem firmwares apart before sending any command */
+    const uint32_t boot_cycles = system_time_get_cycles( );
+    const uint32_t modems      = active & ~lr11xx_update_firmware_gang_wait_boot( targets, target_count, active );
+
+    timing->boot_ready_us = system_time_cycles_to_us( system_time_get_cycles( ) - boot_cycles );
+#endif
+
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 )
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        const uint32_t                  bit     = LR11XX_FW_GANG_BIT( index );
+        const lr11xx_fw_bundle_entry_t* current = lr11xx_update_firmware_probe(
+            targets[index].radio, ( modems & bit ) != 0, bundle, entry_count, kind );
+
+        if( current != NULL )
+        {
+            printf( "> Chip %u: firmware 0x%08x already running, update skipped\n", index, current->fw_expected );
+            targets[index].selected = current;
+            targets[index].status   = LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE;
+            active &= ~bit;
+        }
+    }
+
+    timing->probe_us = lr11xx_update_firmware_lap_us( &lap_cycles );
+#endif
+
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 )
+    lr11xx_bootloader_write_timing_t check_timing = { 0 };
+    uint32_t                         checked      = 0;
+
+    /* An image a chip refuses would leave it blank once erased: keep its current firmware instead */
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        const uint32_t          bit         = LR11XX_FW_GANG_BIT( index );
+        lr11xx_system_version_t version_trx = { 0x00 };
+
+        if( ( ( active & ~modems & bit ) == 0 ) ||
+            ( lr11xx_system_get_version( targets[index].radio, &version_trx ) != LR11XX_STATUS_OK ) )
+        {
+            continue;
+        }
+
+        const uint16_t bootloader_version = lr11xx_update_firmware_get_bootloader_version( version_trx.type );
+
+        entries[index] = ( bootloader_version != 0 )
+                             ? lr11xx_update_firmware_select( bundle, entry_count, kind, bootloader_version )
+                             : NULL;
+        if( ( entries[index] != NULL ) && ( entries[index]->image.format != LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM ) )
+        {
+            checked |= bit;
+        }
+    }
+
+    if( checked != 0 )
+    {
+        printf( "Check the images...\n" );
+        const uint32_t sent = lr11xx_update_firmware_gang_send( targets, target_count, checked,
+                                                                LR11XX_FW_UPDATE_CHECK_ENCRYPTED_FW_IMAGE_OC,
+                                                                entries, &check_timing, &timing->block_retry_count );
 
-/*
- * -----------------------------------------------------------------------------
- * --- PRIVATE VARIABLES -------------------------------------------------------
- */
+        for( uint8_t index = 0; index < target_count; index++ )
+        {
+            bool is_valid = false;
 
-static gpio_t lr11xx_busy = { LR11XX_BUSY_PORT, LR11XX_BUSY_PIN };
+            if( ( checked & LR11XX_FW_GANG_BIT( index ) ) == 0 )
+            {
+                continue;
+            }
+            if( ( sent & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+            {
+                lr11xx_crypto_get_check_encrypted_firmware_image_result( targets[index].radio, &is_valid );
+            }
+            if( is_valid == false )
+            {
+                failed |= LR11XX_FW_GANG_BIT( index );
+            }
+        }
+        printf( "> Image check on %u chips: %u blocks, SPI %u ms, bus idle %u ms\n",
+                lr11xx_update_firmware_gang_count( checked ), check_timing.block_count,
+                system_time_cycles_to_us( check_timing.spi_cycles ) / 1000,
+                system_time_cycles_to_us( check_timing.busy_cycles ) / 1000 );
+    }
 
-/*
- * -----------------------------------------------------------------------------
- * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
- */
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, failed, LR11XX_FW_UPDATE_ERROR,
+                                               "image refused by the chip, flash left untouched" );
+    failed = 0;
 
-bool lr11xx_is_chip_in_production_mode( uint8_t type );
+    timing->validate_us = lr11xx_update_firmware_lap_us( &lap_cycles );
+#endif
 
-bool lr11xx_is_fw_compatible_with_chip( lr11xx_fw_update_t update, uint16_t bootloader_version );
+    printf( "Reset %u chips...\n", lr11xx_update_firmware_gang_count( active ) );
+    lr11xx_update_firmware_gang_reset( targets, target_count, active, true );
 
-/*
- * -----------------------------------------------------------------------------
- * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
- */
+    const uint32_t ready_cycles = system_time_get_cycles( );
+    const uint32_t ready =
+        lr11xx_update_firmware_gang_wait( targets, target_count, active, LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS );
 
-lr11xx_fw_update_status_t lr11xx_update_firmware( void* radio, lr11xx_fw_update_t fw_update_direction,
-                                                  uint32_t fw_expected, const uint32_t* buffer, uint32_t length )
-{
-    lr11xx_bootloader_version_t version_bootloader = { 0 };
+    timing->reset_ready_us = system_time_cycles_to_us( system_time_get_cycles( ) - ready_cycles );
 
-    printf( "Reset the chip...\n" );
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        const uint32_t              bit     = LR11XX_FW_GANG_BIT( index );
+        lr11xx_bootloader_version_t version = { 0 };
+        bool                        is_ready = ( ready & bit ) != 0;
+        uint32_t                    ready_us;
 
-    system_gpio_init_direction_state( lr11xx_busy, SYSTEM_GPIO_PIN_DIRECTION_OUTPUT, SYSTEM_GPIO_PIN_STATE_LOW );
+        if( ( active & bit ) == 0 )
+        {
+            continue;
+        }
 
-    lr11xx_system_reset( radio );
+        if( is_ready == true )
+        {
+            lr11xx_bootloader_get_version( targets[index].radio, &version );
+        }
+        if( ( is_ready == false ) || ( lr11xx_is_chip_in_production_mode( version.type ) == false ) )
+        {
+            /* BUSY released before the bootloader sampled it: the chip booted its firmware */
+            printf( "> Chip %u: bootloader not ready, reset again with BUSY held %u ms\n", index,
+                    LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_RETRY_MS );
+            is_ready = lr11xx_update_firmware_reset( targets[index].radio,
+                                                     LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_RETRY_MS, &version,
+                                                     &ready_us );
+        }
+
+        if( is_ready == false )
+        {
+            failed |= bit;
+        }
+        else if( lr11xx_is_chip_in_production_mode( version.type ) == false )
+        {
+            wrong |= bit;
+        }
+        else
+        {
+            targets[index].bootloader_version = version.fw;
+        }
+    }
 
-    system_time_wait_ms( 500 );
-    system_gpio_init_direction_state( lr11xx_busy, SYSTEM_GPIO_PIN_DIRECTION_INPUT, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_time_wait_ms( 100 );
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, failed, LR11XX_FW_UPDATE_ERROR,
+                                               "still busy after the reset" );
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, wrong, LR11XX_FW_UPDATE_WRONG_CHIP_TYPE,
+                                               "not in production mode" );
+    failed = 0;
+    wrong  = 0;
 
-    printf( "> Reset done!\n" );
+    timing->reset_us = lr11xx_update_firmware_lap_us( &lap_cycles );
 
-    lr11xx_bootloader_get_version( radio, &version_bootloader );
-    printf( "Chip in bootloader mode:\n" );
-    printf( " - Chip type               = 0x%02X (0xDF for production)\n", version_bootloader.type );
-    printf( " - Chip hardware version   = 0x%02X (0x22 for V2C)\n", version_bootloader.hw );
-    printf( " - Chip bootloader version = 0x%04X \n", version_bootloader.fw );
+    uint32_t crc_checked = 0;
+    uint32_t intact      = 0;
+
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        const uint32_t               bit      = LR11XX_FW_GANG_BIT( index );
+        lr11xx_bootloader_chip_eui_t chip_eui = { 0x00 };
+        uint8_t                      first    = 0;
+
+        if( ( active & bit ) == 0 )
+        {
+            continue;
+        }
+
+        /* The bootloader version tells the chip family: take the first entry of the requested kind meant for it */
+        const lr11xx_fw_bundle_entry_t* entry =
+            lr11xx_update_firmware_select( bundle, entry_count, kind, targets[index].bootloader_version );
+
+        if( entry == NULL )
+        {
+            wrong |= bit;
+            continue;
+        }
+        targets[index].selected = entry;
+        entries[index]          = entry;
+
+        lr11xx_bootloader_read_chip_eui( targets[index].radio, chip_eui );
+        printf( "Chip %u: bootloader 0x%04X, ChipEUI 0x%02X%02X%02X%02X%02X%02X%02X%02X, image %u\n", index,
+                targets[index].bootloader_version, chip_eui[0], chip_eui[1], chip_eui[2], chip_eui[3], chip_eui[4],
+                chip_eui[5], chip_eui[6], chip_eui[7], ( unsigned int ) ( entry - bundle ) );
+
+        /* Nothing is erased until the image to flash is known to be intact, each image being checked once */
+        while( ( first < index ) &&
+               ( ( ( crc_checked & LR11XX_FW_GANG_BIT( first ) ) == 0 ) || ( entries[first] != entry ) ) )
+        {
+            first++;
+        }
+        if( entry->image.format == LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM )
+        {
+            failed |= bit;
+            continue;
+        }
+
+        uint32_t crc = 0;
+
+        crc_checked |= bit;
+        if( ( first < index ) ? ( ( intact & LR11XX_FW_GANG_BIT( first ) ) != 0 )
+                                   : ( ( lr11xx_firmware_image_get_crc( &entry->image, &crc ) == true ) &&
+                                       ( crc == entry->crc ) ) )
+        {
+            intact |= bit;
+        }
+        else
+        {
+            failed |= bit;
+        }
+    }
+
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, wrong, LR11XX_FW_UPDATE_WRONG_CHIP_TYPE,
+                                               "no image for this chip" );
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, failed, LR11XX_FW_UPDATE_ERROR,
+                                               "image CRC mismatch or streamed image, flash left untouched" );
+    failed = 0;
 
-    if( lr11xx_is_chip_in_production_mode( version_bootloader.type ) == false )
+    timing->handshake_us = lr11xx_update_firmware_lap_us( &lap_cycles );
+
+    if( active == 0 )
     {
-        return LR11XX_FW_UPDATE_WRONG_CHIP_TYPE;
+        return 0;
     }
 
-    if( lr11xx_is_fw_compatible_with_chip( fw_update_direction, version_bootloader.fw ) == false )
+    printf( "Start flash erase on %u chips...\n", lr11xx_update_firmware_gang_count( active ) );
+    for( uint8_t index = 0; index < target_count; index++ )
     {
-        return LR11XX_FW_UPDATE_WRONG_CHIP_TYPE;
-    };
+        if( ( active & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+        {
+            lr11xx_bootloader_erase_flash( targets[index].radio );
+        }
+    }
 
-    lr11xx_bootloader_pin_t      pin      = { 0x00 };
-    lr11xx_bootloader_chip_eui_t chip_eui = { 0x00 };
-    lr11xx_bootloader_join_eui_t join_eui = { 0x00 };
+    /* The chips erase their flash at the same time, a failed erase being sent again to its chip only */
+    uint8_t  erase_retries[LR11XX_FW_GANG_TARGET_COUNT_MAX] = { 0 };
+    uint32_t erasing                                        = active;
 
-    lr11xx_bootloader_read_pin( radio, pin );
-    lr11xx_bootloader_read_chip_eui( radio, chip_eui );
-    lr11xx_bootloader_read_join_eui( radio, join_eui );
+    while( erasing != 0 )
+    {
+        const uint32_t erased =
+            lr11xx_update_firmware_gang_wait( targets, target_count, erasing, LR11XX_FW_UPDATE_GANG_ERASE_TIMEOUT_MS );
+        uint32_t erase_failed = 0;
 
-    printf( "PIN is     0x%02X%02X%02X%02X\n", pin[0], pin[1], pin[2], pin[3] );
-    printf( "ChipEUI is 0x%02X%02X%02X%02X%02X%02X%02X%02X\n", chip_eui[0], chip_eui[1], chip_eui[2], chip_eui[3],
-            chip_eui[4], chip_eui[5], chip_eui[6], chip_eui[7] );
-    printf( "JoinEUI is 0x%02X%02X%02X%02X%02X%02X%02X%02X\n", join_eui[0], join_eui[1], join_eui[2], join_eui[3],
-            join_eui[4], join_eui[5], join_eui[6], join_eui[7] );
+        active = lr11xx_update_firmware_gang_drop( targets, target_count, active, erasing & ~erased,
+                                                   LR11XX_FW_UPDATE_ERROR, "flash erase timeout" );
+        erasing = 0;
+        for( uint8_t index = 0; index < target_count; index++ )
+        {
+            if( ( erased & LR11XX_FW_GANG_BIT( index ) ) == 0 )
+            {
+                continue;
+            }
+
+            const lr11xx_fw_update_check_t check = lr11xx_update_firmware_check_status(
+                targets[index].radio, &erase_retries[index], &timing->erase_retry_count );
 
-    printf( "Start flash erase...\n" );
-    lr11xx_bootloader_erase_flash( radio );
+            if( check == LR11XX_FW_UPDATE_CHECK_RETRIED )
+            {
+                printf( "> Chip %u: flash erase failed, erase again\n", index );
+                lr11xx_bootloader_erase_flash( targets[index].radio );
+                erasing |= LR11XX_FW_GANG_BIT( index );
+            }
+            else if( check == LR11XX_FW_UPDATE_CHECK_FAILED )
+            {
+                erase_failed |= LR11XX_FW_GANG_BIT( index );
+            }
+        }
+        active = lr11xx_update_firmware_gang_drop( targets, target_count, active, erase_failed,
+                                                   LR11XX_FW_UPDATE_ERROR, "flash erase failed" );
+    }
     printf( "> Flash erase done!\n" );
+    timing->erase_us = lr11xx_update_firmware_lap_us( &lap_cycles );
 
-    printf( "Start flashing firmware...\n" );
-    lr11xx_bootloader_write_flash_encrypted_full( radio, 0, buffer, length );
-    printf( "> Flashing done!\n" );
+    printf( "Start flashing firmware on %u chips...\n", lr11xx_update_firmware_gang_count( active ) );
+    const uint32_t write_start_ms = system_time_GetTicker( );
+    const uint32_t written        = lr11xx_update_firmware_gang_send(
+        targets, target_count, active, LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_OC, entries, &write_timing,
+        &timing->block_retry_count );
+    /* The write duration comes from the ms ticker below: only restart the lap */
+    lr11xx_update_firmware_lap_us( &lap_cycles );
 
-    printf( "Rebooting...\n" );
-    lr11xx_bootloader_reboot( radio, false );
-    printf( "> Reboot done!\n" );
+    timing->write_spi_us       = system_time_cycles_to_us( write_timing.spi_cycles );
+    timing->write_busy_us      = system_time_cycles_to_us( write_timing.busy_cycles );
+    timing->write_us           = ( system_time_GetTicker( ) - write_start_ms ) * 1000;
+    timing->write_block_max_us = system_time_cycles_to_us( write_timing.block_max_cycles );
+    timing->write_block_count  = write_timing.block_count;
 
-    switch( fw_update_direction )
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, active & ~written,
+                                               LR11XX_FW_UPDATE_ERROR, "flashing aborted" );
+
+    uint32_t flash_size_in_byte = 0;
+
+    for( uint8_t index = 0; index < target_count; index++ )
     {
-    case LR1110_FIRMWARE_UPDATE_TO_TRX:
-    case LR1120_FIRMWARE_UPDATE_TO_TRX:
-    case LR1121_FIRMWARE_UPDATE_TO_TRX:
+        if( ( active & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+        {
+            flash_size_in_byte += entries[index]->image.length_in_word * sizeof( uint32_t );
+        }
+    }
+
+    const uint32_t flash_duration_ms = timing->write_us / 1000;
+
+    printf( "> Flashing done! %u bytes to %u chips in %u ms (%u bytes/s)\n", flash_size_in_byte,
+            lr11xx_update_firmware_gang_count( active ), flash_duration_ms,
+            ( flash_duration_ms != 0 ) ? ( uint32_t ) ( ( ( uint64_t ) flash_size_in_byte * 1000 ) / flash_duration_ms )
+                                       : 0 );
+
+    printf( "Rebooting...\n" );
+    for( uint8_t index = 0; index < target_count; index++ )
     {
-        lr11xx_system_version_t version_trx = { 0x00 };
-        lr11xx_system_uid_t     uid         = { 0x00 };
+        if( ( active & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+        {
+            lr11xx_bootloader_reboot( targets[index].radio, false );
+        }
+    }
 
-        lr11xx_system_get_version( radio, &version_trx );
-        printf( "Chip in transceiver mode:\n" );
-        printf( " - Chip type             = 0x%02X\n", version_trx.type );
-        printf( " - Chip hardware version = 0x%02X\n", version_trx.hw );
-        printf( " - Chip firmware version = 0x%04X\n", version_trx.fw );
+    const uint32_t reboot_cycles = system_time_get_cycles( );
+    const uint32_t booted        = lr11xx_update_firmware_gang_wait_ready( targets, target_count, active );
 
-        lr11xx_system_read_uid( radio, uid );
+    timing->reboot_ready_us = system_time_cycles_to_us( system_time_get_cycles( ) - reboot_cycles );
+    timing->reboot_us       = lr11xx_update_firmware_lap_us( &lap_cycles );
+
+    /* A modem command would wait for BUSY forever */
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, active & ~booted,
+                                               LR11XX_FW_UPDATE_ERROR, "firmware not ready after the reboot" );
+    printf( "> Reboot done!\n" );
 
-        if( version_trx.fw == fw_expected )
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        uint32_t fw_version = 0;
+
+        if( ( ( active & LR11XX_FW_GANG_BIT( index ) ) != 0 ) &&
+            ( ( lr11xx_update_firmware_read_version( targets[index].radio, entries[index]->update, &fw_version ) ==
+                false ) ||
+              ( fw_version != entries[index]->fw_expected ) ) )
         {
-            return LR11XX_FW_UPDATE_OK;
+            failed |= LR11XX_FW_GANG_BIT( index );
         }
-        else
+    }
+
+    active = lr11xx_update_firmware_gang_drop( targets, target_count, active, failed, LR11XX_FW_UPDATE_ERROR,
+                                               "unexpected firmware after the reboot" );
+    timing->verify_us = lr11xx_update_firmware_lap_us( &lap_cycles );
+
+    return active;
+}
+
+static uint32_t lr11xx_update_firmware_gang_drop( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                  uint32_t active, uint32_t failed, lr11xx_fw_update_status_t status,
+                                                  const char* reason )
+{
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        if( ( active & failed & LR11XX_FW_GANG_BIT( index ) ) != 0 )
         {
-            return LR11XX_FW_UPDATE_ERROR;
+            printf( "> Chip %u: %s\n", index, reason );
+            targets[index].status = status;
         }
-        break;
     }
-    case LR1110_FIRMWARE_UPDATE_TO_MODEM_V1:
+
+    return active & ~failed;
+}
+
+static uint8_t lr11xx_update_firmware_gang_count( uint32_t mask )
+{
+    uint8_t count = 0;
+
+    for( ; mask != 0; mask &= mask - 1 )
     {
-        lr1110_modem_version_t version_modem = { 0 };
+        count++;
+    }
 
-        system_time_wait_ms( 2000 );
+    return count;
+}
 
-        lr1110_modem_get_version( radio, &version_modem );
-        printf( "Chip in LoRa Basics Modem-E mode:\n" );
-        printf( " - Chip bootloader version = 0x%08x\n", version_modem.bootloader );
-        printf( " - Chip firmware version   = 0x%08x\n", version_modem.firmware );
-        printf( " - Chip LoRaWAN version    = 0x%04x\n", version_modem.lorawan );
+static uint32_t lr11xx_update_firmware_gang_wait( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                  uint32_t mask, uint32_t timeout_ms )
+{
+    const uint32_t start_ms = system_time_GetTicker( );
+    uint32_t       ready    = 0;
 
-        uint32_t fw_version = ( ( uint32_t )( version_modem.functionality ) << 24 ) + version_modem.firmware;
+    /* All chips are waited for: waiting for them in turn over the remaining time is as good as polling them all */
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        const radio_t* radio_local = ( const radio_t* ) targets[index].radio;
+        const uint32_t elapsed_ms  = system_time_GetTicker( ) - start_ms;
 
-        if( fw_version == fw_expected )
+        if( ( ( mask & LR11XX_FW_GANG_BIT( index ) ) != 0 ) &&
+            ( system_gpio_wait_for_state_timeout( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW,
+                                                  ( elapsed_ms < timeout_ms ) ? timeout_ms - elapsed_ms : 0 ) ==
+              true ) )
         {
-            return LR11XX_FW_UPDATE_OK;
+            ready |= LR11XX_FW_GANG_BIT( index );
         }
-        else
+    }
+
+    return ready;
+}
+
+static uint32_t lr11xx_update_firmware_gang_wait_boot( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                       uint32_t mask )
+{
+    const uint32_t start_ms = system_time_GetTicker( );
+    uint32_t       pending  = mask;
+    uint32_t       ready    = 0;
+
+    while( ( pending != 0 ) && ( ( system_time_GetTicker( ) - start_ms ) < LR11XX_FW_UPDATE_PROBE_BOOT_TIMEOUT_MS ) )
+    {
+        for( uint8_t index = 0; index < target_count; index++ )
         {
-            return LR11XX_FW_UPDATE_ERROR;
+            const radio_t* radio_local = ( const radio_t* ) targets[index].radio;
+
+            if( ( pending & LR11XX_FW_GANG_BIT( index ) ) == 0 )
+            {
+                continue;
+            }
+            if( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_LOW )
+            {
+                ready |= LR11XX_FW_GANG_BIT( index );
+                pending &= ~LR11XX_FW_GANG_BIT( index );
+            }
+            else if( system_gpio_get_pin_state( radio_local->irq ) == SYSTEM_GPIO_PIN_STATE_HIGH )
+            {
+                pending &= ~LR11XX_FW_GANG_BIT( index );
+            }
+        }
+
+        if( pending != 0 )
+        {
+            system_time_wait_ms( 1 );
         }
-        break;
     }
-    case LR1121_FIRMWARE_UPDATE_TO_MODEM_V2:
+
+    return ready;
+}
+
+static void lr11xx_update_firmware_gang_reset( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                               uint32_t mask, bool is_bootloader )
+{
+    for( uint8_t index = 0; index < target_count; index++ )
     {
-        lr1121_modem_version_t version_modem = { 0 };
+        const radio_t* radio_local = ( const radio_t* ) targets[index].radio;
 
-        system_time_wait_ms( 2000 );
+        if( ( mask & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+        {
+            system_gpio_init_direction_state( radio_local->busy,
+                                              ( is_bootloader == true ) ? SYSTEM_GPIO_PIN_DIRECTION_OUTPUT
+                                                                        : SYSTEM_GPIO_PIN_DIRECTION_INPUT,
+                                              SYSTEM_GPIO_PIN_STATE_LOW );
+            lr11xx_system_reset( targets[index].radio );
+        }
+    }
 
-        lr1121_modem_get_modem_version( radio, &version_modem );
-        printf( "Chip in LoRa Basics Modem-E mode:\n" );
-        printf( " - Chip use case version: 0x%02X\n", version_modem.use_case );
-        printf( " - Chip modem major version: 0x%02X\n", version_modem.modem_major );
-        printf( " - Chip modem minor version: 0x%02X\n", version_modem.modem_minor );
-        printf( " - Chip modem patch version: 0x%02X\n", version_modem.modem_patch );
-        printf( " - Chip lbm major version: 0x%02X\n", version_modem.lbm_major );
-        printf( " - Chip lbm minor version: 0x%02X\n", version_modem.lbm_minor );
-        printf( " - Chip lbm patch version: 0x%02X\n", version_modem.lbm_patch );
+    if( is_bootloader == false )
+    {
+        return;
+    }
 
-        uint32_t fw_version =
-            ( ( uint32_t )( version_modem.use_case ) << 24 ) + ( ( uint32_t )( version_modem.modem_major ) << 16 ) +
-            ( ( uint32_t )( version_modem.modem_minor << 8 ) ) + ( uint32_t )( version_modem.modem_patch );
+    system_time_wait_ms( LR11XX_FW_UPDATE_BOOTLOADER_BUSY_HOLD_MS );
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        const radio_t* radio_local = ( const radio_t* ) targets[index].radio;
 
-        if( fw_version == fw_expected )
+        if( ( mask & LR11XX_FW_GANG_BIT( index ) ) != 0 )
         {
-            return LR11XX_FW_UPDATE_OK;
+            system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_INPUT,
+                                              SYSTEM_GPIO_PIN_STATE_LOW );
         }
-        else
+    }
+}
+
+static uint32_t lr11xx_update_firmware_gang_wait_ready( const lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                        uint32_t mask )
+{
+    uint32_t modems = 0;
+
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        if( ( ( mask & LR11XX_FW_GANG_BIT( index ) ) != 0 ) &&
+            ( lr11xx_is_fw_of_kind( targets[index].selected->update, LR11XX_FW_BUNDLE_KIND_MODEM ) == true ) )
         {
-            return LR11XX_FW_UPDATE_ERROR;
+            modems |= LR11XX_FW_GANG_BIT( index );
         }
-        break;
     }
+
+    const uint32_t ready =
+        lr11xx_update_firmware_gang_wait( targets, target_count, mask & ~modems, LR11XX_FW_UPDATE_BOOT_TIMEOUT_MS );
+    const uint32_t start_ms = system_time_GetTicker( );
+    uint32_t       sleeping = modems;
+
+    /* A booting modem ignores the wake-ups */
+    while( ( sleeping != 0 ) && ( ( system_time_GetTicker( ) - start_ms ) < LR11XX_FW_UPDATE_MODEM_BOOT_TIMEOUT_MS ) )
+    {
+        for( uint8_t index = 0; index < target_count; index++ )
+        {
+            if( ( sleeping & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+            {
+                lr11xx_hal_wakeup( targets[index].radio );
+            }
+        }
+        sleeping &= ~lr11xx_update_firmware_gang_wait( targets, target_count, sleeping,
+                                                       LR11XX_FW_UPDATE_MODEM_WAKEUP_PERIOD_MS );
     }
 
-    return LR11XX_FW_UPDATE_ERROR;
+    return ready | ( modems & ~sleeping );
 }
 
-/*
- * -----------------------------------------------------------------------------
- * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
- */
-
-bool lr11xx_is_chip_in_production_mode( uint8_t type )
+static uint32_t lr11xx_update_firmware_gang_send( lr11xx_fw_gang_target_t* targets, uint8_t target_count,
+                                                  uint32_t mask, uint16_t opcode,
+                                                  const lr11xx_fw_bundle_entry_t* const* entries,
+                                                  lr11xx_bootloader_write_timing_t*      write_timing,
+                                                  uint32_t*                              retry_count )
 {
-    return ( type == LR11XX_TYPE_PRODUCTION_MODE ) ? true : false;
+    const uint8_t* blocks[LR11XX_FW_GANG_TARGET_COUNT_MAX];
+    uint32_t       lengths[LR11XX_FW_GANG_TARGET_COUNT_MAX];
+    const uint8_t* sent_blocks[LR11XX_FW_GANG_TARGET_COUNT_MAX];
+    uint32_t       sent_lengths[LR11XX_FW_GANG_TARGET_COUNT_MAX];
+    uint32_t       sent_offsets[LR11XX_FW_GANG_TARGET_COUNT_MAX];
+    uint32_t       sent_cycles[LR11XX_FW_GANG_TARGET_COUNT_MAX] = { 0 };
+    uint8_t        retries[LR11XX_FW_GANG_TARGET_COUNT_MAX] = { 0 };
+    uint32_t       offset    = 0;
+    uint32_t       pending   = 0;
+    uint32_t       rising    = 0;
+    uint32_t       unchecked = 0;
+    uint32_t       failed    = 0;
+    bool           is_last   = false;
+    uint32_t       bus_free  = system_time_get_cycles( );
+
+    while( is_last == false )
+    {
+        pending = 0;
+
+        /* Read the blocks of this offset, once per image whatever the number of chips it goes to */
+        for( uint8_t index = 0; index < target_count; index++ )
+        {
+            uint8_t first = 0;
+
+            if( ( mask & LR11XX_FW_GANG_BIT( index ) ) == 0 )
+            {
+                continue;
+            }
+
+            const lr11xx_firmware_image_t* image = &entries[index]->image;
+
+            lengths[index] = lr11xx_firmware_image_get_block_length( image, offset );
+            if( lengths[index] == 0 )
+            {
+                continue;
+            }
+
+            while( ( first < index ) &&
+                   ( ( ( pending & LR11XX_FW_GANG_BIT( first ) ) == 0 ) || ( entries[first] != entries[index] ) ) )
+            {
+                first++;
+            }
+
+            const uint32_t parity = ( offset / LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD ) % 2;
+            uint8_t*       buffer = lr11xx_update_firmware_gang_scratch[index][parity];
+
+            blocks[index] = ( first < index )
+                                ? blocks[first]
+                                : lr11xx_firmware_image_get_block( image, offset, lengths[index], buffer );
+            if( blocks[index] == NULL )
+            {
+                mask &= ~LR11XX_FW_GANG_BIT( index );
+                continue;
+            }
+
+            pending |= LR11XX_FW_GANG_BIT( index );
+        }
+
+        /* Past the last block: a last round checks the status of the last blocks */
+        if( pending == 0 )
+        {
+            is_last = true;
+            pending = mask;
+        }
+
+        /* Round-robin: a chip gets its block as soon as it is done with the previous one */
+        const uint32_t start_ms = system_time_GetTicker( );
+
+        while( pending != 0 )
+        {
+            for( uint8_t index = 0; index < target_count; index++ )
+            {
+                const uint32_t bit = LR11XX_FW_GANG_BIT( index );
+
+                if( ( ( pending & bit ) == 0 ) ||
+                    ( lr11xx_update_firmware_gang_is_ready( targets[index].radio, bit, &rising, sent_cycles[index] ) ==
+                      false ) )
+                {
+                    continue;
+                }
+
+                const uint32_t spi_start_cycles = system_time_get_cycles( );
+                const uint8_t* data             = blocks[index];
+                uint32_t       length           = lengths[index];
+                uint32_t       data_offset      = offset;
+                bool           is_retry         = false;
+
+                if( ( unchecked & bit ) != 0 )
+                {
+                    const lr11xx_fw_update_check_t check =
+                        lr11xx_update_firmware_check_status( targets[index].radio, &retries[index], retry_count );
+
+                    unchecked &= ~bit;
+                    if( check == LR11XX_FW_UPDATE_CHECK_FAILED )
+                    {
+                        failed |= bit;
+                        mask &= ~bit;
+                        pending &= ~bit;
+                        continue;
+                    }
+                    if( check == LR11XX_FW_UPDATE_CHECK_RETRIED )
+                    {
+                        data        = sent_blocks[index];
+                        length      = sent_lengths[index];
+                        data_offset = sent_offsets[index];
+                        is_retry    = true;
+                    }
+                }
+
+                if( ( is_retry == false ) && ( is_last == true ) )
+                {
+                    pending &= ~bit;
+                    continue;
+                }
+
+                lr11xx_update_firmware_send_block( targets[index].radio, opcode, data_offset, data, length );
+                sent_cycles[index] = system_time_get_cycles( );
+
+                /* The time the bus stayed idle, waiting for any chip to get ready, accounts as BUSY wait */
+                lr11xx_bootloader_write_timing_add_block( write_timing, bus_free, spi_start_cycles,
+                                                          sent_cycles[index] );
+                bus_free = sent_cycles[index];
+
+                /* The image check has no status until the last block: only the flash write is checked per block */
+                rising |= bit;
+                if( opcode == LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_OC )
+                {
+                    unchecked |= bit;
+                }
+                if( is_retry == true )
+                {
+                    continue;
+                }
+
+                sent_blocks[index]  = data;
+                sent_lengths[index] = length;
+                sent_offsets[index] = data_offset;
+                targets[index].write_block_count++;
+                pending &= ~bit;
+            }
+
+            if( ( pending != 0 ) &&
+                ( ( system_time_GetTicker( ) - start_ms ) >= LR11XX_FW_UPDATE_GANG_BLOCK_TIMEOUT_MS ) )
+            {
+                mask &= ~pending;
+                pending = 0;
+            }
+        }
+
+        offset += LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD;
+    }
+
+    for( uint8_t index = 0; index < target_count; index++ )
+    {
+        if( ( failed & LR11XX_FW_GANG_BIT( index ) ) != 0 )
+        {
+            printf( "> Chip %u: block %u rejected by the bootloader\n", index,
+                    ( unsigned int ) ( sent_offsets[index] / LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD ) );
+        }
+    }
+
+    write_timing->busy_cycles += system_time_get_cycles( ) - bus_free;
+
+    return mask;
 }
 
-bool lr11xx_is_fw_compatible_with_chip( lr11xx_fw_update_t update, uint16_t bootloader_version )
+static bool lr11xx_update_firmware_gang_is_ready( const void* radio, uint32_t bit, uint32_t* rising,
+                                                  uint32_t sent_cycles )
 {
-    if( ( ( update == LR1110_FIRMWARE_UPDATE_TO_TRX ) || ( update == LR1110_FIRMWARE_UPDATE_TO_MODEM_V1 ) ) &&
-        ( bootloader_version != 0x6500 ) )
+    const radio_t* radio_local = ( const radio_t* ) radio;
+
+    if( system_gpio_get_pin_state( radio_local->busy ) != SYSTEM_GPIO_PIN_STATE_LOW )
     {
+        *rising &= ~bit;
         return false;
     }
-    else if( ( update == LR1120_FIRMWARE_UPDATE_TO_TRX ) && ( bootloader_version != 0x2000 ) )
+
+    /* BUSY still low right after a command: the chip may not have raised it yet */
+    if( ( ( *rising & bit ) != 0 ) && ( system_time_cycles_to_us( system_time_get_cycles( ) - sent_cycles ) <
+                                        LR11XX_BOOTLOADER_DMA_BUSY_RISE_TIMEOUT_US ) )
     {
         return false;
     }
-    else if( ( ( update == LR1121_FIRMWARE_UPDATE_TO_TRX ) || ( update == LR1121_FIRMWARE_UPDATE_TO_MODEM_V2 ) ) &&
-             ( bootloader_version != 0x2100 ) )
+
+    *rising &= ~bit;
+
+    return true;
+}
+
+static void lr11xx_update_firmware_send_block( const void* radio, uint16_t opcode, uint32_t offset_in_word,
+                                               const uint8_t* data, uint32_t length_in_word )
+{
+    const uint32_t offset_in_byte = offset_in_word * sizeof( uint32_t );
+    const uint16_t length_in_byte = ( uint16_t ) ( length_in_word * sizeof( uint32_t ) );
+    const uint8_t  command[LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_CMD_LENGTH] = {
+        ( uint8_t ) ( opcode >> 8 ),          ( uint8_t ) ( opcode >> 0 ),
+        ( uint8_t ) ( offset_in_byte >> 24 ), ( uint8_t ) ( offset_in_byte >> 16 ),
+        ( uint8_t ) ( offset_in_byte >> 8 ),  ( uint8_t ) ( offset_in_byte >> 0 ),
+    };
+
+#if( LR11XX_FW_UPDATE_USE_DMA == 1 )
+    const radio_t* radio_local = ( const radio_t* ) radio;
+    uint8_t        crc         = 0;
+
+    /* The bus is shared: the next chip can only be served once the transfer is over */
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_write( radio_local->spi_device.spi, command, LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_CMD_LENGTH );
+    system_spi_write_dma( radio_local->spi_device.spi, data, length_in_byte );
+    if( radio_local->spi_device.is_crc_on == true )
     {
-        return false;
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, command,
+                                       LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_CMD_LENGTH );
+        crc = lr11xx_modem_crc_update( crc, data, length_in_byte );
+    }
+    system_spi_wait_dma( radio_local->spi_device.spi );
+    if( radio_local->spi_device.is_crc_on == true )
+    {
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
     }
+    system_spi_bus_deselect( &radio_local->spi_device );
+#else
+    lr11xx_hal_write( radio, command, LR11XX_FW_UPDATE_WRITE_FLASH_ENCRYPTED_CMD_LENGTH, data, length_in_byte );
+#endif
+}
 
-    return true;
+static uint32_t lr11xx_update_firmware_lap_us( uint32_t* lap_cycles )
+{
+    const uint32_t now_cycles = system_time_get_cycles( );
+    const uint32_t elapsed    = now_cycles - *lap_cycles;
+
+    *lap_cycles = now_cycles;
+
+    return system_time_cycles_to_us( elapsed );
 }
 
 /* --- EOF ------------------------------------------------------------------ */
@@ -39,6 +39,7 @@
 
 #include "lr11xx_hal.h"
 #include "configuration.h"
+#include "lr11xx_modem_crc.h"
 #include "system.h"
 
 /*
@@ -51,6 +52,31 @@
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
+/*!
+ * @brief Command switching the SPI CRC of the transceiver firmware, always sent with a CRC byte
+ */
+#define LR11XX_HAL_ENABLE_SPI_CRC_OC ( 0x0128 )
+
+/*!
+ * @brief Command status of stat1 announcing a response
+ */
+#define LR11XX_HAL_CMD_STATUS_DATA ( 0x03 )
+
+/*!
+ * @brief Status read of the transceiver firmware, with no side effect: read again on a CRC mismatch
+ */
+#define LR11XX_HAL_GET_STATUS_OC ( 0x0100 )
+
+/*!
+ * @brief Version read of the transceiver firmware, with no side effect: read again on a CRC mismatch
+ */
+#define LR11XX_HAL_GET_VERSION_OC ( 0x0101 )
+
+/*!
+ * @brief Number of times a read with no side effect is sent again once its response failed the SPI CRC check
+ */
+#define LR11XX_HAL_SPI_CRC_READ_RETRY_MAX ( 3 )
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -66,6 +92,26 @@
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
  */
 
+/*!
+ * @brief Read from a transceiver firmware exchanging a CRC byte, the status and version reads being sent again on a
+ * CRC mismatch
+ *
+ * The command is followed by its CRC. The response is read with stat1 and followed by the CRC of both: a command
+ * damaged on its way is dropped by the chip, which then reports no response in stat1. Other reads may have a side
+ * effect on the chip, which cannot tell whether it ran the damaged one: their error is left to the caller.
+ *
+ * @param [in] radio Radio implementation parameters
+ * @param [in] cbuffer Command
+ * @param [in] cbuffer_length Length of the command
+ * @param [out] rbuffer Response
+ * @param [in] rbuffer_length Length of the response
+ *
+ * @returns Operation status, LR11XX_HAL_STATUS_ERROR if every attempt failed the check
+ */
+static lr11xx_hal_status_t lr11xx_hal_read_with_crc( const radio_t* radio, const uint8_t* cbuffer,
+                                                     uint16_t cbuffer_length, uint8_t* rbuffer,
+                                                     uint16_t rbuffer_length );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -79,6 +125,9 @@ lr11xx_hal_status_t lr11xx_hal_reset( const void* radio )
     system_time_wait_ms( 1 );
     system_gpio_set_pin_state( radio_local->reset, SYSTEM_GPIO_PIN_STATE_HIGH );
 
+    /* The chip leaves reset with the SPI CRC off */
+    radio_local->spi_device.is_crc_on = false;
+
     return LR11XX_HAL_STATUS_OK;
 }
 
@@ -86,9 +135,9 @@ lr11xx_hal_status_t lr11xx_hal_wakeup( const void* radio )
 {
     radio_t* radio_local = ( radio_t* ) radio;
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+    system_spi_bus_select( &radio_local->spi_device );
     system_time_wait_ms( 1 );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     return LR11XX_HAL_STATUS_OK;
 }
@@ -98,9 +147,9 @@ lr11xx_hal_status_t lr11xx_hal_abort_blocking_cmd( const void* radio )
     radio_t* radio_local = ( radio_t* ) radio;
     uint8_t                     command[4]     = { 0 };
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_write( radio_local->spi, command, 4 );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_write( radio_local->spi_device.spi, command, 4 );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
 
@@ -113,20 +162,25 @@ lr11xx_hal_status_t lr11xx_hal_read( const void* radio, const uint8_t* cbuffer,
     radio_t* radio_local = ( radio_t* ) radio;
     uint8_t  dummy_byte  = 0x00;
 
+    if( radio_local->spi_device.is_crc_on == true )
+    {
+        return lr11xx_hal_read_with_crc( radio_local, cbuffer, cbuffer_length, rbuffer, rbuffer_length );
+    }
+
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
 
     /* 1st SPI transaction */
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_write( radio_local->spi, cbuffer, cbuffer_length );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_write( radio_local->spi_device.spi, cbuffer, cbuffer_length );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
 
     /* 2nd SPI transaction */
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_write( radio_local->spi, &dummy_byte, 1 );
-    system_spi_read_with_dummy_byte( radio_local->spi, rbuffer, rbuffer_length, LR11XX_NOP );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_write( radio_local->spi_device.spi, &dummy_byte, 1 );
+    system_spi_read_with_dummy_byte( radio_local->spi_device.spi, rbuffer, rbuffer_length, LR11XX_NOP );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     return LR11XX_HAL_STATUS_OK;
 }
@@ -134,14 +188,34 @@ lr11xx_hal_status_t lr11xx_hal_read( const void* radio, const uint8_t* cbuffer,
 lr11xx_hal_status_t lr11xx_hal_write( const void* radio, const uint8_t* cbuffer, const uint16_t cbuffer_length,
                                       const uint8_t* cdata, const uint16_t cdata_length )
 {
-    radio_t* radio_local = ( radio_t* ) radio;
+    radio_t*   radio_local    = ( radio_t* ) radio;
+    const bool is_crc_command = ( cbuffer_length == 3 ) &&
+                                ( ( ( cbuffer[0] << 8 ) | cbuffer[1] ) == LR11XX_HAL_ENABLE_SPI_CRC_OC );
+    const bool is_crc_sent    = ( radio_local->spi_device.is_crc_on == true ) || ( is_crc_command == true );
+    uint8_t    crc            = 0;
+
+    /* Computed while the chip may still be busy with the previous command */
+    if( is_crc_sent == true )
+    {
+        crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, cbuffer, cbuffer_length );
+        crc = lr11xx_modem_crc_update( crc, cdata, cdata_length );
+    }
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_write( radio_local->spi, cbuffer, cbuffer_length );
-    system_spi_write( radio_local->spi, cdata, cdata_length );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_write( radio_local->spi_device.spi, cbuffer, cbuffer_length );
+    system_spi_write( radio_local->spi_device.spi, cdata, cdata_length );
+    if( is_crc_sent == true )
+    {
+        system_spi_write( radio_local->spi_device.spi, &crc, 1 );
+    }
+    system_spi_bus_deselect( &radio_local->spi_device );
+
+    if( is_crc_command == true )
+    {
+        radio_local->spi_device.is_crc_on = ( cbuffer[2] != 0 );
+    }
 
     return LR11XX_HAL_STATUS_OK;
 }
@@ -152,9 +226,9 @@ lr11xx_hal_status_t lr11xx_hal_direct_read( const void* radio, uint8_t* data, co
 
     system_gpio_wait_for_state( radio_local->busy, SYSTEM_GPIO_PIN_STATE_LOW );
 
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_LOW );
-    system_spi_read_with_dummy_byte( radio_local->spi, data, data_length, LR11XX_NOP );
-    system_gpio_set_pin_state( radio_local->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+    system_spi_bus_select( &radio_local->spi_device );
+    system_spi_read_with_dummy_byte( radio_local->spi_device.spi, data, data_length, LR11XX_NOP );
+    system_spi_bus_deselect( &radio_local->spi_device );
 
     return LR11XX_HAL_STATUS_OK;
 }
@@ -164,4 +238,48 @@ lr11xx_hal_status_t lr11xx_hal_direct_read( const void* radio, uint8_t* data, co
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
  */
 
+static lr11xx_hal_status_t lr11xx_hal_read_with_crc( const radio_t* radio, const uint8_t* cbuffer,
+                                                     uint16_t cbuffer_length, uint8_t* rbuffer,
+                                                     uint16_t rbuffer_length )
+{
+    const uint8_t  command_crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, cbuffer, cbuffer_length );
+    const uint16_t opcode      = ( uint16_t ) ( ( cbuffer[0] << 8 ) | cbuffer[1] );
+    const uint8_t  retry_max   = ( ( opcode == LR11XX_HAL_GET_STATUS_OC ) || ( opcode == LR11XX_HAL_GET_VERSION_OC ) )
+                                     ? LR11XX_HAL_SPI_CRC_READ_RETRY_MAX
+                                     : 0;
+
+    for( uint8_t attempt = 0; attempt <= retry_max; attempt++ )
+    {
+        uint8_t stat1 = 0;
+        uint8_t crc   = 0;
+
+        system_gpio_wait_for_state( radio->busy, SYSTEM_GPIO_PIN_STATE_LOW );
+
+        /* 1st SPI transaction */
+        system_spi_bus_select( &radio->spi_device );
+        system_spi_write( radio->spi_device.spi, cbuffer, cbuffer_length );
+        system_spi_write( radio->spi_device.spi, &command_crc, 1 );
+        system_spi_bus_deselect( &radio->spi_device );
+
+        system_gpio_wait_for_state( radio->busy, SYSTEM_GPIO_PIN_STATE_LOW );
+
+        /* 2nd SPI transaction */
+        system_spi_bus_select( &radio->spi_device );
+        system_spi_read_with_dummy_byte( radio->spi_device.spi, &stat1, 1, LR11XX_NOP );
+        system_spi_read_with_dummy_byte( radio->spi_device.spi, rbuffer, rbuffer_length, LR11XX_NOP );
+        system_spi_read_with_dummy_byte( radio->spi_device.spi, &crc, 1, LR11XX_NOP );
+        system_spi_bus_deselect( &radio->spi_device );
+
+        const uint8_t response_crc = lr11xx_modem_crc_update(
+            lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, &stat1, 1 ), rbuffer, rbuffer_length );
+
+        if( ( ( ( stat1 >> 1 ) & 0x07 ) == LR11XX_HAL_CMD_STATUS_DATA ) && ( response_crc == crc ) )
+        {
+            return LR11XX_HAL_STATUS_OK;
+        }
+    }
+
+    return LR11XX_HAL_STATUS_ERROR;
+}
+
 /* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,111 @@
+/*!
+ * @file      lr11xx_modem_crc.c
+ *
+ * @brief     CRC of the LoRa Basics Modem-E command and response frames implementation
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "lr11xx_modem_crc.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief CRC (reflected polynomial 0x65) of the 256 values of a byte
+ *
+ * Slicing by 4 bytes would take 768 more bytes of flash for frames that are mostly a few bytes long.
+ */
+static const uint8_t lr11xx_modem_crc_table[256] = {
+    0x00, 0x3C, 0x78, 0x44, 0x3B, 0x07, 0x43, 0x7F, 0x76, 0x4A, 0x0E, 0x32, 0x4D, 0x71, 0x35, 0x09,
+    0x27, 0x1B, 0x5F, 0x63, 0x1C, 0x20, 0x64, 0x58, 0x51, 0x6D, 0x29, 0x15, 0x6A, 0x56, 0x12, 0x2E,
+    0x4E, 0x72, 0x36, 0x0A, 0x75, 0x49, 0x0D, 0x31, 0x38, 0x04, 0x40, 0x7C, 0x03, 0x3F, 0x7B, 0x47,
+    0x69, 0x55, 0x11, 0x2D, 0x52, 0x6E, 0x2A, 0x16, 0x1F, 0x23, 0x67, 0x5B, 0x24, 0x18, 0x5C, 0x60,
+    0x57, 0x6B, 0x2F, 0x13, 0x6C, 0x50, 0x14, 0x28, 0x21, 0x1D, 0x59, 0x65, 0x1A, 0x26, 0x62, 0x5E,
+    0x70, 0x4C, 0x08, 0x34, 0x4B, 0x77, 0x33, 0x0F, 0x06, 0x3A, 0x7E, 0x42, 0x3D, 0x01, 0x45, 0x79,
+    0x19, 0x25, 0x61, 0x5D, 0x22, 0x1E, 0x5A, 0x66, 0x6F, 0x53, 0x17, 0x2B, 0x54, 0x68, 0x2C, 0x10,
+    0x3E, 0x02, 0x46, 0x7A, 0x05, 0x39, 0x7D, 0x41, 0x48, 0x74, 0x30, 0x0C, 0x73, 0x4F, 0x0B, 0x37,
+    0x65, 0x59, 0x1D, 0x21, 0x5E, 0x62, 0x26, 0x1A, 0x13, 0x2F, 0x6B, 0x57, 0x28, 0x14, 0x50, 0x6C,
+    0x42, 0x7E, 0x3A, 0x06, 0x79, 0x45, 0x01, 0x3D, 0x34, 0x08, 0x4C, 0x70, 0x0F, 0x33, 0x77, 0x4B,
+    0x2B, 0x17, 0x53, 0x6F, 0x10, 0x2C, 0x68, 0x54, 0x5D, 0x61, 0x25, 0x19, 0x66, 0x5A, 0x1E, 0x22,
+    0x0C, 0x30, 0x74, 0x48, 0x37, 0x0B, 0x4F, 0x73, 0x7A, 0x46, 0x02, 0x3E, 0x41, 0x7D, 0x39, 0x05,
+    0x32, 0x0E, 0x4A, 0x76, 0x09, 0x35, 0x71, 0x4D, 0x44, 0x78, 0x3C, 0x00, 0x7F, 0x43, 0x07, 0x3B,
+    0x15, 0x29, 0x6D, 0x51, 0x2E, 0x12, 0x56, 0x6A, 0x63, 0x5F, 0x1B, 0x27, 0x58, 0x64, 0x20, 0x1C,
+    0x7C, 0x40, 0x04, 0x38, 0x47, 0x7B, 0x3F, 0x03, 0x0A, 0x36, 0x72, 0x4E, 0x31, 0x0D, 0x49, 0x75,
+    0x5B, 0x67, 0x23, 0x1F, 0x60, 0x5C, 0x18, 0x24, 0x2D, 0x11, 0x55, 0x69, 0x16, 0x2A, 0x6E, 0x52,
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+uint8_t lr11xx_modem_crc_update( uint8_t crc, const uint8_t* buffer, uint16_t length )
+{
+    for( uint16_t index = 0; index < length; index++ )
+    {
+        crc = lr11xx_modem_crc_table[crc ^ buffer[index]];
+    }
+
+    return crc;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,316 @@
+/*!
+ * @file      lr11xx_station.c
+ *
+ * @brief     LR11XX factory station implementation
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lr11xx_bootloader.h"
+#include "lr11xx_system.h"
+#include "lr11xx_station.h"
+#include "system.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Time between the starts of two presence probes
+ */
+#define LR11XX_STATION_PROBE_PERIOD_MS ( 250 )
+
+/*!
+ * @brief Time BUSY is held low once the chip leaves reset, for the bootloader to sample it
+ *
+ * A probe that sees no module uses the long time next: a chip booting its firmware anyway is seen on the next probe.
+ */
+#define LR11XX_STATION_BUSY_HOLD_MS ( 10 )
+#define LR11XX_STATION_BUSY_HOLD_LONG_MS ( 500 )
+
+/*!
+ * @brief Maximum time for the bootloader to release BUSY after the reset
+ */
+#define LR11XX_STATION_PROBE_TIMEOUT_MS ( 500 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Run one step of the presence probe
+ *
+ * @param [in] station Station
+ * @param [out] is_present Whether the probe saw a module, once it is over
+ *
+ * @returns True once the probe is over, false while it waits for the chip
+ */
+static bool lr11xx_station_probe( lr11xx_station_t* station, bool* is_present );
+
+/*!
+ * @brief Check whether the bootloader version is the one of a production chip of a known family
+ *
+ * A missing module leaves MISO floating: whatever is read does not pass this check.
+ *
+ * @param [in] version Version read from the bootloader
+ *
+ * @returns True if a module answered
+ */
+static bool lr11xx_station_is_version_valid( const lr11xx_bootloader_version_t* version );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void lr11xx_station_init( lr11xx_station_t* station, void* radio )
+{
+    memset( station, 0, sizeof( lr11xx_station_t ) );
+
+    station->radio          = radio;
+    station->state          = LR11XX_STATION_STATE_WAIT_INSERTION;
+    station->probe          = LR11XX_STATION_PROBE_IDLE;
+    station->probe_start_ms = system_time_GetTicker( ) - LR11XX_STATION_PROBE_PERIOD_MS;
+    station->hold_ms        = LR11XX_STATION_BUSY_HOLD_MS;
+}
+
+lr11xx_station_event_t lr11xx_station_step( lr11xx_station_t* station )
+{
+    bool is_present;
+
+    if( ( station->state == LR11XX_STATION_STATE_UPDATING ) ||
+        ( lr11xx_station_probe( station, &is_present ) == false ) )
+    {
+        return LR11XX_STATION_EVENT_NONE;
+    }
+
+    /* Waiting for an insertion, a probe seeing a module is a match; waiting for a removal, a probe seeing none is */
+    if( is_present != ( station->state == LR11XX_STATION_STATE_WAIT_INSERTION ) )
+    {
+        station->match_count = 0;
+        return LR11XX_STATION_EVENT_NONE;
+    }
+
+    if( ++station->match_count < LR11XX_STATION_DEBOUNCE_COUNT )
+    {
+        return LR11XX_STATION_EVENT_NONE;
+    }
+    station->match_count = 0;
+
+    if( station->state == LR11XX_STATION_STATE_WAIT_INSERTION )
+    {
+        printf( "Module inserted: chip type 0x%02X, bootloader version 0x%04X\n", station->version.type,
+                station->version.fw );
+        station->state = LR11XX_STATION_STATE_UPDATING;
+        return LR11XX_STATION_EVENT_INSERTED;
+    }
+
+    printf( "Module removed, waiting for the next one\n" );
+    station->state = LR11XX_STATION_STATE_WAIT_INSERTION;
+    return LR11XX_STATION_EVENT_REMOVED;
+}
+
+void lr11xx_station_end_update( lr11xx_station_t* station, lr11xx_fw_update_status_t status,
+                                const lr11xx_fw_update_timing_t* timing )
+{
+    lr11xx_station_stats_t* stats       = &station->stats;
+    const uint32_t          duration_ms = timing->total_us / 1000;
+
+    stats->unit_count++;
+    if( ( status == LR11XX_FW_UPDATE_OK ) || ( status == LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE ) )
+    {
+        stats->pass_count++;
+    }
+    else
+    {
+        stats->fail_count++;
+    }
+
+    stats->duration_sum_ms += duration_ms;
+    stats->durations_ms[stats->duration_next] = duration_ms;
+    stats->duration_next = ( stats->duration_next + 1 ) % LR11XX_STATION_DURATION_COUNT_MAX;
+
+    /* The clock qualified for this module says nothing of the next one: probe at the default one */
+    ( ( radio_t* ) station->radio )->spi_device.prescaler = LR11XX_SPI_PRESCALER;
+
+    /* The update left the chip out of reset: probe it again from the next step on */
+    station->state          = LR11XX_STATION_STATE_WAIT_REMOVAL;
+    station->probe          = LR11XX_STATION_PROBE_IDLE;
+    station->probe_start_ms = system_time_GetTicker( ) - LR11XX_STATION_PROBE_PERIOD_MS;
+    station->match_count    = 0;
+}
+
+uint32_t lr11xx_station_get_mean_ms( const lr11xx_station_stats_t* stats )
+{
+    if( stats->unit_count == 0 )
+    {
+        return 0;
+    }
+
+    return ( uint32_t ) ( stats->duration_sum_ms / stats->unit_count );
+}
+
+uint32_t lr11xx_station_get_p95_ms( const lr11xx_station_stats_t* stats )
+{
+    uint32_t       sorted[LR11XX_STATION_DURATION_COUNT_MAX];
+    const uint32_t count = ( stats->unit_count < LR11XX_STATION_DURATION_COUNT_MAX )
+                               ? stats->unit_count
+                               : LR11XX_STATION_DURATION_COUNT_MAX;
+
+    if( count == 0 )
+    {
+        return 0;
+    }
+
+    /* A few tens of values, sorted once per unit: insertion sort is enough */
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        const uint32_t value = stats->durations_ms[i];
+        uint32_t       j     = i;
+
+        for( ; ( j > 0 ) && ( sorted[j - 1] > value ); j-- )
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = value;
+    }
+
+    /* Nearest rank: the smallest duration at least 95 % of the units did not exceed */
+    return sorted[( ( count * 95 ) + 99 ) / 100 - 1];
+}
+
+void lr11xx_station_print_stats( const lr11xx_station_stats_t* stats )
+{
+    printf( "Station: %u units, %u passed, %u failed - update time mean %u ms, p95 %u ms\n", stats->unit_count,
+            stats->pass_count, stats->fail_count, lr11xx_station_get_mean_ms( stats ),
+            lr11xx_station_get_p95_ms( stats ) );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool lr11xx_station_probe( lr11xx_station_t* station, bool* is_present )
+{
+    const radio_t* radio_local = ( const radio_t* ) station->radio;
+    const uint32_t now_ms      = system_time_GetTicker( );
+
+    switch( station->probe )
+    {
+    case LR11XX_STATION_PROBE_IDLE:
+        if( ( now_ms - station->probe_start_ms ) < LR11XX_STATION_PROBE_PERIOD_MS )
+        {
+            return false;
+        }
+
+        /* Same reset as the update: the bootloader answers whatever the flash holds */
+        system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_OUTPUT,
+                                          SYSTEM_GPIO_PIN_STATE_LOW );
+        lr11xx_system_reset( station->radio );
+
+        station->probe_start_ms = now_ms;
+        station->wait_start_ms  = system_time_GetTicker( );
+        station->probe          = LR11XX_STATION_PROBE_RESET;
+        return false;
+    case LR11XX_STATION_PROBE_RESET:
+        if( ( now_ms - station->wait_start_ms ) < station->hold_ms )
+        {
+            return false;
+        }
+
+        system_gpio_init_direction_state( radio_local->busy, SYSTEM_GPIO_PIN_DIRECTION_INPUT,
+                                          SYSTEM_GPIO_PIN_STATE_LOW );
+
+        station->wait_start_ms = now_ms;
+        station->probe         = LR11XX_STATION_PROBE_READY;
+        return false;
+    case LR11XX_STATION_PROBE_READY:
+    default:
+        break;
+    }
+
+    if( system_gpio_get_pin_state( radio_local->busy ) == SYSTEM_GPIO_PIN_STATE_LOW )
+    {
+        lr11xx_bootloader_get_version( station->radio, &station->version );
+        *is_present = lr11xx_station_is_version_valid( &station->version );
+    }
+    else if( ( now_ms - station->wait_start_ms ) >= LR11XX_STATION_PROBE_TIMEOUT_MS )
+    {
+        *is_present = false;
+    }
+    else
+    {
+        return false;
+    }
+
+    if( *is_present == false )
+    {
+        station->hold_ms = ( station->hold_ms == LR11XX_STATION_BUSY_HOLD_MS ) ? LR11XX_STATION_BUSY_HOLD_LONG_MS
+                                                                               : LR11XX_STATION_BUSY_HOLD_MS;
+    }
+
+    station->probe = LR11XX_STATION_PROBE_IDLE;
+    return true;
+}
+
+static bool lr11xx_station_is_version_valid( const lr11xx_bootloader_version_t* version )
+{
+    return ( lr11xx_is_chip_in_production_mode( version->type ) == true ) &&
+           ( ( lr11xx_is_fw_compatible_with_chip( LR1110_FIRMWARE_UPDATE_TO_TRX, version->fw ) == true ) ||
+             ( lr11xx_is_fw_compatible_with_chip( LR1120_FIRMWARE_UPDATE_TO_TRX, version->fw ) == true ) ||
+             ( lr11xx_is_fw_compatible_with_chip( LR1121_FIRMWARE_UPDATE_TO_TRX, version->fw ) == true ) );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
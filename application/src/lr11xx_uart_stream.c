@@ -0,0 +1,523 @@
+/*!
+ * @file      lr11xx_uart_stream.c
+ *
+ * @brief     LR11XX firmware image streaming over UART implementation
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stddef.h>
+
+#include "lr11xx_uart_stream.h"
+#include "system.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Time to wait for a block before asking the host to resend it
+ */
+#define LR11XX_UART_STREAM_BLOCK_TIMEOUT_MS ( 1000 )
+
+/*!
+ * @brief Number of times a block is asked again before giving up
+ */
+#define LR11XX_UART_STREAM_BLOCK_RETRY_COUNT ( 5 )
+
+/*!
+ * @brief Sequence number no NAK was sent for
+ */
+#define LR11XX_UART_STREAM_NO_NAK ( 0xFFFF )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+    LR11XX_UART_STREAM_RX_WAIT_SOF,
+    LR11XX_UART_STREAM_RX_HEADER,
+    LR11XX_UART_STREAM_RX_PAYLOAD,
+    LR11XX_UART_STREAM_RX_CRC,
+} lr11xx_uart_stream_rx_state_t;
+
+/*!
+ * @brief Frame being received, only accessed from interrupt context
+ */
+typedef struct
+{
+    lr11xx_uart_stream_rx_state_t state;
+    uint8_t                       header[LR11XX_UART_STREAM_HEADER_LENGTH - 1];  //!< Type, sequence number, length
+    uint16_t                      index;
+    uint16_t                      length;
+    uint16_t                      crc;
+    uint16_t                      crc_received;
+    uint8_t*                      destination;  //!< Where the payload goes, NULL if it is discarded
+} lr11xx_uart_stream_rx_t;
+
+/*!
+ * @brief Block received from the host
+ */
+typedef struct
+{
+    uint8_t  payload[LR11XX_UART_STREAM_PAYLOAD_MAX_LENGTH];
+    uint16_t length;
+} lr11xx_uart_stream_slot_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief Ring of blocks: the interrupt receives the next blocks while the previous ones are written to the chip
+ */
+static lr11xx_uart_stream_slot_t lr11xx_uart_stream_slots[LR11XX_UART_STREAM_WINDOW];
+
+static uint8_t lr11xx_uart_stream_start_payload[LR11XX_UART_STREAM_START_LENGTH];
+
+static lr11xx_uart_stream_rx_t lr11xx_uart_stream_rx;
+
+static volatile bool     lr11xx_uart_stream_is_start_received = false;
+static volatile bool     lr11xx_uart_stream_is_session_open   = false;
+static volatile bool     lr11xx_uart_stream_is_nak_requested  = false;
+static volatile uint16_t lr11xx_uart_stream_nak_seq           = LR11XX_UART_STREAM_NO_NAK;
+static volatile uint8_t  lr11xx_uart_stream_nak_holdoff       = 0;  //!< Frames possibly sent before the last NAK
+static volatile uint32_t lr11xx_uart_stream_received_count    = 0;  //!< Blocks received, written by the interrupt
+static volatile uint32_t lr11xx_uart_stream_released_count    = 0;  //!< Blocks whose slot can be reused
+
+static bool lr11xx_uart_stream_is_start_acked = false;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Frame parser, called from interrupt context for each byte received
+ *
+ * @param [in] data Byte received
+ */
+static void lr11xx_uart_stream_on_byte( uint8_t data );
+
+/*!
+ * @brief Select where the payload of the frame whose header was just received goes
+ *
+ * @returns Payload destination, NULL if the payload is to be discarded
+ */
+static uint8_t* lr11xx_uart_stream_get_destination( void );
+
+/*!
+ * @brief Handle a complete frame, from interrupt context
+ */
+static void lr11xx_uart_stream_on_frame( void );
+
+/*!
+ * @brief Ask the main context to send a NAK for the block expected next
+ *
+ * The frames the host sent before handling the last NAK are not answered again: only a window of frames later is the
+ * resent block itself found missing again.
+ */
+static void lr11xx_uart_stream_request_nak( void );
+
+/*!
+ * @brief Streamed image source, see lr11xx_firmware_image_read_block_t
+ */
+static const uint8_t* lr11xx_uart_stream_read_block( void* context, uint32_t offset_in_word, uint32_t length_in_word );
+
+/*!
+ * @brief Send a NAK for the block expected next
+ */
+static void lr11xx_uart_stream_send_nak( void );
+
+/*!
+ * @brief Send a frame to the host
+ *
+ * @param [in] type Frame type
+ * @param [in] seq Sequence number
+ * @param [in] payload Payload, can be NULL if length is 0
+ * @param [in] length Length of the payload
+ */
+static void lr11xx_uart_stream_send_frame( lr11xx_uart_stream_frame_type_t type, uint8_t seq, const uint8_t* payload,
+                                           uint16_t length );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void lr11xx_uart_stream_init( void )
+{
+    lr11xx_uart_stream_rx.state = LR11XX_UART_STREAM_RX_WAIT_SOF;
+
+    system_uart_start_receive( lr11xx_uart_stream_on_byte );
+}
+
+bool lr11xx_uart_stream_get_start( lr11xx_uart_stream_start_t* start )
+{
+    const uint8_t* payload = lr11xx_uart_stream_start_payload;
+
+    if( lr11xx_uart_stream_is_start_received == false )
+    {
+        return false;
+    }
+
+    start->update         = ( lr11xx_fw_update_t ) payload[0];
+    start->fw_expected    = ( ( uint32_t ) payload[1] << 24 ) + ( ( uint32_t ) payload[2] << 16 ) +
+                         ( ( uint32_t ) payload[3] << 8 ) + ( uint32_t ) payload[4];
+    start->length_in_word = ( ( uint32_t ) payload[5] << 24 ) + ( ( uint32_t ) payload[6] << 16 ) +
+                            ( ( uint32_t ) payload[7] << 8 ) + ( uint32_t ) payload[8];
+
+    lr11xx_uart_stream_received_count    = 0;
+    lr11xx_uart_stream_released_count    = 0;
+    lr11xx_uart_stream_nak_seq           = LR11XX_UART_STREAM_NO_NAK;
+    lr11xx_uart_stream_nak_holdoff       = 0;
+    lr11xx_uart_stream_is_nak_requested  = false;
+    lr11xx_uart_stream_is_start_acked    = false;
+    lr11xx_uart_stream_is_session_open   = true;
+    lr11xx_uart_stream_is_start_received = false;
+
+    if( ( payload[0] > LR1121_FIRMWARE_UPDATE_TO_MODEM_V2 ) || ( start->length_in_word == 0 ) )
+    {
+        lr11xx_uart_stream_finish( LR11XX_FW_UPDATE_ERROR );
+        return false;
+    }
+
+    return true;
+}
+
+void lr11xx_uart_stream_get_image( const lr11xx_uart_stream_start_t* start, lr11xx_firmware_image_t* image )
+{
+    image->words          = NULL;
+    image->length_in_word = start->length_in_word;
+    image->format         = LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM;
+    image->read_block     = lr11xx_uart_stream_read_block;
+    image->rewind         = NULL;
+    image->context        = NULL;
+}
+
+void lr11xx_uart_stream_finish( lr11xx_fw_update_status_t status )
+{
+    const uint8_t payload = ( uint8_t ) status;
+
+    if( lr11xx_uart_stream_is_session_open == false )
+    {
+        return;
+    }
+
+    if( lr11xx_uart_stream_is_start_acked == true )
+    {
+        lr11xx_uart_stream_released_count = lr11xx_uart_stream_received_count;
+        lr11xx_uart_stream_send_frame( LR11XX_UART_STREAM_FRAME_ACK, ( uint8_t ) lr11xx_uart_stream_released_count,
+                                       NULL, 0 );
+    }
+
+    lr11xx_uart_stream_is_session_open = false;
+    lr11xx_uart_stream_send_frame( LR11XX_UART_STREAM_FRAME_DONE, 0, &payload, 1 );
+}
+
+uint16_t lr11xx_uart_stream_crc_update( uint16_t crc, uint8_t data )
+{
+    crc ^= ( uint16_t ) data << 8;
+
+    for( uint8_t bit = 0; bit < 8; bit++ )
+    {
+        crc = ( ( crc & 0x8000 ) != 0 ) ? ( uint16_t ) ( ( crc << 1 ) ^ 0x1021 ) : ( uint16_t ) ( crc << 1 );
+    }
+
+    return crc;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void lr11xx_uart_stream_on_byte( uint8_t data )
+{
+    lr11xx_uart_stream_rx_t* rx = &lr11xx_uart_stream_rx;
+
+    switch( rx->state )
+    {
+    case LR11XX_UART_STREAM_RX_WAIT_SOF:
+    {
+        if( data == LR11XX_UART_STREAM_SOF )
+        {
+            rx->index = 0;
+            rx->crc   = 0xFFFF;
+            rx->state = LR11XX_UART_STREAM_RX_HEADER;
+        }
+        break;
+    }
+    case LR11XX_UART_STREAM_RX_HEADER:
+    {
+        rx->header[rx->index++] = data;
+        rx->crc                 = lr11xx_uart_stream_crc_update( rx->crc, data );
+
+        if( rx->index == sizeof( rx->header ) )
+        {
+            rx->length = ( ( uint16_t ) rx->header[2] << 8 ) + rx->header[3];
+
+            if( rx->length > LR11XX_UART_STREAM_PAYLOAD_MAX_LENGTH )
+            {
+                /* Corrupted header: look for the start of the next frame */
+                lr11xx_uart_stream_request_nak( );
+                rx->state = LR11XX_UART_STREAM_RX_WAIT_SOF;
+                break;
+            }
+
+            rx->destination  = lr11xx_uart_stream_get_destination( );
+            rx->index        = 0;
+            rx->crc_received = 0;
+            rx->state = ( rx->length != 0 ) ? LR11XX_UART_STREAM_RX_PAYLOAD : LR11XX_UART_STREAM_RX_CRC;
+        }
+        break;
+    }
+    case LR11XX_UART_STREAM_RX_PAYLOAD:
+    {
+        if( rx->destination != NULL )
+        {
+            rx->destination[rx->index] = data;
+        }
+        rx->crc = lr11xx_uart_stream_crc_update( rx->crc, data );
+
+        if( ++rx->index == rx->length )
+        {
+            rx->index = 0;
+            rx->state = LR11XX_UART_STREAM_RX_CRC;
+        }
+        break;
+    }
+    case LR11XX_UART_STREAM_RX_CRC:
+    {
+        rx->crc_received = ( uint16_t ) ( rx->crc_received << 8 ) + data;
+
+        if( ++rx->index == LR11XX_UART_STREAM_CRC_LENGTH )
+        {
+            lr11xx_uart_stream_on_frame( );
+            rx->state = LR11XX_UART_STREAM_RX_WAIT_SOF;
+        }
+        break;
+    }
+    }
+}
+
+static uint8_t* lr11xx_uart_stream_get_destination( void )
+{
+    const lr11xx_uart_stream_rx_t* rx       = &lr11xx_uart_stream_rx;
+    const uint32_t                 received = lr11xx_uart_stream_received_count;
+
+    switch( rx->header[0] )
+    {
+    case LR11XX_UART_STREAM_FRAME_START:
+    {
+        if( ( lr11xx_uart_stream_is_session_open == false ) && ( lr11xx_uart_stream_is_start_received == false ) &&
+            ( rx->length == LR11XX_UART_STREAM_START_LENGTH ) )
+        {
+            return lr11xx_uart_stream_start_payload;
+        }
+        break;
+    }
+    case LR11XX_UART_STREAM_FRAME_DATA:
+    {
+        /* Only the block expected next is kept, and only if its slot was released */
+        if( ( lr11xx_uart_stream_is_session_open == true ) && ( rx->header[1] == ( uint8_t ) ( received + 1 ) ) &&
+            ( ( received - lr11xx_uart_stream_released_count ) < LR11XX_UART_STREAM_WINDOW ) )
+        {
+            lr11xx_uart_stream_slot_t* slot = &lr11xx_uart_stream_slots[received % LR11XX_UART_STREAM_WINDOW];
+
+            slot->length = rx->length;
+            return slot->payload;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    return NULL;
+}
+
+static void lr11xx_uart_stream_on_frame( void )
+{
+    const lr11xx_uart_stream_rx_t* rx = &lr11xx_uart_stream_rx;
+
+    if( lr11xx_uart_stream_nak_holdoff != 0 )
+    {
+        lr11xx_uart_stream_nak_holdoff--;
+    }
+
+    if( rx->crc != rx->crc_received )
+    {
+        lr11xx_uart_stream_request_nak( );
+        return;
+    }
+
+    switch( rx->header[0] )
+    {
+    case LR11XX_UART_STREAM_FRAME_START:
+    {
+        if( rx->destination != NULL )
+        {
+            lr11xx_uart_stream_is_start_received = true;
+        }
+        break;
+    }
+    case LR11XX_UART_STREAM_FRAME_DATA:
+    {
+        if( rx->destination != NULL )
+        {
+            lr11xx_uart_stream_received_count++;
+        }
+        else
+        {
+            lr11xx_uart_stream_request_nak( );
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void lr11xx_uart_stream_request_nak( void )
+{
+    const uint8_t expected = ( uint8_t ) ( lr11xx_uart_stream_received_count + 1 );
+
+    if( ( lr11xx_uart_stream_is_session_open == true ) &&
+        ( ( lr11xx_uart_stream_nak_seq != expected ) || ( lr11xx_uart_stream_nak_holdoff == 0 ) ) )
+    {
+        lr11xx_uart_stream_is_nak_requested = true;
+    }
+}
+
+static const uint8_t* lr11xx_uart_stream_read_block( void* context, uint32_t offset_in_word, uint32_t length_in_word )
+{
+    const uint32_t             block    = offset_in_word / LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD;
+    const uint8_t              window   = LR11XX_UART_STREAM_WINDOW;
+    uint32_t                   start_ms = system_time_GetTicker( );
+    uint8_t                    retry    = 0;
+    lr11xx_uart_stream_slot_t* slot     = &lr11xx_uart_stream_slots[block % LR11XX_UART_STREAM_WINDOW];
+
+    if( lr11xx_uart_stream_is_start_acked == false )
+    {
+        /* The flash is erased: the host can start sending the image */
+        lr11xx_uart_stream_is_start_acked = true;
+        lr11xx_uart_stream_send_frame( LR11XX_UART_STREAM_FRAME_ACK, 0, &window, 1 );
+    }
+
+    /* The previous block may still be on the wire: only release the ones before it */
+    if( ( block >= 2 ) && ( lr11xx_uart_stream_released_count < ( block - 1 ) ) )
+    {
+        lr11xx_uart_stream_released_count = block - 1;
+        lr11xx_uart_stream_send_frame( LR11XX_UART_STREAM_FRAME_ACK, ( uint8_t ) lr11xx_uart_stream_released_count,
+                                       NULL, 0 );
+    }
+
+    while( lr11xx_uart_stream_received_count <= block )
+    {
+        if( lr11xx_uart_stream_is_nak_requested == true )
+        {
+            lr11xx_uart_stream_is_nak_requested = false;
+            lr11xx_uart_stream_send_nak( );
+        }
+
+        if( ( system_time_GetTicker( ) - start_ms ) > LR11XX_UART_STREAM_BLOCK_TIMEOUT_MS )
+        {
+            if( ++retry > LR11XX_UART_STREAM_BLOCK_RETRY_COUNT )
+            {
+                return NULL;
+            }
+
+            lr11xx_uart_stream_send_nak( );
+            start_ms = system_time_GetTicker( );
+        }
+
+        system_uart_wait_for_receive( );
+    }
+
+    if( slot->length != ( length_in_word * sizeof( uint32_t ) ) )
+    {
+        return NULL;
+    }
+
+    return slot->payload;
+}
+
+static void lr11xx_uart_stream_send_nak( void )
+{
+    const uint8_t expected = ( uint8_t ) ( lr11xx_uart_stream_received_count + 1 );
+
+    lr11xx_uart_stream_nak_seq     = expected;
+    lr11xx_uart_stream_nak_holdoff = LR11XX_UART_STREAM_WINDOW;
+    lr11xx_uart_stream_send_frame( LR11XX_UART_STREAM_FRAME_NAK, expected, NULL, 0 );
+}
+
+static void lr11xx_uart_stream_send_frame( lr11xx_uart_stream_frame_type_t type, uint8_t seq, const uint8_t* payload,
+                                           uint16_t length )
+{
+    const uint8_t header[LR11XX_UART_STREAM_HEADER_LENGTH] = {
+        LR11XX_UART_STREAM_SOF, ( uint8_t ) type, seq, ( uint8_t ) ( length >> 8 ), ( uint8_t ) ( length >> 0 ),
+    };
+    uint16_t crc = 0xFFFF;
+
+    for( uint16_t i = 0; i < LR11XX_UART_STREAM_HEADER_LENGTH; i++ )
+    {
+        /* The SOF is not covered by the CRC */
+        if( i != 0 )
+        {
+            crc = lr11xx_uart_stream_crc_update( crc, header[i] );
+        }
+        system_uart_send_char( header[i] );
+    }
+
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        crc = lr11xx_uart_stream_crc_update( crc, payload[i] );
+        system_uart_send_char( payload[i] );
+    }
+
+    system_uart_send_char( ( uint8_t ) ( crc >> 8 ) );
+    system_uart_send_char( ( uint8_t ) ( crc >> 0 ) );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -37,17 +37,31 @@
  * --- DEPENDENCIES ------------------------------------------------------------
  */
 
-#if defined IMAGE_HEADER_FILE
+#if( LR11XX_UART_STREAM == 1 )
+#include "lr11xx_uart_stream.h"
+#elif defined LR11XX_FIRMWARE_BUNDLE_FILE
+#include LR11XX_FIRMWARE_BUNDLE_FILE
+#elif defined IMAGE_HEADER_FILE
 #include IMAGE_HEADER_FILE
 #else
 #error IMAGE_HEADER_FILE is not defined, please define it or include firmware image instead of this message
 #endif
 
+#if defined( LR11XX_FIRMWARE_DIFF_FILE )
+#include LR11XX_FIRMWARE_DIFF_FILE
+#endif
+
+#if( LR11XX_STATION == 1 ) && ( LR11XX_UART_STREAM == 1 )
+#error LR11XX_STATION flashes the embedded image or bundle on every module, it does not combine with LR11XX_UART_STREAM
+#endif
+
 #include "configuration.h"
 #include "system.h"
 #include "stdio.h"
 #include "string.h"
 #include "lr11xx_firmware_update.h"
+#include "lr11xx_firmware_lz.h"
+#include "lr11xx_station.h"
 #include "lvgl.h"
 #include "lv_port_disp.h"
 #include "gui.h"
@@ -63,6 +77,13 @@
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
+/*!
+ * @brief Power-up time of the display controller, which has no reset line nor readiness signal on this board
+ *
+ * The LR11XX needs no wait: the update starts with a reset and waits for BUSY.
+ */
+#define MAIN_DISPLAY_POWER_UP_MS ( 120 )
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -74,8 +95,7 @@
  */
 
 radio_t radio = {
-    SPI1,
-    { LR11XX_NSS_PORT, LR11XX_NSS_PIN },
+    { SPI1, { LR11XX_NSS_PORT, LR11XX_NSS_PIN }, LR11XX_SPI_PRESCALER, LL_SPI_DATAWIDTH_8BIT, false },
     { LR11XX_RESET_PORT, LR11XX_RESET_PIN },
     { LR11XX_IRQ_PORT, LR11XX_IRQ_PIN },
     { LR11XX_BUSY_PORT, LR11XX_BUSY_PIN },
@@ -85,11 +105,102 @@ static gpio_t lr11xx_led_tx   = { LR11XX_LED_TX_PORT, LR11XX_LED_TX_PIN };
 static gpio_t lr11xx_led_rx   = { LR11XX_LED_RX_PORT, LR11XX_LED_RX_PIN };
 static gpio_t lr11xx_led_scan = { LR11XX_LED_SCAN_PORT, LR11XX_LED_SCAN_PIN };
 
+/*!
+ * @brief Update in progress, run one step per turn of the main loop
+ */
+static lr11xx_fw_update_session_t main_update_session;
+static lr11xx_fw_update_timing_t  main_update_timing;
+static bool                       main_is_updating = false;
+
+#if( LR11XX_STATION == 1 )
+/*!
+ * @brief Modules detected as they are inserted and removed, statistics of the units updated
+ */
+static lr11xx_station_t main_station;
+#endif
+
+#if( LR11XX_UART_STREAM != 1 ) && !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+static lr11xx_firmware_lz_t    lr11xx_image_lz;
+static lr11xx_firmware_image_t lr11xx_image;
+#else
+static const lr11xx_firmware_image_t lr11xx_image = {
+    .words          = lr11xx_firmware_image,
+    .length_in_word = sizeof( lr11xx_firmware_image ) / sizeof( lr11xx_firmware_image[0] ),
+    .format         = LR11XX_FIRMWARE_IMAGE_FORMAT,
+};
+#endif
+#if defined( LR11XX_FIRMWARE_FLASH_HASH )
+static const uint8_t lr11xx_flash_hash[LR11XX_FW_FLASH_HASH_LENGTH] = { LR11XX_FIRMWARE_FLASH_HASH };
+#endif
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
  */
 
+/*!
+ * @brief Print the update about to be done
+ *
+ * @param [in] update Type of firmware
+ * @param [in] fw_expected Expected LR11xx firmware version
+ */
+static void main_print_update( lr11xx_fw_update_t update, uint32_t fw_expected );
+
+/*!
+ * @brief Start the update of the chip with an image, to be run step by step from the main loop
+ *
+ * @param [in] update Type of firmware
+ * @param [in] fw_expected Expected LR11xx firmware version
+ * @param [in] image Firmware image
+ */
+static void main_start_update( lr11xx_fw_update_t update, uint32_t fw_expected, const lr11xx_firmware_image_t* image );
+
+#if( LR11XX_UART_STREAM != 1 )
+/*!
+ * @brief Start the update of the embedded image, or of the bundle entry matching the chip
+ */
+static void main_start_next_update( void );
+#endif
+
+/*!
+ * @brief Report the outcome of the update once its last step is run
+ */
+static void main_end_update( void );
+
+/*!
+ * @brief Report the outcome of an update on the LEDs, the display and the console
+ *
+ * @param [in] status Update status
+ * @param [in] timing Timing filled by the update
+ */
+static void main_report_update( lr11xx_fw_update_status_t status, const lr11xx_fw_update_timing_t* timing );
+
+/*!
+ * @brief Print the display refreshes of an update, the screen being redrawn while the LR11xx is flashed
+ *
+ * @param [in] timing Timing of the update
+ */
+static void main_print_display_stats( const lr11xx_fw_update_timing_t* timing );
+
+#if( LR11XX_STATION == 1 )
+/*!
+ * @brief Record the outcome of an update in the station statistics and ask for the removal of the module
+ *
+ * @param [in] status Update status
+ */
+static void main_report_station( lr11xx_fw_update_status_t status );
+#endif
+
+/*!
+ * @brief Show the progress of the flash write on the display and the console
+ *
+ * @param [in] progress Progress of the write
+ * @param [in] context Unused
+ */
+static void main_show_progress( const lr11xx_bootloader_progress_t* progress, void* context );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -97,90 +208,320 @@ static gpio_t lr11xx_led_scan = { LR11XX_LED_SCAN_PORT, LR11XX_LED_SCAN_PIN };
 
 int main( void )
 {
+#if( LR11XX_UART_STREAM != 1 )
     bool is_updated = false;
+#endif
 
     system_init( );
 
-    system_time_wait_ms( 2000 );
+    system_time_wait_ms( MAIN_DISPLAY_POWER_UP_MS );
 
     lv_init( );
     lv_port_disp_init( );
 
     printf( "LR11XX updater tool %s\n", DEMO_VERSION );
 
-    gui_init( LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION );
+    gui_init( );
+
+    /* First frame drawn here rather than in the main loop, to report how long a full screen takes to flush */
+    lv_port_disp_frame_t frame;
+
+    lv_refr_now( NULL );
+    lv_port_disp_get_last_frame( &frame );
+    printf( "Display: %u pixels flushed in %u.%u ms\n", frame.px, frame.time_us / 1000, ( frame.time_us / 100 ) % 10 );
+
+    lr11xx_update_firmware_set_progress_callback( main_show_progress, NULL );
+
+#if( LR11XX_UART_STREAM == 1 )
+    /* The image comes from the host, one session after the other: the same binary flashes any firmware */
+    lr11xx_uart_stream_init( );
+
+    gui_update( "WAITING FOR IMAGE\nON COM PORT" );
+    printf( "Waiting for an image on the UART\n" );
+#elif defined LR11XX_FIRMWARE_BUNDLE_FILE
+    /* The image is selected once the chip is known */
+    printf( "Update from a bundle of %u images\n", LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT );
+#else
+    gui_set_firmware( LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION );
+    main_print_update( LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION );
+
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+    /* The image is decoded block per block while it is flashed */
+    if( lr11xx_firmware_lz_init( &lr11xx_image_lz, lr11xx_firmware_image_lz, sizeof( lr11xx_firmware_image_lz ),
+                                 &lr11xx_image ) == false )
+    {
+        system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_HIGH );
+        gui_update( "ERROR\nCorrupted compressed image" );
+        printf( "Error! Corrupted compressed image.\n" );
+        is_updated = true;
+    }
+#endif
+#endif
+
+#if( LR11XX_STATION == 1 )
+    lr11xx_station_init( &main_station, &radio );
 
-    switch( LR11XX_FIRMWARE_UPDATE_TO )
+    if( is_updated == false )
+    {
+        gui_update( "WAITING FOR A MODULE" );
+        printf( "Station mode: waiting for a module\n" );
+    }
+#endif
+
+    while( 1 )
+    {
+        /* During an update, a refresh only starts while the chip is busy, the display using the bus meanwhile: the
+         * update takes it back once the segment being sent is done */
+        if( ( main_is_updating == false ) || ( lr11xx_update_firmware_is_waiting( &main_update_session ) == true ) )
+        {
+            lv_task_handler( );
+        }
+
+        /* One step per turn: the display is refreshed all along the update */
+        if( main_is_updating == true )
+        {
+            if( lr11xx_update_firmware_step( &main_update_session ) == false )
+            {
+                main_end_update( );
+            }
+            continue;
+        }
+
+#if( LR11XX_UART_STREAM == 1 )
+        lr11xx_uart_stream_start_t start;
+
+        if( lr11xx_uart_stream_get_start( &start ) == true )
+        {
+            lr11xx_firmware_image_t image;
+
+            lr11xx_uart_stream_get_image( &start, &image );
+
+            system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_LOW );
+            system_gpio_set_pin_state( lr11xx_led_rx, SYSTEM_GPIO_PIN_STATE_LOW );
+            gui_set_firmware( start.update, start.fw_expected );
+            gui_update( "UPDATE ON GOING..." );
+            lv_task_handler( );
+            main_print_update( start.update, start.fw_expected );
+
+            main_start_update( start.update, start.fw_expected, &image );
+        }
+#elif( LR11XX_STATION == 1 )
+        /* No reset between two units: each module inserted is updated, the next one is waited for once it is gone */
+        if( is_updated == false )
+        {
+            switch( lr11xx_station_step( &main_station ) )
+            {
+            case LR11XX_STATION_EVENT_INSERTED:
+                system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_LOW );
+                system_gpio_set_pin_state( lr11xx_led_rx, SYSTEM_GPIO_PIN_STATE_LOW );
+                gui_update( "UPDATE ON GOING..." );
+                lv_task_handler( );
+
+                main_start_next_update( );
+                break;
+            case LR11XX_STATION_EVENT_REMOVED:
+                system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_LOW );
+                system_gpio_set_pin_state( lr11xx_led_rx, SYSTEM_GPIO_PIN_STATE_LOW );
+                gui_update( "WAITING FOR A MODULE" );
+                break;
+            case LR11XX_STATION_EVENT_NONE:
+            default:
+                break;
+            }
+        }
+#else
+        if( is_updated == false )
+        {
+            main_start_next_update( );
+
+            is_updated = true;
+        }
+#endif
+    };
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void main_print_update( lr11xx_fw_update_t update, uint32_t fw_expected )
+{
+    switch( update )
     {
     case LR1110_FIRMWARE_UPDATE_TO_TRX:
     {
-        printf( "Update LR1110 to transceiver firmware 0x%04x\n", LR11XX_FIRMWARE_VERSION );
+        printf( "Update LR1110 to transceiver firmware 0x%04x\n", fw_expected );
         break;
     }
     case LR1120_FIRMWARE_UPDATE_TO_TRX:
     {
-        printf( "Update LR1120 to transceiver firmware 0x%04x\n", LR11XX_FIRMWARE_VERSION );
+        printf( "Update LR1120 to transceiver firmware 0x%04x\n", fw_expected );
         break;
     }
     case LR1121_FIRMWARE_UPDATE_TO_TRX:
     {
-        printf( "Update LR1121 to transceiver firmware 0x%04x\n", LR11XX_FIRMWARE_VERSION );
+        printf( "Update LR1121 to transceiver firmware 0x%04x\n", fw_expected );
         break;
     }
     case LR1110_FIRMWARE_UPDATE_TO_MODEM_V1:
     {
-        printf( "Update LR1110 to modem firmware 0x%06x\n", LR11XX_FIRMWARE_VERSION );
+        printf( "Update LR1110 to modem firmware 0x%06x\n", fw_expected );
         break;
     }
     case LR1121_FIRMWARE_UPDATE_TO_MODEM_V2:
     {
-        printf( "Update LR1121 to modem firmware 0x%06x\n", LR11XX_FIRMWARE_VERSION );
+        printf( "Update LR1121 to modem firmware 0x%06x\n", fw_expected );
         break;
     }
     }
+}
 
-    while( 1 )
+static void main_start_update( lr11xx_fw_update_t update, uint32_t fw_expected, const lr11xx_firmware_image_t* image )
+{
+    system_gpio_set_pin_state( lr11xx_led_scan, SYSTEM_GPIO_PIN_STATE_HIGH );
+    lv_port_disp_reset_stats( );
+
+#if defined( LR11XX_FIRMWARE_DIFF_FILE )
+    lr11xx_update_firmware_start_diff( &main_update_session, &radio, update, fw_expected, image, &lr11xx_firmware_diff,
+                                       &main_update_timing );
+#elif defined( LR11XX_FIRMWARE_FLASH_HASH )
+    lr11xx_update_firmware_start( &main_update_session, &radio, update, fw_expected, image, lr11xx_flash_hash,
+                                  &main_update_timing );
+#else
+    lr11xx_update_firmware_start( &main_update_session, &radio, update, fw_expected, image, NULL, &main_update_timing );
+#endif
+
+    main_is_updating = true;
+}
+
+#if( LR11XX_UART_STREAM != 1 )
+static void main_start_next_update( void )
+{
+#if defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+    system_gpio_set_pin_state( lr11xx_led_scan, SYSTEM_GPIO_PIN_STATE_HIGH );
+    lv_port_disp_reset_stats( );
+
+    lr11xx_update_firmware_start_from_bundle( &main_update_session, &radio, lr11xx_firmware_bundle,
+                                              LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT, LR11XX_FW_BUNDLE_KIND,
+                                              &main_update_timing );
+    main_is_updating = true;
+#else
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+    /* The image is decoded once, from its start: every update needs the decoder set up again */
+    ( void ) lr11xx_firmware_lz_init( &lr11xx_image_lz, lr11xx_firmware_image_lz, sizeof( lr11xx_firmware_image_lz ),
+                                      &lr11xx_image );
+#endif
+    main_start_update( LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+#endif
+}
+#endif
+
+static void main_end_update( void )
+{
+    const lr11xx_fw_bundle_entry_t* selected;
+    const lr11xx_fw_update_status_t status = lr11xx_update_firmware_get_status( &main_update_session, &selected );
+
+    main_is_updating = false;
+
+#if defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+    if( selected != NULL )
     {
-        lv_task_handler( );
+        gui_set_firmware( selected->update, selected->fw_expected );
+    }
+#else
+    ( void ) selected;
+#endif
 
-        if( is_updated == false )
-        {
-            system_gpio_set_pin_state( lr11xx_led_scan, SYSTEM_GPIO_PIN_STATE_HIGH );
+    main_report_update( status, &main_update_timing );
 
-            const lr11xx_fw_update_status_t status = lr11xx_update_firmware(
-                &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, lr11xx_firmware_image,
-                sizeof( lr11xx_firmware_image ) / sizeof( lr11xx_firmware_image[0] ) );
+#if( LR11XX_UART_STREAM == 1 )
+    lr11xx_uart_stream_finish( status );
+#elif( LR11XX_STATION == 1 )
+    main_report_station( status );
+#endif
+}
 
-            system_gpio_set_pin_state( lr11xx_led_scan, SYSTEM_GPIO_PIN_STATE_LOW );
+static void main_print_display_stats( const lr11xx_fw_update_timing_t* timing )
+{
+    lv_port_disp_stats_t stats;
+    uint32_t             percent = 0;
 
-            switch( status )
-            {
-            case LR11XX_FW_UPDATE_OK:
-                system_gpio_set_pin_state( lr11xx_led_rx, SYSTEM_GPIO_PIN_STATE_HIGH );
-                gui_update( "UPDATE DONE!\nPlease flash another application\n(like EVK Demo App)" );
-                printf( "Expected firmware running!\n" );
-                printf( "Please flash another application (like EVK Demo App).\n" );
-                break;
-            case LR11XX_FW_UPDATE_WRONG_CHIP_TYPE:
-                system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_HIGH );
-                gui_update( "WRONG CHIP TYPE" );
-                printf( "Wrong chip type!\n" );
-                break;
-            case LR11XX_FW_UPDATE_ERROR:
-                system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_HIGH );
-                gui_update( "ERROR\nWrong firmware version\nPlease retry" );
-                printf( "Error! Wrong firmware version - please retry.\n" );
-                break;
-            }
+    lv_port_disp_get_stats( &stats );
+    if( timing->total_us != 0 )
+    {
+        percent = ( uint32_t ) ( ( ( uint64_t ) stats.time_us * 100 ) / timing->total_us );
+    }
 
-            is_updated = true;
-        }
-    };
+    printf( "Display: %u refreshes, %u pixels flushed in %u ms (%u%% of the update)\n", stats.refresh_count, stats.px,
+            stats.time_us / 1000, percent );
 }
 
-/*
- * -----------------------------------------------------------------------------
- * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
- */
+static void main_report_update( lr11xx_fw_update_status_t status, const lr11xx_fw_update_timing_t* timing )
+{
+    system_gpio_set_pin_state( lr11xx_led_scan, SYSTEM_GPIO_PIN_STATE_LOW );
+
+    lr11xx_update_firmware_print_timing( timing );
+    main_print_display_stats( timing );
+    gui_show_timing( timing );
+
+    switch( status )
+    {
+    case LR11XX_FW_UPDATE_OK:
+        system_gpio_set_pin_state( lr11xx_led_rx, SYSTEM_GPIO_PIN_STATE_HIGH );
+        gui_update( "UPDATE DONE!\nPlease flash another application\n(like EVK Demo App)" );
+        printf( "Expected firmware running!\n" );
+#if( LR11XX_STATION != 1 )
+        printf( "Please flash another application (like EVK Demo App).\n" );
+#endif
+        break;
+    case LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE:
+        system_gpio_set_pin_state( lr11xx_led_rx, SYSTEM_GPIO_PIN_STATE_HIGH );
+        gui_update( "ALREADY UP TO DATE\nPlease flash another application\n(like EVK Demo App)" );
+        printf( "Expected firmware already running, nothing flashed!\n" );
+#if( LR11XX_STATION != 1 )
+        printf( "Please flash another application (like EVK Demo App).\n" );
+#endif
+        break;
+    case LR11XX_FW_UPDATE_WRONG_CHIP_TYPE:
+        system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_HIGH );
+        gui_update( "WRONG CHIP TYPE" );
+        printf( "Wrong chip type!\n" );
+        break;
+    case LR11XX_FW_UPDATE_ERROR:
+        system_gpio_set_pin_state( lr11xx_led_tx, SYSTEM_GPIO_PIN_STATE_HIGH );
+        gui_update( "ERROR\nWrong firmware version\nPlease retry" );
+        printf( "Error! Wrong firmware version - please retry.\n" );
+        break;
+    }
+}
+
+#if( LR11XX_STATION == 1 )
+static void main_report_station( lr11xx_fw_update_status_t status )
+{
+    const lr11xx_station_stats_t* stats = &main_station.stats;
+    char                          text[96];
+
+    lr11xx_station_end_update( &main_station, status, &main_update_timing );
+    lr11xx_station_print_stats( stats );
+
+    /* In place of the single chip instructions: the operator only swaps the module */
+    sprintf( text, "%s\nPlease remove the module\n%u units - %u passed - %u failed",
+             ( ( status == LR11XX_FW_UPDATE_OK ) || ( status == LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE ) ) ? "PASS"
+                                                                                                      : "FAIL",
+             stats->unit_count, stats->pass_count, stats->fail_count );
+    gui_update( text );
+    printf( "Please remove the module.\n" );
+}
+#endif
+
+static void main_show_progress( const lr11xx_bootloader_progress_t* progress, void* context )
+{
+    ( void ) context;
+
+    /* Drawn by the next LVGL task handler call, between two steps of the update */
+    gui_show_progress( progress );
+    lr11xx_update_firmware_print_progress( progress );
+}
 
 /* --- EOF ------------------------------------------------------------------ */
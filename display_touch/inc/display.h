@@ -44,6 +44,8 @@ extern "C" {
  * --- DEPENDENCIES ------------------------------------------------------------
  */
 
+#include "configuration.h"
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC MACROS -----------------------------------------------------------
@@ -64,6 +66,13 @@ extern "C" {
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
  */
 
+/*!
+ * @brief Get the display as a device of the shared SPI bus
+ *
+ * @returns Display device, to be selected with system_spi_bus_select or given to queued transactions
+ */
+const spi_device_t* display_get_spi_device( void );
+
 /*!
  * @brief Initialize the display
  */
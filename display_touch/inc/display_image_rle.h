@@ -0,0 +1,123 @@
+/*!
+ * @file      display_image_rle.h
+ *
+ * @brief     Palette and run-length encoded images, decoded line by line while drawn
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DISPLAY_IMAGE_RLE_H
+#define DISPLAY_IMAGE_RLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief LVGL color format of the images, given in the header of their lv_img_dsc_t
+ */
+#define DISPLAY_IMAGE_RLE_CF LV_IMG_CF_USER_ENCODED_0
+
+/*!
+ * @brief Run coding, shared with tools/display_image_rle.py
+ *
+ * Each run starts with a byte holding the palette index in its 6 low bits and the run length in its 2 high bits. A
+ * length of 0 means a long run, its length minus DISPLAY_IMAGE_RLE_LONG_RUN_MIN being given by the next byte. Runs
+ * do not cross rows.
+ */
+#define DISPLAY_IMAGE_RLE_INDEX_MASK 0x3F
+#define DISPLAY_IMAGE_RLE_COUNT_SHIFT 6
+#define DISPLAY_IMAGE_RLE_LONG_RUN_MIN 4
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Image data, pointed to by the data field of its lv_img_dsc_t
+ */
+typedef struct
+{
+    const lv_color_t* palette;      //!< Colors of the image, 64 at most
+    const uint16_t*   row_offsets;  //!< Offset in runs of the first run of each row
+    const uint8_t*    runs;         //!< Runs of all the rows, one after the other
+} display_image_rle_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Register the image decoder in LVGL
+ *
+ * @remark To be called after lv_init, before any image in this format is used. The image is never decoded as a whole:
+ * LVGL reads it one line at a time, straight into its draw buffer.
+ */
+void display_image_rle_init( void );
+
+/*!
+ * @brief Decode part of a row of an image
+ *
+ * @param [in] image Image data
+ * @param [in] x First pixel to decode in the row
+ * @param [in] y Row
+ * @param [in] length Number of pixels to decode
+ * @param [out] buffer Decoded pixels
+ */
+void display_image_rle_read_line( const display_image_rle_t* image, uint16_t x, uint16_t y, uint16_t length,
+                                  lv_color_t* buffer );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DISPLAY_IMAGE_RLE_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -32,7 +32,8 @@
 #define LV_COLOR_DEPTH     16
 
 /* Swap the 2 bytes of RGB565 color.
- * Useful if the display has a 8 bit interface (e.g. SPI)*/
+ * Useful if the display has a 8 bit interface (e.g. SPI)
+ * Not needed: the draw buffers are sent in 16-bit SPI frames, high byte first*/
 #define LV_COLOR_16_SWAP   0
 
 /* 1: Enable screen transparency.
@@ -27,12 +27,37 @@ extern "C" {
  *      TYPEDEFS
  **********************/
 
+/*Last refresh of the display*/
+typedef struct
+{
+    uint32_t px;      /*Number of pixels flushed*/
+    uint32_t time_us; /*Time from the first area flushed to the last one sent*/
+} lv_port_disp_frame_t;
+
+/*Refreshes accumulated since the last reset*/
+typedef struct
+{
+    uint32_t refresh_count; /*Number of refreshes*/
+    uint32_t px;            /*Number of pixels flushed*/
+    uint32_t time_us;       /*Time spent sending the areas*/
+} lv_port_disp_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
 
 void lv_port_disp_init( void );
 
+/*Get the number of pixels and the flush time of the last refresh, once its
+ * last area is sent*/
+void lv_port_disp_get_last_frame( lv_port_disp_frame_t* frame );
+
+/*Restart the accumulation of the refreshes*/
+void lv_port_disp_reset_stats( void );
+
+/*Get the refreshes accumulated since the last reset*/
+void lv_port_disp_get_stats( lv_port_disp_stats_t* stats );
+
 /**********************
  *      MACROS
  **********************/
@@ -63,6 +63,13 @@
  * --- PRIVATE VARIABLES -------------------------------------------------------
  */
 
+/*!
+ * @brief Display on SPI1, sharing it with the LR11xx: commands in 8-bit frames, the pixels switching to 16-bit ones
+ */
+static const spi_device_t display_spi_device = {
+    SPI1, { DISPLAY_NSS_PORT, DISPLAY_NSS_PIN }, DISPLAY_SPI_PRESCALER, LL_SPI_DATAWIDTH_8BIT, false,
+};
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
@@ -94,9 +101,14 @@ void display_send_data( const uint16_t data )
     system_spi_write( SPI1, &dl, 1 );
 }
 
+const spi_device_t* display_get_spi_device( void )
+{
+    return &display_spi_device;
+}
+
 void display_init( void )
 {
-    LL_GPIO_ResetOutputPin( DISPLAY_NSS_PORT, DISPLAY_NSS_PIN );
+    system_spi_bus_select( &display_spi_device );
 
     // ILI9341 init
     display_send_command( 0x11 );
@@ -207,7 +219,7 @@ void display_init( void )
 
     display_send_command( 0x29 );  // Display on
 
-    LL_GPIO_SetOutputPin( DISPLAY_NSS_PORT, DISPLAY_NSS_PIN );
+    system_spi_bus_deselect( &display_spi_device );
 
     LL_mDelay( 5 );
 }
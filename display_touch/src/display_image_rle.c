@@ -0,0 +1,212 @@
+/*!
+ * @file      display_image_rle.c
+ *
+ * @brief     Palette and run-length encoded images, decoded line by line while drawn
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "display_image_rle.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Give the header of an image in this format
+ *
+ * @param [in] decoder LVGL decoder
+ * @param [in] src Image source
+ * @param [out] header Image header
+ *
+ * @returns LV_RES_OK if the image is in this format, LV_RES_INV otherwise
+ */
+static lv_res_t display_image_rle_info( lv_img_decoder_t* decoder, const void* src, lv_img_header_t* header );
+
+/*!
+ * @brief Open an image in this format, to be read line by line
+ *
+ * @param [in] decoder LVGL decoder
+ * @param [in,out] dsc Decoding session
+ *
+ * @returns LV_RES_OK
+ */
+static lv_res_t display_image_rle_open( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc );
+
+/*!
+ * @brief Decode part of a row into the draw buffer
+ *
+ * @param [in] decoder LVGL decoder
+ * @param [in] dsc Decoding session
+ * @param [in] x First pixel to decode in the row
+ * @param [in] y Row
+ * @param [in] len Number of pixels to decode
+ * @param [out] buf Decoded pixels
+ *
+ * @returns LV_RES_OK
+ */
+static lv_res_t display_image_rle_read( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc, lv_coord_t x,
+                                        lv_coord_t y, lv_coord_t len, uint8_t* buf );
+
+/*!
+ * @brief Close an image - nothing to release
+ *
+ * @param [in] decoder LVGL decoder
+ * @param [in] dsc Decoding session
+ */
+static void display_image_rle_close( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void display_image_rle_init( void )
+{
+    lv_img_decoder_t* decoder = lv_img_decoder_create( );
+
+    lv_img_decoder_set_info_cb( decoder, display_image_rle_info );
+    lv_img_decoder_set_open_cb( decoder, display_image_rle_open );
+    lv_img_decoder_set_read_line_cb( decoder, display_image_rle_read );
+    lv_img_decoder_set_close_cb( decoder, display_image_rle_close );
+}
+
+void display_image_rle_read_line( const display_image_rle_t* image, uint16_t x, uint16_t y, uint16_t length,
+                                  lv_color_t* buffer )
+{
+    const uint8_t* run      = &image->runs[image->row_offsets[y]];
+    uint16_t       position = 0;
+
+    while( length > 0 )
+    {
+        uint8_t  index = *run & DISPLAY_IMAGE_RLE_INDEX_MASK;
+        uint16_t count = *run >> DISPLAY_IMAGE_RLE_COUNT_SHIFT;
+
+        run++;
+        if( count == 0 )
+        {
+            count = *run + DISPLAY_IMAGE_RLE_LONG_RUN_MIN;
+            run++;
+        }
+
+        /* Runs ending before the first pixel are skipped whole */
+        if( position + count <= x )
+        {
+            position += count;
+            continue;
+        }
+
+        if( position < x )
+        {
+            count -= x - position;
+            position = x;
+        }
+        if( count > length )
+        {
+            count = length;
+        }
+
+        const lv_color_t color = image->palette[index];
+
+        position += count;
+        length -= count;
+        while( count-- > 0 )
+        {
+            *buffer++ = color;
+        }
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static lv_res_t display_image_rle_info( lv_img_decoder_t* decoder, const void* src, lv_img_header_t* header )
+{
+    if( lv_img_src_get_type( src ) != LV_IMG_SRC_VARIABLE )
+    {
+        return LV_RES_INV;
+    }
+
+    const lv_img_dsc_t* image = ( const lv_img_dsc_t* ) src;
+
+    if( image->header.cf != DISPLAY_IMAGE_RLE_CF )
+    {
+        return LV_RES_INV;
+    }
+
+    *header = image->header;
+    return LV_RES_OK;
+}
+
+static lv_res_t display_image_rle_open( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc )
+{
+    /* No decoded copy of the image: LVGL falls back to reading it line by line */
+    dsc->img_data  = NULL;
+    dsc->user_data = ( void* ) ( ( const lv_img_dsc_t* ) dsc->src )->data;
+    return LV_RES_OK;
+}
+
+static lv_res_t display_image_rle_read( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc, lv_coord_t x,
+                                        lv_coord_t y, lv_coord_t len, uint8_t* buf )
+{
+    display_image_rle_read_line( ( const display_image_rle_t* ) dsc->user_data, x, y, len, ( lv_color_t* ) buf );
+    return LV_RES_OK;
+}
+
+static void display_image_rle_close( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc ) {}
+
+/* --- EOF ------------------------------------------------------------------ */
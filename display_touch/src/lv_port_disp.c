@@ -13,15 +13,32 @@
 #include "lv_port_disp.h"
 #include "display.h"
 #include "configuration.h"
+#include "system.h"
 
 /*********************
  *      DEFINES
  *********************/
 
+/*Number of rows of each of the two draw buffers*/
+#define DISP_BUF_ROWS 10
+
+/*Largest number of pixels sent in one go: 1 kB, about 0.8 ms at 10 MHz, less
+ * than the LR11xx takes to commit a flash block*/
+#define DISP_SEGMENT_PX 512
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/*Area queued on the shared SPI bus, one segment of rows after the other*/
+typedef struct
+{
+    lv_disp_drv_t* disp_drv;
+    lv_area_t      area;    /*Rows of the segment being sent*/
+    lv_coord_t     y2;      /*Last row of the area*/
+    lv_color_t*    color_p; /*Pixels of the segment being sent*/
+} disp_flush_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
@@ -29,6 +46,9 @@ static void disp_init( void );
 
 static void disp_flush( lv_disp_drv_t* disp_drv, const lv_area_t* area,
                         lv_color_t* color_p );
+static void disp_flush_start( void* context );
+static void disp_flush_done( void* context );
+static void disp_monitor( lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px );
 #if LV_USE_GPU
 static void gpu_blend( lv_color_t* dest, const lv_color_t* src, uint32_t length,
                        lv_opa_t opa );
@@ -39,6 +59,17 @@ static void gpu_fill( lv_color_t* dest, uint32_t length, lv_color_t color );
  *  STATIC VARIABLES
  **********************/
 
+/*A frame starts with its first flush and ends once its last one is sent*/
+static bool                 disp_is_frame_on_going;
+static uint32_t             disp_frame_start_cycles;
+static lv_port_disp_frame_t disp_last_frame;
+static lv_port_disp_stats_t disp_stats;
+
+/*One area at a time: LittlevGL waits for it before flushing the next one*/
+static disp_flush_t                 disp_pending_flush;
+static system_spi_bus_transaction_t disp_transaction;
+static uint32_t                     disp_area_start_cycles;
+
 /**********************
  *      MACROS
  **********************/
@@ -80,20 +111,24 @@ void lv_port_disp_init( void )
      * */
 
     /* Example for 1) */
-    static lv_disp_buf_t disp_buf_1;
-    static lv_color_t    buf1_1[LV_HOR_RES_MAX * 10]; /*A buffer for 10 rows*/
-    lv_disp_buf_init( &disp_buf_1, buf1_1, NULL,
-                      LV_HOR_RES_MAX * 10 ); /*Initialize the display buffer*/
-
-    /* Example for 2) */
-    // static lv_disp_buf_t disp_buf_2;
-    // static lv_color_t    buf2_1[LV_HOR_RES_MAX * 10]; /*A buffer for 10
-    // rows*/ static lv_color_t
-    //     buf2_2[LV_HOR_RES_MAX * 10]; /*An other buffer for 10 rows*/
-    // lv_disp_buf_init( &disp_buf_2, buf2_1, buf2_2,
+    // static lv_disp_buf_t disp_buf_1;
+    // static lv_color_t    buf1_1[LV_HOR_RES_MAX * 10]; /*A buffer for 10
+    // rows*/
+    // lv_disp_buf_init( &disp_buf_1, buf1_1, NULL,
     //                   LV_HOR_RES_MAX * 10 ); /*Initialize the display
     //                   buffer*/
 
+    /* 2) is used: one buffer is sent by DMA while the next rows are drawn in
+     * the other one */
+    static lv_disp_buf_t disp_buf_2;
+    static lv_color_t
+        buf2_1[LV_HOR_RES_MAX * DISP_BUF_ROWS]; /*A buffer for 10 rows*/
+    static lv_color_t
+        buf2_2[LV_HOR_RES_MAX * DISP_BUF_ROWS]; /*An other buffer for 10 rows*/
+    lv_disp_buf_init( &disp_buf_2, buf2_1, buf2_2,
+                      LV_HOR_RES_MAX *
+                          DISP_BUF_ROWS ); /*Initialize the display buffer*/
+
     /* Example for 3) */
     // static lv_disp_buf_t disp_buf_3;
     // static lv_color_t
@@ -123,7 +158,10 @@ void lv_port_disp_init( void )
     disp_drv.flush_cb = disp_flush;
 
     /*Set a display buffer*/
-    disp_drv.buffer = &disp_buf_1;
+    disp_drv.buffer = &disp_buf_2;
+
+    /*Called once all the areas of a refresh are flushed*/
+    disp_drv.monitor_cb = disp_monitor;
 
 #if LV_USE_GPU
     /*Optionally add functions to access the GPU. (Only in buffered mode,
@@ -140,6 +178,25 @@ void lv_port_disp_init( void )
     lv_disp_drv_register( &disp_drv );
 }
 
+void lv_port_disp_get_last_frame( lv_port_disp_frame_t* frame )
+{
+    system_spi_bus_wait( SPI1 );
+
+    *frame = disp_last_frame;
+}
+
+void lv_port_disp_reset_stats( void )
+{
+    disp_stats.refresh_count = 0;
+    disp_stats.px            = 0;
+    disp_stats.time_us       = 0;
+}
+
+void lv_port_disp_get_stats( lv_port_disp_stats_t* stats )
+{
+    *stats = disp_stats;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -148,44 +205,99 @@ void lv_port_disp_init( void )
 static void disp_init( void ) { display_init( ); }
 
 /* Flush the content of the internal buffer the specific area on the display
- * You can use DMA or any hardware acceleration to do this operation in the
- * background but 'lv_disp_flush_ready()' has to be called when finished. */
+ * The area is queued on the SPI bus it shares with the LR11xx, which goes
+ * first: it is sent by DMA in 16-bit frames, in segments of at most
+ * DISP_SEGMENT_PX pixels, each one queued again behind the LR11xx, so that the
+ * chip never waits for more than one segment. 'lv_disp_flush_ready()' is
+ * called from the DMA completion interrupt of the last one, LittlevGL drawing
+ * the next area in the other buffer in the meantime. */
 static void disp_flush( lv_disp_drv_t* disp_drv, const lv_area_t* area,
                         lv_color_t* color_p )
 {
-    /*The most simple case (but also the slowest) to put all pixels to the
-     * screen one-by-one*/
+    if( disp_is_frame_on_going == false )
+    {
+        disp_is_frame_on_going  = true;
+        disp_frame_start_cycles = system_time_get_cycles( );
+    }
+
+    disp_pending_flush.disp_drv = disp_drv;
+    disp_pending_flush.area     = *area;
+    disp_pending_flush.y2       = area->y2;
+    disp_pending_flush.color_p  = color_p;
+
+    disp_transaction.device  = display_get_spi_device( );
+    disp_transaction.start   = disp_flush_start;
+    disp_transaction.context = &disp_pending_flush;
+    system_spi_bus_submit( &disp_transaction );
+}
+
+/* Called by the SPI bus once the display is selected: the rows of the next
+ * segment are sent as they are in the buffer, high byte first as the ILI9341
+ * expects them, at least one row at a time */
+static void disp_flush_start( void* context )
+{
+    disp_flush_t*    flush = ( disp_flush_t* ) context;
+    const lv_coord_t rows =
+        LV_MATH_MAX( DISP_SEGMENT_PX / lv_area_get_width( &flush->area ), 1 );
 
-    int32_t x;
-    int32_t y;
+    disp_area_start_cycles = system_time_get_cycles( );
 
-    LL_GPIO_ResetOutputPin( DISPLAY_NSS_PORT, DISPLAY_NSS_PIN );
+    flush->area.y2 = LV_MATH_MIN( flush->area.y1 + rows - 1, flush->y2 );
 
     display_send_command( 0x2A );  // Set Column
-    display_send_data( area->x1 );
-    display_send_data( area->x2 );
+    display_send_data( flush->area.x1 );
+    display_send_data( flush->area.x2 );
 
     display_send_command( 0x2B );  // Set Page
-    display_send_data( area->y1 );
-    display_send_data( area->y2 );
+    display_send_data( flush->area.y1 );
+    display_send_data( flush->area.y2 );
 
     display_send_command( 0x2C );
 
-    for( y = area->y1; y <= area->y2; y++ )
+    /* 8-bit frames are restored by the SPI bus with the NSS rising edge */
+    system_spi_set_data_width( SPI1, LL_SPI_DATAWIDTH_16BIT );
+    system_spi_write_16bit_dma_with_callback(
+        SPI1, &flush->color_p->full, lv_area_get_size( &flush->area ),
+        disp_flush_done, context );
+}
+
+/* Called from the DMA completion interrupt, once a segment is sent: the bus is
+ * given back, to the LR11xx first if it is waiting for it, the next segment
+ * being queued behind it */
+static void disp_flush_done( void* context )
+{
+    disp_flush_t*  flush = ( disp_flush_t* ) context;
+    const uint32_t now   = system_time_get_cycles( );
+
+    disp_stats.time_us +=
+        system_time_cycles_to_us( now - disp_area_start_cycles );
+    disp_last_frame.time_us =
+        system_time_cycles_to_us( now - disp_frame_start_cycles );
+
+    system_spi_bus_end( );
+
+    if( flush->area.y2 < flush->y2 )
     {
-        for( x = area->x1; x <= area->x2; x++ )
-        {
-            /* Put a pixel to the display. For example: */
-            display_send_data( color_p->full );
-            color_p++;
-        }
+        flush->color_p += lv_area_get_size( &flush->area );
+        flush->area.y1 = flush->area.y2 + 1;
+        system_spi_bus_submit( &disp_transaction );
+        return;
     }
 
-    LL_GPIO_SetOutputPin( DISPLAY_NSS_PORT, DISPLAY_NSS_PIN );
-
     /* IMPORTANT!!!
      * Inform the graphics library that you are ready with the flushing*/
-    lv_disp_flush_ready( disp_drv );
+    lv_disp_flush_ready( flush->disp_drv );
+}
+
+/* Called at the end of a refresh, the last area being possibly still sent:
+ * it is not waited for, the LR11xx getting the bus once it is sent */
+static void disp_monitor( lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px )
+{
+    disp_last_frame.px     = px;
+    disp_is_frame_on_going = false;
+
+    disp_stats.refresh_count++;
+    disp_stats.px += px;
 }
 
 /*OPTIONAL: GPU INTERFACE*/
@@ -0,0 +1,411 @@
+/*!
+ * @file      lr11xx_simulator.h
+ *
+ * @brief     Simulated LR11xx chip for the host build header file
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_SIMULATOR_H
+#define LR11XX_SIMULATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "configuration.h"
+#include "lr11xx_firmware_image.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief Maximum number of simulated chips
+ */
+#define LR11XX_SIMULATOR_CHIP_COUNT_MAX ( 8 )
+
+/*!
+ * @brief Maximum number of firmware images a simulated chip is able to boot
+ */
+#define LR11XX_SIMULATOR_FIRMWARE_COUNT_MAX ( 4 )
+
+/*!
+ * @brief Size of the simulated flash, in word
+ */
+#define LR11XX_SIMULATOR_FLASH_SIZE_IN_WORD ( 65536 )
+
+/*!
+ * @brief Length of the flash hash returned by the LR1110 bootloader
+ */
+#define LR11XX_SIMULATOR_HASH_LENGTH ( 16 )
+
+/*!
+ * @brief Bootloader versions reported by the simulated chips
+ */
+#define LR11XX_SIMULATOR_BOOTLOADER_LR1110 ( 0x6500 )
+#define LR11XX_SIMULATOR_BOOTLOADER_LR1120 ( 0x2000 )
+#define LR11XX_SIMULATOR_BOOTLOADER_LR1121 ( 0x2100 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Kind of firmware a simulated chip runs once booted from flash
+ */
+typedef enum
+{
+    LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER,  //!< Transceiver firmware
+    LR11XX_SIMULATOR_FIRMWARE_MODEM_V1,     //!< LR1110 LoRa Basics Modem-E firmware
+    LR11XX_SIMULATOR_FIRMWARE_MODEM_V2,     //!< LR1121 LoRa Basics Modem firmware
+} lr11xx_simulator_firmware_type_t;
+
+/*!
+ * @brief Timing model of the MCU and of the simulated chips
+ *
+ * The MCU side only accounts for the time spent on the bus and on the GPIOs: SPI bytes, polled transfer gaps, DMA
+ * set-up and interrupt latencies. Everything else the application does is considered free.
+ */
+typedef struct
+{
+    uint32_t spi_clock_hz;                 //!< SPI clock frequency at the default prescaler, 80 MHz / 8 on the target
+    uint32_t spi_clock_max_hz;             //!< Fastest SPI clock read back reliably, 0 for no limit: MISO lags above
+    uint32_t spi_polled_byte_overhead_ns;  //!< CPU gap added to every byte of a polled transfer
+    uint32_t spi_call_overhead_ns;         //!< Cost of one polled transfer call
+    uint32_t spi_dma_setup_ns;             //!< Cost of programming one DMA transfer
+    uint32_t gpio_access_ns;               //!< Cost of one GPIO read or write
+    uint32_t irq_latency_ns;               //!< Latency between an interrupt and the wake-up of the CPU
+    uint32_t busy_rise_ns;                 //!< Delay between the NSS rising edge and the rise of BUSY
+    uint32_t command_busy_us;              //!< BUSY duration of a simple command
+    uint32_t erase_busy_ms;                //!< BUSY duration of the flash erase command
+    uint32_t erase_page_busy_ms;           //!< BUSY duration of the LR1110 flash page erase command
+    uint32_t write_busy_us;                //!< BUSY duration of one encrypted flash write command
+    uint32_t check_busy_us;                //!< BUSY duration of one image check command, no flash programming
+    uint32_t hash_busy_ms;                 //!< BUSY duration of the LR1110 flash hash command
+    uint32_t reset_busy_ms;                //!< BUSY duration after a reset
+    uint32_t reboot_busy_ms;               //!< BUSY duration after a reboot command
+    uint32_t modem_wakeup_us;              //!< Time needed by a modem firmware to wake up on NSS
+    uint32_t modem_response_us;            //!< Time needed by a modem firmware to prepare a response
+    uint32_t modem_sleep_us;               //!< Time a modem firmware stays awake after a response or a wake-up
+} lr11xx_simulator_timing_t;
+
+/*!
+ * @brief Counters maintained by a simulated chip
+ */
+typedef struct
+{
+    uint32_t frame_count;               //!< Number of SPI frames (NSS low to NSS high)
+    uint32_t byte_count;                //!< Number of bytes exchanged
+    uint32_t erase_count;               //!< Number of flash erase commands
+    uint32_t erase_reject_count;        //!< Number of flash erase commands failed on purpose, not counted above
+    uint32_t page_erase_count;          //!< Number of flash page erase commands
+    uint32_t write_count;               //!< Number of encrypted flash write commands
+    uint32_t write_byte_count;          //!< Number of bytes written to flash
+    uint32_t write_reject_count;        //!< Number of encrypted flash writes failed on purpose, not counted above
+    uint32_t check_count;               //!< Number of image check commands
+    uint32_t corrupted_response_count;  //!< Number of transceiver firmware responses damaged on purpose
+    uint32_t corrupted_command_count;   //!< Number of transceiver firmware read commands damaged on purpose
+    uint32_t busy_violation_count;      //!< Number of frames started while BUSY was high
+    uint32_t error_count;               //!< Number of protocol errors (bad length, write to non-erased flash, ...)
+    uint64_t busy_time_ns;              //!< Cumulated time spent with BUSY high on commands
+} lr11xx_simulator_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Reset the simulator: clear the virtual clock and detach all chips
+ *
+ * @param [in] timing Timing model to use, NULL for the default one
+ */
+void lr11xx_simulator_init( const lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Get the default timing model
+ *
+ * @param [out] timing Default timing model
+ */
+void lr11xx_simulator_get_default_timing( lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Get the timing model in use
+ *
+ * @returns Pointer to the timing model in use
+ */
+const lr11xx_simulator_timing_t* lr11xx_simulator_get_timing( void );
+
+/*!
+ * @brief Attach a simulated chip to the pins of a radio
+ *
+ * The chip starts in bootloader mode with an erased flash.
+ *
+ * @param [in] radio Radio the chip is wired to
+ * @param [in] bootloader_version Bootloader version reported by the chip
+ *
+ * @returns Index of the chip, -1 if no more chip can be attached
+ */
+int32_t lr11xx_simulator_attach( const radio_t* radio, uint16_t bootloader_version );
+
+/*!
+ * @brief Insert or remove the module carrying a chip, its pins staying wired to the MCU
+ *
+ * A removed chip ignores its pins and the bus: the MCU reads BUSY low and MISO high. Once inserted again, the chip
+ * powers up and boots, in bootloader mode if the MCU holds BUSY low. Several chips wired to the same pins stand for
+ * modules inserted one after the other.
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] is_present True to insert the module, false to remove it
+ */
+void lr11xx_simulator_set_present( int32_t chip, bool is_present );
+
+/*!
+ * @brief Declare a firmware image the chip is able to boot
+ *
+ * On boot, the chip runs the firmware whose image matches the content of its flash, and stays in bootloader mode if
+ * none does.
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] type Kind of firmware
+ * @param [in] version Version the firmware reports, as expected by lr11xx_update_firmware
+ * @param [in] image Firmware image, as stored in the image header files, in either byte order
+ */
+void lr11xx_simulator_add_firmware( int32_t chip, lr11xx_simulator_firmware_type_t type, uint32_t version,
+                                    const lr11xx_firmware_image_t* image );
+
+/*!
+ * @brief Program the flash of a chip with one of its firmware images, as left by a previous update
+ *
+ * The chip runs the firmware from its next reset on.
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] firmware Index of the firmware, in the order of the lr11xx_simulator_add_firmware calls
+ */
+void lr11xx_simulator_flash_firmware( int32_t chip, uint8_t firmware );
+
+/*!
+ * @brief Have one encrypted flash write of a chip reach the flash with one bit flipped, the command being accepted
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] write_index Write to damage, counted from 1 as the write_count counter, 0 for none
+ */
+void lr11xx_simulator_corrupt_write( int32_t chip, uint32_t write_index );
+
+/*!
+ * @brief Have encrypted flash writes of a chip fail, the bootloader reporting CMD_FAIL and leaving the flash untouched
+ *
+ * The writes are counted from 1 in the order the chip receives them, the failed ones included: a block failing once
+ * then written again takes two writes.
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] write_index First write to fail, 0 for none
+ * @param [in] count Number of writes to fail from write_index on
+ */
+void lr11xx_simulator_reject_write( int32_t chip, uint32_t write_index, uint32_t count );
+
+/*!
+ * @brief Have the next flash erases of a chip fail, the bootloader reporting CMD_FAIL and leaving the flash untouched
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] count Number of erases to fail
+ */
+void lr11xx_simulator_reject_erase( int32_t chip, uint32_t count );
+
+/*!
+ * @brief Have the next responses of the transceiver firmware of a chip reach the MCU with one bit flipped
+ *
+ * The bit is flipped on the line, after the chip has computed the SPI CRC of the response, if enabled. The bootloader
+ * responses are left intact: it has no SPI CRC to detect the damage.
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] count Number of responses to damage
+ */
+void lr11xx_simulator_corrupt_responses( int32_t chip, uint32_t count );
+
+/*!
+ * @brief Have the next read commands sent to the transceiver firmware of a chip reach it with one bit flipped
+ *
+ * The bit is flipped on the line, after the MCU has computed the SPI CRC of the command. With the SPI CRC enabled, the
+ * chip drops the command, reports a CRC error in stat1 and has no response to send; otherwise the command is left
+ * intact. Only the commands answered with data are damaged: the HAL has no way to send a write again.
+ *
+ * @param [in] chip Index of the chip
+ * @param [in] count Number of read commands to damage
+ */
+void lr11xx_simulator_corrupt_commands( int32_t chip, uint32_t count );
+
+/*!
+ * @brief Compute the flash hash an LR1110 chip reports once an image is written
+ *
+ * The digest is specific to the simulator, the algorithm of the bootloader not being public.
+ *
+ * @param [in] image Firmware image, in either byte order
+ * @param [out] hash Flash hash
+ */
+void lr11xx_simulator_get_image_hash( const lr11xx_firmware_image_t* image,
+                                      uint8_t                        hash[LR11XX_SIMULATOR_HASH_LENGTH] );
+
+/*!
+ * @brief Get the counters of a chip
+ *
+ * @param [in] chip Index of the chip
+ * @param [out] stats Counters of the chip
+ */
+void lr11xx_simulator_get_stats( int32_t chip, lr11xx_simulator_stats_t* stats );
+
+/*!
+ * @brief Check whether a chip currently runs a firmware booted from flash
+ *
+ * @param [in] chip Index of the chip
+ * @param [out] version Version of the running firmware, can be NULL
+ *
+ * @returns True if a firmware is running, false if the chip is in bootloader mode
+ */
+bool lr11xx_simulator_is_firmware_running( int32_t chip, uint32_t* version );
+
+/*!
+ * @brief Get the virtual time
+ *
+ * @returns Virtual time in ns
+ */
+uint64_t lr11xx_simulator_get_time_ns( void );
+
+/*!
+ * @brief Advance the virtual time
+ *
+ * @param [in] duration_ns Duration to add, in ns
+ */
+void lr11xx_simulator_advance_ns( uint64_t duration_ns );
+
+/*!
+ * @brief Get the duration of one byte on the SPI bus
+ *
+ * @returns Duration of one byte, in ns
+ */
+uint32_t lr11xx_simulator_get_spi_byte_ns( void );
+
+/*!
+ * @brief Set the SPI clock the MCU drives the bus with
+ *
+ * Above spi_clock_max_hz of the timing model, the bytes read back from the chips lag one bit, as with a MISO line too
+ * slow for the clock: the commands still reach the chips intact.
+ *
+ * @param [in] spi_clock_hz SPI clock frequency, in Hz
+ */
+void lr11xx_simulator_set_spi_clock( uint32_t spi_clock_hz );
+
+/*!
+ * @brief Notify a GPIO output change to the chips
+ *
+ * @param [in] gpio Pin driven by the MCU
+ * @param [in] is_high Level driven on the pin
+ */
+void lr11xx_simulator_set_pin( gpio_t gpio, bool is_high );
+
+/*!
+ * @brief Notify a GPIO direction change to the chips
+ *
+ * A BUSY pin driven by the MCU during a reset makes the chip stay in bootloader mode.
+ *
+ * @param [in] gpio Pin
+ * @param [in] is_output True if the MCU drives the pin
+ * @param [in] is_high Level driven on the pin, if any
+ */
+void lr11xx_simulator_set_pin_direction( gpio_t gpio, bool is_output, bool is_high );
+
+/*!
+ * @brief Check whether a pin is driven by a simulated chip
+ *
+ * @param [in] gpio Pin
+ *
+ * @returns True if the pin is the BUSY or the IRQ line of a chip
+ */
+bool lr11xx_simulator_is_chip_pin( gpio_t gpio );
+
+/*!
+ * @brief Get the level of a pin driven by a simulated chip, at the current virtual time
+ *
+ * @param [in] gpio Pin
+ *
+ * @returns True if the pin is high
+ */
+bool lr11xx_simulator_get_pin( gpio_t gpio );
+
+/*!
+ * @brief Get the first time, from now on, a pin driven by a simulated chip is at a given level
+ *
+ * @param [in] gpio Pin
+ * @param [in] is_high Level to wait for
+ *
+ * @returns Virtual time in ns, UINT64_MAX if the pin never reaches the level
+ */
+uint64_t lr11xx_simulator_get_pin_edge_ns( gpio_t gpio, bool is_high );
+
+/*!
+ * @brief Exchange one byte with the chip selected on a bus
+ *
+ * @param [in] spi Bus
+ * @param [in] mosi Byte sent by the MCU
+ *
+ * @returns Byte sent back by the selected chip, 0xFF if no chip is selected
+ */
+uint8_t lr11xx_simulator_spi_exchange( SPI_TypeDef* spi, uint8_t mosi );
+
+/*!
+ * @brief Report a misuse of the bus detected by the host system layer on the chip selected on a bus
+ *
+ * @param [in] spi Bus
+ * @param [in] reason Short description of the misuse
+ */
+void lr11xx_simulator_report_error( SPI_TypeDef* spi, const char* reason );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LR11XX_SIMULATOR_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,146 @@
+/*!
+ * @file      lr11xx_uart_stream_host.h
+ *
+ * @brief     Host side of the LR11XX UART image streaming, for the host build
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_UART_STREAM_HOST_H
+#define LR11XX_UART_STREAM_HOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lr11xx_firmware_image.h"
+#include "lr11xx_firmware_update.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Counters maintained by the simulated host
+ */
+typedef struct
+{
+    uint32_t data_frame_count;  //!< Number of DATA frames sent, retransmissions included
+    uint32_t corrupted_count;   //!< Number of DATA frames corrupted on purpose
+    uint32_t nak_count;         //!< Number of NAK frames received
+    uint32_t ack_count;         //!< Number of ACK frames received
+    bool     is_done;           //!< True once the DONE frame is received
+    uint8_t  done_status;       //!< Status carried by the DONE frame
+} lr11xx_uart_stream_host_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Start streaming an image to the simulated MCU, as tools/lr11xx_uart_stream.py does to the board
+ *
+ * @param [in] image Image to stream
+ * @param [in] update Type of firmware
+ * @param [in] fw_expected Version reported by the firmware once flashed
+ * @param [in] corrupt_period Corrupt one DATA frame out of this number, 0 to never corrupt any
+ */
+void lr11xx_uart_stream_host_init( const lr11xx_firmware_image_t* image, lr11xx_fw_update_t update,
+                                   uint32_t fw_expected, uint32_t corrupt_period );
+
+/*!
+ * @brief Check whether a stream was started
+ *
+ * @returns True if lr11xx_uart_stream_host_init was called
+ */
+bool lr11xx_uart_stream_host_is_active( void );
+
+/*!
+ * @brief Get the duration of one byte on the UART
+ *
+ * @returns Duration of a byte in ns
+ */
+uint32_t lr11xx_uart_stream_host_get_byte_ns( void );
+
+/*!
+ * @brief Handle a byte sent by the MCU - frames are decoded, anything else is printed as console output
+ *
+ * @param [in] data Byte sent
+ * @param [in] now_ns Virtual time at which the byte is fully sent
+ */
+void lr11xx_uart_stream_host_on_tx( uint8_t data, uint64_t now_ns );
+
+/*!
+ * @brief Get the virtual time at which the next byte sent by the host is fully received by the MCU
+ *
+ * @returns Virtual time in ns, UINT64_MAX if the host has nothing to send
+ */
+uint64_t lr11xx_uart_stream_host_get_next_rx_ns( void );
+
+/*!
+ * @brief Take the next byte sent by the host
+ *
+ * @returns Byte received by the MCU
+ */
+uint8_t lr11xx_uart_stream_host_pop_rx( void );
+
+/*!
+ * @brief Get the counters of the simulated host
+ *
+ * @param [out] stats Counters
+ */
+void lr11xx_uart_stream_host_get_stats( lr11xx_uart_stream_host_stats_t* stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LR11XX_UART_STREAM_HOST_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,114 @@
+/*!
+ * @file      stm32l476xx.h
+ *
+ * @brief     Host stand-in for the STM32L476xx CMSIS device header
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STM32L476XX_H
+#define STM32L476XX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief Peripheral instances
+ *
+ * The host build only uses them as identifiers: they keep the addresses of the real device so that a pin or a bus can
+ * be compared the same way on both builds, but they are never dereferenced.
+ */
+#define GPIOA ( ( GPIO_TypeDef* ) 0x48000000UL )
+#define GPIOB ( ( GPIO_TypeDef* ) 0x48000400UL )
+#define GPIOC ( ( GPIO_TypeDef* ) 0x48000800UL )
+#define GPIOD ( ( GPIO_TypeDef* ) 0x48000C00UL )
+#define GPIOH ( ( GPIO_TypeDef* ) 0x48001C00UL )
+
+#define SPI1 ( ( SPI_TypeDef* ) 0x40013000UL )
+#define SPI2 ( ( SPI_TypeDef* ) 0x40003800UL )
+#define SPI3 ( ( SPI_TypeDef* ) 0x40003C00UL )
+
+#define USART2 ( ( USART_TypeDef* ) 0x40004400UL )
+
+/*!
+ * @brief Interrupt masking, with nothing to mask: the host build has no interrupt
+ */
+#define __disable_irq( )
+#define __enable_irq( )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+typedef struct
+{
+    uint32_t reserved;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    uint32_t reserved;
+} SPI_TypeDef;
+
+typedef struct
+{
+    uint32_t reserved;
+} USART_TypeDef;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // STM32L476XX_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,77 @@
+/*!
+ * @file      stm32l4xx_ll_gpio.h
+ *
+ * @brief     Host stand-in for the STM32L4xx LL GPIO driver header
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STM32L4XX_LL_GPIO_H
+#define STM32L4XX_LL_GPIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "stm32l476xx.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+#define LL_GPIO_PIN_0 ( 0x00000001UL )
+#define LL_GPIO_PIN_1 ( 0x00000002UL )
+#define LL_GPIO_PIN_2 ( 0x00000004UL )
+#define LL_GPIO_PIN_3 ( 0x00000008UL )
+#define LL_GPIO_PIN_4 ( 0x00000010UL )
+#define LL_GPIO_PIN_5 ( 0x00000020UL )
+#define LL_GPIO_PIN_6 ( 0x00000040UL )
+#define LL_GPIO_PIN_7 ( 0x00000080UL )
+#define LL_GPIO_PIN_8 ( 0x00000100UL )
+#define LL_GPIO_PIN_9 ( 0x00000200UL )
+#define LL_GPIO_PIN_10 ( 0x00000400UL )
+#define LL_GPIO_PIN_11 ( 0x00000800UL )
+#define LL_GPIO_PIN_12 ( 0x00001000UL )
+#define LL_GPIO_PIN_13 ( 0x00002000UL )
+#define LL_GPIO_PIN_14 ( 0x00004000UL )
+#define LL_GPIO_PIN_15 ( 0x00008000UL )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // STM32L4XX_LL_GPIO_H
+
+/* --- EOF ------------------------------------------------------------------ */
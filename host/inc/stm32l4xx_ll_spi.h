@@ -0,0 +1,80 @@
+/*!
+ * @file      stm32l4xx_ll_spi.h
+ *
+ * @brief     Host stand-in for the STM32L4xx LL SPI driver header
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STM32L4XX_LL_SPI_H
+#define STM32L4XX_LL_SPI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "stm32l476xx.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * @brief Baud rate prescalers, with the CR1 BR field values of the real device
+ */
+#define SPI_CR1_BR_Pos ( 3U )
+
+#define LL_SPI_BAUDRATEPRESCALER_DIV2 ( 0x00000000UL )
+#define LL_SPI_BAUDRATEPRESCALER_DIV4 ( 0x00000008UL )
+#define LL_SPI_BAUDRATEPRESCALER_DIV8 ( 0x00000010UL )
+#define LL_SPI_BAUDRATEPRESCALER_DIV16 ( 0x00000018UL )
+#define LL_SPI_BAUDRATEPRESCALER_DIV32 ( 0x00000020UL )
+#define LL_SPI_BAUDRATEPRESCALER_DIV64 ( 0x00000028UL )
+#define LL_SPI_BAUDRATEPRESCALER_DIV128 ( 0x00000030UL )
+#define LL_SPI_BAUDRATEPRESCALER_DIV256 ( 0x00000038UL )
+
+/*!
+ * @brief Frame sizes, with the CR2 DS field values of the real device
+ */
+#define LL_SPI_DATAWIDTH_8BIT ( 0x00000700UL )
+#define LL_SPI_DATAWIDTH_16BIT ( 0x00000F00UL )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // STM32L4XX_LL_SPI_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,439 @@
+/*!
+ * @file      lr11xx_firmware_gang_bench.c
+ *
+ * @brief     Host benchmark of the gang update against several simulated chips
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+/* dup, dup2 */
+#define _POSIX_C_SOURCE 200809L
+
+#include IMAGE_HEADER_FILE
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "configuration.h"
+#include "system.h"
+#include "lr11xx_firmware_update.h"
+#include "lr11xx_simulator.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Chips of the faulty fixture: one failing a few writes, one failing an erase, one failing every write
+ */
+#define LR11XX_FIRMWARE_GANG_BENCH_FAULTY_CHIP_COUNT ( 4 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*!
+ * @brief Outcome of the update of a gang
+ */
+typedef struct
+{
+    lr11xx_fw_update_timing_t timing;    //!< Duration of the update phases
+    bool                      is_clean;  //!< Every chip updated, without BUSY violation nor protocol error
+} lr11xx_firmware_gang_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief Chips of the fixture, sharing SPI1 with their own NSS, NRESET, IRQ and BUSY lines
+ */
+static radio_t lr11xx_firmware_gang_bench_radios[LR11XX_FW_GANG_TARGET_COUNT_MAX];
+
+static const lr11xx_fw_bundle_entry_t lr11xx_firmware_gang_bench_entry = {
+    .update      = LR11XX_FIRMWARE_UPDATE_TO,
+    .fw_expected = LR11XX_FIRMWARE_VERSION,
+    .image =
+        {
+            .words          = lr11xx_firmware_image,
+            .length_in_word = sizeof( lr11xx_firmware_image ) / sizeof( lr11xx_firmware_image[0] ),
+            .format         = LR11XX_FIRMWARE_IMAGE_FORMAT,
+        },
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static bool lr11xx_firmware_gang_bench_parse_arguments( int argc, char** argv, lr11xx_simulator_timing_t* timing,
+                                                        bool* is_verbose );
+
+/*!
+ * @brief Attach blank chips to the fixture, able to boot the image under test
+ *
+ * @param [in] timing Timing of the simulated chips
+ * @param [in] chip_count Number of chips
+ */
+static void lr11xx_firmware_gang_bench_attach( const lr11xx_simulator_timing_t* timing, uint8_t chip_count );
+
+/*!
+ * @brief Check that every chip runs the image under test, without BUSY violation nor protocol error
+ *
+ * @param [in] chip_count Number of chips
+ *
+ * @returns True if every chip is clean
+ */
+static bool lr11xx_firmware_gang_bench_check( uint8_t chip_count );
+
+/*!
+ * @brief Update a gang of blank chips
+ *
+ * @param [in] timing Timing of the simulated chips
+ * @param [in] chip_count Number of chips, 0 to update a single chip with lr11xx_update_firmware instead
+ * @param [in] is_verbose True to keep the update log
+ * @param [out] result Outcome of the update
+ */
+static void lr11xx_firmware_gang_bench_run( const lr11xx_simulator_timing_t* timing, uint8_t chip_count,
+                                            bool is_verbose, lr11xx_firmware_gang_bench_result_t* result );
+
+/*!
+ * @brief Update a gang whose chips fail some commands, checking that only the faulty chip is dropped
+ *
+ * @param [in] timing Timing of the simulated chips
+ * @param [in] is_verbose True to keep the update log
+ *
+ * @returns True if the failed commands were sent again and the chip failing every write dropped
+ */
+static bool lr11xx_firmware_gang_bench_run_faulty( const lr11xx_simulator_timing_t* timing, bool is_verbose );
+
+/*!
+ * @brief Hide the update log unless verbose
+ *
+ * @param [in] is_verbose True to keep the update log
+ *
+ * @returns Saved standard output, to give to lr11xx_firmware_gang_bench_unmute, -1 if verbose
+ */
+static int lr11xx_firmware_gang_bench_mute( bool is_verbose );
+
+/*!
+ * @brief Restore the standard output hidden by lr11xx_firmware_gang_bench_mute
+ *
+ * @param [in] saved_stdout Saved standard output
+ */
+static void lr11xx_firmware_gang_bench_unmute( int saved_stdout );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    lr11xx_simulator_timing_t           timing;
+    lr11xx_firmware_gang_bench_result_t result;
+    bool                                is_verbose = false;
+    int                                 status     = EXIT_SUCCESS;
+
+    lr11xx_simulator_get_default_timing( &timing );
+    if( lr11xx_firmware_gang_bench_parse_arguments( argc, argv, &timing, &is_verbose ) == false )
+    {
+        printf( "Usage: %s [-s spi_clock_hz] [-w write_busy_us] [-v is_verbose]\n", argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    for( uint8_t index = 0; index < LR11XX_FW_GANG_TARGET_COUNT_MAX; index++ )
+    {
+        lr11xx_firmware_gang_bench_radios[index] = ( radio_t ){
+            { SPI1, { GPIOC, LL_GPIO_PIN_0 << index }, LR11XX_SPI_PRESCALER, LL_SPI_DATAWIDTH_8BIT, false },
+            { GPIOD, LL_GPIO_PIN_0 << index },
+            { GPIOH, LL_GPIO_PIN_8 << index },
+            { GPIOH, LL_GPIO_PIN_0 << index },
+        };
+    }
+
+    printf( "Gang update of %s (%u bytes), SPI at %u Hz, %u us per block write\n", IMAGE_HEADER_FILE,
+            ( unsigned int ) sizeof( lr11xx_firmware_image ), timing.spi_clock_hz, timing.write_busy_us );
+
+    /* Sequential updates are the reference: one chip after the other, each with lr11xx_update_firmware */
+    lr11xx_firmware_gang_bench_run( &timing, 0, is_verbose, &result );
+
+    const double single_ms = result.timing.total_us / 1000.0;
+
+    printf( "Single-chip update: %.0f ms, %.0f units/hour%s\n", single_ms, 3600000.0 / single_ms,
+            ( result.is_clean == true ) ? "" : "  FAILED" );
+    status = ( result.is_clean == true ) ? status : EXIT_FAILURE;
+
+    printf( "%6s %10s %10s %9s %11s %9s %11s\n", "Chips", "Update ms", "Write ms", "Bus use", "Units/hour",
+            "Speed-up", "Efficiency" );
+
+    for( uint8_t chip_count = 1; chip_count <= LR11XX_FW_GANG_TARGET_COUNT_MAX; chip_count++ )
+    {
+        lr11xx_firmware_gang_bench_run( &timing, chip_count, is_verbose, &result );
+
+        const double total_ms = result.timing.total_us / 1000.0;
+        const double speed_up = ( chip_count * single_ms ) / total_ms;
+
+        printf( "%6u %10.0f %10.0f %8.1f%% %11.0f %8.2fx %10.1f%%%s\n", chip_count, total_ms,
+                result.timing.write_us / 1000.0,
+                ( result.timing.write_us != 0 ) ? ( 100.0 * result.timing.write_spi_us ) / result.timing.write_us : 0,
+                ( chip_count * 3600000.0 ) / total_ms, speed_up, ( 100.0 * speed_up ) / chip_count,
+                ( result.is_clean == true ) ? "" : "  FAILED" );
+
+        status = ( result.is_clean == true ) ? status : EXIT_FAILURE;
+    }
+
+    const bool is_faulty_passed = lr11xx_firmware_gang_bench_run_faulty( &timing, is_verbose );
+
+    printf( "Faulty fixture: %s\n", ( is_faulty_passed == true ) ? "OK" : "FAILED" );
+    status = ( is_faulty_passed == true ) ? status : EXIT_FAILURE;
+
+    return status;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void lr11xx_firmware_gang_bench_attach( const lr11xx_simulator_timing_t* timing, uint8_t chip_count )
+{
+    lr11xx_simulator_firmware_type_t firmware_type      = LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER;
+    uint16_t                         bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1110;
+
+    switch( LR11XX_FIRMWARE_UPDATE_TO )
+    {
+    case LR1110_FIRMWARE_UPDATE_TO_TRX:
+        break;
+    case LR1110_FIRMWARE_UPDATE_TO_MODEM_V1:
+        firmware_type = LR11XX_SIMULATOR_FIRMWARE_MODEM_V1;
+        break;
+    case LR1120_FIRMWARE_UPDATE_TO_TRX:
+        bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1120;
+        break;
+    case LR1121_FIRMWARE_UPDATE_TO_TRX:
+        bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1121;
+        break;
+    case LR1121_FIRMWARE_UPDATE_TO_MODEM_V2:
+        firmware_type      = LR11XX_SIMULATOR_FIRMWARE_MODEM_V2;
+        bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1121;
+        break;
+    }
+
+    lr11xx_simulator_init( timing );
+    for( uint8_t index = 0; index < chip_count; index++ )
+    {
+        const int32_t chip = lr11xx_simulator_attach( &lr11xx_firmware_gang_bench_radios[index], bootloader_version );
+
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION,
+                                       &lr11xx_firmware_gang_bench_entry.image );
+    }
+
+    system_init( );
+}
+
+static bool lr11xx_firmware_gang_bench_check( uint8_t chip_count )
+{
+    for( uint8_t index = 0; index < chip_count; index++ )
+    {
+        lr11xx_simulator_stats_t stats;
+        uint32_t                 version = 0;
+
+        lr11xx_simulator_get_stats( index, &stats );
+        if( ( stats.busy_violation_count != 0 ) || ( stats.error_count != 0 ) ||
+            ( lr11xx_simulator_is_firmware_running( index, &version ) == false ) ||
+            ( version != LR11XX_FIRMWARE_VERSION ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void lr11xx_firmware_gang_bench_run( const lr11xx_simulator_timing_t* timing, uint8_t chip_count,
+                                            bool is_verbose, lr11xx_firmware_gang_bench_result_t* result )
+{
+    lr11xx_fw_gang_target_t targets[LR11XX_FW_GANG_TARGET_COUNT_MAX];
+    bool                    is_updated;
+
+    lr11xx_firmware_gang_bench_attach( timing, ( chip_count != 0 ) ? chip_count : 1 );
+
+    /* The update log of each run would bury the table */
+    const int saved_stdout = lr11xx_firmware_gang_bench_mute( is_verbose );
+
+    if( chip_count == 0 )
+    {
+        is_updated = lr11xx_update_firmware( &lr11xx_firmware_gang_bench_radios[0], LR11XX_FIRMWARE_UPDATE_TO,
+                                             LR11XX_FIRMWARE_VERSION, &lr11xx_firmware_gang_bench_entry.image,
+                                             &result->timing ) == LR11XX_FW_UPDATE_OK;
+    }
+    else
+    {
+        for( uint8_t index = 0; index < chip_count; index++ )
+        {
+            targets[index].radio = &lr11xx_firmware_gang_bench_radios[index];
+        }
+
+        /* The reference CRC is the one of the image itself: the bench is about the bus, not the image */
+        lr11xx_fw_bundle_entry_t entry = lr11xx_firmware_gang_bench_entry;
+
+        lr11xx_firmware_image_get_crc( &entry.image, &entry.crc );
+        is_updated = lr11xx_update_firmware_gang( targets, chip_count, &entry, 1, LR11XX_FW_BUNDLE_KIND_ANY,
+                                                  &result->timing ) == chip_count;
+    }
+
+    lr11xx_firmware_gang_bench_unmute( saved_stdout );
+
+    result->is_clean = is_updated && lr11xx_firmware_gang_bench_check( ( chip_count != 0 ) ? chip_count : 1 );
+}
+
+static bool lr11xx_firmware_gang_bench_run_faulty( const lr11xx_simulator_timing_t* timing, bool is_verbose )
+{
+    lr11xx_fw_gang_target_t   targets[LR11XX_FIRMWARE_GANG_BENCH_FAULTY_CHIP_COUNT];
+    lr11xx_fw_update_timing_t update_timing;
+    lr11xx_fw_bundle_entry_t  entry = lr11xx_firmware_gang_bench_entry;
+    bool                      is_passed;
+
+    lr11xx_firmware_gang_bench_attach( timing, LR11XX_FIRMWARE_GANG_BENCH_FAULTY_CHIP_COUNT );
+    lr11xx_simulator_reject_write( 1, 5, 2 );
+    lr11xx_simulator_reject_erase( 2, 1 );
+    lr11xx_simulator_reject_write( 3, 10, UINT32_MAX );
+
+    for( uint8_t index = 0; index < LR11XX_FIRMWARE_GANG_BENCH_FAULTY_CHIP_COUNT; index++ )
+    {
+        targets[index].radio = &lr11xx_firmware_gang_bench_radios[index];
+    }
+    lr11xx_firmware_image_get_crc( &entry.image, &entry.crc );
+
+    const int      saved_stdout = lr11xx_firmware_gang_bench_mute( is_verbose );
+    const uint32_t updated      = lr11xx_update_firmware_gang( targets, LR11XX_FIRMWARE_GANG_BENCH_FAULTY_CHIP_COUNT,
+                                                               &entry, 1, LR11XX_FW_BUNDLE_KIND_ANY, &update_timing );
+    lr11xx_firmware_gang_bench_unmute( saved_stdout );
+
+    /* The chip failing every write gives up after its retries, the others end up clean */
+    is_passed = ( updated == ( LR11XX_FIRMWARE_GANG_BENCH_FAULTY_CHIP_COUNT - 1 ) ) &&
+                ( lr11xx_firmware_gang_bench_check( LR11XX_FIRMWARE_GANG_BENCH_FAULTY_CHIP_COUNT - 1 ) == true ) &&
+                ( targets[3].status == LR11XX_FW_UPDATE_ERROR ) &&
+                ( lr11xx_simulator_is_firmware_running( 3, NULL ) == false ) &&
+                ( update_timing.erase_retry_count == 1 ) &&
+                ( update_timing.block_retry_count == ( 2 + LR11XX_FW_UPDATE_RETRY_COUNT_MAX ) );
+
+    return is_passed;
+}
+
+static int lr11xx_firmware_gang_bench_mute( bool is_verbose )
+{
+    int saved_stdout = -1;
+
+    fflush( stdout );
+    if( is_verbose == false )
+    {
+        const int null_fd = open( "/dev/null", O_WRONLY );
+
+        saved_stdout = dup( STDOUT_FILENO );
+        dup2( null_fd, STDOUT_FILENO );
+        close( null_fd );
+    }
+
+    return saved_stdout;
+}
+
+static void lr11xx_firmware_gang_bench_unmute( int saved_stdout )
+{
+    fflush( stdout );
+    if( saved_stdout >= 0 )
+    {
+        dup2( saved_stdout, STDOUT_FILENO );
+        close( saved_stdout );
+    }
+}
+
+static bool lr11xx_firmware_gang_bench_parse_arguments( int argc, char** argv, lr11xx_simulator_timing_t* timing,
+                                                        bool* is_verbose )
+{
+    for( int i = 1; i < argc; i++ )
+    {
+        uint32_t value;
+        char*    end;
+
+        if( ( strlen( argv[i] ) != 2 ) || ( argv[i][0] != '-' ) || ( ( i + 1 ) >= argc ) )
+        {
+            return false;
+        }
+
+        value = ( uint32_t ) strtoul( argv[i + 1], &end, 0 );
+        if( *end != '\0' )
+        {
+            return false;
+        }
+
+        switch( argv[i][1] )
+        {
+        case 's':
+            if( value == 0 )
+            {
+                return false;
+            }
+            timing->spi_clock_hz = value;
+            break;
+        case 'w':
+            timing->write_busy_us = value;
+            break;
+        case 'v':
+            *is_verbose = ( value != 0 );
+            break;
+        default:
+            return false;
+        }
+
+        i++;
+    }
+
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,299 @@
+/*!
+ * @file      lr11xx_firmware_lz_bench.c
+ *
+ * @brief     Host benchmark of the compressed firmware image decoder
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+/* clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lr11xx_firmware_image.h"
+#include "lr11xx_firmware_lz.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Number of times each image is decoded, the fastest pass is kept
+ */
+#define LR11XX_FIRMWARE_LZ_BENCH_PASS_COUNT ( 20 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*!
+ * @brief Outcome of the decoding of one image
+ */
+typedef struct
+{
+    uint32_t image_length;  //!< Decoded length in byte
+    uint32_t block_count;   //!< Number of blocks
+    uint64_t total_ns;      //!< Decoding time of the fastest pass
+    uint64_t block_max_ns;  //!< Slowest block of the fastest pass
+    bool     is_crc_ok;     //!< CRC-32 of the decoded image matches the one of the container
+} lr11xx_firmware_lz_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Read a whole file
+ *
+ * @param [in] path Path of the file
+ * @param [out] length Length of the file in byte
+ *
+ * @returns Content of the file to be freed, NULL on error
+ */
+static uint8_t* lr11xx_firmware_lz_bench_read_file( const char* path, uint32_t* length );
+
+/*!
+ * @brief Decode a container block per block, the way the flash write requests them
+ *
+ * @param [in] container Compressed image
+ * @param [in] container_length Length of the compressed image in byte
+ * @param [out] result Decoding time and CRC of the fastest pass
+ *
+ * @returns True if the container decoded without error
+ */
+static bool lr11xx_firmware_lz_bench_run( const uint8_t* container, uint32_t container_length,
+                                          lr11xx_firmware_lz_bench_result_t* result );
+
+/*!
+ * @brief Get the monotonic time
+ *
+ * @returns Time in ns
+ */
+static uint64_t lr11xx_firmware_lz_bench_get_ns( void );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    uint64_t image_total     = 0;
+    uint64_t container_total = 0;
+    int      status          = EXIT_SUCCESS;
+
+    if( argc < 2 )
+    {
+        printf( "Usage: %s <container>...\n", argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    printf( "%-32s %10s %10s %7s %12s %12s\n", "Image", "Bytes", "Compressed", "Ratio", "ns/block", "Max ns/block" );
+
+    for( int i = 1; i < argc; i++ )
+    {
+        lr11xx_firmware_lz_bench_result_t result;
+        uint32_t                          container_length;
+        uint8_t* container = lr11xx_firmware_lz_bench_read_file( argv[i], &container_length );
+        const char* name   = ( strrchr( argv[i], '/' ) != NULL ) ? strrchr( argv[i], '/' ) + 1 : argv[i];
+
+        if( ( container == NULL ) || ( lr11xx_firmware_lz_bench_run( container, container_length, &result ) == false ) )
+        {
+            printf( "%-32s decoding failed\n", name );
+            status = EXIT_FAILURE;
+            free( container );
+            continue;
+        }
+
+        printf( "%-32s %10u %10u %7.3f %12.0f %12u%s\n", name, result.image_length, container_length,
+                ( double ) container_length / result.image_length, ( double ) result.total_ns / result.block_count,
+                ( unsigned int ) result.block_max_ns, ( result.is_crc_ok == true ) ? "" : "  CRC MISMATCH" );
+
+        if( result.is_crc_ok == false )
+        {
+            status = EXIT_FAILURE;
+        }
+
+        image_total += result.image_length;
+        container_total += container_length;
+        free( container );
+    }
+
+    if( image_total != 0 )
+    {
+        printf( "Overall ratio %.3f: %.1f LR1110 images fit in 1 MB, against %.1f uncompressed\n",
+                ( double ) container_total / image_total,
+                ( 1024.0 * 1024.0 * image_total ) / ( 245280.0 * container_total ), ( 1024.0 * 1024.0 ) / 245280.0 );
+    }
+
+    return status;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint8_t* lr11xx_firmware_lz_bench_read_file( const char* path, uint32_t* length )
+{
+    FILE*    file = fopen( path, "rb" );
+    uint8_t* data = NULL;
+    long     size;
+
+    if( file == NULL )
+    {
+        return NULL;
+    }
+
+    if( ( fseek( file, 0, SEEK_END ) == 0 ) && ( ( size = ftell( file ) ) > 0 ) && ( fseek( file, 0, SEEK_SET ) == 0 ) )
+    {
+        data = malloc( ( size_t ) size );
+        if( ( data != NULL ) && ( fread( data, 1, ( size_t ) size, file ) != ( size_t ) size ) )
+        {
+            free( data );
+            data = NULL;
+        }
+        *length = ( uint32_t ) size;
+    }
+
+    fclose( file );
+
+    return data;
+}
+
+static bool lr11xx_firmware_lz_bench_run( const uint8_t* container, uint32_t container_length,
+                                          lr11xx_firmware_lz_bench_result_t* result )
+{
+    static lr11xx_firmware_lz_t lz;
+    lr11xx_firmware_image_t     image;
+    uint32_t*                   decoded = NULL;
+
+    memset( result, 0, sizeof( *result ) );
+    result->total_ns = UINT64_MAX;
+
+    for( uint32_t pass = 0; pass < LR11XX_FIRMWARE_LZ_BENCH_PASS_COUNT; pass++ )
+    {
+        uint64_t total_ns     = 0;
+        uint64_t block_max_ns = 0;
+        uint32_t block_count  = 0;
+        uint32_t offset       = 0;
+
+        if( lr11xx_firmware_lz_init( &lz, container, container_length, &image ) == false )
+        {
+            return false;
+        }
+
+        if( decoded == NULL )
+        {
+            decoded = malloc( image.length_in_word * sizeof( uint32_t ) );
+            if( decoded == NULL )
+            {
+                return false;
+            }
+        }
+
+        for( uint32_t length = lr11xx_firmware_image_get_block_length( &image, offset ); length != 0;
+             length          = lr11xx_firmware_image_get_block_length( &image, offset ) )
+        {
+            const uint64_t start_ns = lr11xx_firmware_lz_bench_get_ns( );
+            const uint8_t* block    = lr11xx_firmware_image_get_block( &image, offset, length, NULL );
+            const uint64_t block_ns = lr11xx_firmware_lz_bench_get_ns( ) - start_ns;
+
+            if( block == NULL )
+            {
+                free( decoded );
+                return false;
+            }
+
+            memcpy( &decoded[offset], block, length * sizeof( uint32_t ) );
+            total_ns += block_ns;
+            block_max_ns = ( block_ns > block_max_ns ) ? block_ns : block_max_ns;
+            block_count++;
+            offset += length;
+        }
+
+        if( total_ns < result->total_ns )
+        {
+            result->total_ns     = total_ns;
+            result->block_max_ns = block_max_ns;
+            result->block_count  = block_count;
+        }
+    }
+
+    /* The decoded buffer holds the SPI byte stream: checked the way the updater checks a wire-order image */
+    const lr11xx_firmware_image_t decoded_image = {
+        .words          = decoded,
+        .length_in_word = image.length_in_word,
+        .format         = LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER,
+    };
+
+    uint32_t crc = 0;
+
+    result->image_length = image.length_in_word * sizeof( uint32_t );
+    result->is_crc_ok    = ( lr11xx_firmware_image_get_crc( &decoded_image, &crc ) == true ) &&
+                        ( crc == lr11xx_firmware_lz_get_crc( &lz ) );
+
+    free( decoded );
+
+    return ( result->block_count != 0 );
+}
+
+static uint64_t lr11xx_firmware_lz_bench_get_ns( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return ( ( uint64_t ) now.tv_sec * 1000000000ULL ) + ( uint64_t ) now.tv_nsec;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
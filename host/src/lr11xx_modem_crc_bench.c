@@ -0,0 +1,288 @@
+/*!
+ * @file      lr11xx_modem_crc_bench.c
+ *
+ * @brief     Host check and benchmark of the Modem-E frame CRC
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+/* clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lr1110_modem_hal.h"
+#include "lr1121_modem_hal.h"
+#include "lr11xx_modem_crc.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Longest frame checked against the bitwise CRC, every split point included
+ */
+#define LR11XX_MODEM_CRC_BENCH_CHECK_LENGTH_MAX ( 300 )
+
+/*!
+ * @brief Number of frames computed per timed pass
+ */
+#define LR11XX_MODEM_CRC_BENCH_FRAME_COUNT ( 10000 )
+
+/*!
+ * @brief Number of timed passes, the fastest one is kept
+ */
+#define LR11XX_MODEM_CRC_BENCH_PASS_COUNT ( 20 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*!
+ * @brief CRC function under benchmark
+ */
+typedef uint8_t ( *lr11xx_modem_crc_bench_crc_t )( uint8_t crc, const uint8_t* buffer, uint16_t length );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief Frame lengths timed: status read, short command, join parameters, largest uplink
+ */
+static const uint16_t lr11xx_modem_crc_bench_lengths[] = { 2, 8, 40, 244 };
+
+/*!
+ * @brief Sink of the computed CRCs, so that the timed loops are not optimized out
+ */
+static volatile uint8_t lr11xx_modem_crc_bench_sink;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Bitwise CRC of the LR1110 Modem-E HAL, as a function pointer
+ */
+static uint8_t lr11xx_modem_crc_bench_bitwise( uint8_t crc, const uint8_t* buffer, uint16_t length );
+
+/*!
+ * @brief Check the table CRC against both bitwise ones
+ *
+ * Every initial value with every byte, then pseudo-random frames of every length up to
+ * LR11XX_MODEM_CRC_BENCH_CHECK_LENGTH_MAX, computed in two parts at every split point.
+ *
+ * @returns Number of mismatches
+ */
+static uint32_t lr11xx_modem_crc_bench_check( void );
+
+/*!
+ * @brief Time a CRC function on frames of a given length
+ *
+ * @param [in] crc_function CRC function
+ * @param [in] buffer Frame
+ * @param [in] length Length of the frame in byte
+ *
+ * @returns Time per frame of the fastest pass in ns
+ */
+static double lr11xx_modem_crc_bench_time( lr11xx_modem_crc_bench_crc_t crc_function, const uint8_t* buffer,
+                                           uint16_t length );
+
+/*!
+ * @brief Get the next pseudo-random byte (xorshift32)
+ *
+ * @param [in,out] state Generator state, not zero
+ *
+ * @returns Pseudo-random byte
+ */
+static uint8_t lr11xx_modem_crc_bench_random( uint32_t* state );
+
+/*!
+ * @brief Get the monotonic time
+ *
+ * @returns Time in ns
+ */
+static uint64_t lr11xx_modem_crc_bench_get_ns( void );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( void )
+{
+    uint8_t        buffer[LR11XX_MODEM_CRC_BENCH_CHECK_LENGTH_MAX];
+    uint32_t       state      = 0x2545F491;
+    const uint32_t mismatches = lr11xx_modem_crc_bench_check( );
+
+    printf( "Check against the bitwise CRC: %s\n", ( mismatches == 0 ) ? "OK" : "MISMATCH" );
+    if( mismatches != 0 )
+    {
+        printf( "%u mismatches\n", mismatches );
+        return EXIT_FAILURE;
+    }
+
+    for( uint16_t index = 0; index < sizeof( buffer ); index++ )
+    {
+        buffer[index] = lr11xx_modem_crc_bench_random( &state );
+    }
+
+    printf( "%-8s %14s %14s %8s\n", "Bytes", "Bitwise ns", "Table ns", "Speedup" );
+
+    for( uint32_t index = 0; index < ( sizeof( lr11xx_modem_crc_bench_lengths ) / sizeof( uint16_t ) ); index++ )
+    {
+        const uint16_t length     = lr11xx_modem_crc_bench_lengths[index];
+        const double   bitwise_ns = lr11xx_modem_crc_bench_time( lr11xx_modem_crc_bench_bitwise, buffer, length );
+        const double   table_ns   = lr11xx_modem_crc_bench_time( lr11xx_modem_crc_update, buffer, length );
+
+        printf( "%-8u %14.1f %14.1f %7.1fx\n", length, bitwise_ns, table_ns, bitwise_ns / table_ns );
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint8_t lr11xx_modem_crc_bench_bitwise( uint8_t crc, const uint8_t* buffer, uint16_t length )
+{
+    return lr1110_modem_compute_crc( crc, buffer, length );
+}
+
+static uint32_t lr11xx_modem_crc_bench_check( void )
+{
+    uint8_t  buffer[LR11XX_MODEM_CRC_BENCH_CHECK_LENGTH_MAX];
+    uint32_t state      = 0x9E3779B9;
+    uint32_t mismatches = 0;
+
+    for( uint16_t crc = 0; crc < 256; crc++ )
+    {
+        for( uint16_t value = 0; value < 256; value++ )
+        {
+            const uint8_t byte = ( uint8_t ) value;
+
+            if( lr11xx_modem_crc_update( ( uint8_t ) crc, &byte, 1 ) != lr1110_modem_compute_crc( crc, &byte, 1 ) )
+            {
+                mismatches++;
+            }
+        }
+    }
+
+    for( uint16_t length = 0; length <= sizeof( buffer ); length++ )
+    {
+        for( uint16_t index = 0; index < length; index++ )
+        {
+            buffer[index] = lr11xx_modem_crc_bench_random( &state );
+        }
+
+        const uint8_t expected = lr1110_modem_compute_crc( LR11XX_MODEM_CRC_INITIAL_VALUE, buffer, length );
+
+        if( lr1121_modem_compute_crc( LR11XX_MODEM_CRC_INITIAL_VALUE, buffer, length ) != expected )
+        {
+            mismatches++;
+        }
+
+        /* The command then the data, as the HALs compute it */
+        for( uint16_t split = 0; split <= length; split++ )
+        {
+            const uint8_t crc = lr11xx_modem_crc_update( LR11XX_MODEM_CRC_INITIAL_VALUE, buffer, split );
+
+            if( lr11xx_modem_crc_update( crc, buffer + split, length - split ) != expected )
+            {
+                mismatches++;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+static double lr11xx_modem_crc_bench_time( lr11xx_modem_crc_bench_crc_t crc_function, const uint8_t* buffer,
+                                           uint16_t length )
+{
+    uint64_t best_ns = UINT64_MAX;
+
+    for( uint32_t pass = 0; pass < LR11XX_MODEM_CRC_BENCH_PASS_COUNT; pass++ )
+    {
+        uint8_t        crc      = 0;
+        const uint64_t start_ns = lr11xx_modem_crc_bench_get_ns( );
+
+        for( uint32_t frame = 0; frame < LR11XX_MODEM_CRC_BENCH_FRAME_COUNT; frame++ )
+        {
+            /* Chained so that a frame cannot be computed before the previous one */
+            crc = crc_function( crc ^ LR11XX_MODEM_CRC_INITIAL_VALUE, buffer, length );
+        }
+
+        const uint64_t pass_ns = lr11xx_modem_crc_bench_get_ns( ) - start_ns;
+
+        lr11xx_modem_crc_bench_sink = crc;
+        best_ns                     = ( pass_ns < best_ns ) ? pass_ns : best_ns;
+    }
+
+    return ( double ) best_ns / LR11XX_MODEM_CRC_BENCH_FRAME_COUNT;
+}
+
+static uint8_t lr11xx_modem_crc_bench_random( uint32_t* state )
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return ( uint8_t ) *state;
+}
+
+static uint64_t lr11xx_modem_crc_bench_get_ns( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return ( ( uint64_t ) now.tv_sec * 1000000000ULL ) + ( uint64_t ) now.tv_nsec;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
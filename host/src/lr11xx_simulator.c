@@ -0,0 +1,1371 @@
+/*!
+ * @file      lr11xx_simulator.c
+ *
+ * @brief     Simulated LR11xx chip for the host build
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lr11xx_simulator.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Longest SPI frame a chip records (encrypted write command with a full block)
+ */
+#define LR11XX_SIMULATOR_FRAME_LENGTH_MAX ( 512 )
+
+/*!
+ * @brief Number of protocol errors printed before going quiet
+ */
+#define LR11XX_SIMULATOR_ERROR_PRINT_MAX ( 10 )
+
+/*!
+ * @brief Opcodes understood by the bootloader and by the transceiver firmware
+ */
+#define LR11XX_SIMULATOR_NOP_OC ( 0x0000 )
+#define LR11XX_SIMULATOR_GET_STATUS_OC ( 0x0100 )
+#define LR11XX_SIMULATOR_GET_VERSION_OC ( 0x0101 )
+#define LR11XX_SIMULATOR_READ_UID_OC ( 0x0125 )
+#define LR11XX_SIMULATOR_ERASE_FLASH_OC ( 0x8000 )
+#define LR11XX_SIMULATOR_ERASE_PAGE_OC ( 0x8001 )
+#define LR11XX_SIMULATOR_WRITE_FLASH_ENCRYPTED_OC ( 0x8003 )
+#define LR11XX_SIMULATOR_GET_HASH_OC ( 0x8004 )
+#define LR11XX_SIMULATOR_REBOOT_OC ( 0x8005 )
+#define LR11XX_SIMULATOR_GET_PIN_OC ( 0x800B )
+#define LR11XX_SIMULATOR_READ_CHIP_EUI_OC ( 0x800C )
+#define LR11XX_SIMULATOR_READ_JOIN_EUI_OC ( 0x800D )
+#define LR11XX_SIMULATOR_CHECK_FW_IMAGE_OC ( 0x050F )
+#define LR11XX_SIMULATOR_GET_CHECK_FW_IMAGE_RESULT_OC ( 0x0510 )
+
+/*!
+ * @brief SPI CRC of the transceiver firmware: the command switching it is always sent with its CRC byte
+ */
+#define LR11XX_SIMULATOR_ENABLE_SPI_CRC_OC ( 0x0128 )
+
+/*!
+ * @brief Encrypted write command layout
+ */
+#define LR11XX_SIMULATOR_WRITE_HEADER_LENGTH ( 6 )
+#define LR11XX_SIMULATOR_WRITE_PAYLOAD_LENGTH_MAX ( 256 )
+
+/*!
+ * @brief Flash page erased by the LR1110 page erase command, in byte
+ */
+#define LR11XX_SIMULATOR_PAGE_LENGTH ( 1024 )
+
+/*!
+ * @brief Reboot argument keeping the chip in bootloader mode
+ */
+#define LR11XX_SIMULATOR_REBOOT_STAY_IN_BOOTLOADER ( 0x03 )
+
+/*!
+ * @brief Chip information
+ */
+#define LR11XX_SIMULATOR_HW_VERSION ( 0x22 )
+#define LR11XX_SIMULATOR_TYPE_PRODUCTION_MODE ( 0xDF )
+#define LR11XX_SIMULATOR_TYPE_LR1110 ( 0x01 )
+#define LR11XX_SIMULATOR_TYPE_LR1120 ( 0x02 )
+#define LR11XX_SIMULATOR_TYPE_LR1121 ( 0x03 )
+
+/*!
+ * @brief Bootloader status fields
+ */
+#define LR11XX_SIMULATOR_CMD_STATUS_FAIL ( 0x00 )
+#define LR11XX_SIMULATOR_CMD_STATUS_PERR ( 0x01 )
+#define LR11XX_SIMULATOR_CMD_STATUS_OK ( 0x02 )
+#define LR11XX_SIMULATOR_CMD_STATUS_DATA ( 0x03 )
+#define LR11XX_SIMULATOR_RESET_STATUS_CLEARED ( 0x00 )
+#define LR11XX_SIMULATOR_RESET_STATUS_EXTERNAL ( 0x02 )
+#define LR11XX_SIMULATOR_CHIP_MODE_STBY_RC ( 0x01 )
+
+/*!
+ * @brief Modem commands and response codes
+ */
+#define LR11XX_SIMULATOR_MODEM_V1_GROUP_ID ( 0x06 )
+#define LR11XX_SIMULATOR_MODEM_V2_GROUP_ID ( 0x0601 )
+#define LR11XX_SIMULATOR_MODEM_GET_VERSION_CMD ( 0x01 )
+#define LR11XX_SIMULATOR_MODEM_V1_VERSION_LENGTH ( 10 )
+#define LR11XX_SIMULATOR_MODEM_V2_VERSION_LENGTH ( 9 )
+#define LR11XX_SIMULATOR_MODEM_RC_OK ( 0x00 )
+#define LR11XX_SIMULATOR_MODEM_RC_UNKNOWN ( 0x01 )
+#define LR11XX_SIMULATOR_MODEM_RC_FRAME_ERROR ( 0x0F )
+#define LR11XX_SIMULATOR_MODEM_CRC_POLYNOMIAL ( 0x65 )
+
+/*!
+ * @brief Identifiers reported by the chips, the index of the chip is added to the last byte
+ */
+static const uint8_t lr11xx_simulator_pin[4]      = { 0x12, 0x34, 0x56, 0x00 };
+static const uint8_t lr11xx_simulator_chip_eui[8] = { 0x00, 0x16, 0xC0, 0x01, 0xFF, 0x00, 0x00, 0x00 };
+static const uint8_t lr11xx_simulator_join_eui[8] = { 0x00, 0x16, 0xC0, 0x01, 0xFF, 0xFE, 0x00, 0x01 };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct
+{
+    lr11xx_simulator_firmware_type_t type;
+    uint32_t                         version;
+    lr11xx_firmware_image_t          image;
+} lr11xx_simulator_firmware_t;
+
+typedef struct
+{
+    radio_t  radio;
+    uint16_t bootloader_version;
+    bool     is_present;  //!< False while the module is removed
+
+    lr11xx_simulator_firmware_t firmwares[LR11XX_SIMULATOR_FIRMWARE_COUNT_MAX];
+    uint8_t                     firmware_count;
+    int8_t                      running_firmware;  //!< Index of the running firmware, -1 in bootloader mode
+
+    bool is_nss_high;
+    bool is_reset_high;
+    bool is_busy_driven;      //!< True if the MCU drives the BUSY pin
+    bool is_busy_driven_high;
+
+    /* BUSY is high from busy_rise_ns included to busy_fall_ns excluded, and again from sleep_ns */
+    uint64_t busy_rise_ns;
+    uint64_t busy_fall_ns;
+    uint64_t sleep_ns;      //!< A modem firmware woken up without a command goes back to sleep
+    uint64_t boot_done_ns;  //!< A modem firmware ignores the wake-ups until booted
+
+    uint8_t  command_status;
+    uint8_t  reset_status;
+    bool     is_response_pending;
+    uint8_t  response[LR11XX_SIMULATOR_FRAME_LENGTH_MAX];
+    uint16_t response_length;
+
+    bool     is_frame_response_read;
+    bool     is_frame_wakeup;
+    uint8_t  mosi[LR11XX_SIMULATOR_FRAME_LENGTH_MAX];
+    uint16_t mosi_length;
+    uint8_t  miso[LR11XX_SIMULATOR_FRAME_LENGTH_MAX];
+    uint16_t miso_length;
+    uint16_t miso_index;
+    uint8_t  miso_lag;  //!< Last bit shifted out, read back in the next byte when the clock is too fast
+
+    bool     is_spi_crc_on;             //!< Transceiver firmware exchanging a CRC byte, off after every boot
+    uint32_t corrupted_response_count;  //!< Number of transceiver firmware responses left to damage on the line
+    uint32_t corrupted_command_count;   //!< Number of transceiver firmware read commands left to damage on the line
+
+    uint8_t flash[LR11XX_SIMULATOR_FLASH_SIZE_IN_WORD * 4];
+
+    /* Image check: length checked so far, and firmwares the image still matches, one bit each */
+    uint32_t check_length;
+    uint8_t  check_matches;
+
+    uint32_t corrupted_write;       //!< Encrypted write reaching the flash damaged, counted from 1, 0 for none
+    uint32_t rejected_write;        //!< First encrypted write to fail, counted from 1 with the failed ones, 0 for none
+    uint32_t rejected_write_count;  //!< Number of encrypted writes to fail from rejected_write on
+    uint32_t rejected_erase_count;  //!< Number of flash erases left to fail
+
+    lr11xx_simulator_stats_t stats;
+} lr11xx_simulator_chip_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static lr11xx_simulator_timing_t lr11xx_simulator_timing;
+static uint64_t                  lr11xx_simulator_now_ns;
+static uint32_t                  lr11xx_simulator_spi_clock_hz;
+static uint32_t                  lr11xx_simulator_error_print_count;
+
+static lr11xx_simulator_chip_t lr11xx_simulator_chips[LR11XX_SIMULATOR_CHIP_COUNT_MAX];
+static uint8_t                 lr11xx_simulator_chip_count;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static bool lr11xx_simulator_is_same_pin( gpio_t a, gpio_t b );
+
+static bool lr11xx_simulator_is_busy_high( const lr11xx_simulator_chip_t* chip, uint64_t time_ns );
+
+static bool lr11xx_simulator_is_modem_running( const lr11xx_simulator_chip_t* chip );
+
+static bool lr11xx_simulator_is_image_matching( const lr11xx_firmware_image_t* image, uint32_t offset,
+                                                const uint8_t* data, uint32_t length );
+
+static void lr11xx_simulator_set_busy( lr11xx_simulator_chip_t* chip, uint64_t duration_ns );
+
+static void lr11xx_simulator_error( lr11xx_simulator_chip_t* chip, const char* reason );
+
+static void lr11xx_simulator_boot( lr11xx_simulator_chip_t* chip, bool from_flash, uint64_t boot_time_ns );
+
+static void lr11xx_simulator_start_frame( lr11xx_simulator_chip_t* chip );
+
+static void lr11xx_simulator_end_frame( lr11xx_simulator_chip_t* chip );
+
+static void lr11xx_simulator_execute_command( lr11xx_simulator_chip_t* chip );
+
+static void lr11xx_simulator_execute_modem_command( lr11xx_simulator_chip_t* chip );
+
+static bool lr11xx_simulator_is_read_command( uint16_t opcode );
+
+static void lr11xx_simulator_set_response( lr11xx_simulator_chip_t* chip, const uint8_t* data, uint16_t length );
+
+static uint8_t lr11xx_simulator_modem_crc( uint8_t crc, const uint8_t* buffer, uint16_t length );
+
+static void lr11xx_simulator_hash( const uint8_t* flash, uint32_t length, uint8_t hash[LR11XX_SIMULATOR_HASH_LENGTH] );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void lr11xx_simulator_init( const lr11xx_simulator_timing_t* timing )
+{
+    if( timing != NULL )
+    {
+        lr11xx_simulator_timing = *timing;
+    }
+    else
+    {
+        lr11xx_simulator_get_default_timing( &lr11xx_simulator_timing );
+    }
+
+    lr11xx_simulator_now_ns            = 0;
+    lr11xx_simulator_spi_clock_hz      = lr11xx_simulator_timing.spi_clock_hz;
+    lr11xx_simulator_error_print_count = 0;
+    lr11xx_simulator_chip_count        = 0;
+}
+
+void lr11xx_simulator_get_default_timing( lr11xx_simulator_timing_t* timing )
+{
+    /* SPI1 clocked at 80 MHz / 8, register-level polled loop and DMA set-up as measured on the NUCLEO-L476RG */
+    timing->spi_clock_hz                = 10000000;
+    timing->spi_clock_max_hz            = 0;
+    timing->spi_polled_byte_overhead_ns = 500;
+    timing->spi_call_overhead_ns        = 300;
+    timing->spi_dma_setup_ns            = 1500;
+    timing->gpio_access_ns              = 50;
+    timing->irq_latency_ns              = 500;
+
+    /* BUSY rises faster than the MCU can read it back after NSS, raise it to stress the BUSY handling */
+    timing->busy_rise_ns    = 40;
+    timing->command_busy_us = 20;
+    timing->erase_busy_ms      = 2000;
+    timing->erase_page_busy_ms = 20;
+    timing->write_busy_us      = 1300;
+    timing->check_busy_us      = 600;
+    timing->hash_busy_ms       = 10;
+    timing->reset_busy_ms      = 250;
+    timing->reboot_busy_ms     = 250;
+
+    timing->modem_wakeup_us   = 100;
+    timing->modem_response_us = 500;
+    timing->modem_sleep_us    = 1000;
+}
+
+const lr11xx_simulator_timing_t* lr11xx_simulator_get_timing( void )
+{
+    return &lr11xx_simulator_timing;
+}
+
+int32_t lr11xx_simulator_attach( const radio_t* radio, uint16_t bootloader_version )
+{
+    if( lr11xx_simulator_chip_count >= LR11XX_SIMULATOR_CHIP_COUNT_MAX )
+    {
+        return -1;
+    }
+
+    lr11xx_simulator_chip_t* chip = &lr11xx_simulator_chips[lr11xx_simulator_chip_count];
+
+    memset( chip, 0, sizeof( lr11xx_simulator_chip_t ) );
+    memset( chip->flash, 0xFF, sizeof( chip->flash ) );
+
+    chip->radio              = *radio;
+    chip->bootloader_version = bootloader_version;
+    chip->is_present         = true;
+    chip->running_firmware   = -1;
+    chip->is_nss_high        = true;
+    chip->is_reset_high      = true;
+    chip->command_status     = LR11XX_SIMULATOR_CMD_STATUS_OK;
+    chip->reset_status       = LR11XX_SIMULATOR_RESET_STATUS_CLEARED;
+    chip->sleep_ns           = UINT64_MAX;
+
+    return lr11xx_simulator_chip_count++;
+}
+
+void lr11xx_simulator_set_present( int32_t chip, bool is_present )
+{
+    lr11xx_simulator_chip_t* chip_local = &lr11xx_simulator_chips[chip];
+
+    if( is_present == chip_local->is_present )
+    {
+        return;
+    }
+    chip_local->is_present = is_present;
+
+    if( is_present == true )
+    {
+        /* Power-up: the MCU keeps NSS and the reset line high at rest */
+        chip_local->is_nss_high   = true;
+        chip_local->is_reset_high = true;
+        chip_local->reset_status  = LR11XX_SIMULATOR_RESET_STATUS_CLEARED;
+        lr11xx_simulator_boot(
+            chip_local, ( chip_local->is_busy_driven == false ) || ( chip_local->is_busy_driven_high == true ),
+            ( uint64_t ) lr11xx_simulator_timing.reset_busy_ms * 1000000 );
+    }
+}
+
+void lr11xx_simulator_add_firmware( int32_t chip, lr11xx_simulator_firmware_type_t type, uint32_t version,
+                                    const lr11xx_firmware_image_t* image )
+{
+    lr11xx_simulator_chip_t* chip_local = &lr11xx_simulator_chips[chip];
+
+    if( chip_local->firmware_count < LR11XX_SIMULATOR_FIRMWARE_COUNT_MAX )
+    {
+        lr11xx_simulator_firmware_t* firmware = &chip_local->firmwares[chip_local->firmware_count++];
+
+        firmware->type    = type;
+        firmware->version = version;
+        firmware->image   = *image;
+    }
+}
+
+void lr11xx_simulator_flash_firmware( int32_t chip, uint8_t firmware )
+{
+    lr11xx_simulator_chip_t*                 chip_local = &lr11xx_simulator_chips[chip];
+    const lr11xx_simulator_firmware_t* const firmware_local = &chip_local->firmwares[firmware];
+    const uint32_t*                          words          = firmware_local->image.words;
+
+    memset( chip_local->flash, 0xFF, sizeof( chip_local->flash ) );
+
+    /* Same layout as the bootloader writes: big-endian words */
+    for( uint32_t word = 0; word < firmware_local->image.length_in_word; word++ )
+    {
+        uint8_t* flash = &chip_local->flash[word * 4];
+
+        if( firmware_local->image.format == LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER )
+        {
+            memcpy( flash, &words[word], sizeof( uint32_t ) );
+        }
+        else
+        {
+            flash[0] = ( uint8_t )( words[word] >> 24 );
+            flash[1] = ( uint8_t )( words[word] >> 16 );
+            flash[2] = ( uint8_t )( words[word] >> 8 );
+            flash[3] = ( uint8_t )( words[word] >> 0 );
+        }
+    }
+}
+
+void lr11xx_simulator_corrupt_write( int32_t chip, uint32_t write_index )
+{
+    lr11xx_simulator_chips[chip].corrupted_write = write_index;
+}
+
+void lr11xx_simulator_reject_write( int32_t chip, uint32_t write_index, uint32_t count )
+{
+    lr11xx_simulator_chips[chip].rejected_write       = write_index;
+    lr11xx_simulator_chips[chip].rejected_write_count = count;
+}
+
+void lr11xx_simulator_reject_erase( int32_t chip, uint32_t count )
+{
+    lr11xx_simulator_chips[chip].rejected_erase_count = count;
+}
+
+void lr11xx_simulator_corrupt_responses( int32_t chip, uint32_t count )
+{
+    lr11xx_simulator_chips[chip].corrupted_response_count = count;
+}
+
+void lr11xx_simulator_corrupt_commands( int32_t chip, uint32_t count )
+{
+    lr11xx_simulator_chips[chip].corrupted_command_count = count;
+}
+
+void lr11xx_simulator_get_image_hash( const lr11xx_firmware_image_t* image,
+                                      uint8_t                        hash[LR11XX_SIMULATOR_HASH_LENGTH] )
+{
+    static uint8_t flash[LR11XX_SIMULATOR_FLASH_SIZE_IN_WORD * 4];
+
+    memset( flash, 0xFF, sizeof( flash ) );
+    for( uint32_t word = 0; word < image->length_in_word; word++ )
+    {
+        if( image->format == LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER )
+        {
+            memcpy( &flash[word * 4], &image->words[word], sizeof( uint32_t ) );
+        }
+        else
+        {
+            flash[word * 4 + 0] = ( uint8_t )( image->words[word] >> 24 );
+            flash[word * 4 + 1] = ( uint8_t )( image->words[word] >> 16 );
+            flash[word * 4 + 2] = ( uint8_t )( image->words[word] >> 8 );
+            flash[word * 4 + 3] = ( uint8_t )( image->words[word] >> 0 );
+        }
+    }
+
+    lr11xx_simulator_hash( flash, sizeof( flash ), hash );
+}
+
+void lr11xx_simulator_get_stats( int32_t chip, lr11xx_simulator_stats_t* stats )
+{
+    *stats = lr11xx_simulator_chips[chip].stats;
+}
+
+bool lr11xx_simulator_is_firmware_running( int32_t chip, uint32_t* version )
+{
+    const lr11xx_simulator_chip_t* chip_local = &lr11xx_simulator_chips[chip];
+
+    if( chip_local->running_firmware < 0 )
+    {
+        return false;
+    }
+
+    if( version != NULL )
+    {
+        *version = chip_local->firmwares[chip_local->running_firmware].version;
+    }
+
+    return true;
+}
+
+uint64_t lr11xx_simulator_get_time_ns( void )
+{
+    return lr11xx_simulator_now_ns;
+}
+
+void lr11xx_simulator_advance_ns( uint64_t duration_ns )
+{
+    lr11xx_simulator_now_ns += duration_ns;
+}
+
+uint32_t lr11xx_simulator_get_spi_byte_ns( void )
+{
+    return ( uint32_t )( ( 8ULL * 1000000000ULL ) / lr11xx_simulator_spi_clock_hz );
+}
+
+void lr11xx_simulator_set_spi_clock( uint32_t spi_clock_hz )
+{
+    lr11xx_simulator_spi_clock_hz = spi_clock_hz;
+}
+
+void lr11xx_simulator_set_pin( gpio_t gpio, bool is_high )
+{
+    for( uint8_t i = 0; i < lr11xx_simulator_chip_count; i++ )
+    {
+        lr11xx_simulator_chip_t* chip = &lr11xx_simulator_chips[i];
+
+        if( chip->is_present == false )
+        {
+            continue;
+        }
+
+        if( lr11xx_simulator_is_same_pin( gpio, chip->radio.spi_device.nss ) && ( is_high != chip->is_nss_high ) )
+        {
+            chip->is_nss_high = is_high;
+
+            if( chip->is_reset_high == true )
+            {
+                if( is_high == false )
+                {
+                    lr11xx_simulator_start_frame( chip );
+                }
+                else
+                {
+                    lr11xx_simulator_end_frame( chip );
+                }
+            }
+        }
+        else if( lr11xx_simulator_is_same_pin( gpio, chip->radio.reset ) && ( is_high != chip->is_reset_high ) )
+        {
+            chip->is_reset_high = is_high;
+
+            if( is_high == true )
+            {
+                /* The bootloader samples BUSY when leaving reset: held low by the MCU, the chip stays in bootloader */
+                const bool stay_in_bootloader =
+                    ( chip->is_busy_driven == true ) && ( chip->is_busy_driven_high == false );
+
+                chip->reset_status = LR11XX_SIMULATOR_RESET_STATUS_EXTERNAL;
+                lr11xx_simulator_boot( chip, !stay_in_bootloader,
+                                       ( uint64_t ) lr11xx_simulator_timing.reset_busy_ms * 1000000 );
+            }
+            else
+            {
+                chip->is_response_pending = false;
+            }
+        }
+    }
+}
+
+void lr11xx_simulator_set_pin_direction( gpio_t gpio, bool is_output, bool is_high )
+{
+    for( uint8_t i = 0; i < lr11xx_simulator_chip_count; i++ )
+    {
+        lr11xx_simulator_chip_t* chip = &lr11xx_simulator_chips[i];
+
+        if( lr11xx_simulator_is_same_pin( gpio, chip->radio.busy ) )
+        {
+            chip->is_busy_driven      = is_output;
+            chip->is_busy_driven_high = is_high;
+        }
+    }
+}
+
+bool lr11xx_simulator_is_chip_pin( gpio_t gpio )
+{
+    for( uint8_t i = 0; i < lr11xx_simulator_chip_count; i++ )
+    {
+        if( lr11xx_simulator_is_same_pin( gpio, lr11xx_simulator_chips[i].radio.busy ) ||
+            lr11xx_simulator_is_same_pin( gpio, lr11xx_simulator_chips[i].radio.irq ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool lr11xx_simulator_get_pin( gpio_t gpio )
+{
+    for( uint8_t i = 0; i < lr11xx_simulator_chip_count; i++ )
+    {
+        const lr11xx_simulator_chip_t* chip = &lr11xx_simulator_chips[i];
+
+        if( lr11xx_simulator_is_same_pin( gpio, chip->radio.busy ) )
+        {
+            if( chip->is_busy_driven == true )
+            {
+                return chip->is_busy_driven_high;
+            }
+            if( chip->is_present == false )
+            {
+                /* Left floating by a removed module, read low */
+                continue;
+            }
+            return lr11xx_simulator_is_busy_high( chip, lr11xx_simulator_now_ns );
+        }
+        if( lr11xx_simulator_is_same_pin( gpio, chip->radio.irq ) )
+        {
+            /* A modem firmware raises its EVENT line once booted, the reset event staying pending: never read here */
+            return ( chip->is_present == true ) && ( chip->is_reset_high == true ) &&
+                   ( lr11xx_simulator_is_modem_running( chip ) == true ) &&
+                   ( lr11xx_simulator_now_ns >= chip->boot_done_ns );
+        }
+    }
+
+    return false;
+}
+
+uint64_t lr11xx_simulator_get_pin_edge_ns( gpio_t gpio, bool is_high )
+{
+    const uint64_t now         = lr11xx_simulator_now_ns;
+    bool           is_floating = false;
+
+    for( uint8_t i = 0; i < lr11xx_simulator_chip_count; i++ )
+    {
+        const lr11xx_simulator_chip_t* chip = &lr11xx_simulator_chips[i];
+
+        if( lr11xx_simulator_is_same_pin( gpio, chip->radio.busy ) == false )
+        {
+            continue;
+        }
+
+        if( chip->is_busy_driven == true )
+        {
+            return ( chip->is_busy_driven_high == is_high ) ? now : UINT64_MAX;
+        }
+
+        if( chip->is_present == false )
+        {
+            is_floating = true;
+            continue;
+        }
+
+        if( lr11xx_simulator_is_busy_high( chip, now ) == is_high )
+        {
+            return now;
+        }
+
+        if( chip->is_reset_high == false )
+        {
+            return UINT64_MAX;
+        }
+
+        if( is_high == true )
+        {
+            /* BUSY is low: it rises only if the rise is still to come */
+            return ( chip->busy_rise_ns > now ) ? chip->busy_rise_ns : chip->sleep_ns;
+        }
+
+        return chip->busy_fall_ns;
+    }
+
+    /* A floating pin is read low, and stays so */
+    return ( ( is_floating == true ) && ( is_high == false ) ) ? now : UINT64_MAX;
+}
+
+uint8_t lr11xx_simulator_spi_exchange( SPI_TypeDef* spi, uint8_t mosi )
+{
+    lr11xx_simulator_chip_t* selected = NULL;
+    uint8_t                  miso     = 0xFF;
+
+    for( uint8_t i = 0; i < lr11xx_simulator_chip_count; i++ )
+    {
+        lr11xx_simulator_chip_t* chip = &lr11xx_simulator_chips[i];
+
+        if( ( chip->radio.spi_device.spi != spi ) || ( chip->is_nss_high == true ) || ( chip->is_present == false ) )
+        {
+            continue;
+        }
+
+        if( selected != NULL )
+        {
+            lr11xx_simulator_error( chip, "several chips selected on the same bus" );
+        }
+        selected = chip;
+
+        chip->stats.byte_count++;
+
+        if( chip->mosi_length < LR11XX_SIMULATOR_FRAME_LENGTH_MAX )
+        {
+            chip->mosi[chip->mosi_length++] = mosi;
+        }
+        else
+        {
+            lr11xx_simulator_error( chip, "frame too long" );
+        }
+
+        miso = ( chip->miso_index < chip->miso_length ) ? chip->miso[chip->miso_index] : 0x00;
+        chip->miso_index++;
+
+        if( ( lr11xx_simulator_timing.spi_clock_max_hz != 0 ) &&
+            ( lr11xx_simulator_spi_clock_hz > lr11xx_simulator_timing.spi_clock_max_hz ) )
+        {
+            const uint8_t lag = chip->miso_lag;
+
+            chip->miso_lag = miso & 0x01;
+            miso           = ( uint8_t )( ( miso >> 1 ) | ( lag << 7 ) );
+        }
+    }
+
+    return miso;
+}
+
+void lr11xx_simulator_report_error( SPI_TypeDef* spi, const char* reason )
+{
+    for( uint8_t i = 0; i < lr11xx_simulator_chip_count; i++ )
+    {
+        lr11xx_simulator_chip_t* chip = &lr11xx_simulator_chips[i];
+
+        if( ( chip->radio.spi_device.spi == spi ) && ( chip->is_nss_high == false ) && ( chip->is_present == true ) )
+        {
+            lr11xx_simulator_error( chip, reason );
+        }
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool lr11xx_simulator_is_same_pin( gpio_t a, gpio_t b )
+{
+    return ( a.port == b.port ) && ( a.pin == b.pin );
+}
+
+static bool lr11xx_simulator_is_busy_high( const lr11xx_simulator_chip_t* chip, uint64_t time_ns )
+{
+    if( chip->is_reset_high == false )
+    {
+        return true;
+    }
+
+    return ( ( time_ns >= chip->busy_rise_ns ) && ( time_ns < chip->busy_fall_ns ) ) || ( time_ns >= chip->sleep_ns );
+}
+
+static bool lr11xx_simulator_is_modem_running( const lr11xx_simulator_chip_t* chip )
+{
+    return ( chip->running_firmware >= 0 ) &&
+           ( chip->firmwares[chip->running_firmware].type != LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER );
+}
+
+static bool lr11xx_simulator_is_image_matching( const lr11xx_firmware_image_t* image, uint32_t offset,
+                                                const uint8_t* data, uint32_t length )
+{
+    const uint32_t* words = image->words;
+
+    if( ( offset + length ) > ( image->length_in_word * sizeof( uint32_t ) ) )
+    {
+        return false;
+    }
+
+    /* Flash and SPI hold the image in the same order, that is with big-endian words */
+    if( image->format == LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER )
+    {
+        return memcmp( data, ( const uint8_t* ) words + offset, length ) == 0;
+    }
+
+    for( uint32_t index = 0; index < length; index++ )
+    {
+        const uint32_t byte = offset + index;
+
+        if( data[index] != ( uint8_t )( words[byte / 4] >> ( 24 - 8 * ( byte % 4 ) ) ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void lr11xx_simulator_set_busy( lr11xx_simulator_chip_t* chip, uint64_t duration_ns )
+{
+    chip->busy_rise_ns = lr11xx_simulator_now_ns + lr11xx_simulator_timing.busy_rise_ns;
+    chip->busy_fall_ns = chip->busy_rise_ns + duration_ns;
+    chip->sleep_ns     = UINT64_MAX;
+    chip->stats.busy_time_ns += duration_ns;
+}
+
+static void lr11xx_simulator_error( lr11xx_simulator_chip_t* chip, const char* reason )
+{
+    chip->stats.error_count++;
+
+    if( lr11xx_simulator_error_print_count < LR11XX_SIMULATOR_ERROR_PRINT_MAX )
+    {
+        lr11xx_simulator_error_print_count++;
+        fprintf( stderr, "[sim %10.3f ms] chip %u: %s\n", ( double ) lr11xx_simulator_now_ns / 1000000.0,
+                 ( unsigned int ) ( chip - lr11xx_simulator_chips ), reason );
+    }
+}
+
+static void lr11xx_simulator_boot( lr11xx_simulator_chip_t* chip, bool from_flash, uint64_t boot_time_ns )
+{
+    chip->running_firmware    = -1;
+    chip->is_response_pending = false;
+    chip->is_spi_crc_on       = false;
+    chip->command_status      = LR11XX_SIMULATOR_CMD_STATUS_OK;
+
+    for( uint8_t i = 0; ( from_flash == true ) && ( i < chip->firmware_count ); i++ )
+    {
+        const lr11xx_firmware_image_t* image = &chip->firmwares[i].image;
+
+        if( lr11xx_simulator_is_image_matching( image, 0, chip->flash, image->length_in_word * sizeof( uint32_t ) ) ==
+            true )
+        {
+            chip->running_firmware = i;
+            break;
+        }
+    }
+
+    chip->busy_rise_ns = lr11xx_simulator_now_ns;
+    chip->sleep_ns     = UINT64_MAX;
+    chip->boot_done_ns = lr11xx_simulator_now_ns + boot_time_ns;
+    if( lr11xx_simulator_is_modem_running( chip ) == true )
+    {
+        /* A modem firmware goes to sleep once booted, with BUSY high until woken up by NSS */
+        chip->busy_fall_ns = UINT64_MAX;
+    }
+    else
+    {
+        chip->busy_fall_ns = chip->boot_done_ns;
+    }
+}
+
+static void lr11xx_simulator_start_frame( lr11xx_simulator_chip_t* chip )
+{
+    const bool is_busy_high = lr11xx_simulator_is_busy_high( chip, lr11xx_simulator_now_ns );
+
+    chip->stats.frame_count++;
+    chip->mosi_length            = 0;
+    chip->miso_length            = 0;
+    chip->miso_index             = 0;
+    chip->miso_lag               = 0;
+    chip->is_frame_response_read = false;
+    chip->is_frame_wakeup        = false;
+
+    if( lr11xx_simulator_is_modem_running( chip ) == true )
+    {
+        if( chip->is_response_pending == true )
+        {
+            if( is_busy_high == false )
+            {
+                chip->stats.busy_violation_count++;
+            }
+            chip->is_frame_response_read = true;
+            memcpy( chip->miso, chip->response, chip->response_length );
+            chip->miso_length = chip->response_length;
+        }
+        else if( is_busy_high == true )
+        {
+            chip->is_frame_wakeup = true;
+        }
+        return;
+    }
+
+    if( is_busy_high == true )
+    {
+        chip->stats.busy_violation_count++;
+    }
+
+    chip->miso[chip->miso_length++] = ( uint8_t )( chip->command_status << 1 );
+
+    if( chip->is_response_pending == true )
+    {
+        chip->is_frame_response_read = true;
+        memcpy( &chip->miso[chip->miso_length], chip->response, chip->response_length );
+        chip->miso_length += chip->response_length;
+
+        /* The CRC covers stat1 and the response */
+        if( chip->is_spi_crc_on == true )
+        {
+            chip->miso[chip->miso_length] = lr11xx_simulator_modem_crc( 0xFF, chip->miso, chip->miso_length );
+            chip->miso_length++;
+        }
+
+        /* Damaged on the line, after the CRC is computed: the bootloader, with no CRC, is spared */
+        if( ( chip->corrupted_response_count != 0 ) && ( chip->running_firmware >= 0 ) )
+        {
+            chip->miso[1 + chip->response_length / 2] ^= 0x01;
+            chip->corrupted_response_count--;
+            chip->stats.corrupted_response_count++;
+        }
+    }
+    else
+    {
+        /* Stat2 followed by the 32-bit interrupt status */
+        chip->miso[chip->miso_length++] = ( uint8_t )( ( chip->reset_status << 4 ) |
+                                                       ( LR11XX_SIMULATOR_CHIP_MODE_STBY_RC << 1 ) |
+                                                       ( ( chip->running_firmware >= 0 ) ? 0x01 : 0x00 ) );
+        memset( &chip->miso[chip->miso_length], 0x00, 4 );
+        chip->miso_length += 4;
+    }
+}
+
+static void lr11xx_simulator_end_frame( lr11xx_simulator_chip_t* chip )
+{
+    if( chip->is_frame_response_read == true )
+    {
+        chip->is_response_pending = false;
+
+        if( lr11xx_simulator_is_modem_running( chip ) == true )
+        {
+            /* BUSY goes low once the response is read, and high again when the modem goes back to sleep */
+            chip->busy_rise_ns = lr11xx_simulator_now_ns + ( uint64_t ) lr11xx_simulator_timing.modem_sleep_us * 1000;
+            chip->busy_fall_ns = UINT64_MAX;
+            chip->sleep_ns     = UINT64_MAX;
+        }
+        return;
+    }
+
+    if( chip->is_frame_wakeup == true )
+    {
+        const uint64_t wakeup_ns =
+            ( chip->boot_done_ns > lr11xx_simulator_now_ns ) ? chip->boot_done_ns : lr11xx_simulator_now_ns;
+
+        chip->busy_fall_ns = wakeup_ns + ( uint64_t ) lr11xx_simulator_timing.modem_wakeup_us * 1000;
+        chip->sleep_ns     = chip->busy_fall_ns + ( uint64_t ) lr11xx_simulator_timing.modem_sleep_us * 1000;
+        if( chip->busy_rise_ns > lr11xx_simulator_now_ns )
+        {
+            chip->busy_rise_ns = lr11xx_simulator_now_ns;
+        }
+        return;
+    }
+
+    if( lr11xx_simulator_is_modem_running( chip ) == true )
+    {
+        lr11xx_simulator_execute_modem_command( chip );
+    }
+    else
+    {
+        lr11xx_simulator_execute_command( chip );
+    }
+}
+
+static void lr11xx_simulator_execute_command( lr11xx_simulator_chip_t* chip )
+{
+    const bool is_bootloader = ( chip->running_firmware < 0 );
+    uint64_t   busy_ns       = ( uint64_t ) lr11xx_simulator_timing.command_busy_us * 1000;
+    uint8_t    response[8]   = { 0 };
+    uint16_t   opcode;
+
+    if( chip->mosi_length < 2 )
+    {
+        /* Wake-up pulse or truncated frame: nothing to execute */
+        return;
+    }
+
+    opcode = ( uint16_t )( ( chip->mosi[0] << 8 ) | chip->mosi[1] );
+    if( opcode == LR11XX_SIMULATOR_NOP_OC )
+    {
+        /* Direct read of the status */
+        return;
+    }
+
+    /* The command switching the CRC carries one whatever the current setting, the bootloader knows neither */
+    if( ( is_bootloader == false ) &&
+        ( ( chip->is_spi_crc_on == true ) || ( opcode == LR11XX_SIMULATOR_ENABLE_SPI_CRC_OC ) ) )
+    {
+        const bool is_damaged =
+            ( chip->corrupted_command_count != 0 ) && ( lr11xx_simulator_is_read_command( opcode ) == true );
+
+        /* Damaged on the line, after the MCU computed the CRC: the chip drops the command and has no data to send */
+        if( is_damaged == true )
+        {
+            chip->mosi[chip->mosi_length / 2] ^= 0x01;
+            chip->corrupted_command_count--;
+            chip->stats.corrupted_command_count++;
+        }
+
+        chip->mosi_length--;
+        if( lr11xx_simulator_modem_crc( 0xFF, chip->mosi, chip->mosi_length ) != chip->mosi[chip->mosi_length] )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_PERR;
+            if( is_damaged == false )
+            {
+                lr11xx_simulator_error( chip, "command with a wrong SPI CRC" );
+            }
+            return;
+        }
+    }
+
+    chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_OK;
+
+    switch( opcode )
+    {
+    case LR11XX_SIMULATOR_GET_STATUS_OC:
+        chip->reset_status = LR11XX_SIMULATOR_RESET_STATUS_CLEARED;
+        break;
+
+    case LR11XX_SIMULATOR_GET_VERSION_OC:
+        response[0] = LR11XX_SIMULATOR_HW_VERSION;
+        if( is_bootloader == true )
+        {
+            response[1] = LR11XX_SIMULATOR_TYPE_PRODUCTION_MODE;
+            response[2] = ( uint8_t )( chip->bootloader_version >> 8 );
+            response[3] = ( uint8_t )( chip->bootloader_version >> 0 );
+        }
+        else
+        {
+            const uint32_t version = chip->firmwares[chip->running_firmware].version;
+
+            switch( chip->bootloader_version )
+            {
+            case LR11XX_SIMULATOR_BOOTLOADER_LR1120:
+                response[1] = LR11XX_SIMULATOR_TYPE_LR1120;
+                break;
+            case LR11XX_SIMULATOR_BOOTLOADER_LR1121:
+                response[1] = LR11XX_SIMULATOR_TYPE_LR1121;
+                break;
+            default:
+                response[1] = LR11XX_SIMULATOR_TYPE_LR1110;
+                break;
+            }
+            response[2] = ( uint8_t )( version >> 8 );
+            response[3] = ( uint8_t )( version >> 0 );
+        }
+        lr11xx_simulator_set_response( chip, response, 4 );
+        break;
+
+    case LR11XX_SIMULATOR_READ_UID_OC:
+        memcpy( response, lr11xx_simulator_chip_eui, sizeof( lr11xx_simulator_chip_eui ) );
+        response[7] += ( uint8_t )( chip - lr11xx_simulator_chips );
+        lr11xx_simulator_set_response( chip, response, 8 );
+        break;
+
+    case LR11XX_SIMULATOR_ERASE_FLASH_OC:
+        if( is_bootloader == false )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "flash erase outside of bootloader mode" );
+            break;
+        }
+        busy_ns = ( uint64_t ) lr11xx_simulator_timing.erase_busy_ms * 1000000;
+        if( chip->rejected_erase_count != 0 )
+        {
+            /* Failed on purpose: not a protocol error */
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            chip->rejected_erase_count--;
+            chip->stats.erase_reject_count++;
+            break;
+        }
+        memset( chip->flash, 0xFF, sizeof( chip->flash ) );
+        chip->stats.erase_count++;
+        break;
+
+    case LR11XX_SIMULATOR_ERASE_PAGE_OC:
+        /* Only the LR1110 bootloader erases the flash page by page */
+        if( ( is_bootloader == false ) || ( chip->bootloader_version != LR11XX_SIMULATOR_BOOTLOADER_LR1110 ) ||
+            ( chip->mosi_length != 3 ) ||
+            ( ( ( uint32_t ) chip->mosi[2] + 1 ) * LR11XX_SIMULATOR_PAGE_LENGTH > sizeof( chip->flash ) ) )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "invalid page erase command" );
+            break;
+        }
+        memset( &chip->flash[chip->mosi[2] * LR11XX_SIMULATOR_PAGE_LENGTH], 0xFF, LR11XX_SIMULATOR_PAGE_LENGTH );
+        chip->stats.page_erase_count++;
+        busy_ns = ( uint64_t ) lr11xx_simulator_timing.erase_page_busy_ms * 1000000;
+        break;
+
+    case LR11XX_SIMULATOR_GET_HASH_OC:
+    {
+        uint8_t hash[LR11XX_SIMULATOR_HASH_LENGTH];
+
+        if( ( is_bootloader == false ) || ( chip->bootloader_version != LR11XX_SIMULATOR_BOOTLOADER_LR1110 ) )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "invalid flash hash command" );
+            break;
+        }
+        lr11xx_simulator_hash( chip->flash, sizeof( chip->flash ), hash );
+        lr11xx_simulator_set_response( chip, hash, LR11XX_SIMULATOR_HASH_LENGTH );
+        busy_ns = ( uint64_t ) lr11xx_simulator_timing.hash_busy_ms * 1000000;
+        break;
+    }
+
+    case LR11XX_SIMULATOR_WRITE_FLASH_ENCRYPTED_OC:
+    {
+        const uint16_t payload_length = chip->mosi_length - LR11XX_SIMULATOR_WRITE_HEADER_LENGTH;
+        uint32_t       offset         = 0;
+
+        if( ( is_bootloader == false ) || ( chip->mosi_length < LR11XX_SIMULATOR_WRITE_HEADER_LENGTH ) )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "invalid flash write command" );
+            break;
+        }
+
+        offset = ( ( uint32_t ) chip->mosi[2] << 24 ) | ( ( uint32_t ) chip->mosi[3] << 16 ) |
+                 ( ( uint32_t ) chip->mosi[4] << 8 ) | ( ( uint32_t ) chip->mosi[5] << 0 );
+
+        if( ( payload_length == 0 ) || ( ( payload_length % 4 ) != 0 ) ||
+            ( payload_length > LR11XX_SIMULATOR_WRITE_PAYLOAD_LENGTH_MAX ) || ( ( offset % 4 ) != 0 ) ||
+            ( ( offset + payload_length ) > sizeof( chip->flash ) ) )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "flash write out of bounds or misaligned" );
+            break;
+        }
+
+        busy_ns = ( uint64_t ) lr11xx_simulator_timing.write_busy_us * 1000;
+
+        /* Counted with the failed writes, so that a retry of the failed block is the next write */
+        const uint32_t write_index = chip->stats.write_count + chip->stats.write_reject_count + 1;
+
+        if( ( chip->rejected_write != 0 ) && ( write_index >= chip->rejected_write ) &&
+            ( ( write_index - chip->rejected_write ) < chip->rejected_write_count ) )
+        {
+            /* Failed on purpose: not a protocol error */
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            chip->stats.write_reject_count++;
+            break;
+        }
+
+        for( uint16_t i = 0; i < payload_length; i++ )
+        {
+            if( chip->flash[offset + i] != 0xFF )
+            {
+                lr11xx_simulator_error( chip, "flash write to a non-erased area" );
+                break;
+            }
+        }
+
+        memcpy( &chip->flash[offset], &chip->mosi[LR11XX_SIMULATOR_WRITE_HEADER_LENGTH], payload_length );
+        chip->stats.write_count++;
+        if( chip->stats.write_count == chip->corrupted_write )
+        {
+            chip->flash[offset + payload_length / 2] ^= 0x01;
+        }
+        chip->stats.write_byte_count += payload_length;
+        break;
+    }
+
+    case LR11XX_SIMULATOR_REBOOT_OC:
+    {
+        const bool stay_in_bootloader =
+            ( chip->mosi_length > 2 ) && ( chip->mosi[2] == LR11XX_SIMULATOR_REBOOT_STAY_IN_BOOTLOADER );
+
+        lr11xx_simulator_boot( chip, !stay_in_bootloader,
+                               ( uint64_t ) lr11xx_simulator_timing.reboot_busy_ms * 1000000 );
+        return;
+    }
+
+    case LR11XX_SIMULATOR_GET_PIN_OC:
+        memcpy( response, lr11xx_simulator_pin, sizeof( lr11xx_simulator_pin ) );
+        response[3] += ( uint8_t )( chip - lr11xx_simulator_chips );
+        lr11xx_simulator_set_response( chip, response, 4 );
+        break;
+
+    case LR11XX_SIMULATOR_READ_CHIP_EUI_OC:
+        memcpy( response, lr11xx_simulator_chip_eui, sizeof( lr11xx_simulator_chip_eui ) );
+        response[7] += ( uint8_t )( chip - lr11xx_simulator_chips );
+        lr11xx_simulator_set_response( chip, response, 8 );
+        break;
+
+    case LR11XX_SIMULATOR_READ_JOIN_EUI_OC:
+        lr11xx_simulator_set_response( chip, lr11xx_simulator_join_eui, 8 );
+        break;
+
+    case LR11XX_SIMULATOR_CHECK_FW_IMAGE_OC:
+    {
+        const uint16_t payload_length = chip->mosi_length - LR11XX_SIMULATOR_WRITE_HEADER_LENGTH;
+        uint32_t       offset         = 0;
+
+        if( ( is_bootloader == true ) || ( chip->mosi_length < LR11XX_SIMULATOR_WRITE_HEADER_LENGTH ) ||
+            ( payload_length > LR11XX_SIMULATOR_WRITE_PAYLOAD_LENGTH_MAX ) )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "invalid image check command" );
+            break;
+        }
+
+        offset = ( ( uint32_t ) chip->mosi[2] << 24 ) | ( ( uint32_t ) chip->mosi[3] << 16 ) |
+                 ( ( uint32_t ) chip->mosi[4] << 8 ) | ( ( uint32_t ) chip->mosi[5] << 0 );
+
+        /* The image is accepted if it is one the chip is able to boot, sent in order from its start */
+        if( offset == 0 )
+        {
+            chip->check_length  = 0;
+            chip->check_matches = ( uint8_t )( ( 1 << chip->firmware_count ) - 1 );
+        }
+        if( offset != chip->check_length )
+        {
+            chip->check_matches = 0;
+        }
+        for( uint8_t i = 0; i < chip->firmware_count; i++ )
+        {
+            if( lr11xx_simulator_is_image_matching( &chip->firmwares[i].image, offset,
+                                                    &chip->mosi[LR11XX_SIMULATOR_WRITE_HEADER_LENGTH],
+                                                    payload_length ) == false )
+            {
+                chip->check_matches &= ( uint8_t ) ~( 1 << i );
+            }
+        }
+        chip->check_length = offset + payload_length;
+        chip->stats.check_count++;
+        busy_ns = ( uint64_t ) lr11xx_simulator_timing.check_busy_us * 1000;
+        break;
+    }
+
+    case LR11XX_SIMULATOR_ENABLE_SPI_CRC_OC:
+        if( ( is_bootloader == true ) || ( chip->mosi_length != 3 ) )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "invalid SPI CRC command" );
+            break;
+        }
+        chip->is_spi_crc_on = ( chip->mosi[2] != 0 );
+        break;
+
+    case LR11XX_SIMULATOR_GET_CHECK_FW_IMAGE_RESULT_OC:
+    {
+        /* The whole image must have been checked */
+        for( uint8_t i = 0; i < chip->firmware_count; i++ )
+        {
+            if( ( chip->firmwares[i].image.length_in_word * sizeof( uint32_t ) ) != chip->check_length )
+            {
+                chip->check_matches &= ( uint8_t ) ~( 1 << i );
+            }
+        }
+        response[0] = ( chip->check_matches != 0 ) ? 1 : 0;
+        lr11xx_simulator_set_response( chip, response, 1 );
+        break;
+    }
+
+    default:
+        if( is_bootloader == true )
+        {
+            chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_FAIL;
+            lr11xx_simulator_error( chip, "unknown bootloader opcode" );
+        }
+        break;
+    }
+
+    lr11xx_simulator_set_busy( chip, busy_ns );
+}
+
+static void lr11xx_simulator_execute_modem_command( lr11xx_simulator_chip_t* chip )
+{
+    const lr11xx_simulator_firmware_t* firmware        = &chip->firmwares[chip->running_firmware];
+    const uint32_t                     version         = firmware->version;
+    uint8_t                            response[16]    = { LR11XX_SIMULATOR_MODEM_RC_OK };
+    uint16_t                           response_length = 1;
+    uint16_t                           group_id;
+    uint8_t                            command;
+
+    if( chip->mosi_length == 0 )
+    {
+        /* Wake-up pulse of an already awake modem */
+        return;
+    }
+
+    if( lr11xx_simulator_modem_crc( 0xFF, chip->mosi, chip->mosi_length - 1 ) !=
+        chip->mosi[chip->mosi_length - 1] )
+    {
+        response[0] = LR11XX_SIMULATOR_MODEM_RC_FRAME_ERROR;
+        lr11xx_simulator_error( chip, "bad modem command CRC" );
+    }
+    else if( firmware->type == LR11XX_SIMULATOR_FIRMWARE_MODEM_V1 )
+    {
+        group_id = chip->mosi[0];
+        command  = chip->mosi[1];
+
+        if( ( group_id == LR11XX_SIMULATOR_MODEM_V1_GROUP_ID ) &&
+            ( command == LR11XX_SIMULATOR_MODEM_GET_VERSION_CMD ) )
+        {
+            /* Bootloader, functionality, firmware and LoRaWAN versions */
+            response[3]     = ( uint8_t )( chip->bootloader_version >> 8 );
+            response[4]     = ( uint8_t )( chip->bootloader_version >> 0 );
+            response[5]     = ( uint8_t )( version >> 24 );
+            response[6]     = ( uint8_t )( version >> 16 );
+            response[7]     = ( uint8_t )( version >> 8 );
+            response[8]     = ( uint8_t )( version >> 0 );
+            response[9]     = 0x01;
+            response[10]    = 0x03;
+            response_length = 1 + LR11XX_SIMULATOR_MODEM_V1_VERSION_LENGTH;
+        }
+        else
+        {
+            response[0] = LR11XX_SIMULATOR_MODEM_RC_UNKNOWN;
+        }
+    }
+    else
+    {
+        group_id = ( uint16_t )( ( chip->mosi[0] << 8 ) | chip->mosi[1] );
+        command  = chip->mosi[2];
+
+        if( ( group_id == LR11XX_SIMULATOR_MODEM_V2_GROUP_ID ) &&
+            ( command == LR11XX_SIMULATOR_MODEM_GET_VERSION_CMD ) )
+        {
+            /* Use case, modem version and LoRa Basics Modem version */
+            response[1]     = ( uint8_t )( version >> 24 );
+            response[2]     = ( uint8_t )( version >> 16 );
+            response[3]     = ( uint8_t )( version >> 8 );
+            response[4]     = ( uint8_t )( version >> 0 );
+            response[6]     = 0x04;
+            response[7]     = 0x05;
+            response[8]     = 0x00;
+            response_length = 1 + LR11XX_SIMULATOR_MODEM_V2_VERSION_LENGTH;
+        }
+        else
+        {
+            response[0] = LR11XX_SIMULATOR_MODEM_RC_UNKNOWN;
+        }
+    }
+
+    /* The response code and data are followed by their CRC */
+    response[response_length] = lr11xx_simulator_modem_crc( 0xFF, response, response_length );
+    response_length++;
+    lr11xx_simulator_set_response( chip, response, response_length );
+
+    /* BUSY rises once the response is ready and stays high until it is read */
+    chip->busy_rise_ns = lr11xx_simulator_now_ns + ( uint64_t ) lr11xx_simulator_timing.modem_response_us * 1000;
+    chip->busy_fall_ns = UINT64_MAX;
+    chip->sleep_ns     = UINT64_MAX;
+}
+
+static bool lr11xx_simulator_is_read_command( uint16_t opcode )
+{
+    /* The commands the transceiver firmware answers with data: only the version read is sent again by the HAL */
+    return ( opcode == LR11XX_SIMULATOR_GET_VERSION_OC ) || ( opcode == LR11XX_SIMULATOR_READ_UID_OC ) ||
+           ( opcode == LR11XX_SIMULATOR_GET_CHECK_FW_IMAGE_RESULT_OC );
+}
+
+static void lr11xx_simulator_set_response( lr11xx_simulator_chip_t* chip, const uint8_t* data, uint16_t length )
+{
+    memcpy( chip->response, data, length );
+    chip->response_length     = length;
+    chip->is_response_pending = true;
+    if( lr11xx_simulator_is_modem_running( chip ) == false )
+    {
+        chip->command_status = LR11XX_SIMULATOR_CMD_STATUS_DATA;
+    }
+}
+
+static uint8_t lr11xx_simulator_modem_crc( uint8_t crc, const uint8_t* buffer, uint16_t length )
+{
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        uint8_t extract = buffer[i];
+
+        for( uint8_t bit = 0; bit < 8; bit++ )
+        {
+            const uint8_t sum = ( crc ^ extract ) & 0x01;
+
+            crc >>= 1;
+            if( sum != 0 )
+            {
+                crc ^= LR11XX_SIMULATOR_MODEM_CRC_POLYNOMIAL;
+            }
+            extract >>= 1;
+        }
+    }
+
+    return crc;
+}
+
+static void lr11xx_simulator_hash( const uint8_t* flash, uint32_t length, uint8_t hash[LR11XX_SIMULATOR_HASH_LENGTH] )
+{
+    /* Four interleaved FNV-1a lanes: the digest of the real bootloader is not public, only its length matters here */
+    uint32_t lanes[LR11XX_SIMULATOR_HASH_LENGTH / 4] = { 0x811C9DC5, 0x811C9DC5 ^ 1, 0x811C9DC5 ^ 2, 0x811C9DC5 ^ 3 };
+
+    for( uint32_t i = 0; i < length; i++ )
+    {
+        lanes[i % 4] = ( lanes[i % 4] ^ flash[i] ) * 0x01000193;
+    }
+
+    for( uint8_t lane = 0; lane < 4; lane++ )
+    {
+        hash[lane * 4 + 0] = ( uint8_t )( lanes[lane] >> 24 );
+        hash[lane * 4 + 1] = ( uint8_t )( lanes[lane] >> 16 );
+        hash[lane * 4 + 2] = ( uint8_t )( lanes[lane] >> 8 );
+        hash[lane * 4 + 3] = ( uint8_t )( lanes[lane] >> 0 );
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,466 @@
+/*!
+ * @file      lr11xx_uart_stream_host.c
+ *
+ * @brief     Host side of the LR11XX UART image streaming, for the host build
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lr11xx_uart_stream_host.h"
+#include "lr11xx_uart_stream.h"
+#include "lr11xx_simulator.h"
+#include "system_uart.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Delay for the host to react to a frame: a USB full-speed serial bridge polls once per millisecond
+ */
+#define LR11XX_UART_STREAM_HOST_LATENCY_NS ( 1000000 )
+
+#define LR11XX_UART_STREAM_HOST_FRAME_MAX_LENGTH                                           \
+    ( LR11XX_UART_STREAM_HEADER_LENGTH + LR11XX_UART_STREAM_PAYLOAD_MAX_LENGTH + \
+      LR11XX_UART_STREAM_CRC_LENGTH )
+
+/*!
+ * @brief Largest payload of the frames sent by the MCU
+ */
+#define LR11XX_UART_STREAM_HOST_RX_PAYLOAD_MAX_LENGTH ( 16 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+    LR11XX_UART_STREAM_HOST_SEND_START,
+    LR11XX_UART_STREAM_HOST_WAIT_START_ACK,
+    LR11XX_UART_STREAM_HOST_STREAM,
+    LR11XX_UART_STREAM_HOST_DONE,
+} lr11xx_uart_stream_host_state_t;
+
+/*!
+ * @brief Decoder of the frames sent by the MCU
+ */
+typedef struct
+{
+    bool     is_in_frame;
+    uint8_t  header[LR11XX_UART_STREAM_HEADER_LENGTH - 1];
+    uint8_t  payload[LR11XX_UART_STREAM_HOST_RX_PAYLOAD_MAX_LENGTH];
+    uint16_t index;
+    uint16_t length;
+    uint16_t crc;
+} lr11xx_uart_stream_host_decoder_t;
+
+typedef struct
+{
+    bool                            is_active;
+    const lr11xx_firmware_image_t*  image;
+    lr11xx_fw_update_t              update;
+    uint32_t                        fw_expected;
+    uint32_t                        corrupt_period;
+    lr11xx_uart_stream_host_state_t state;
+    uint32_t                        block_count;
+    uint8_t                         window;
+
+    uint32_t next_block;        //!< Index of the next block to send
+    uint32_t acked_count;       //!< Blocks acknowledged, as known by the host
+    bool     is_ack_pending;    //!< An ACK was received but the host has not reacted yet
+    uint32_t pending_acked_count;
+    uint64_t ack_ns;            //!< Virtual time at which the host reacts to the pending ACK
+    bool     is_nak_pending;    //!< A NAK was received but the host has not reacted yet
+    uint32_t nak_block;
+    uint64_t nak_ns;            //!< Virtual time at which the host reacts to the pending NAK
+
+    uint8_t  frame[LR11XX_UART_STREAM_HOST_FRAME_MAX_LENGTH];  //!< Frame on the line
+    uint16_t frame_length;
+    uint16_t frame_index;       //!< Index of the next byte to deliver
+    uint64_t frame_start_ns;    //!< Virtual time at which the first byte starts
+    uint64_t line_free_ns;      //!< Virtual time at which the last frame ends
+
+    lr11xx_uart_stream_host_decoder_t decoder;
+    lr11xx_uart_stream_host_stats_t   stats;
+} lr11xx_uart_stream_host_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static lr11xx_uart_stream_host_t lr11xx_uart_stream_host;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Prepare the next frame to send, if any
+ *
+ * @returns True if a frame is ready, false if the host has nothing to send for now
+ */
+static bool lr11xx_uart_stream_host_prepare_frame( void );
+
+/*!
+ * @brief Build a frame
+ *
+ * @param [in] type Frame type
+ * @param [in] seq Sequence number
+ * @param [in] payload Payload
+ * @param [in] length Length of the payload
+ */
+static void lr11xx_uart_stream_host_build_frame( lr11xx_uart_stream_frame_type_t type, uint8_t seq,
+                                                 const uint8_t* payload, uint16_t length );
+
+/*!
+ * @brief Handle a complete frame sent by the MCU
+ *
+ * @param [in] now_ns Virtual time at which the frame is received
+ */
+static void lr11xx_uart_stream_host_on_frame( uint64_t now_ns );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void lr11xx_uart_stream_host_init( const lr11xx_firmware_image_t* image, lr11xx_fw_update_t update,
+                                   uint32_t fw_expected, uint32_t corrupt_period )
+{
+    lr11xx_uart_stream_host_t* host = &lr11xx_uart_stream_host;
+
+    memset( host, 0, sizeof( lr11xx_uart_stream_host_t ) );
+
+    host->is_active      = true;
+    host->image          = image;
+    host->update         = update;
+    host->fw_expected    = fw_expected;
+    host->corrupt_period = corrupt_period;
+    host->state          = LR11XX_UART_STREAM_HOST_SEND_START;
+    host->block_count    = ( image->length_in_word + LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD - 1 ) /
+                        LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD;
+    host->line_free_ns = lr11xx_simulator_get_time_ns( );
+}
+
+bool lr11xx_uart_stream_host_is_active( void )
+{
+    return lr11xx_uart_stream_host.is_active;
+}
+
+uint32_t lr11xx_uart_stream_host_get_byte_ns( void )
+{
+    /* Start bit, 8 data bits and stop bit */
+    return ( uint32_t ) ( ( 10ULL * 1000000000ULL ) / SYSTEM_UART_BAUDRATE );
+}
+
+void lr11xx_uart_stream_host_on_tx( uint8_t data, uint64_t now_ns )
+{
+    lr11xx_uart_stream_host_decoder_t* decoder = &lr11xx_uart_stream_host.decoder;
+
+    if( decoder->is_in_frame == false )
+    {
+        if( data == LR11XX_UART_STREAM_SOF )
+        {
+            decoder->is_in_frame = true;
+            decoder->index       = 0;
+            decoder->crc         = 0xFFFF;
+        }
+        else
+        {
+            putchar( data );
+        }
+        return;
+    }
+
+    const uint16_t header_length = sizeof( decoder->header );
+
+    if( decoder->index < header_length )
+    {
+        decoder->header[decoder->index] = data;
+        decoder->crc                    = lr11xx_uart_stream_crc_update( decoder->crc, data );
+
+        if( decoder->index == ( header_length - 1 ) )
+        {
+            decoder->length = ( ( uint16_t ) decoder->header[2] << 8 ) + decoder->header[3];
+            if( decoder->length > LR11XX_UART_STREAM_HOST_RX_PAYLOAD_MAX_LENGTH )
+            {
+                decoder->is_in_frame = false;
+                return;
+            }
+        }
+    }
+    else if( decoder->index < ( header_length + decoder->length ) )
+    {
+        decoder->payload[decoder->index - header_length] = data;
+        decoder->crc = lr11xx_uart_stream_crc_update( decoder->crc, data );
+    }
+    else
+    {
+        decoder->crc ^= ( decoder->index == ( header_length + decoder->length ) ) ? ( ( uint16_t ) data << 8 ) : data;
+
+        if( decoder->index == ( header_length + decoder->length + LR11XX_UART_STREAM_CRC_LENGTH - 1 ) )
+        {
+            decoder->is_in_frame = false;
+            if( decoder->crc == 0 )
+            {
+                lr11xx_uart_stream_host_on_frame( now_ns );
+            }
+            return;
+        }
+    }
+
+    decoder->index++;
+}
+
+uint64_t lr11xx_uart_stream_host_get_next_rx_ns( void )
+{
+    lr11xx_uart_stream_host_t* host = &lr11xx_uart_stream_host;
+
+    if( host->is_active == false )
+    {
+        return UINT64_MAX;
+    }
+
+    if( ( host->frame_index >= host->frame_length ) && ( lr11xx_uart_stream_host_prepare_frame( ) == false ) )
+    {
+        return UINT64_MAX;
+    }
+
+    return host->frame_start_ns + ( uint64_t ) ( host->frame_index + 1 ) * lr11xx_uart_stream_host_get_byte_ns( );
+}
+
+uint8_t lr11xx_uart_stream_host_pop_rx( void )
+{
+    lr11xx_uart_stream_host_t* host = &lr11xx_uart_stream_host;
+    const uint8_t              data = host->frame[host->frame_index++];
+
+    if( host->frame_index == host->frame_length )
+    {
+        host->line_free_ns =
+            host->frame_start_ns + ( uint64_t ) host->frame_length * lr11xx_uart_stream_host_get_byte_ns( );
+    }
+
+    return data;
+}
+
+void lr11xx_uart_stream_host_get_stats( lr11xx_uart_stream_host_stats_t* stats )
+{
+    *stats = lr11xx_uart_stream_host.stats;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool lr11xx_uart_stream_host_prepare_frame( void )
+{
+    lr11xx_uart_stream_host_t* host     = &lr11xx_uart_stream_host;
+    uint64_t                   start_ns = host->line_free_ns;
+
+    switch( host->state )
+    {
+    case LR11XX_UART_STREAM_HOST_SEND_START:
+    {
+        const uint8_t payload[LR11XX_UART_STREAM_START_LENGTH] = {
+            ( uint8_t ) host->update,
+            ( uint8_t ) ( host->fw_expected >> 24 ),
+            ( uint8_t ) ( host->fw_expected >> 16 ),
+            ( uint8_t ) ( host->fw_expected >> 8 ),
+            ( uint8_t ) ( host->fw_expected >> 0 ),
+            ( uint8_t ) ( host->image->length_in_word >> 24 ),
+            ( uint8_t ) ( host->image->length_in_word >> 16 ),
+            ( uint8_t ) ( host->image->length_in_word >> 8 ),
+            ( uint8_t ) ( host->image->length_in_word >> 0 ),
+        };
+
+        lr11xx_uart_stream_host_build_frame( LR11XX_UART_STREAM_FRAME_START, 0, payload, sizeof( payload ) );
+        host->state = LR11XX_UART_STREAM_HOST_WAIT_START_ACK;
+        break;
+    }
+    case LR11XX_UART_STREAM_HOST_STREAM:
+    {
+        /* Apply what the host already reacted to when the line gets free */
+        if( ( host->is_nak_pending == true ) && ( host->nak_ns <= start_ns ) )
+        {
+            host->next_block     = host->nak_block;
+            host->is_nak_pending = false;
+        }
+        if( ( host->is_ack_pending == true ) && ( host->ack_ns <= start_ns ) )
+        {
+            host->acked_count    = host->pending_acked_count;
+            host->is_ack_pending = false;
+        }
+
+        if( ( host->next_block >= host->block_count ) || ( host->next_block >= ( host->acked_count + host->window ) ) )
+        {
+            /* Nothing to send until the host reacts to the next pending frame */
+            if( ( host->is_ack_pending == true ) && ( host->next_block < host->block_count ) &&
+                ( host->next_block < ( host->pending_acked_count + host->window ) ) )
+            {
+                start_ns             = ( host->ack_ns > start_ns ) ? host->ack_ns : start_ns;
+                host->acked_count    = host->pending_acked_count;
+                host->is_ack_pending = false;
+            }
+            else if( host->is_nak_pending == true )
+            {
+                start_ns             = ( host->nak_ns > start_ns ) ? host->nak_ns : start_ns;
+                host->next_block     = host->nak_block;
+                host->is_nak_pending = false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        const uint32_t offset_in_word = host->next_block * LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD;
+        const uint32_t length_in_word = lr11xx_firmware_image_get_block_length( host->image, offset_in_word );
+        uint8_t        scratch[LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_BYTE];
+        const uint8_t* block =
+            lr11xx_firmware_image_get_block( host->image, offset_in_word, length_in_word, scratch );
+
+        lr11xx_uart_stream_host_build_frame( LR11XX_UART_STREAM_FRAME_DATA, ( uint8_t ) ( host->next_block + 1 ), block,
+                                             ( uint16_t ) ( length_in_word * sizeof( uint32_t ) ) );
+        host->next_block++;
+        host->stats.data_frame_count++;
+
+        if( ( host->corrupt_period != 0 ) && ( ( host->stats.data_frame_count % host->corrupt_period ) == 0 ) )
+        {
+            host->frame[LR11XX_UART_STREAM_HEADER_LENGTH] ^= 0x01;
+            host->stats.corrupted_count++;
+        }
+        break;
+    }
+    default:
+    {
+        return false;
+    }
+    }
+
+    host->frame_start_ns = start_ns;
+    return true;
+}
+
+static void lr11xx_uart_stream_host_build_frame( lr11xx_uart_stream_frame_type_t type, uint8_t seq,
+                                                 const uint8_t* payload, uint16_t length )
+{
+    lr11xx_uart_stream_host_t* host = &lr11xx_uart_stream_host;
+    uint16_t                   crc  = 0xFFFF;
+
+    host->frame[0] = LR11XX_UART_STREAM_SOF;
+    host->frame[1] = ( uint8_t ) type;
+    host->frame[2] = seq;
+    host->frame[3] = ( uint8_t ) ( length >> 8 );
+    host->frame[4] = ( uint8_t ) ( length >> 0 );
+    memcpy( &host->frame[LR11XX_UART_STREAM_HEADER_LENGTH], payload, length );
+
+    host->frame_length = LR11XX_UART_STREAM_HEADER_LENGTH + length;
+    for( uint16_t i = 1; i < host->frame_length; i++ )
+    {
+        crc = lr11xx_uart_stream_crc_update( crc, host->frame[i] );
+    }
+    host->frame[host->frame_length++] = ( uint8_t ) ( crc >> 8 );
+    host->frame[host->frame_length++] = ( uint8_t ) ( crc >> 0 );
+    host->frame_index                 = 0;
+}
+
+static void lr11xx_uart_stream_host_on_frame( uint64_t now_ns )
+{
+    lr11xx_uart_stream_host_t*               host    = &lr11xx_uart_stream_host;
+    const lr11xx_uart_stream_host_decoder_t* decoder = &host->decoder;
+    const uint8_t                            seq     = decoder->header[1];
+
+    switch( decoder->header[0] )
+    {
+    case LR11XX_UART_STREAM_FRAME_ACK:
+    {
+        host->stats.ack_count++;
+
+        if( ( host->state == LR11XX_UART_STREAM_HOST_WAIT_START_ACK ) && ( seq == 0 ) && ( decoder->length == 1 ) )
+        {
+            host->window       = decoder->payload[0];
+            host->state        = LR11XX_UART_STREAM_HOST_STREAM;
+            host->line_free_ns = now_ns + LR11XX_UART_STREAM_HOST_LATENCY_NS;
+        }
+        else if( host->state == LR11XX_UART_STREAM_HOST_STREAM )
+        {
+            /* Cumulative acknowledgment: the sequence number is the block count modulo 256 */
+            const uint32_t base = ( host->is_ack_pending == true ) ? host->pending_acked_count : host->acked_count;
+
+            host->pending_acked_count = base + ( uint8_t ) ( seq - ( uint8_t ) base );
+            host->ack_ns              = now_ns + LR11XX_UART_STREAM_HOST_LATENCY_NS;
+            host->is_ack_pending      = true;
+        }
+        break;
+    }
+    case LR11XX_UART_STREAM_FRAME_NAK:
+    {
+        const uint32_t base = ( host->is_ack_pending == true ) ? host->pending_acked_count : host->acked_count;
+
+        host->stats.nak_count++;
+        if( host->state == LR11XX_UART_STREAM_HOST_STREAM )
+        {
+            /* The expected block is the first one not acknowledged yet, or one of the window following it */
+            host->nak_block      = base + ( uint8_t ) ( seq - 1 - ( uint8_t ) base );
+            host->nak_ns         = now_ns + LR11XX_UART_STREAM_HOST_LATENCY_NS;
+            host->is_nak_pending = true;
+        }
+        break;
+    }
+    case LR11XX_UART_STREAM_FRAME_DONE:
+    {
+        host->state             = LR11XX_UART_STREAM_HOST_DONE;
+        host->stats.is_done     = true;
+        host->stats.done_status = ( decoder->length == 1 ) ? decoder->payload[0] : 0xFF;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
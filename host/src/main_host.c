@@ -0,0 +1,1863 @@
+/*!
+ * @file      main_host.c
+ *
+ * @brief     Host build entry point: run a firmware update against a simulated LR11xx
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#if defined LR11XX_FIRMWARE_BUNDLE_FILE
+#include LR11XX_FIRMWARE_BUNDLE_FILE
+#elif defined IMAGE_HEADER_FILE
+#include IMAGE_HEADER_FILE
+#else
+#error IMAGE_HEADER_FILE is not defined, please define it or include firmware image instead of this message
+#endif
+
+#if defined( LR11XX_FIRMWARE_DIFF_FILE )
+#include LR11XX_FIRMWARE_DIFF_FILE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "configuration.h"
+#include "system.h"
+#include "lr11xx_firmware_update.h"
+#include "lr11xx_firmware_lz.h"
+#include "lr11xx_hal.h"
+#include "lr11xx_system.h"
+#include "lr11xx_simulator.h"
+#include "lr11xx_station.h"
+#include "lr11xx_uart_stream.h"
+#include "lr11xx_uart_stream_host.h"
+#include "version.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Length of a progress line printed by lr11xx_update_firmware_print_progress, charged on the COM port
+ */
+#define MAIN_HOST_PROGRESS_LINE_LENGTH ( 72 )
+
+/*!
+ * @brief Maximum time for the station to see a module inserted or removed, and time a module stays once updated
+ */
+#define MAIN_HOST_STATION_DETECTION_TIMEOUT_MS ( 5000 )
+#define MAIN_HOST_STATION_HANDLING_MS ( 2000 )
+
+/*!
+ * @brief Display area the board flushes at once, in bytes: 10 rows of 240 RGB565 pixels, sent at the default SPI clock
+ */
+#define MAIN_HOST_DISPLAY_AREA_LENGTH ( 4800 )
+
+/*!
+ * @brief Largest part of a display area the board sends in one go, in bytes, the LR11xx taking the bus in between
+ */
+#define MAIN_HOST_DISPLAY_SEGMENT_LENGTH ( 1024 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*!
+ * @brief Progress reports received during an update
+ */
+typedef struct
+{
+    uint32_t report_count;     //!< Number of reports
+    uint32_t written_in_byte;  //!< Bytes written at the last report
+    uint32_t total_in_byte;    //!< Bytes to write at the last report
+    uint64_t cost_ns;          //!< Time the reports took on the COM port
+    bool     is_monotonic;     //!< Whether the bytes written never went backwards
+} main_host_progress_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+radio_t radio = {
+    { SPI1, { LR11XX_NSS_PORT, LR11XX_NSS_PIN }, LR11XX_SPI_PRESCALER, LL_SPI_DATAWIDTH_8BIT, false },
+    { LR11XX_RESET_PORT, LR11XX_RESET_PIN },
+    { LR11XX_IRQ_PORT, LR11XX_IRQ_PIN },
+    { LR11XX_BUSY_PORT, LR11XX_BUSY_PIN },
+};
+
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+static lr11xx_firmware_lz_t    lr11xx_image_lz;
+static lr11xx_firmware_image_t lr11xx_image;
+#elif !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+static const lr11xx_firmware_image_t lr11xx_image = {
+    .words          = lr11xx_firmware_image,
+    .length_in_word = sizeof( lr11xx_firmware_image ) / sizeof( lr11xx_firmware_image[0] ),
+    .format         = LR11XX_FIRMWARE_IMAGE_FORMAT,
+};
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static void main_host_usage( const char* name );
+
+static bool main_host_parse_arguments( int argc, char** argv, lr11xx_simulator_timing_t* timing,
+                                       uint32_t* corrupt_period, bool* is_up_to_date );
+
+/*!
+ * @brief Get the simulated chip a firmware is meant for
+ *
+ * @param [in] update Type of firmware
+ * @param [out] bootloader_version Bootloader version of the chip
+ * @param [out] firmware_type Kind of firmware the chip runs once updated
+ */
+static void main_host_get_chip( lr11xx_fw_update_t update, uint16_t* bootloader_version,
+                                lr11xx_simulator_firmware_type_t* firmware_type );
+
+/*!
+ * @brief Print the outcome of a simulated update
+ *
+ * @param [in] status Update status
+ * @param [in] chip Index of the chip
+ *
+ * @returns True if the chip saw neither BUSY violation nor protocol error
+ */
+static bool main_host_print_summary( lr11xx_fw_update_status_t status, int32_t chip );
+
+/*!
+ * @brief Check the status of an update against the state the chip started in
+ *
+ * @param [in] status Update status
+ * @param [in] chip Index of the chip
+ * @param [in] is_up_to_date True if the chip already ran the firmware to flash
+ *
+ * @returns True if an up-to-date chip was left untouched, and any other chip updated
+ */
+static bool main_host_check_status( lr11xx_fw_update_status_t status, int32_t chip, bool is_up_to_date );
+
+#if !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+/*!
+ * @brief Print the progress of the flash write and account for the time the line takes on the COM port
+ *
+ * @param [in] progress Progress of the write
+ * @param [inout] context Progress reports received, main_host_progress_t
+ */
+static void main_host_on_progress( const lr11xx_bootloader_progress_t* progress, void* context );
+
+/*!
+ * @brief Check the progress reports of an update
+ *
+ * @param [in] progress Progress reports received
+ * @param [in] timing Timing of the update
+ *
+ * @returns True if the reports were rate-limited, ended with the last byte and cost less than 1 % of the write
+ */
+static bool main_host_check_progress( const main_host_progress_t* progress, const lr11xx_fw_update_timing_t* timing );
+#endif
+
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+/*!
+ * @brief Decode the whole compressed image
+ *
+ * @param [out] image Decoded image, in SPI byte order
+ *
+ * @returns True if the image decoded without error
+ */
+static bool main_host_decode_image( lr11xx_firmware_image_t* image );
+
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 ) && ( LR11XX_UART_STREAM != 1 )
+/*!
+ * @brief Update a chip running a transceiver firmware with the compressed image and one block failing every retry
+ *
+ * @param [in] timing Timing of the simulated chip
+ * @param [in] decoded_image Image the simulated chip boots once flashed
+ *
+ * @returns True if the image was checked by the chip, then written twice, each time decoded from its start again
+ */
+static bool main_host_run_compressed_check( const lr11xx_simulator_timing_t* timing,
+                                            const lr11xx_firmware_image_t*   decoded_image );
+#endif
+#endif
+
+#if defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+/*!
+ * @brief Run the bundle once per chip it holds an image for, then once with a corrupted image CRC, and once with a
+ * damaged image on a chip running a transceiver firmware
+ *
+ * @param [in] timing Timing of the simulated chip
+ * @param [in] is_up_to_date True to start each chip with its first image already flashed
+ *
+ * @returns True if every chip got its image and the corrupted images were refused before the flash erase
+ */
+static bool main_host_run_bundle( const lr11xx_simulator_timing_t* timing, bool is_up_to_date );
+#endif
+
+#if defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+/*!
+ * @brief Update a chip running the transceiver firmware of the bundle to a damaged copy of it, then to a streamed one
+ *
+ * @param [in] timing Timing of the simulated chip
+ *
+ * @returns True if the damaged image was refused and, when validated, without leaving the running firmware, and the
+ * streamed one refused without being read
+ */
+static bool main_host_run_damaged_image( const lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Block source of a streamed image failing to provide any block
+ *
+ * @param [in] context Number of blocks requested, incremented
+ * @param [in] offset_in_word Offset of the block in the image
+ * @param [in] length_in_word Length of the block in word
+ *
+ * @returns NULL
+ */
+static const uint8_t* main_host_read_no_block( void* context, uint32_t offset_in_word, uint32_t length_in_word );
+#endif
+
+#if !defined( LR11XX_FIRMWARE_DIFF_FILE ) && ( LR11XX_UART_STREAM != 1 ) && !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+/*!
+ * @brief Update the chip with a block failing a few times, then failing every retry, with the flash erase failing
+ * once, and with every block failing from the middle of the image on
+ *
+ * @param [in] timing Timing of the simulated chip
+ * @param [in] flashed_image Image the simulated chip boots once flashed, decoded if the embedded one is compressed
+ *
+ * @returns True if the failed block alone was written again, the whole flash only once the block failed every retry,
+ * and the chip left in bootloader mode once the second run failed too
+ */
+static bool main_host_run_retry( const lr11xx_simulator_timing_t* timing,
+                                 const lr11xx_firmware_image_t*   flashed_image );
+#endif
+
+#if !defined( LR11XX_FIRMWARE_DIFF_FILE ) && !defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED ) && \
+    ( LR11XX_UART_STREAM != 1 ) && !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+/*!
+ * @brief Update an LR1110 with the right expected flash hash, then with one block damaged on its way to the flash,
+ * then with a wrong expected hash
+ *
+ * @param [in] timing Timing of the simulated chip
+ *
+ * @returns True if the damaged block was written again in the same session, and the wrong hash refused
+ */
+static bool main_host_run_hash( const lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Run the update one step at a time, the way the board main loop does, with the main loop busy for a
+ * while between two steps
+ *
+ * @param [in] timing Timing of the simulated chip
+ * @param [in] blocking_timing Timing of the same update run in one call
+ *
+ * @returns True if every run got the image, with the SPI bus idle between steps and no step longer than one block or
+ * the flash hash read
+ */
+static bool main_host_run_steps( const lr11xx_simulator_timing_t* timing,
+                                 const lr11xx_fw_update_timing_t* blocking_timing );
+
+/*!
+ * @brief Run the update step by step with a display refresh due every LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS: without
+ * display, with the area sent in one go as soon as the refresh is due, and with the refresh started while the chip is
+ * busy and its area sent one segment per main loop turn, as the board does
+ *
+ * @param [in] timing Timing of the simulated chip
+ *
+ * @returns True if every run got the image, the segmented refreshes costing less than 1 % of the update time without
+ * display
+ */
+static bool main_host_run_display( const lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Update the chip over SPI links of several quality: with no limit, and reading back reliably up to 2.5, 1.2,
+ * 0.6 and 0.3 times the default SPI clock
+ *
+ * @param [in] timing Timing of the simulated chip
+ *
+ * @returns True if every run got the image, over the fastest clock both the link and LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ
+ * allow
+ */
+static bool main_host_run_spi_clock( const lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Read the version of a transceiver firmware with the SPI CRC enabled and responses or commands damaged on the
+ * line, then, with LR11XX_FW_UPDATE_SPI_CRC, update it: a few responses damaged on a chip already up to date and on a
+ * blank chip, a few commands on a chip already up to date, and as many responses as the HAL reads one
+ *
+ * @param [in] timing Timing of the simulated chip
+ *
+ * @returns True if no damaged response nor dropped command was taken for a good read: the retried reads hid the first
+ * damages, and the read failing every attempt had the chip updated again
+ */
+static bool main_host_run_spi_crc( const lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Run the station main loop over modules inserted one after the other: a new one, one already up to date, one
+ * failing every flash write and a new one again
+ *
+ * @param [in] timing Timing of the simulated chip
+ *
+ * @returns True if every module was seen once inserted and once removed, nothing seen while none was in place, and
+ * the statistics count the units, passed and failed
+ */
+static bool main_host_run_station( const lr11xx_simulator_timing_t* timing );
+
+/*!
+ * @brief Step the station the way the board main loop does, until it reports a change or a timeout
+ *
+ * @param [in] station Station
+ * @param [in] timeout_ms Maximum time to run
+ *
+ * @returns Change reported by the station, LR11XX_STATION_EVENT_NONE on timeout
+ */
+static lr11xx_station_event_t main_host_step_station( lr11xx_station_t* station, uint32_t timeout_ms );
+#endif
+
+#if defined( LR11XX_FIRMWARE_DIFF_FILE )
+/*!
+ * @brief Run the differential update on a chip running the base firmware, with no expected flash hash, with the
+ * right one and with a wrong one, then on a blank chip
+ *
+ * @param [in] timing Timing of the simulated chip
+ *
+ * @returns True if every chip got the image, through a full erase on the blank chip only, and the wrong hash refused
+ * after a full erase and write
+ */
+static bool main_host_run_diff( const lr11xx_simulator_timing_t* timing );
+#endif
+
+#if( LR11XX_UART_STREAM == 1 )
+/*!
+ * @brief Stream the image over the simulated UART and run the update the way the board does in streaming mode
+ *
+ * @param [in] corrupt_period Corrupt one DATA frame out of this number, 0 to never corrupt any
+ * @param [out] update_timing Timing of the update
+ *
+ * @returns Update status
+ */
+static lr11xx_fw_update_status_t main_host_run_uart_stream( uint32_t                   corrupt_period,
+                                                            lr11xx_fw_update_timing_t* update_timing );
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    lr11xx_simulator_timing_t timing;
+    uint32_t                  corrupt_period = 0;
+    bool                      is_up_to_date  = false;
+
+    lr11xx_simulator_get_default_timing( &timing );
+    if( main_host_parse_arguments( argc, argv, &timing, &corrupt_period, &is_up_to_date ) == false )
+    {
+        main_host_usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+#if defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+    printf( "LR11XX updater tool %s (host simulation)\n", DEMO_VERSION );
+    printf( "Update from a bundle of %u images\n", LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT );
+
+    return ( main_host_run_bundle( &timing, is_up_to_date ) == true ) ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+    lr11xx_simulator_firmware_type_t firmware_type;
+    uint16_t                         bootloader_version;
+    lr11xx_fw_update_timing_t        update_timing;
+    lr11xx_fw_update_status_t        status;
+    main_host_progress_t             progress = { .is_monotonic = true };
+
+#if defined( LR11XX_FIRMWARE_DIFF_FILE )
+    if( is_up_to_date == false )
+    {
+        printf( "LR11XX updater tool %s (host simulation)\n", DEMO_VERSION );
+        printf( "Differential update to firmware 0x%08x from firmware 0x%08x\n", LR11XX_FIRMWARE_VERSION,
+                lr11xx_firmware_diff.base_version );
+
+        return ( main_host_run_diff( &timing ) == true ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+#endif
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    lr11xx_simulator_init( &timing );
+    const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+    lr11xx_firmware_image_t decoded_image;
+
+    /* The chip boots the image once decoded: decode it a first time for the simulator, then again while flashing */
+    if( ( main_host_decode_image( &decoded_image ) == false ) ||
+        ( lr11xx_firmware_lz_init( &lr11xx_image_lz, lr11xx_firmware_image_lz, sizeof( lr11xx_firmware_image_lz ),
+                                   &lr11xx_image ) == false ) )
+    {
+        printf( "Corrupted compressed image\n" );
+        return EXIT_FAILURE;
+    }
+    printf( "Compressed image: %u bytes for %u bytes of firmware\n",
+            ( unsigned int ) sizeof( lr11xx_firmware_image_lz ),
+            ( unsigned int ) ( lr11xx_image.length_in_word * sizeof( uint32_t ) ) );
+    lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &decoded_image );
+#else
+    lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+#endif
+    if( is_up_to_date == true )
+    {
+        lr11xx_simulator_flash_firmware( chip, 0 );
+    }
+
+    system_init( );
+
+    printf( "LR11XX updater tool %s (host simulation)\n", DEMO_VERSION );
+    printf( "Update to firmware 0x%08x from %s\n", LR11XX_FIRMWARE_VERSION, IMAGE_HEADER_FILE );
+
+    lr11xx_update_firmware_set_progress_callback( main_host_on_progress, &progress );
+
+#if( LR11XX_UART_STREAM == 1 )
+    status = main_host_run_uart_stream( corrupt_period, &update_timing );
+#elif defined( LR11XX_FIRMWARE_DIFF_FILE )
+    status = lr11xx_update_firmware_diff( &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image,
+                                          &lr11xx_firmware_diff, &update_timing );
+#else
+    status = lr11xx_update_firmware( &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image,
+                                     &update_timing );
+#endif
+
+    /* The other runs are not reported */
+    lr11xx_update_firmware_set_progress_callback( NULL, NULL );
+
+    lr11xx_update_firmware_print_timing( &update_timing );
+
+    const bool is_clean = main_host_print_summary( status, chip );
+
+    /* In hundredths of a percent */
+    const uint32_t progress_cost =
+        ( update_timing.write_us != 0 ) ? ( uint32_t ) ( ( progress.cost_ns * 10 ) / update_timing.write_us ) : 0;
+    printf( " - Progress reports  = %u (%u.%02u %% of the write)\n", progress.report_count, progress_cost / 100,
+            progress_cost % 100 );
+#if( LR11XX_UART_STREAM == 1 )
+    lr11xx_uart_stream_host_stats_t stream_stats;
+
+    lr11xx_uart_stream_host_get_stats( &stream_stats );
+    printf( " - UART DATA frames  = %u (%u corrupted)\n", stream_stats.data_frame_count,
+            stream_stats.corrupted_count );
+    printf( " - UART ACK / NAK    = %u / %u\n", stream_stats.ack_count, stream_stats.nak_count );
+
+    if( ( stream_stats.is_done == false ) || ( stream_stats.done_status != ( uint8_t ) status ) )
+    {
+        printf( "Host did not receive the update status\n" );
+        return EXIT_FAILURE;
+    }
+#endif
+
+    if( ( main_host_check_status( status, chip, is_up_to_date ) == false ) || ( is_clean == false ) ||
+        ( main_host_check_progress( &progress, &update_timing ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+#if !defined( LR11XX_FIRMWARE_DIFF_FILE ) && !defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED ) && \
+    ( LR11XX_UART_STREAM != 1 )
+    if( ( bootloader_version == LR11XX_SIMULATOR_BOOTLOADER_LR1110 ) && ( is_up_to_date == false ) &&
+        ( main_host_run_hash( &timing ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+#endif
+
+#if !defined( LR11XX_FIRMWARE_DIFF_FILE ) && ( LR11XX_UART_STREAM != 1 )
+    /* A compressed image is rewound for each update, and for the whole flash to be written again */
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+    if( ( is_up_to_date == false ) && ( main_host_run_retry( &timing, &decoded_image ) == false ) )
+#else
+    if( ( is_up_to_date == false ) && ( main_host_run_retry( &timing, &lr11xx_image ) == false ) )
+#endif
+    {
+        return EXIT_FAILURE;
+    }
+#endif
+
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED ) && ( LR11XX_FW_UPDATE_VALIDATE == 1 ) && ( LR11XX_UART_STREAM != 1 )
+    if( ( is_up_to_date == false ) && ( main_host_run_compressed_check( &timing, &decoded_image ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+#endif
+
+#if !defined( LR11XX_FIRMWARE_DIFF_FILE ) && !defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED ) && \
+    ( LR11XX_UART_STREAM != 1 )
+    if( ( is_up_to_date == false ) && ( main_host_run_steps( &timing, &update_timing ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    if( ( is_up_to_date == false ) && ( main_host_run_display( &timing ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    if( ( is_up_to_date == false ) && ( main_host_run_spi_clock( &timing ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    if( ( is_up_to_date == false ) && ( main_host_run_spi_crc( &timing ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    if( ( is_up_to_date == false ) && ( main_host_run_station( &timing ) == false ) )
+    {
+        return EXIT_FAILURE;
+    }
+#endif
+
+    return EXIT_SUCCESS;
+#endif
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void main_host_usage( const char* name )
+{
+    printf( "Usage: %s [-s spi_clock_hz] [-e erase_busy_ms] [-w write_busy_us] [-r reset_busy_ms]"
+            " [-c corrupt_period] [-u is_up_to_date]\n",
+            name );
+}
+
+static void main_host_get_chip( lr11xx_fw_update_t update, uint16_t* bootloader_version,
+                                lr11xx_simulator_firmware_type_t* firmware_type )
+{
+    *bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1110;
+    *firmware_type      = LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER;
+
+    switch( update )
+    {
+    case LR1110_FIRMWARE_UPDATE_TO_TRX:
+        break;
+    case LR1110_FIRMWARE_UPDATE_TO_MODEM_V1:
+        *firmware_type = LR11XX_SIMULATOR_FIRMWARE_MODEM_V1;
+        break;
+    case LR1120_FIRMWARE_UPDATE_TO_TRX:
+        *bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1120;
+        break;
+    case LR1121_FIRMWARE_UPDATE_TO_TRX:
+        *bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1121;
+        break;
+    case LR1121_FIRMWARE_UPDATE_TO_MODEM_V2:
+        *firmware_type      = LR11XX_SIMULATOR_FIRMWARE_MODEM_V2;
+        *bootloader_version = LR11XX_SIMULATOR_BOOTLOADER_LR1121;
+        break;
+    }
+}
+
+static bool main_host_print_summary( lr11xx_fw_update_status_t status, int32_t chip )
+{
+    lr11xx_simulator_stats_t stats;
+
+    lr11xx_simulator_get_stats( chip, &stats );
+
+    printf( "Simulation summary:\n" );
+    printf( " - Update status     = %s\n", ( status == LR11XX_FW_UPDATE_OK )                  ? "OK"
+                                           : ( status == LR11XX_FW_UPDATE_WRONG_CHIP_TYPE )   ? "WRONG CHIP TYPE"
+                                           : ( status == LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE ) ? "ALREADY UP TO DATE"
+                                                                                              : "ERROR" );
+    printf( " - Virtual time      = %.3f ms\n", ( double ) lr11xx_simulator_get_time_ns( ) / 1000000.0 );
+    printf( " - SPI frames        = %u (%u bytes)\n", stats.frame_count, stats.byte_count );
+    printf( " - Flash erases      = %u (%u pages)\n", stats.erase_count, stats.page_erase_count );
+    printf( " - Flash writes      = %u (%u bytes)\n", stats.write_count, stats.write_byte_count );
+    printf( " - Image checks      = %u\n", stats.check_count );
+    printf( " - Chip BUSY time    = %.3f ms\n", ( double ) stats.busy_time_ns / 1000000.0 );
+    printf( " - BUSY violations   = %u\n", stats.busy_violation_count );
+    printf( " - Protocol errors   = %u\n", stats.error_count );
+
+    return ( stats.busy_violation_count == 0 ) && ( stats.error_count == 0 );
+}
+
+static bool main_host_check_status( lr11xx_fw_update_status_t status, int32_t chip, bool is_up_to_date )
+{
+    lr11xx_simulator_stats_t stats;
+
+    lr11xx_simulator_get_stats( chip, &stats );
+
+#if( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 )
+    if( is_up_to_date == true )
+    {
+        return ( status == LR11XX_FW_UPDATE_ALREADY_UP_TO_DATE ) && ( stats.erase_count == 0 );
+    }
+#else
+    ( void ) stats;
+    ( void ) is_up_to_date;
+#endif
+
+    return ( status == LR11XX_FW_UPDATE_OK );
+}
+
+#if !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+static void main_host_on_progress( const lr11xx_bootloader_progress_t* progress, void* context )
+{
+    main_host_progress_t* reports = ( main_host_progress_t* ) context;
+
+    lr11xx_update_firmware_print_progress( progress );
+
+    /* Printing is free on the host: charge the time the line takes on the board COM port */
+    const uint64_t cost_ns = ( uint64_t ) MAIN_HOST_PROGRESS_LINE_LENGTH * lr11xx_uart_stream_host_get_byte_ns( );
+    lr11xx_simulator_advance_ns( cost_ns );
+
+    reports->is_monotonic &= ( progress->written_in_byte > reports->written_in_byte );
+    reports->report_count++;
+    reports->written_in_byte = progress->written_in_byte;
+    reports->total_in_byte   = progress->total_in_byte;
+    reports->cost_ns += cost_ns;
+}
+
+static bool main_host_check_progress( const main_host_progress_t* progress, const lr11xx_fw_update_timing_t* timing )
+{
+    if( timing->write_us == 0 )
+    {
+        return ( progress->report_count == 0 );
+    }
+
+    /* One report per period at most, plus the last block */
+    const uint32_t report_max = ( timing->write_us / 1000 ) / LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS + 1;
+
+    if( ( progress->is_monotonic == false ) || ( progress->report_count == 0 ) ||
+        ( progress->report_count > report_max ) || ( progress->written_in_byte != progress->total_in_byte ) ||
+        ( ( progress->cost_ns * 100 ) >= ( ( uint64_t ) timing->write_us * 1000 ) ) )
+    {
+        printf( "Unexpected progress reports\n" );
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+#if defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED )
+static bool main_host_decode_image( lr11xx_firmware_image_t* image )
+{
+    lr11xx_firmware_image_t stream;
+    uint32_t*               words;
+    uint32_t                offset = 0;
+
+    if( lr11xx_firmware_lz_init( &lr11xx_image_lz, lr11xx_firmware_image_lz, sizeof( lr11xx_firmware_image_lz ),
+                                 &stream ) == false )
+    {
+        return false;
+    }
+
+    words = malloc( stream.length_in_word * sizeof( uint32_t ) );
+    if( words == NULL )
+    {
+        return false;
+    }
+
+    for( uint32_t length = lr11xx_firmware_image_get_block_length( &stream, offset ); length != 0;
+         length          = lr11xx_firmware_image_get_block_length( &stream, offset ) )
+    {
+        const uint8_t* block = lr11xx_firmware_image_get_block( &stream, offset, length, NULL );
+
+        if( block == NULL )
+        {
+            free( words );
+            return false;
+        }
+
+        memcpy( &words[offset], block, length * sizeof( uint32_t ) );
+        offset += length;
+    }
+
+    image->words          = words;
+    image->length_in_word = stream.length_in_word;
+    image->format         = LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER;
+
+    return true;
+}
+
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 ) && ( LR11XX_UART_STREAM != 1 )
+static bool main_host_run_compressed_check( const lr11xx_simulator_timing_t* timing,
+                                            const lr11xx_firmware_image_t*   decoded_image )
+{
+    lr11xx_simulator_firmware_type_t firmware_type;
+    uint16_t                         bootloader_version;
+    lr11xx_fw_update_timing_t        update_timing;
+    lr11xx_simulator_stats_t         stats;
+    lr11xx_firmware_image_t          running_image = *decoded_image;
+    uint32_t                         version       = 0;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    /* The chip runs an older transceiver firmware: the same image with its last word changed */
+    uint32_t* words = malloc( decoded_image->length_in_word * sizeof( uint32_t ) );
+    if( words == NULL )
+    {
+        return false;
+    }
+    memcpy( words, decoded_image->words, decoded_image->length_in_word * sizeof( uint32_t ) );
+    words[decoded_image->length_in_word - 1] ^= 0x01;
+    running_image.words = words;
+
+    /* A block in the middle of the image */
+    const uint32_t block_index = ( decoded_image->length_in_word / LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD ) / 2;
+
+    lr11xx_simulator_init( timing );
+    const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+    lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, decoded_image );
+    lr11xx_simulator_add_firmware( chip, LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER, LR11XX_FIRMWARE_VERSION - 1,
+                                   &running_image );
+    lr11xx_simulator_flash_firmware( chip, 1 );
+    lr11xx_simulator_reject_write( chip, block_index, LR11XX_FW_UPDATE_RETRY_COUNT_MAX + 1 );
+    system_init( );
+
+    printf( "\nChip running a transceiver firmware updated with the compressed image, one block failing every "
+            "retry\n" );
+
+    /* The image is decoded for the check, then for the write, then for the write once the block gave up */
+    const lr11xx_fw_update_status_t status = lr11xx_update_firmware_with_hash(
+        &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image, NULL, &update_timing );
+
+    lr11xx_update_firmware_print_timing( &update_timing );
+    const bool is_clean = main_host_print_summary( status, chip );
+
+    lr11xx_simulator_get_stats( chip, &stats );
+    const bool is_passed = ( is_clean == true ) && ( status == LR11XX_FW_UPDATE_OK ) && ( stats.check_count != 0 ) &&
+                           ( update_timing.reflash_count == 1 ) &&
+                           ( lr11xx_simulator_is_firmware_running( chip, &version ) == true ) &&
+                           ( version == LR11XX_FIRMWARE_VERSION );
+
+    free( words );
+
+    printf( "\nCompressed image check run: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+#endif
+#endif
+
+#if defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+static bool main_host_run_bundle( const lr11xx_simulator_timing_t* timing, bool is_up_to_date )
+{
+    static const uint16_t bootloader_versions[] = {
+        LR11XX_SIMULATOR_BOOTLOADER_LR1110,
+        LR11XX_SIMULATOR_BOOTLOADER_LR1120,
+        LR11XX_SIMULATOR_BOOTLOADER_LR1121,
+    };
+    lr11xx_fw_bundle_entry_t  corrupted[LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT];
+    lr11xx_fw_update_timing_t update_timing;
+    uint8_t                   run_count = 0;
+    bool                      is_passed = true;
+
+    for( uint8_t i = 0; i < ( sizeof( bootloader_versions ) / sizeof( bootloader_versions[0] ) ); i++ )
+    {
+        const lr11xx_fw_bundle_entry_t*  selected;
+        uint8_t                          firmware_count = 0;
+        lr11xx_simulator_firmware_type_t first_type     = LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER;
+
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_versions[i] );
+
+        /* The chip boots whichever of its images the bundle flashes */
+        for( uint8_t index = 0; index < LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT; index++ )
+        {
+            lr11xx_simulator_firmware_type_t firmware_type;
+            uint16_t                         bootloader_version;
+
+            main_host_get_chip( lr11xx_firmware_bundle[index].update, &bootloader_version, &firmware_type );
+            if( ( bootloader_version == bootloader_versions[i] ) &&
+                ( firmware_count < LR11XX_SIMULATOR_FIRMWARE_COUNT_MAX ) )
+            {
+                lr11xx_simulator_add_firmware( chip, firmware_type, lr11xx_firmware_bundle[index].fw_expected,
+                                               &lr11xx_firmware_bundle[index].image );
+                first_type = ( firmware_count == 0 ) ? firmware_type : first_type;
+                firmware_count++;
+            }
+        }
+
+        if( firmware_count == 0 )
+        {
+            continue;
+        }
+
+        /* The first image is the one the bundle selects, unless the kind requested rules it out */
+        const bool is_first_of_kind = ( LR11XX_FW_BUNDLE_KIND == LR11XX_FW_BUNDLE_KIND_ANY ) ||
+                                      ( ( LR11XX_FW_BUNDLE_KIND == LR11XX_FW_BUNDLE_KIND_MODEM ) ==
+                                        ( first_type != LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER ) );
+
+        if( is_up_to_date == true )
+        {
+            lr11xx_simulator_flash_firmware( chip, 0 );
+        }
+
+        system_init( );
+
+        printf( "\nChip with bootloader 0x%04x\n", bootloader_versions[i] );
+
+        const lr11xx_fw_update_status_t status =
+            lr11xx_update_firmware_from_bundle( &radio, lr11xx_firmware_bundle, LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT,
+                                                LR11XX_FW_BUNDLE_KIND, &selected, &update_timing );
+
+        if( ( selected == NULL ) && ( status == LR11XX_FW_UPDATE_WRONG_CHIP_TYPE ) )
+        {
+            /* Only images of another kind for this chip */
+            printf( "No image of the selected kind for this chip\n" );
+            continue;
+        }
+
+        lr11xx_update_firmware_print_timing( &update_timing );
+        if( ( main_host_print_summary( status, chip ) == false ) ||
+            ( main_host_check_status( status, chip, is_up_to_date && is_first_of_kind ) == false ) )
+        {
+            is_passed = false;
+        }
+
+        run_count++;
+    }
+
+    /* A damaged image must be refused while the chip still holds its previous firmware */
+    memcpy( corrupted, lr11xx_firmware_bundle, sizeof( corrupted ) );
+    corrupted[0].crc ^= 1;
+
+    uint16_t                         bootloader_version;
+    lr11xx_simulator_firmware_type_t firmware_type;
+    lr11xx_simulator_stats_t         stats;
+    const lr11xx_fw_bundle_entry_t*  selected;
+
+    main_host_get_chip( corrupted[0].update, &bootloader_version, &firmware_type );
+    lr11xx_simulator_init( timing );
+    const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+    system_init( );
+
+    printf( "\nChip with bootloader 0x%04x, image CRC corrupted\n", bootloader_version );
+
+    const lr11xx_fw_update_status_t status = lr11xx_update_firmware_from_bundle(
+        &radio, corrupted, 1, LR11XX_FW_BUNDLE_KIND_ANY, &selected, &update_timing );
+
+    lr11xx_simulator_get_stats( chip, &stats );
+    if( ( status != LR11XX_FW_UPDATE_ERROR ) || ( stats.erase_count != 0 ) )
+    {
+        printf( "Corrupted image not refused before the flash erase\n" );
+        is_passed = false;
+    }
+
+    if( main_host_run_damaged_image( timing ) == false )
+    {
+        is_passed = false;
+    }
+
+    printf( "\nBundle run on %u chips: %s\n", run_count, ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed && ( run_count != 0 );
+}
+#endif
+
+#if defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+static bool main_host_run_damaged_image( const lr11xx_simulator_timing_t* timing )
+{
+    const lr11xx_fw_bundle_entry_t*  trx = NULL;
+    const lr11xx_fw_bundle_entry_t*  selected;
+    lr11xx_fw_bundle_entry_t         damaged;
+    lr11xx_fw_update_timing_t        update_timing;
+    lr11xx_simulator_firmware_type_t firmware_type;
+    lr11xx_simulator_stats_t         stats;
+    uint16_t                         bootloader_version;
+
+    for( uint8_t index = 0; ( trx == NULL ) && ( index < LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT ); index++ )
+    {
+        main_host_get_chip( lr11xx_firmware_bundle[index].update, &bootloader_version, &firmware_type );
+        if( firmware_type == LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER )
+        {
+            trx = &lr11xx_firmware_bundle[index];
+        }
+    }
+
+    if( trx == NULL )
+    {
+        return true;
+    }
+
+    /* A newer firmware, as far as the version tells, with one word damaged in the middle of the image */
+    const uint32_t length_in_byte = trx->image.length_in_word * sizeof( uint32_t );
+    uint32_t*      words          = malloc( length_in_byte );
+
+    if( words == NULL )
+    {
+        return false;
+    }
+    memcpy( words, trx->image.words, length_in_byte );
+    words[trx->image.length_in_word / 2] ^= 0x00010000;
+
+    damaged             = *trx;
+    damaged.image.words = words;
+    damaged.fw_expected += 1;
+
+    lr11xx_simulator_init( timing );
+    const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+    lr11xx_simulator_add_firmware( chip, firmware_type, trx->fw_expected, &trx->image );
+    lr11xx_simulator_flash_firmware( chip, 0 );
+    system_init( );
+
+    printf( "\nChip with bootloader 0x%04x running firmware 0x%08x, image damaged\n", bootloader_version,
+            trx->fw_expected );
+
+    const lr11xx_fw_update_status_t status =
+        lr11xx_update_firmware_from_bundle( &radio, &damaged, 1, LR11XX_FW_BUNDLE_KIND_ANY, &selected, &update_timing );
+
+    free( words );
+    lr11xx_update_firmware_print_timing( &update_timing );
+    main_host_print_summary( status, chip );
+
+    lr11xx_simulator_get_stats( chip, &stats );
+    if( ( status != LR11XX_FW_UPDATE_ERROR ) || ( stats.erase_count != 0 ) )
+    {
+        printf( "Damaged image not refused before the flash erase\n" );
+        return false;
+    }
+#if( LR11XX_FW_UPDATE_VALIDATE == 1 )
+    if( ( stats.check_count == 0 ) || ( lr11xx_simulator_is_firmware_running( chip, NULL ) == false ) )
+    {
+        printf( "Damaged image not refused by the image check\n" );
+        return false;
+    }
+#endif
+
+    /* A streamed entry cannot be checked against its CRC without being consumed */
+    uint32_t read_count = 0;
+
+    damaged.image.format     = LR11XX_FIRMWARE_IMAGE_FORMAT_STREAM;
+    damaged.image.words      = NULL;
+    damaged.image.read_block = main_host_read_no_block;
+    damaged.image.context    = &read_count;
+
+    lr11xx_simulator_init( timing );
+    const int32_t streamed_chip = lr11xx_simulator_attach( &radio, bootloader_version );
+    lr11xx_simulator_add_firmware( streamed_chip, firmware_type, trx->fw_expected, &trx->image );
+    lr11xx_simulator_flash_firmware( streamed_chip, 0 );
+    system_init( );
+
+    printf( "\nChip with bootloader 0x%04x running firmware 0x%08x, bundle image streamed\n", bootloader_version,
+            trx->fw_expected );
+
+    const lr11xx_fw_update_status_t streamed_status =
+        lr11xx_update_firmware_from_bundle( &radio, &damaged, 1, LR11XX_FW_BUNDLE_KIND_ANY, &selected, &update_timing );
+
+    main_host_print_summary( streamed_status, streamed_chip );
+
+    lr11xx_simulator_get_stats( streamed_chip, &stats );
+    if( ( streamed_status != LR11XX_FW_UPDATE_ERROR ) || ( stats.erase_count != 0 ) || ( read_count != 0 ) )
+    {
+        printf( "Streamed bundle image not refused before being read\n" );
+        return false;
+    }
+
+    return true;
+}
+
+static const uint8_t* main_host_read_no_block( void* context, uint32_t offset_in_word, uint32_t length_in_word )
+{
+    ( *( uint32_t* ) context )++;
+
+    return NULL;
+}
+#endif
+
+#if !defined( LR11XX_FIRMWARE_DIFF_FILE ) && ( LR11XX_UART_STREAM != 1 ) && !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+static bool main_host_run_retry( const lr11xx_simulator_timing_t* timing,
+                                 const lr11xx_firmware_image_t*   flashed_image )
+{
+    static const char* const names[] = {
+        "one block failing twice",
+        "one block failing every retry",
+        "flash erase failing once",
+        "every block failing from the middle on",
+    };
+    /* Expected outcome of each run */
+    static const uint32_t block_retry_counts[] = { 2, LR11XX_FW_UPDATE_RETRY_COUNT_MAX, 0,
+                                                   2 * LR11XX_FW_UPDATE_RETRY_COUNT_MAX };
+    static const uint32_t reflash_counts[]     = { 0, 1, 0, 1 };
+    lr11xx_simulator_firmware_type_t firmware_type;
+    uint16_t                         bootloader_version;
+    lr11xx_fw_update_timing_t        update_timing;
+    lr11xx_simulator_stats_t         stats;
+    bool                             is_passed = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    /* A block in the middle of the image */
+    const uint32_t block_index = ( lr11xx_image.length_in_word / LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD ) / 2;
+
+    for( uint8_t run = 0; run < ( sizeof( names ) / sizeof( names[0] ) ); run++ )
+    {
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, flashed_image );
+        switch( run )
+        {
+        case 0:
+            lr11xx_simulator_reject_write( chip, block_index, 2 );
+            break;
+        case 1:
+            lr11xx_simulator_reject_write( chip, block_index, LR11XX_FW_UPDATE_RETRY_COUNT_MAX + 1 );
+            break;
+        case 2:
+            lr11xx_simulator_reject_erase( chip, 1 );
+            break;
+        default:
+            lr11xx_simulator_reject_write( chip, block_index, UINT32_MAX );
+            break;
+        }
+        system_init( );
+
+        printf( "\nChip updated with %s\n", names[run] );
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware_with_hash(
+            &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image, NULL, &update_timing );
+
+        lr11xx_update_firmware_print_timing( &update_timing );
+        const bool is_clean = main_host_print_summary( status, chip );
+
+        lr11xx_simulator_get_stats( chip, &stats );
+        printf( " - Failed on purpose = %u writes, %u erases\n", stats.write_reject_count, stats.erase_reject_count );
+
+        /* Only a block failing every retry has the whole flash erased again */
+        const bool is_running  = lr11xx_simulator_is_firmware_running( chip, NULL );
+        const bool is_last_run = ( run == ( ( sizeof( names ) / sizeof( names[0] ) ) - 1 ) );
+
+        if( ( is_clean == false ) || ( update_timing.block_retry_count != block_retry_counts[run] ) ||
+            ( update_timing.erase_retry_count != ( ( run == 2 ) ? 1 : 0 ) ) ||
+            ( update_timing.reflash_count != reflash_counts[run] ) ||
+            ( stats.erase_count != ( 1 + reflash_counts[run] ) ) ||
+            ( ( is_last_run == true ) ? ( ( status != LR11XX_FW_UPDATE_ERROR ) || ( is_running == true ) )
+                                      : ( ( status != LR11XX_FW_UPDATE_OK ) || ( is_running == false ) ) ) )
+        {
+            printf( "Unexpected outcome\n" );
+            is_passed = false;
+        }
+    }
+
+    printf( "\nBlock retry runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+#endif
+
+#if !defined( LR11XX_FIRMWARE_DIFF_FILE ) && !defined( LR11XX_FIRMWARE_IMAGE_COMPRESSED ) && \
+    ( LR11XX_UART_STREAM != 1 ) && !defined( LR11XX_FIRMWARE_BUNDLE_FILE )
+static bool main_host_run_hash( const lr11xx_simulator_timing_t* timing )
+{
+    static const char* const names[] = {
+        "expected hash",
+        "expected hash, one block damaged",
+        "wrong expected hash",
+    };
+    lr11xx_simulator_firmware_type_t firmware_type;
+    uint16_t                         bootloader_version;
+    lr11xx_fw_update_timing_t        update_timing;
+    lr11xx_simulator_stats_t         stats;
+    uint8_t                          hash[LR11XX_SIMULATOR_HASH_LENGTH];
+    bool                             is_passed = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+    lr11xx_simulator_get_image_hash( &lr11xx_image, hash );
+
+    for( uint8_t run = 0; run < ( sizeof( names ) / sizeof( names[0] ) ); run++ )
+    {
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        if( run == 1 )
+        {
+            /* A block in the middle of the image */
+            const uint32_t block_count = lr11xx_image.length_in_word / LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD;
+            lr11xx_simulator_corrupt_write( chip, block_count / 2 );
+        }
+        else if( run == 2 )
+        {
+            hash[0] ^= 0x01;
+        }
+        system_init( );
+
+        printf( "\nChip updated with %s\n", names[run] );
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware_with_hash(
+            &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image, hash, &update_timing );
+
+        lr11xx_update_firmware_print_timing( &update_timing );
+        const bool is_clean = main_host_print_summary( status, chip );
+
+        /* A mismatch is caught before the reboot: the flash is written again, or the chip left in bootloader mode */
+        lr11xx_simulator_get_stats( chip, &stats );
+        const bool is_running = lr11xx_simulator_is_firmware_running( chip, NULL );
+
+        if( ( is_clean == false ) || ( stats.erase_count != ( ( run == 0 ) ? 1 : 2 ) ) ||
+            ( update_timing.reflash_count != ( ( run == 0 ) ? 0 : 1 ) ) ||
+            ( ( run == 2 ) ? ( ( status != LR11XX_FW_UPDATE_ERROR ) || ( is_running == true ) )
+                           : ( ( status != LR11XX_FW_UPDATE_OK ) || ( is_running == false ) ) ) )
+        {
+            printf( "Unexpected outcome\n" );
+            is_passed = false;
+        }
+    }
+
+    printf( "\nFlash hash runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+
+static bool main_host_run_steps( const lr11xx_simulator_timing_t* timing,
+                                 const lr11xx_fw_update_timing_t* blocking_timing )
+{
+    /* Time the main loop spends elsewhere, in the display refresh for instance, between two steps */
+    static const uint32_t loop_us[] = { 100, 1000, 5000 };
+    static lr11xx_fw_update_session_t session;
+    lr11xx_simulator_firmware_type_t  firmware_type;
+    uint16_t                          bootloader_version;
+    lr11xx_fw_update_timing_t         update_timing;
+    bool                              is_passed = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    /* A step sends at most one block and waits for the chip to take it, or, on an LR1110, reads the flash hash while
+     * the driver waits for the chip to compute it. The block is timed at the default clock: the other steps, such as
+     * the modem version check, do not get any faster with the clock the link qualification locks in */
+    const uint32_t block_max_us =
+        blocking_timing->write_block_max_us +
+        ( uint32_t ) ( ( uint64_t ) LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD * sizeof( uint32_t ) * 8000000u /
+                       timing->spi_clock_hz );
+    const uint32_t step_max_us =
+        block_max_us +
+        ( ( bootloader_version == LR11XX_SIMULATOR_BOOTLOADER_LR1110 ) ? timing->hash_busy_ms * 1000u : 0 );
+
+    for( uint8_t run = 0; run < ( sizeof( loop_us ) / sizeof( loop_us[0] ) ); run++ )
+    {
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        system_init( );
+
+        printf( "\nChip updated step by step, %u us of main loop between steps\n", loop_us[run] );
+
+        uint32_t step_count  = 0;
+        uint64_t step_max    = 0;
+        bool     is_bus_idle = true;
+
+        lr11xx_update_firmware_start( &session, &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION,
+                                      &lr11xx_image, NULL, &update_timing );
+        while( true )
+        {
+            const uint64_t step_start = lr11xx_simulator_get_time_ns( );
+            const bool     is_running = lr11xx_update_firmware_step( &session );
+            const uint64_t step_ns    = lr11xx_simulator_get_time_ns( ) - step_start;
+
+            step_count++;
+            step_max = ( step_ns > step_max ) ? step_ns : step_max;
+            /* The display shares nothing with the chip between two steps: no transfer may be left running */
+            is_bus_idle &= system_spi_is_dma_done( radio.spi_device.spi );
+
+            if( is_running == false )
+            {
+                break;
+            }
+            lr11xx_simulator_advance_ns( ( uint64_t ) loop_us[run] * 1000u );
+        }
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware_get_status( &session, NULL );
+
+        lr11xx_update_firmware_print_timing( &update_timing );
+        const bool is_clean = main_host_print_summary( status, chip );
+
+        printf( " - Steps             = %u (longest %u us)\n", step_count, ( unsigned int ) ( step_max / 1000u ) );
+        printf( " - Total vs one call = %+d ms\n",
+                ( int ) ( ( ( int64_t ) update_timing.total_us - ( int64_t ) blocking_timing->total_us ) / 1000 ) );
+
+        if( ( is_clean == false ) || ( status != LR11XX_FW_UPDATE_OK ) ||
+            ( lr11xx_simulator_is_firmware_running( chip, NULL ) == false ) || ( is_bus_idle == false ) ||
+            ( step_max > ( ( uint64_t ) step_max_us * 1000u ) ) )
+        {
+            printf( "Unexpected outcome\n" );
+            is_passed = false;
+        }
+    }
+
+    printf( "\nStep by step runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+
+static bool main_host_run_display( const lr11xx_simulator_timing_t* timing )
+{
+    static const char* const names[] = {
+        "no display",
+        "display area sent in one go as soon as due",
+        "display area sent in segments while the chip is busy",
+    };
+    static lr11xx_fw_update_session_t session;
+    lr11xx_simulator_firmware_type_t  firmware_type;
+    uint16_t                          bootloader_version;
+    lr11xx_fw_update_timing_t         update_timing;
+    uint32_t                          total_us[sizeof( names ) / sizeof( names[0] )];
+    uint32_t                          refresh_count       = 0;
+    uint32_t                          write_refresh_count = 0;
+    uint32_t                          write_us            = 0;
+    bool                              is_passed           = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    const uint64_t byte_ns = 8000000000ull / timing->spi_clock_hz;
+
+    for( uint8_t run = 0; run < ( sizeof( names ) / sizeof( names[0] ) ); run++ )
+    {
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        system_init( );
+
+        printf( "\nChip updated step by step, %s\n", names[run] );
+
+        uint64_t due_ns        = 0;
+        uint32_t pending_bytes = 0;
+
+        refresh_count       = 0;
+        write_refresh_count = 0;
+        lr11xx_update_firmware_start( &session, &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION,
+                                      &lr11xx_image, NULL, &update_timing );
+        while( lr11xx_update_firmware_step( &session ) == true )
+        {
+            if( ( run != 0 ) && ( pending_bytes == 0 ) && ( lr11xx_simulator_get_time_ns( ) >= due_ns ) &&
+                ( ( run == 1 ) || ( lr11xx_update_firmware_is_waiting( &session ) == true ) ) )
+            {
+                pending_bytes = MAIN_HOST_DISPLAY_AREA_LENGTH;
+                due_ns        = lr11xx_simulator_get_time_ns( ) + LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS * 1000000ull;
+                refresh_count++;
+
+                /* The progress bar and the rate only change through the flash write */
+                if( ( session.state == LR11XX_FW_UPDATE_STATE_WRITE ) ||
+                    ( session.state == LR11XX_FW_UPDATE_STATE_COMMIT ) )
+                {
+                    write_refresh_count++;
+                }
+            }
+
+            /* The chip goes on with its command while the display holds the bus, the next step waiting for it */
+            uint32_t sent_bytes = pending_bytes;
+            if( ( run == 2 ) && ( sent_bytes > MAIN_HOST_DISPLAY_SEGMENT_LENGTH ) )
+            {
+                sent_bytes = MAIN_HOST_DISPLAY_SEGMENT_LENGTH;
+            }
+
+            lr11xx_simulator_advance_ns( sent_bytes * byte_ns );
+            pending_bytes -= sent_bytes;
+            lr11xx_simulator_advance_ns( 100000 );
+        }
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware_get_status( &session, NULL );
+
+        lr11xx_update_firmware_print_timing( &update_timing );
+        const bool is_clean = main_host_print_summary( status, chip );
+
+        total_us[run] = update_timing.total_us;
+        write_us      = update_timing.write_us;
+        printf( " - Display refreshes = %u of %u us, %u in the write\n", refresh_count,
+                ( unsigned int ) ( MAIN_HOST_DISPLAY_AREA_LENGTH * byte_ns / 1000u ), write_refresh_count );
+        printf( " - Total vs no display = %+d ms\n",
+                ( int ) ( ( ( int64_t ) total_us[run] - ( int64_t ) total_us[0] ) / 1000 ) );
+
+        if( ( is_clean == false ) || ( status != LR11XX_FW_UPDATE_OK ) ||
+            ( lr11xx_simulator_is_firmware_running( chip, NULL ) == false ) )
+        {
+            printf( "Unexpected outcome\n" );
+            is_passed = false;
+        }
+    }
+
+    /* Sent in segments while the chip is busy, the refreshes mostly hide behind it, the progress being drawn at least
+     * once every two periods through the write */
+    if( ( write_refresh_count == 0 ) ||
+        ( write_refresh_count < ( write_us / ( 2000u * LR11XX_FW_UPDATE_PROGRESS_PERIOD_MS ) ) ) ||
+        ( total_us[2] >= ( total_us[0] + total_us[0] / 100 ) ) )
+    {
+        printf( "Segmented display refreshes cost %d us, %u in the write\n", ( int ) ( total_us[2] - total_us[0] ),
+                write_refresh_count );
+        is_passed = false;
+    }
+
+    printf( "\nDisplay runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+
+static bool main_host_run_spi_clock( const lr11xx_simulator_timing_t* timing )
+{
+    /* Fastest clock read back reliably, in tenths of the default clock, 0 for no limit */
+    static const uint32_t link_max_tenths[] = { 0, 25, 12, 6, 3 };
+    /* Prescalers of the qualification, slowest first */
+    static const uint32_t prescalers[] = {
+        LL_SPI_BAUDRATEPRESCALER_DIV32, LL_SPI_BAUDRATEPRESCALER_DIV16, LL_SPI_BAUDRATEPRESCALER_DIV8,
+        LL_SPI_BAUDRATEPRESCALER_DIV4,  LL_SPI_BAUDRATEPRESCALER_DIV2,
+    };
+    lr11xx_simulator_timing_t        link_timing = *timing;
+    lr11xx_simulator_firmware_type_t firmware_type;
+    uint16_t                         bootloader_version;
+    lr11xx_fw_update_timing_t        update_timing;
+    bool                             is_passed = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    for( uint8_t run = 0; run < ( sizeof( link_max_tenths ) / sizeof( link_max_tenths[0] ) ); run++ )
+    {
+        link_timing.spi_clock_max_hz =
+            ( uint32_t ) ( ( ( uint64_t ) timing->spi_clock_hz * link_max_tenths[run] ) / 10 );
+
+        lr11xx_simulator_init( &link_timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        system_init( );
+
+        uint32_t expected_hz = system_spi_get_clock_hz( prescalers[0] );
+        for( uint8_t step = 1; step < ( sizeof( prescalers ) / sizeof( prescalers[0] ) ); step++ )
+        {
+            const uint32_t clock_hz = system_spi_get_clock_hz( prescalers[step] );
+
+            if( ( clock_hz > LR11XX_FW_UPDATE_SPI_CLOCK_MAX_HZ ) ||
+                ( ( link_timing.spi_clock_max_hz != 0 ) && ( clock_hz > link_timing.spi_clock_max_hz ) ) )
+            {
+                break;
+            }
+            expected_hz = clock_hz;
+        }
+
+        if( link_timing.spi_clock_max_hz == 0 )
+        {
+            printf( "\nChip updated over a link with no clock limit\n" );
+        }
+        else
+        {
+            printf( "\nChip updated over a link reliable up to %u kHz\n", link_timing.spi_clock_max_hz / 1000 );
+        }
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware(
+            &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image, &update_timing );
+
+        lr11xx_update_firmware_print_timing( &update_timing );
+        const bool is_clean = main_host_print_summary( status, chip );
+
+        if( ( is_clean == false ) || ( status != LR11XX_FW_UPDATE_OK ) ||
+            ( lr11xx_simulator_is_firmware_running( chip, NULL ) == false ) ||
+            ( update_timing.spi_clock_hz != expected_hz ) )
+        {
+            printf( "Unexpected outcome, SPI clock expected at %u kHz\n", expected_hz / 1000 );
+            is_passed = false;
+        }
+    }
+
+    printf( "\nSPI clock runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+
+static bool main_host_run_spi_crc( const lr11xx_simulator_timing_t* timing )
+{
+    /* Version reads: damaged responses, then damaged commands, as many as the HAL retries then one more */
+    static const uint32_t read_responses[] = { 2, 4, 0, 0 };
+    static const uint32_t read_commands[]  = { 0, 0, 2, 4 };
+#if( LR11XX_FW_UPDATE_SPI_CRC == 1 )
+    /* Updates: the last one damaging the first response and its three retries */
+    static const uint32_t damage_responses[] = { 2, 2, 0, 4 };
+    static const uint32_t damage_commands[]  = { 0, 0, 2, 0 };
+    static const bool     is_flashed[]       = { true, false, true, true };
+    /* Without the probe, the read failing every attempt would be the one of the final check */
+    const uint8_t             run_count = ( LR11XX_FW_UPDATE_SKIP_IF_CURRENT == 1 ) ? 4 : 3;
+    lr11xx_fw_update_timing_t update_timing;
+#endif
+    lr11xx_simulator_firmware_type_t firmware_type;
+    uint16_t                         bootloader_version;
+    bool                             is_passed = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    if( firmware_type != LR11XX_SIMULATOR_FIRMWARE_TRANSCEIVER )
+    {
+        printf( "\nSPI CRC runs: skipped, a modem firmware has no SPI CRC\n" );
+        return true;
+    }
+
+    /* The HAL reads again whatever the build: the CRC is enabled on the running firmware directly */
+    for( uint8_t run = 0; run < ( sizeof( read_responses ) / sizeof( read_responses[0] ) ); run++ )
+    {
+        lr11xx_simulator_stats_t stats;
+        lr11xx_system_version_t  version = { 0 };
+
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        lr11xx_simulator_flash_firmware( chip, 0 );
+        system_init( );
+
+        lr11xx_hal_reset( &radio );
+        system_gpio_wait_for_state( radio.busy, SYSTEM_GPIO_PIN_STATE_LOW );
+        lr11xx_system_enable_spi_crc( &radio, true );
+
+        lr11xx_simulator_corrupt_responses( chip, read_responses[run] );
+        lr11xx_simulator_corrupt_commands( chip, read_commands[run] );
+        const lr11xx_status_t status   = lr11xx_system_get_version( &radio, &version );
+        const bool            is_found = ( read_responses[run] + read_commands[run] ) < 4;
+
+        printf( "\nVersion read with %u responses and %u commands damaged: %s\n", read_responses[run],
+                read_commands[run], ( status == LR11XX_STATUS_OK ) ? "OK" : "ERROR" );
+
+        lr11xx_simulator_get_stats( chip, &stats );
+        if( ( ( status == LR11XX_STATUS_OK ) != is_found ) ||
+            ( ( is_found == true ) && ( version.fw != ( uint16_t ) LR11XX_FIRMWARE_VERSION ) ) ||
+            ( stats.corrupted_response_count != read_responses[run] ) ||
+            ( stats.corrupted_command_count != read_commands[run] ) || ( stats.error_count != 0 ) ||
+            ( stats.busy_violation_count != 0 ) )
+        {
+            printf( "Unexpected outcome, %u responses and %u commands damaged\n", stats.corrupted_response_count,
+                    stats.corrupted_command_count );
+            is_passed = false;
+        }
+    }
+
+    /* A read the HAL cannot tell is side-effect free is sent once: its error is left to the caller */
+    {
+        lr11xx_simulator_stats_t stats;
+        lr11xx_system_uid_t      uid;
+
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        lr11xx_simulator_flash_firmware( chip, 0 );
+        system_init( );
+
+        lr11xx_hal_reset( &radio );
+        system_gpio_wait_for_state( radio.busy, SYSTEM_GPIO_PIN_STATE_LOW );
+        lr11xx_system_enable_spi_crc( &radio, true );
+
+        lr11xx_simulator_corrupt_responses( chip, 2 );
+        const lr11xx_status_t status = lr11xx_system_read_uid( &radio, uid );
+
+        printf( "\nUID read with 2 responses damaged: %s\n", ( status == LR11XX_STATUS_OK ) ? "OK" : "ERROR" );
+
+        lr11xx_simulator_get_stats( chip, &stats );
+        if( ( status == LR11XX_STATUS_OK ) || ( stats.corrupted_response_count != 1 ) || ( stats.error_count != 0 ) ||
+            ( stats.busy_violation_count != 0 ) )
+        {
+            printf( "Unexpected outcome, %u responses damaged\n", stats.corrupted_response_count );
+            is_passed = false;
+        }
+    }
+
+#if( LR11XX_FW_UPDATE_SPI_CRC == 1 )
+    for( uint8_t run = 0; run < run_count; run++ )
+    {
+        lr11xx_simulator_stats_t stats;
+
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        if( is_flashed[run] == true )
+        {
+            lr11xx_simulator_flash_firmware( chip, 0 );
+        }
+        lr11xx_simulator_corrupt_responses( chip, damage_responses[run] );
+        lr11xx_simulator_corrupt_commands( chip, damage_commands[run] );
+        system_init( );
+
+        printf( "\n%s chip updated with %u responses and %u commands damaged\n",
+                ( is_flashed[run] == true ) ? "Up-to-date" : "Blank", damage_responses[run], damage_commands[run] );
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware(
+            &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image, &update_timing );
+
+        const bool is_clean = main_host_print_summary( status, chip );
+        lr11xx_simulator_get_stats( chip, &stats );
+
+        /* A read failing every attempt is a firmware not found running: the chip is updated again */
+        const bool is_status_expected = ( run == 3 ) ? ( status == LR11XX_FW_UPDATE_OK )
+                                                     : main_host_check_status( status, chip, is_flashed[run] );
+
+        if( ( is_clean == false ) || ( is_status_expected == false ) ||
+            ( lr11xx_simulator_is_firmware_running( chip, NULL ) == false ) ||
+            ( stats.corrupted_response_count != damage_responses[run] ) ||
+            ( stats.corrupted_command_count != damage_commands[run] ) )
+        {
+            printf( "Unexpected outcome, %u responses and %u commands damaged\n", stats.corrupted_response_count,
+                    stats.corrupted_command_count );
+            is_passed = false;
+        }
+    }
+#endif
+
+    printf( "\nSPI CRC runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+
+static bool main_host_run_station( const lr11xx_simulator_timing_t* timing )
+{
+    static const char* const names[] = {
+        "new module",
+        "module already up to date",
+        "module failing every flash write",
+        "new module",
+    };
+    static lr11xx_fw_update_session_t session;
+    static lr11xx_station_t           station;
+    lr11xx_simulator_firmware_type_t  firmware_type;
+    uint16_t                          bootloader_version;
+    lr11xx_fw_update_timing_t         update_timing;
+    int32_t                           chips[sizeof( names ) / sizeof( names[0] )];
+    const uint8_t                     unit_count = sizeof( names ) / sizeof( names[0] );
+    uint64_t                          detection_max_ns = 0;
+    bool                              is_passed        = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+
+    /* One chip per module, all wired to the same pins and inserted one after the other */
+    lr11xx_simulator_init( timing );
+    for( uint8_t unit = 0; unit < unit_count; unit++ )
+    {
+        chips[unit] = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chips[unit], firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        lr11xx_simulator_set_present( chips[unit], false );
+    }
+    lr11xx_simulator_flash_firmware( chips[1], 0 );
+    lr11xx_simulator_reject_write( chips[2], 1, UINT32_MAX );
+    system_init( );
+
+    printf( "\nStation run over %u modules\n", unit_count );
+
+    lr11xx_station_init( &station, &radio );
+
+    /* Nothing in place yet */
+    if( main_host_step_station( &station, MAIN_HOST_STATION_HANDLING_MS ) != LR11XX_STATION_EVENT_NONE )
+    {
+        printf( "Module seen while none is inserted\n" );
+        is_passed = false;
+    }
+
+    for( uint8_t unit = 0; unit < unit_count; unit++ )
+    {
+        printf( "\nStation updates a %s\n", names[unit] );
+
+        lr11xx_simulator_set_present( chips[unit], true );
+        uint64_t start_ns = lr11xx_simulator_get_time_ns( );
+
+        if( main_host_step_station( &station, MAIN_HOST_STATION_DETECTION_TIMEOUT_MS ) !=
+            LR11XX_STATION_EVENT_INSERTED )
+        {
+            printf( "Module not seen once inserted\n" );
+            is_passed = false;
+            break;
+        }
+        detection_max_ns = ( ( lr11xx_simulator_get_time_ns( ) - start_ns ) > detection_max_ns )
+                               ? ( lr11xx_simulator_get_time_ns( ) - start_ns )
+                               : detection_max_ns;
+
+        lr11xx_update_firmware_start( &session, &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION,
+                                      &lr11xx_image, NULL, &update_timing );
+        while( lr11xx_update_firmware_step( &session ) == true )
+        {
+            lr11xx_simulator_advance_ns( 100000 );
+        }
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware_get_status( &session, NULL );
+
+        lr11xx_station_end_update( &station, status, &update_timing );
+        lr11xx_station_print_stats( &station.stats );
+
+        const bool is_clean   = main_host_print_summary( status, chips[unit] );
+        const bool is_running = lr11xx_simulator_is_firmware_running( chips[unit], NULL );
+
+        if( ( is_clean == false ) ||
+            ( ( unit == 2 ) ? ( ( status != LR11XX_FW_UPDATE_ERROR ) || ( is_running == true ) )
+                            : ( ( main_host_check_status( status, chips[unit], unit == 1 ) == false ) ||
+                                ( is_running == false ) ) ) )
+        {
+            printf( "Unexpected outcome\n" );
+            is_passed = false;
+        }
+
+        /* The module stays in place a while, then is taken out */
+        if( main_host_step_station( &station, MAIN_HOST_STATION_HANDLING_MS ) != LR11XX_STATION_EVENT_NONE )
+        {
+            printf( "Module seen removed while still in place\n" );
+            is_passed = false;
+        }
+
+        lr11xx_simulator_set_present( chips[unit], false );
+        start_ns = lr11xx_simulator_get_time_ns( );
+
+        if( main_host_step_station( &station, MAIN_HOST_STATION_DETECTION_TIMEOUT_MS ) !=
+            LR11XX_STATION_EVENT_REMOVED )
+        {
+            printf( "Module not seen once removed\n" );
+            is_passed = false;
+            break;
+        }
+        detection_max_ns = ( ( lr11xx_simulator_get_time_ns( ) - start_ns ) > detection_max_ns )
+                               ? ( lr11xx_simulator_get_time_ns( ) - start_ns )
+                               : detection_max_ns;
+    }
+
+    const lr11xx_station_stats_t* stats = &station.stats;
+
+    printf( "\nStation summary:\n" );
+    printf( " - Units             = %u (%u passed, %u failed)\n", stats->unit_count, stats->pass_count,
+            stats->fail_count );
+    printf( " - Update time       = mean %u ms, p95 %u ms\n", lr11xx_station_get_mean_ms( stats ),
+            lr11xx_station_get_p95_ms( stats ) );
+    printf( " - Detection latency = %u ms at most\n", ( unsigned int ) ( detection_max_ns / 1000000u ) );
+    printf( " - Virtual time      = %.3f ms\n", ( double ) lr11xx_simulator_get_time_ns( ) / 1000000.0 );
+
+    if( ( stats->unit_count != unit_count ) || ( stats->pass_count != ( unit_count - 1u ) ) ||
+        ( stats->fail_count != 1 ) || ( lr11xx_station_get_p95_ms( stats ) < lr11xx_station_get_mean_ms( stats ) ) )
+    {
+        printf( "Unexpected statistics\n" );
+        is_passed = false;
+    }
+
+    printf( "\nStation runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+
+static lr11xx_station_event_t main_host_step_station( lr11xx_station_t* station, uint32_t timeout_ms )
+{
+    const uint64_t end_ns = lr11xx_simulator_get_time_ns( ) + ( uint64_t ) timeout_ms * 1000000u;
+
+    while( lr11xx_simulator_get_time_ns( ) < end_ns )
+    {
+        const lr11xx_station_event_t event = lr11xx_station_step( station );
+
+        if( event != LR11XX_STATION_EVENT_NONE )
+        {
+            return event;
+        }
+
+        /* One turn of the main loop, the display refresh included */
+        lr11xx_simulator_advance_ns( 1000000u );
+    }
+
+    return LR11XX_STATION_EVENT_NONE;
+}
+#endif
+
+#if defined( LR11XX_FIRMWARE_DIFF_FILE )
+static bool main_host_run_diff( const lr11xx_simulator_timing_t* timing )
+{
+    static const char* const names[] = {
+        "running the base firmware, no expected hash",
+        "running the base firmware, expected hash",
+        "running the base firmware, wrong expected hash",
+        "blank",
+    };
+    const lr11xx_firmware_image_t base_image = {
+        .words          = lr11xx_firmware_diff_base_image,
+        .length_in_word = LR11XX_FIRMWARE_DIFF_BASE_LENGTH_IN_WORD,
+        .format         = LR11XX_FIRMWARE_IMAGE_FORMAT_HOST_ORDER,
+    };
+    lr11xx_simulator_firmware_type_t firmware_type;
+    lr11xx_simulator_firmware_type_t base_type;
+    uint16_t                         bootloader_version;
+    uint16_t                         base_bootloader_version;
+    lr11xx_fw_update_timing_t        update_timing;
+    lr11xx_simulator_stats_t         stats;
+    lr11xx_fw_diff_t                 diff      = lr11xx_firmware_diff;
+    bool                             is_passed = true;
+
+    main_host_get_chip( LR11XX_FIRMWARE_UPDATE_TO, &bootloader_version, &firmware_type );
+    main_host_get_chip( lr11xx_firmware_diff.update, &base_bootloader_version, &base_type );
+
+    for( uint8_t run = 0; run < ( sizeof( names ) / sizeof( names[0] ) ); run++ )
+    {
+        uint32_t version = 0;
+
+        if( run == 1 )
+        {
+            lr11xx_simulator_get_image_hash( &lr11xx_image, diff.hash );
+        }
+        else if( run == 2 )
+        {
+            diff.hash[0] ^= 0x01;
+        }
+        else if( run == 3 )
+        {
+            diff.hash[0] ^= 0x01;
+        }
+
+        lr11xx_simulator_init( timing );
+        const int32_t chip = lr11xx_simulator_attach( &radio, bootloader_version );
+        lr11xx_simulator_add_firmware( chip, firmware_type, LR11XX_FIRMWARE_VERSION, &lr11xx_image );
+        lr11xx_simulator_add_firmware( chip, base_type, lr11xx_firmware_diff.base_version, &base_image );
+        if( run != 3 )
+        {
+            lr11xx_simulator_flash_firmware( chip, 1 );
+        }
+        system_init( );
+
+        printf( "\nChip %s\n", names[run] );
+
+        const lr11xx_fw_update_status_t status = lr11xx_update_firmware_diff(
+            &radio, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION, &lr11xx_image, &diff, &update_timing );
+
+        lr11xx_update_firmware_print_timing( &update_timing );
+        const bool is_clean = main_host_print_summary( status, chip );
+
+        /* Pages erased one by one and a full erase are exclusive, except when the hash mismatched: the chip is then
+         * left in bootloader mode once the flash is written again. Without the expected hash, the flash is fully
+         * written */
+        lr11xx_simulator_get_stats( chip, &stats );
+        const bool is_running        = lr11xx_simulator_is_firmware_running( chip, &version );
+        const bool is_erase_expected = ( run != 1 ) || ( update_timing.erase_page_count == 0 );
+        const bool is_outcome_expected =
+            ( run == 2 ) ? ( ( status == LR11XX_FW_UPDATE_ERROR ) && ( is_running == false ) )
+                         : ( ( status == LR11XX_FW_UPDATE_OK ) && ( is_running == true ) &&
+                             ( version == LR11XX_FIRMWARE_VERSION ) );
+
+        if( ( is_clean == false ) || ( is_outcome_expected == false ) ||
+            ( ( stats.erase_count != 0 ) != is_erase_expected ) ||
+            ( ( ( run == 0 ) || ( run == 3 ) ) && ( stats.page_erase_count != 0 ) ) )
+        {
+            printf( "Unexpected outcome\n" );
+            is_passed = false;
+        }
+    }
+
+    printf( "\nDifferential update runs: %s\n", ( is_passed == true ) ? "OK" : "FAILED" );
+
+    return is_passed;
+}
+#endif
+
+#if( LR11XX_UART_STREAM == 1 )
+static lr11xx_fw_update_status_t main_host_run_uart_stream( uint32_t                   corrupt_period,
+                                                            lr11xx_fw_update_timing_t* update_timing )
+{
+    lr11xx_uart_stream_start_t start;
+    lr11xx_firmware_image_t    image;
+
+    lr11xx_uart_stream_host_init( &lr11xx_image, LR11XX_FIRMWARE_UPDATE_TO, LR11XX_FIRMWARE_VERSION,
+                                  corrupt_period );
+    lr11xx_uart_stream_init( );
+
+    while( lr11xx_uart_stream_get_start( &start ) == false )
+    {
+        if( lr11xx_uart_stream_host_get_next_rx_ns( ) == UINT64_MAX )
+        {
+            fprintf( stderr, "host: deadlock waiting for the START frame\n" );
+            exit( EXIT_FAILURE );
+        }
+        system_uart_wait_for_receive( );
+    }
+
+    lr11xx_uart_stream_get_image( &start, &image );
+
+    const lr11xx_fw_update_status_t status =
+        lr11xx_update_firmware( &radio, start.update, start.fw_expected, &image, update_timing );
+
+    lr11xx_uart_stream_finish( status );
+
+    return status;
+}
+#endif
+
+static bool main_host_parse_arguments( int argc, char** argv, lr11xx_simulator_timing_t* timing,
+                                       uint32_t* corrupt_period, bool* is_up_to_date )
+{
+    for( int i = 1; i < argc; i++ )
+    {
+        uint32_t value;
+        char*    end;
+
+        if( ( strlen( argv[i] ) != 2 ) || ( argv[i][0] != '-' ) || ( ( i + 1 ) >= argc ) )
+        {
+            return false;
+        }
+
+        value = ( uint32_t ) strtoul( argv[i + 1], &end, 0 );
+        if( *end != '\0' )
+        {
+            return false;
+        }
+
+        switch( argv[i][1] )
+        {
+        case 's':
+            if( value == 0 )
+            {
+                return false;
+            }
+            timing->spi_clock_hz = value;
+            break;
+        case 'e':
+            timing->erase_busy_ms = value;
+            break;
+        case 'w':
+            timing->write_busy_us = value;
+            break;
+        case 'r':
+            timing->reset_busy_ms = value;
+            break;
+        case 'c':
+            *corrupt_period = value;
+            break;
+        case 'u':
+            *is_up_to_date = ( value != 0 );
+            break;
+        default:
+            return false;
+        }
+
+        i++;
+    }
+
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
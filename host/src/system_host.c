@@ -0,0 +1,521 @@
+/*!
+ * @file      system_host.c
+ *
+ * @brief     MCU system layer of the host build, driven by the LR11xx simulator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "system.h"
+#include "lr11xx_simulator.h"
+#include "lr11xx_uart_stream_host.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Number of MCU output pins tracked by the host build
+ */
+#define SYSTEM_HOST_PIN_COUNT_MAX ( 48 )
+
+/*!
+ * @brief Core clock of the simulated MCU, the cycle counter runs at this rate
+ */
+#define SYSTEM_HOST_CORE_CLOCK_MHZ ( 80 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct
+{
+    gpio_t gpio;
+    bool   is_output;
+    bool   is_high;
+} system_host_pin_t;
+
+typedef struct
+{
+    SPI_TypeDef*              spi;
+    const uint8_t*            buffer;
+    uint16_t                  length;
+    uint64_t                  end_ns;  //!< Virtual time at which the last byte leaves the bus
+    system_spi_dma_callback_t callback;
+    void*                     callback_context;
+    bool                      is_in_flight;
+} system_host_dma_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static system_host_pin_t system_host_pins[SYSTEM_HOST_PIN_COUNT_MAX];
+static uint8_t           system_host_pin_count;
+
+static system_host_dma_t system_host_dma;
+
+static system_uart_rx_callback_t system_host_uart_rx_callback = NULL;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Let virtual time run, delivering to the UART callback the bytes received meanwhile
+ *
+ * @param [in] duration_ns Duration in ns
+ */
+static void system_host_advance_ns( uint64_t duration_ns );
+
+static system_host_pin_t* system_host_get_pin( gpio_t gpio );
+
+static void system_host_wait_for_edge( gpio_t gpio, system_gpio_pin_state_t state, uint32_t wake_up_ns );
+
+static void system_host_complete_dma( void );
+
+static void system_host_check_dma_idle( const char* reason );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void system_init( void )
+{
+    system_clock_init( );
+    system_gpio_init( );
+    system_spi_init( );
+    system_spi_dma_init( );
+    system_time_init( );
+    system_uart_init( );
+}
+
+void system_clock_init( void ) {}
+
+void system_gpio_init( void )
+{
+    system_host_pin_count = 0;
+}
+
+void system_gpio_set_pin_state( gpio_t gpio, const system_gpio_pin_state_t state )
+{
+    system_host_pin_t* pin = system_host_get_pin( gpio );
+
+    system_host_check_dma_idle( "GPIO written while a DMA transfer is in flight" );
+
+    system_host_advance_ns( lr11xx_simulator_get_timing( )->gpio_access_ns );
+
+    pin->is_high = ( state == SYSTEM_GPIO_PIN_STATE_HIGH );
+    lr11xx_simulator_set_pin( gpio, pin->is_high );
+}
+
+system_gpio_pin_state_t system_gpio_get_pin_state( gpio_t gpio )
+{
+    bool is_high;
+
+    system_host_advance_ns( lr11xx_simulator_get_timing( )->gpio_access_ns );
+
+    if( lr11xx_simulator_is_chip_pin( gpio ) == true )
+    {
+        is_high = lr11xx_simulator_get_pin( gpio );
+    }
+    else
+    {
+        is_high = system_host_get_pin( gpio )->is_high;
+    }
+
+    return ( is_high == true ) ? SYSTEM_GPIO_PIN_STATE_HIGH : SYSTEM_GPIO_PIN_STATE_LOW;
+}
+
+void system_gpio_init_direction_state( const gpio_t gpio, const system_gpio_pin_direction_t direction,
+                                       const system_gpio_pin_state_t state )
+{
+    system_host_pin_t* pin = system_host_get_pin( gpio );
+
+    pin->is_output = ( direction == SYSTEM_GPIO_PIN_DIRECTION_OUTPUT );
+    pin->is_high   = ( state == SYSTEM_GPIO_PIN_STATE_HIGH );
+
+    lr11xx_simulator_set_pin_direction( gpio, pin->is_output, pin->is_high );
+}
+
+void system_gpio_wait_for_state( gpio_t io, uint8_t state )
+{
+    /* Polling loop: the edge is seen at the next read of the pin */
+    system_host_wait_for_edge( io, ( system_gpio_pin_state_t ) state, lr11xx_simulator_get_timing( )->gpio_access_ns );
+}
+
+void system_gpio_wait_for_state_irq( gpio_t gpio, system_gpio_pin_state_t state )
+{
+    system_host_wait_for_edge( gpio, state, lr11xx_simulator_get_timing( )->irq_latency_ns );
+}
+
+bool system_gpio_wait_for_state_timeout( gpio_t gpio, system_gpio_pin_state_t state, uint32_t timeout_ms )
+{
+    const uint64_t timeout_ns = ( uint64_t ) timeout_ms * 1000000;
+    const uint64_t start_ns   = lr11xx_simulator_get_time_ns( );
+    const bool     is_high    = ( state == SYSTEM_GPIO_PIN_STATE_HIGH );
+    uint64_t       edge_ns;
+
+    system_host_advance_ns( lr11xx_simulator_get_timing( )->gpio_access_ns );
+
+    if( lr11xx_simulator_is_chip_pin( gpio ) == true )
+    {
+        edge_ns = lr11xx_simulator_get_pin_edge_ns( gpio, is_high );
+    }
+    else
+    {
+        edge_ns = ( system_host_get_pin( gpio )->is_high == is_high ) ? lr11xx_simulator_get_time_ns( ) : UINT64_MAX;
+    }
+
+    /* Unlike the unbounded waits, a pin that never changes only costs the timeout */
+    if( ( edge_ns == UINT64_MAX ) || ( edge_ns >= ( start_ns + timeout_ns ) ) )
+    {
+        if( ( start_ns + timeout_ns ) > lr11xx_simulator_get_time_ns( ) )
+        {
+            system_host_advance_ns( start_ns + timeout_ns - lr11xx_simulator_get_time_ns( ) );
+        }
+        return false;
+    }
+
+    if( edge_ns > lr11xx_simulator_get_time_ns( ) )
+    {
+        system_host_advance_ns( edge_ns - lr11xx_simulator_get_time_ns( ) +
+                                lr11xx_simulator_get_timing( )->gpio_access_ns );
+    }
+
+    return true;
+}
+
+void system_spi_init( void ) {}
+
+void system_spi_set_prescaler( SPI_TypeDef* spi, uint32_t prescaler )
+{
+    lr11xx_simulator_set_spi_clock( system_spi_get_clock_hz( prescaler ) );
+}
+
+/* The simulated chip only takes 8-bit frames: 16-bit ones are for the display, which is not simulated */
+void system_spi_set_data_width( SPI_TypeDef* spi, uint32_t data_width ) {}
+
+uint32_t system_spi_get_clock_hz( uint32_t prescaler )
+{
+    /* The timing model gives the clock at the default prescaler, 8 */
+    return ( uint32_t )( ( ( uint64_t ) lr11xx_simulator_get_timing( )->spi_clock_hz * 8 ) >>
+                         ( 1 + ( prescaler >> SPI_CR1_BR_Pos ) ) );
+}
+
+void system_spi_write( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length )
+{
+    const lr11xx_simulator_timing_t* timing = lr11xx_simulator_get_timing( );
+
+    system_host_check_dma_idle( "polled SPI transfer while a DMA transfer is in flight" );
+
+    system_host_advance_ns( timing->spi_call_overhead_ns );
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        lr11xx_simulator_spi_exchange( spi, buffer[i] );
+        system_host_advance_ns( lr11xx_simulator_get_spi_byte_ns( ) + timing->spi_polled_byte_overhead_ns );
+    }
+}
+
+void system_spi_read_with_dummy_byte( SPI_TypeDef* spi, uint8_t* buffer, uint16_t length, uint8_t dummy_byte )
+{
+    const lr11xx_simulator_timing_t* timing = lr11xx_simulator_get_timing( );
+
+    system_host_check_dma_idle( "polled SPI transfer while a DMA transfer is in flight" );
+
+    system_host_advance_ns( timing->spi_call_overhead_ns );
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        buffer[i] = lr11xx_simulator_spi_exchange( spi, dummy_byte );
+        system_host_advance_ns( lr11xx_simulator_get_spi_byte_ns( ) + timing->spi_polled_byte_overhead_ns );
+    }
+}
+
+void system_spi_dma_init( void )
+{
+    system_host_dma.is_in_flight = false;
+}
+
+void system_spi_write_dma( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length )
+{
+    system_spi_write_dma_with_callback( spi, buffer, length, NULL, NULL );
+}
+
+void system_spi_write_dma_with_callback( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length,
+                                         system_spi_dma_callback_t callback, void* context )
+{
+    system_host_check_dma_idle( "DMA transfer started while another one is in flight" );
+
+    system_host_advance_ns( lr11xx_simulator_get_timing( )->spi_dma_setup_ns );
+
+    /* The bytes are handed to the chip when the transfer completes, so that a buffer modified while in flight is seen
+     * by the chip the same way it would be on the bus */
+    system_host_dma.spi              = spi;
+    system_host_dma.buffer           = buffer;
+    system_host_dma.length           = length;
+    system_host_dma.end_ns =
+        lr11xx_simulator_get_time_ns( ) + ( uint64_t ) length * lr11xx_simulator_get_spi_byte_ns( );
+    system_host_dma.callback         = callback;
+    system_host_dma.callback_context = context;
+    system_host_dma.is_in_flight     = true;
+}
+
+bool system_spi_is_dma_done( SPI_TypeDef* spi )
+{
+    system_host_advance_ns( lr11xx_simulator_get_timing( )->gpio_access_ns );
+
+    if( ( system_host_dma.is_in_flight == true ) && ( lr11xx_simulator_get_time_ns( ) >= system_host_dma.end_ns ) )
+    {
+        system_host_complete_dma( );
+    }
+
+    return ( system_host_dma.is_in_flight == false ) || ( system_host_dma.spi != spi );
+}
+
+void system_spi_wait_dma( SPI_TypeDef* spi )
+{
+    if( ( system_host_dma.is_in_flight == false ) || ( system_host_dma.spi != spi ) )
+    {
+        return;
+    }
+
+    if( lr11xx_simulator_get_time_ns( ) < system_host_dma.end_ns )
+    {
+        system_host_advance_ns( system_host_dma.end_ns - lr11xx_simulator_get_time_ns( ) +
+                                     lr11xx_simulator_get_timing( )->irq_latency_ns );
+    }
+
+    system_host_complete_dma( );
+}
+
+void system_spi_dma_irq_handler( void ) {}
+
+void system_time_init( void ) {}
+
+void system_time_wait_ms( uint32_t time_in_ms )
+{
+    system_host_check_dma_idle( "blocking wait while a DMA transfer is in flight" );
+
+    system_host_advance_ns( ( uint64_t ) time_in_ms * 1000000 );
+}
+
+void system_time_IncreaseTicker( void ) {}
+
+uint32_t system_time_GetTicker( void )
+{
+    return ( uint32_t )( lr11xx_simulator_get_time_ns( ) / 1000000 );
+}
+
+uint32_t system_time_get_cycles( void )
+{
+    return ( uint32_t )( ( lr11xx_simulator_get_time_ns( ) * SYSTEM_HOST_CORE_CLOCK_MHZ ) / 1000 );
+}
+
+uint32_t system_time_cycles_to_us( uint64_t cycles )
+{
+    return ( uint32_t )( cycles / SYSTEM_HOST_CORE_CLOCK_MHZ );
+}
+
+void system_uart_init( void ) {}
+
+int32_t system_uart_send_char( int32_t ch )
+{
+    /* Console output is printed as is, only the bytes sent to a simulated host take time on the line */
+    if( lr11xx_uart_stream_host_is_active( ) == false )
+    {
+        return putchar( ( int ) ch );
+    }
+
+    system_host_advance_ns( lr11xx_uart_stream_host_get_byte_ns( ) );
+    lr11xx_uart_stream_host_on_tx( ( uint8_t ) ch, lr11xx_simulator_get_time_ns( ) );
+
+    return ch;
+}
+
+int32_t system_uart_receive_char( void )
+{
+    return getchar( );
+}
+
+void system_uart_flush( void )
+{
+    fflush( stdout );
+}
+
+void system_uart_start_receive( system_uart_rx_callback_t callback )
+{
+    system_host_uart_rx_callback = callback;
+}
+
+void system_uart_stop_receive( void )
+{
+    system_host_uart_rx_callback = NULL;
+}
+
+void system_uart_wait_for_receive( void )
+{
+    const uint64_t now_ns = lr11xx_simulator_get_time_ns( );
+    const uint64_t rx_ns  = lr11xx_uart_stream_host_get_next_rx_ns( );
+    uint64_t       wake_ns;
+
+    /* Woken up by the next byte received, or by the 1 ms tick at the latest */
+    wake_ns = ( ( now_ns / 1000000 ) + 1 ) * 1000000;
+    if( rx_ns < wake_ns )
+    {
+        wake_ns = ( rx_ns > now_ns ) ? rx_ns : now_ns;
+    }
+
+    system_host_advance_ns( wake_ns - now_ns + lr11xx_simulator_get_timing( )->irq_latency_ns );
+}
+
+void system_uart_irq_handler( void ) {}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void system_host_advance_ns( uint64_t duration_ns )
+{
+    lr11xx_simulator_advance_ns( duration_ns );
+
+    while( ( system_host_uart_rx_callback != NULL ) &&
+           ( lr11xx_uart_stream_host_get_next_rx_ns( ) <= lr11xx_simulator_get_time_ns( ) ) )
+    {
+        system_host_uart_rx_callback( lr11xx_uart_stream_host_pop_rx( ) );
+    }
+}
+
+static system_host_pin_t* system_host_get_pin( gpio_t gpio )
+{
+    for( uint8_t i = 0; i < system_host_pin_count; i++ )
+    {
+        if( ( system_host_pins[i].gpio.port == gpio.port ) && ( system_host_pins[i].gpio.pin == gpio.pin ) )
+        {
+            return &system_host_pins[i];
+        }
+    }
+
+    if( system_host_pin_count >= SYSTEM_HOST_PIN_COUNT_MAX )
+    {
+        fprintf( stderr, "host: too many GPIOs in use\n" );
+        exit( EXIT_FAILURE );
+    }
+
+    /* Pins not configured yet read as high: NSS and RESET are pulled up on the boards */
+    system_host_pins[system_host_pin_count].gpio      = gpio;
+    system_host_pins[system_host_pin_count].is_output = false;
+    system_host_pins[system_host_pin_count].is_high   = true;
+
+    return &system_host_pins[system_host_pin_count++];
+}
+
+static void system_host_wait_for_edge( gpio_t gpio, system_gpio_pin_state_t state, uint32_t wake_up_ns )
+{
+    const bool is_high = ( state == SYSTEM_GPIO_PIN_STATE_HIGH );
+    uint64_t   edge_ns;
+
+    /* The pin is read once before deciding to wait */
+    system_host_advance_ns( lr11xx_simulator_get_timing( )->gpio_access_ns );
+
+    if( lr11xx_simulator_is_chip_pin( gpio ) == true )
+    {
+        edge_ns = lr11xx_simulator_get_pin_edge_ns( gpio, is_high );
+    }
+    else
+    {
+        edge_ns = ( system_host_get_pin( gpio )->is_high == is_high ) ? lr11xx_simulator_get_time_ns( ) : UINT64_MAX;
+    }
+
+    if( edge_ns == UINT64_MAX )
+    {
+        /* Nothing is ever going to change the pin: on target, the MCU would hang there */
+        fprintf( stderr, "host: deadlock waiting for a GPIO to go %s\n", ( is_high == true ) ? "high" : "low" );
+        exit( EXIT_FAILURE );
+    }
+
+    if( edge_ns > lr11xx_simulator_get_time_ns( ) )
+    {
+        system_host_advance_ns( edge_ns - lr11xx_simulator_get_time_ns( ) + wake_up_ns );
+    }
+}
+
+static void system_host_complete_dma( void )
+{
+    for( uint16_t i = 0; i < system_host_dma.length; i++ )
+    {
+        lr11xx_simulator_spi_exchange( system_host_dma.spi, system_host_dma.buffer[i] );
+    }
+
+    /* Called from the completion interrupt on the board, once the transfer is seen as done: it may start the next */
+    system_host_dma.is_in_flight = false;
+
+    if( system_host_dma.callback != NULL )
+    {
+        system_spi_dma_callback_t callback = system_host_dma.callback;
+
+        system_host_dma.callback = NULL;
+        callback( system_host_dma.callback_context );
+    }
+}
+
+static void system_host_check_dma_idle( const char* reason )
+{
+    if( system_host_dma.is_in_flight == false )
+    {
+        return;
+    }
+
+    if( lr11xx_simulator_get_time_ns( ) < system_host_dma.end_ns )
+    {
+        lr11xx_simulator_report_error( system_host_dma.spi, reason );
+    }
+
+    system_host_complete_dma( );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
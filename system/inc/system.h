@@ -47,6 +47,7 @@ extern "C" {
 #include "system_clock.h"
 #include "system_gpio.h"
 #include "system_spi.h"
+#include "system_spi_bus.h"
 #include "system_uart.h"
 #include "system_time.h"
 
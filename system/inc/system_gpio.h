@@ -44,6 +44,8 @@ extern "C" {
  * --- DEPENDENCIES ------------------------------------------------------------
  */
 
+#include <stdbool.h>
+
 #include "configuration.h"
 
 /*
@@ -118,6 +120,28 @@ void system_gpio_init_direction_state( const gpio_t gpio, const system_gpio_pin_
                                        const system_gpio_pin_state_t state );
 void system_gpio_wait_for_state( gpio_t io, uint8_t state );
 
+/*!
+ * @brief Wait for a GPIO configured as input to reach a given state - the MCU sleeps until the matching edge
+ *
+ * @remark The EXTI line of the GPIO is armed for the duration of the call only. Only the EXTI lines with a handler
+ * in system_it.c can be used (BUSY line).
+ *
+ * @param [in] gpio GPIO to wait on
+ * @param [in] state State to wait for
+ */
+void system_gpio_wait_for_state_irq( gpio_t gpio, system_gpio_pin_state_t state );
+
+/*!
+ * @brief Wait for a GPIO configured as input to reach a given state, for a bounded time
+ *
+ * @param [in] gpio GPIO to wait on
+ * @param [in] state State to wait for
+ * @param [in] timeout_ms Maximum time to wait, in ms
+ *
+ * @returns True if the GPIO reached the state in time
+ */
+bool system_gpio_wait_for_state_timeout( gpio_t gpio, system_gpio_pin_state_t state, uint32_t timeout_ms );
+
 #ifdef __cplusplus
 }
 #endif
@@ -116,6 +116,16 @@ void SysTick_Handler( void );
  */
 void EXTI4_IRQHandler( void );
 
+/*!
+ * @brief EXTI3 interrupt handler (LR11XX BUSY line)
+ */
+void EXTI3_IRQHandler( void );
+
+/*!
+ * @brief DMA1 channel 2 interrupt handler (SPI1 RX)
+ */
+void DMA1_Channel2_IRQHandler( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,8 @@ extern "C" {
  * --- DEPENDENCIES ------------------------------------------------------------
  */
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "stm32l4xx_ll_bus.h"
@@ -65,6 +67,13 @@ extern "C" {
  * --- PUBLIC TYPES ------------------------------------------------------------
  */
 
+/*!
+ * @brief Function called from the DMA completion interrupt, once the last byte of the transfer is shifted out
+ *
+ * @param [in] context Context given when the transfer was started
+ */
+typedef void ( *system_spi_dma_callback_t )( void* context );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
@@ -75,6 +84,38 @@ extern "C" {
  */
 void system_spi_init( void );
 
+/*!
+ * @brief Set the SPI clock prescaler, for the device about to be selected
+ *
+ * @remark The devices sharing a bus each have their own clock: this is to be called before every NSS falling edge.
+ * CR1 is written only when the prescaler changes, after the end of the previous transfer.
+ *
+ * @param [in] spi SPI interface to use
+ * @param [in] prescaler Prescaler of the SPI clock, one of LL_SPI_BAUDRATEPRESCALER_DIVx
+ */
+void system_spi_set_prescaler( SPI_TypeDef* spi, uint32_t prescaler );
+
+/*!
+ * @brief Set the size of the SPI frames
+ *
+ * @remark The bus is left in 8-bit mode between two transactions: a device using 16-bit frames sets them once selected
+ * and sets 8-bit frames back before its NSS rising edge. CR2 is written only when the size changes, with the SPI
+ * disabled after the end of the previous transfer.
+ *
+ * @param [in] spi SPI interface to use
+ * @param [in] data_width Size of the frames, LL_SPI_DATAWIDTH_8BIT or LL_SPI_DATAWIDTH_16BIT
+ */
+void system_spi_set_data_width( SPI_TypeDef* spi, uint32_t data_width );
+
+/*!
+ * @brief Get the SPI clock frequency a prescaler gives
+ *
+ * @param [in] prescaler Prescaler of the SPI clock, one of LL_SPI_BAUDRATEPRESCALER_DIVx
+ *
+ * @returns SPI clock frequency, in Hz
+ */
+uint32_t system_spi_get_clock_hz( uint32_t prescaler );
+
 /*!
  * @brief Initialize the MCU GPIO
  *
@@ -93,6 +134,77 @@ void system_spi_write( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length
  */
 void system_spi_read_with_dummy_byte( SPI_TypeDef* spi, uint8_t* buffer, uint16_t length, uint8_t dummy_byte );
 
+/*!
+ * @brief Initialize the DMA channels used for SPI1 bulk transfers
+ */
+void system_spi_dma_init( void );
+
+/*!
+ * @brief Start sending a buffer over the SPI by DMA - non-blocking call
+ *
+ * @remark Only SPI1 is supported. Bytes received during the transfer are discarded. The buffer must stay untouched
+ * until @ref system_spi_wait_dma returns.
+ *
+ * @param [in] spi SPI interface to use
+ * @param [in] buffer Buffer to read the data from
+ * @param [in] length Number of bytes to be sent
+ */
+void system_spi_write_dma( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length );
+
+/*!
+ * @brief Start sending a buffer over the SPI by DMA, calling a function once it is sent - non-blocking call
+ *
+ * @remark Same as @ref system_spi_write_dma, the callback being called from the DMA completion interrupt, the transfer
+ * being already seen as done. It is the place to release the chip select of the device, and it may start the next
+ * transfer.
+ *
+ * @param [in] spi SPI interface to use
+ * @param [in] buffer Buffer to read the data from
+ * @param [in] length Number of bytes to be sent
+ * @param [in] callback Function called once the buffer is sent, NULL for none
+ * @param [in] context Context given to the callback
+ */
+void system_spi_write_dma_with_callback( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length,
+                                         system_spi_dma_callback_t callback, void* context );
+
+/*!
+ * @brief Start sending 16-bit words over the SPI by DMA, calling a function once they are sent - non-blocking call
+ *
+ * @remark Same as @ref system_spi_write_dma_with_callback, the SPI being set to 16-bit frames beforehand with
+ * @ref system_spi_set_data_width: each word is sent as it is in memory, most significant bit first.
+ *
+ * @param [in] spi SPI interface to use
+ * @param [in] buffer Buffer to read the words from
+ * @param [in] length Number of words to be sent
+ * @param [in] callback Function called once the buffer is sent, NULL for none
+ * @param [in] context Context given to the callback
+ */
+void system_spi_write_16bit_dma_with_callback( SPI_TypeDef* spi, const uint16_t* buffer, uint16_t length,
+                                               system_spi_dma_callback_t callback, void* context );
+
+/*!
+ * @brief Check whether the last DMA transfer started with @ref system_spi_write_dma is complete
+ *
+ * @param [in] spi SPI interface to check
+ *
+ * @returns true if no DMA transfer is on-going on this interface, false otherwise
+ */
+bool system_spi_is_dma_done( SPI_TypeDef* spi );
+
+/*!
+ * @brief Wait for the last DMA transfer started with @ref system_spi_write_dma to complete
+ *
+ * @remark The MCU sleeps until the DMA completion interrupt
+ *
+ * @param [in] spi SPI interface to use
+ */
+void system_spi_wait_dma( SPI_TypeDef* spi );
+
+/*!
+ * @brief DMA completion handler, to be called from the SPI1 RX DMA channel interrupt
+ */
+void system_spi_dma_irq_handler( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,156 @@
+/*!
+ * @file      system_spi_bus.h
+ *
+ * @brief     Arbitration of a SPI bus shared by several devices header file
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SYSTEM_SPI_BUS_H
+#define SYSTEM_SPI_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "configuration.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Function sending a queued transaction, the device being selected
+ *
+ * It starts the transfer and returns: @ref system_spi_bus_end is called once the last frame is sent, usually from the
+ * DMA completion callback.
+ *
+ * @param [in] context Context given with the transaction
+ */
+typedef void ( *system_spi_bus_start_t )( void* context );
+
+/*!
+ * @brief Transaction queued on the bus
+ *
+ * The transaction belongs to the bus from @ref system_spi_bus_submit until it ends: it must stay where it is and be
+ * left untouched until then.
+ */
+typedef struct system_spi_bus_transaction_s
+{
+    const spi_device_t*                  device;   //!< Device to select
+    system_spi_bus_start_t               start;    //!< Function sending the transaction
+    void*                                context;  //!< Context given to the function
+    struct system_spi_bus_transaction_s* next;     //!< Next transaction in the queue, private to the bus
+} system_spi_bus_transaction_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Select a device for a transaction of its own - blocking call
+ *
+ * @remark This is the priority path, the one of the LR11xx: the transaction in progress, if any, is waited for, and no
+ * queued transaction starts until @ref system_spi_bus_deselect. The clock and the frame size of the device are set
+ * before its NSS falling edge.
+ *
+ * @param [in] device Device to select
+ */
+void system_spi_bus_select( const spi_device_t* device );
+
+/*!
+ * @brief Deselect a device selected by @ref system_spi_bus_select
+ *
+ * @remark The bus is set back to 8-bit frames before the NSS rising edge, then the next queued transaction starts.
+ *
+ * @param [in] device Device to deselect
+ */
+void system_spi_bus_deselect( const spi_device_t* device );
+
+/*!
+ * @brief Queue a transaction - non-blocking call
+ *
+ * @remark The transactions are sent in the order they are queued, one at a time, each as soon as the bus is free and
+ * not held by @ref system_spi_bus_select. The first one starts before the function returns if the bus is free.
+ *
+ * @param [in] transaction Transaction to queue
+ */
+void system_spi_bus_submit( system_spi_bus_transaction_t* transaction );
+
+/*!
+ * @brief End the queued transaction in progress, and start the next one
+ *
+ * @remark To be called by the transaction once its last frame is sent, possibly from an interrupt: the device is
+ * deselected the same way as by @ref system_spi_bus_deselect.
+ */
+void system_spi_bus_end( void );
+
+/*!
+ * @brief Check whether a queued transaction is in progress or waiting
+ *
+ * @returns true if the bus is free of queued transactions, false otherwise
+ */
+bool system_spi_bus_is_idle( void );
+
+/*!
+ * @brief Wait for the queued transactions to be sent
+ *
+ * @remark Not to be called with a device selected by @ref system_spi_bus_select: the queue would not move
+ *
+ * @param [in] spi SPI interface of the transactions
+ */
+void system_spi_bus_wait( SPI_TypeDef* spi );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SYSTEM_SPI_BUS_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -90,6 +90,25 @@ void system_time_IncreaseTicker( void );
  */
 uint32_t system_time_GetTicker( void );
 
+/*!
+ * @brief Get the value of the CPU cycle counter
+ *
+ * @remark The counter runs at the core clock and wraps around every 53 s at 80 MHz: only differences between two
+ * values close in time are meaningful.
+ *
+ * @returns Current value of the cycle counter
+ */
+uint32_t system_time_get_cycles( void );
+
+/*!
+ * @brief Convert a number of CPU cycles to a duration
+ *
+ * @param [in] cycles Number of cycles
+ *
+ * @returns Duration in us
+ */
+uint32_t system_time_cycles_to_us( uint64_t cycles );
+
 #ifdef __cplusplus
 }
 #endif
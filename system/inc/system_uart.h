@@ -45,6 +45,7 @@ extern "C" {
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "stm32l476xx.h"
 #include "stm32l4xx_ll_bus.h"
 #include "stm32l4xx_ll_gpio.h"
@@ -60,11 +61,25 @@ extern "C" {
  * --- PUBLIC CONSTANTS --------------------------------------------------------
  */
 
+/*!
+ * @brief Baud rate of the UART channel
+ */
+#ifndef SYSTEM_UART_BAUDRATE
+#define SYSTEM_UART_BAUDRATE ( 921600 )
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
  */
 
+/*!
+ * @brief Function called from interrupt context for each byte received
+ *
+ * @param [in] data Byte received
+ */
+typedef void ( *system_uart_rx_callback_t )( uint8_t data );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
@@ -94,6 +109,30 @@ int32_t system_uart_receive_char( void );
  */
 void system_uart_flush( void );
 
+/*!
+ * @brief Start receiving under interrupt
+ *
+ * @remark system_uart_receive_char must not be used until system_uart_stop_receive is called
+ *
+ * @param [in] callback Function called for each byte received
+ */
+void system_uart_start_receive( system_uart_rx_callback_t callback );
+
+/*!
+ * @brief Stop receiving under interrupt
+ */
+void system_uart_stop_receive( void );
+
+/*!
+ * @brief Sleep until the next interrupt - a byte received or the 1 ms tick at the latest
+ */
+void system_uart_wait_for_receive( void );
+
+/*!
+ * @brief UART interrupt handler
+ */
+void system_uart_irq_handler( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -74,6 +74,7 @@ void system_init( void )
     system_clock_init( );
     system_gpio_init( );
     system_spi_init( );
+    system_spi_dma_init( );
     system_time_init( );
     system_uart_init( );
 }
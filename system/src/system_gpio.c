@@ -38,6 +38,7 @@
  */
 
 #include "system_gpio.h"
+#include "system_time.h"
 
 #include "stm32l476xx.h"
 #include "stm32l4xx_ll_bus.h"
@@ -88,6 +89,23 @@ static void system_gpio_init_input( GPIO_TypeDef* port, uint32_t pin, system_gpi
  */
 static void system_gpio_init_output( GPIO_TypeDef* port, uint32_t pin, uint8_t initialState );
 
+/*!
+ * @brief Route the EXTI line of a pin to its port
+ *
+ * @param [in] port GPIO port of the pin
+ * @param [in] pin GPIO pin
+ */
+static void system_gpio_set_exti_source( GPIO_TypeDef* port, uint32_t pin );
+
+/*!
+ * @brief Get the interrupt line serving the EXTI line of a pin
+ *
+ * @param [in] pin GPIO pin
+ *
+ * @returns EXTI interrupt number
+ */
+static IRQn_Type system_gpio_get_exti_irqn( uint32_t pin );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -178,6 +196,56 @@ void system_gpio_wait_for_state( gpio_t gpio, system_gpio_pin_state_t state )
     }
 }
 
+void system_gpio_wait_for_state_irq( gpio_t gpio, system_gpio_pin_state_t state )
+{
+    LL_APB2_GRP1_EnableClock( LL_APB2_GRP1_PERIPH_SYSCFG );
+    system_gpio_set_exti_source( gpio.port, gpio.pin );
+
+    if( state == SYSTEM_GPIO_PIN_STATE_LOW )
+    {
+        LL_EXTI_DisableRisingTrig_0_31( gpio.pin );
+        LL_EXTI_EnableFallingTrig_0_31( gpio.pin );
+    }
+    else
+    {
+        LL_EXTI_DisableFallingTrig_0_31( gpio.pin );
+        LL_EXTI_EnableRisingTrig_0_31( gpio.pin );
+    }
+    LL_EXTI_ClearFlag_0_31( gpio.pin );
+    LL_EXTI_EnableIT_0_31( gpio.pin );
+    NVIC_SetPriority( system_gpio_get_exti_irqn( gpio.pin ), 0 );
+    NVIC_EnableIRQ( system_gpio_get_exti_irqn( gpio.pin ) );
+
+    /* With interrupts masked, WFI still wakes up on the pending edge so it cannot be missed */
+    __disable_irq( );
+    while( system_gpio_get_pin_state( gpio ) != state )
+    {
+        __WFI( );
+        __enable_irq( );
+        __disable_irq( );
+    }
+    __enable_irq( );
+
+    LL_EXTI_DisableIT_0_31( gpio.pin );
+    LL_EXTI_DisableFallingTrig_0_31( gpio.pin );
+    LL_EXTI_DisableRisingTrig_0_31( gpio.pin );
+}
+
+bool system_gpio_wait_for_state_timeout( gpio_t gpio, system_gpio_pin_state_t state, uint32_t timeout_ms )
+{
+    const uint32_t start_ms = system_time_GetTicker( );
+
+    while( system_gpio_get_pin_state( gpio ) != state )
+    {
+        if( ( system_time_GetTicker( ) - start_ms ) >= timeout_ms )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
@@ -214,7 +282,7 @@ static void system_gpio_init_input( GPIO_TypeDef* port, uint32_t pin, system_gpi
         LL_EXTI_InitTypeDef EXTI_InitStruct = { 0 };
 
         LL_APB2_GRP1_EnableClock( LL_APB2_GRP1_PERIPH_SYSCFG );
-        LL_SYSCFG_SetEXTISource( LL_SYSCFG_EXTI_PORTB, LL_SYSCFG_EXTI_LINE4 );
+        system_gpio_set_exti_source( port, pin );
 
         EXTI_InitStruct.Line_0_31   = pin;
         EXTI_InitStruct.Line_32_63  = LL_EXTI_LINE_NONE;
@@ -236,41 +304,10 @@ static void system_gpio_init_input( GPIO_TypeDef* port, uint32_t pin, system_gpi
         }
         LL_EXTI_Init( &EXTI_InitStruct );
 
-        if( pin == LL_GPIO_PIN_0 )
-        {
-            NVIC_EnableIRQ( EXTI0_IRQn );
-            NVIC_SetPriority( EXTI0_IRQn, 0 );
-        }
-        else if( pin == LL_GPIO_PIN_1 )
-        {
-            NVIC_EnableIRQ( EXTI1_IRQn );
-            NVIC_SetPriority( EXTI1_IRQn, 0 );
-        }
-        else if( pin == LL_GPIO_PIN_2 )
-        {
-            NVIC_EnableIRQ( EXTI2_IRQn );
-            NVIC_SetPriority( EXTI2_IRQn, 0 );
-        }
-        else if( pin == LL_GPIO_PIN_3 )
-        {
-            NVIC_EnableIRQ( EXTI3_IRQn );
-            NVIC_SetPriority( EXTI3_IRQn, 0 );
-        }
-        else if( pin == LL_GPIO_PIN_4 )
-        {
-            NVIC_EnableIRQ( EXTI4_IRQn );
-            NVIC_SetPriority( EXTI4_IRQn, 0 );
-        }
-        else if( ( pin >= LL_GPIO_PIN_5 ) && ( pin <= LL_GPIO_PIN_9 ) )
-        {
-            NVIC_EnableIRQ( EXTI9_5_IRQn );
-            NVIC_SetPriority( EXTI9_5_IRQn, 0 );
-        }
-        else if( ( pin >= LL_GPIO_PIN_10 ) && ( pin <= LL_GPIO_PIN_15 ) )
-        {
-            NVIC_EnableIRQ( EXTI15_10_IRQn );
-            NVIC_SetPriority( EXTI15_10_IRQn, 0 );
-        }
+        const IRQn_Type irqn = system_gpio_get_exti_irqn( pin );
+
+        NVIC_EnableIRQ( irqn );
+        NVIC_SetPriority( irqn, 0 );
     }
 }
 
@@ -312,4 +349,31 @@ static void system_gpio_init_output( GPIO_TypeDef* port, uint32_t pin, uint8_t i
     LL_GPIO_Init( port, &GPIO_InitStruct );
 }
 
+static void system_gpio_set_exti_source( GPIO_TypeDef* port, uint32_t pin )
+{
+    const uint32_t position = POSITION_VAL( pin );
+    const uint32_t line     = ( ( 0x000FU << ( ( position & 0x03U ) * 4U ) ) << 16U ) | ( position >> 2U );
+
+    LL_SYSCFG_SetEXTISource( ( ( uint32_t ) port - GPIOA_BASE ) / ( GPIOB_BASE - GPIOA_BASE ), line );
+}
+
+static IRQn_Type system_gpio_get_exti_irqn( uint32_t pin )
+{
+    switch( pin )
+    {
+    case LL_GPIO_PIN_0:
+        return EXTI0_IRQn;
+    case LL_GPIO_PIN_1:
+        return EXTI1_IRQn;
+    case LL_GPIO_PIN_2:
+        return EXTI2_IRQn;
+    case LL_GPIO_PIN_3:
+        return EXTI3_IRQn;
+    case LL_GPIO_PIN_4:
+        return EXTI4_IRQn;
+    default:
+        return ( pin <= LL_GPIO_PIN_9 ) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+    }
+}
+
 /* --- EOF ------------------------------------------------------------------ */
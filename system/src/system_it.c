@@ -43,6 +43,7 @@
 #include <stdbool.h>
 #include "system_time.h"
 #include "system_uart.h"
+#include "system_spi.h"
 
 extern void lv_tick_inc( uint32_t );
 
@@ -175,6 +176,37 @@ void SysTick_Handler( void )
     lv_tick_inc( 1 );
 }
 
+/**
+ * @brief  This function handles EXTI line 3 interrupt (LR11XX BUSY edge).
+ * @param  None
+ * @retval None
+ */
+void EXTI3_IRQHandler( void )
+{
+    /* The waiting context only needs to be woken up */
+    LL_EXTI_ClearFlag_0_31( LL_EXTI_LINE_3 );
+}
+
+/**
+ * @brief  This function handles DMA1 channel 2 interrupt (SPI1 RX).
+ * @param  None
+ * @retval None
+ */
+void DMA1_Channel2_IRQHandler( void )
+{
+    system_spi_dma_irq_handler( );
+}
+
+/**
+ * @brief  This function handles USART2 global interrupt.
+ * @param  None
+ * @retval None
+ */
+void USART2_IRQHandler( void )
+{
+    system_uart_irq_handler( );
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
@@ -38,6 +38,7 @@
  */
 
 #include "system_spi.h"
+#include "stm32l4xx_ll_dma.h"
 
 /*
  * -----------------------------------------------------------------------------
@@ -49,6 +50,12 @@
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
+/*!
+ * @brief DMA channels connected to SPI1 (request 1 on DMA1)
+ */
+#define SYSTEM_SPI_DMA_RX_CHANNEL LL_DMA_CHANNEL_2
+#define SYSTEM_SPI_DMA_TX_CHANNEL LL_DMA_CHANNEL_3
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -59,11 +66,38 @@
  * --- PRIVATE VARIABLES -------------------------------------------------------
  */
 
+static volatile bool system_spi_dma_done = true;
+
+/*!
+ * @brief Function to call at the end of the on-going DMA transfer, and its context
+ */
+static system_spi_dma_callback_t system_spi_dma_callback;
+static void*                     system_spi_dma_callback_context;
+
+/*!
+ * @brief Sink for the frames received during a DMA write, 8 or 16 bits wide
+ */
+static uint16_t system_spi_dma_rx_dummy;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
  */
 
+/*!
+ * @brief Start a DMA write of frames of a given size
+ *
+ * @param [in] spi SPI interface to use
+ * @param [in] buffer Buffer to read the frames from
+ * @param [in] length Number of frames to be sent
+ * @param [in] periph_size LL_DMA_PDATAALIGN_BYTE for 8-bit frames, LL_DMA_PDATAALIGN_HALFWORD for 16-bit ones
+ * @param [in] memory_size LL_DMA_MDATAALIGN_BYTE for 8-bit frames, LL_DMA_MDATAALIGN_HALFWORD for 16-bit ones
+ * @param [in] callback Function called once the buffer is sent, NULL for none
+ * @param [in] context Context given to the callback
+ */
+static void system_spi_start_dma( SPI_TypeDef* spi, const void* buffer, uint16_t length, uint32_t periph_size,
+                                  uint32_t memory_size, system_spi_dma_callback_t callback, void* context );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -114,6 +148,46 @@ void system_spi_init( void )
     LL_SPI_SetRxFIFOThreshold( SPI1, LL_SPI_RX_FIFO_TH_QUARTER );
 }
 
+void system_spi_set_prescaler( SPI_TypeDef* spi, uint32_t prescaler )
+{
+    if( LL_SPI_GetBaudRatePrescaler( spi ) == prescaler )
+    {
+        return;
+    }
+
+    /* The clock must not change while the last frame is still shifted out */
+    while( LL_SPI_IsActiveFlag_BSY( spi ) != 0 )
+    {
+    };
+
+    LL_SPI_SetBaudRatePrescaler( spi, prescaler );
+}
+
+void system_spi_set_data_width( SPI_TypeDef* spi, uint32_t data_width )
+{
+    if( LL_SPI_GetDataWidth( spi ) == data_width )
+    {
+        return;
+    }
+
+    /* The frame size and the RX FIFO threshold are changed with the SPI disabled, once the last frame is out */
+    while( LL_SPI_IsActiveFlag_BSY( spi ) != 0 )
+    {
+    };
+
+    LL_SPI_Disable( spi );
+    LL_SPI_SetDataWidth( spi, data_width );
+    LL_SPI_SetRxFIFOThreshold(
+        spi, ( data_width == LL_SPI_DATAWIDTH_8BIT ) ? LL_SPI_RX_FIFO_TH_QUARTER : LL_SPI_RX_FIFO_TH_HALF );
+    LL_SPI_Enable( spi );
+}
+
+uint32_t system_spi_get_clock_hz( uint32_t prescaler )
+{
+    /* SPI1 is clocked by PCLK2, undivided from SYSCLK */
+    return SystemCoreClock >> ( 1 + ( prescaler >> SPI_CR1_BR_Pos ) );
+}
+
 void system_spi_write( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length )
 {
     uint16_t rx_len = 0;
@@ -166,9 +240,128 @@ void system_spi_read_with_dummy_byte( SPI_TypeDef* spi, uint8_t* buffer, uint16_
     }
 }
 
+void system_spi_dma_init( void )
+{
+    LL_AHB1_GRP1_EnableClock( LL_AHB1_GRP1_PERIPH_DMA1 );
+
+    /* SPI1_RX: the received bytes are discarded in a single dummy byte */
+    LL_DMA_SetPeriphRequest( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL, LL_DMA_REQUEST_1 );
+    LL_DMA_ConfigTransfer( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL,
+                           LL_DMA_DIRECTION_PERIPH_TO_MEMORY | LL_DMA_PRIORITY_HIGH | LL_DMA_MODE_NORMAL |
+                               LL_DMA_PERIPH_NOINCREMENT | LL_DMA_MEMORY_NOINCREMENT | LL_DMA_PDATAALIGN_BYTE |
+                               LL_DMA_MDATAALIGN_BYTE );
+    LL_DMA_SetPeriphAddress( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL, LL_SPI_DMA_GetRegAddr( SPI1 ) );
+    LL_DMA_SetMemoryAddress( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL, ( uint32_t ) &system_spi_dma_rx_dummy );
+    LL_DMA_EnableIT_TC( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL );
+
+    /* SPI1_TX */
+    LL_DMA_SetPeriphRequest( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL, LL_DMA_REQUEST_1 );
+    LL_DMA_ConfigTransfer( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL,
+                           LL_DMA_DIRECTION_MEMORY_TO_PERIPH | LL_DMA_PRIORITY_HIGH | LL_DMA_MODE_NORMAL |
+                               LL_DMA_PERIPH_NOINCREMENT | LL_DMA_MEMORY_INCREMENT | LL_DMA_PDATAALIGN_BYTE |
+                               LL_DMA_MDATAALIGN_BYTE );
+    LL_DMA_SetPeriphAddress( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL, LL_SPI_DMA_GetRegAddr( SPI1 ) );
+
+    NVIC_SetPriority( DMA1_Channel2_IRQn, 0 );
+    NVIC_EnableIRQ( DMA1_Channel2_IRQn );
+}
+
+void system_spi_write_dma( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length )
+{
+    system_spi_write_dma_with_callback( spi, buffer, length, NULL, NULL );
+}
+
+void system_spi_write_dma_with_callback( SPI_TypeDef* spi, const uint8_t* buffer, uint16_t length,
+                                         system_spi_dma_callback_t callback, void* context )
+{
+    system_spi_start_dma( spi, buffer, length, LL_DMA_PDATAALIGN_BYTE, LL_DMA_MDATAALIGN_BYTE, callback, context );
+}
+
+void system_spi_write_16bit_dma_with_callback( SPI_TypeDef* spi, const uint16_t* buffer, uint16_t length,
+                                               system_spi_dma_callback_t callback, void* context )
+{
+    system_spi_start_dma( spi, buffer, length, LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, callback,
+                          context );
+}
+
+bool system_spi_is_dma_done( SPI_TypeDef* spi )
+{
+    /* The DMA channels only serve SPI1: no transfer can be on-going on another interface */
+    return ( spi != SPI1 ) || ( system_spi_dma_done == true );
+}
+
+void system_spi_wait_dma( SPI_TypeDef* spi )
+{
+    __disable_irq( );
+    while( system_spi_is_dma_done( spi ) == false )
+    {
+        __WFI( );
+        __enable_irq( );
+        __disable_irq( );
+    }
+    __enable_irq( );
+}
+
+void system_spi_dma_irq_handler( void )
+{
+    if( LL_DMA_IsActiveFlag_TC2( DMA1 ) != 0 )
+    {
+        LL_DMA_ClearFlag_GI2( DMA1 );
+        LL_DMA_ClearFlag_GI3( DMA1 );
+
+        LL_DMA_DisableChannel( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL );
+        LL_DMA_DisableChannel( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL );
+        LL_SPI_DisableDMAReq_TX( SPI1 );
+        LL_SPI_DisableDMAReq_RX( SPI1 );
+
+        /* Done first: the callback may start the next transfer */
+        system_spi_dma_done = true;
+
+        if( system_spi_dma_callback != NULL )
+        {
+            system_spi_dma_callback_t callback = system_spi_dma_callback;
+
+            system_spi_dma_callback = NULL;
+            callback( system_spi_dma_callback_context );
+        }
+    }
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
  */
 
+static void system_spi_start_dma( SPI_TypeDef* spi, const void* buffer, uint16_t length, uint32_t periph_size,
+                                  uint32_t memory_size, system_spi_dma_callback_t callback, void* context )
+{
+    if( length == 0 )
+    {
+        if( callback != NULL )
+        {
+            callback( context );
+        }
+        return;
+    }
+
+    system_spi_dma_callback         = callback;
+    system_spi_dma_callback_context = context;
+    system_spi_dma_done             = false;
+
+    LL_DMA_SetPeriphSize( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL, periph_size );
+    LL_DMA_SetMemorySize( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL, memory_size );
+    LL_DMA_SetPeriphSize( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL, periph_size );
+    LL_DMA_SetMemorySize( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL, memory_size );
+
+    LL_DMA_SetDataLength( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL, length );
+    LL_DMA_SetMemoryAddress( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL, ( uint32_t ) buffer );
+    LL_DMA_SetDataLength( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL, length );
+
+    /* Sequence from the reference manual: RX request first, then channels, then TX request */
+    LL_SPI_EnableDMAReq_RX( spi );
+    LL_DMA_EnableChannel( DMA1, SYSTEM_SPI_DMA_RX_CHANNEL );
+    LL_DMA_EnableChannel( DMA1, SYSTEM_SPI_DMA_TX_CHANNEL );
+    LL_SPI_EnableDMAReq_TX( spi );
+}
+
 /* --- EOF ------------------------------------------------------------------ */
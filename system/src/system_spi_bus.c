@@ -0,0 +1,221 @@
+/*!
+ * @file      system_spi_bus.c
+ *
+ * @brief     Arbitration of a SPI bus shared by several devices
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stddef.h>
+
+#include "system_spi_bus.h"
+#include "system_gpio.h"
+#include "system_spi.h"
+
+#include "stm32l476xx.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief Queued transactions not started yet, oldest first
+ */
+static system_spi_bus_transaction_t* volatile system_spi_bus_head;
+static system_spi_bus_transaction_t* volatile system_spi_bus_tail;
+
+/*!
+ * @brief Queued transaction in progress, NULL if none
+ */
+static system_spi_bus_transaction_t* volatile system_spi_bus_running;
+
+/*!
+ * @brief Whether a device selected by system_spi_bus_select holds the bus, the queue waiting meanwhile
+ */
+static volatile bool system_spi_bus_is_held;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Set the bus up for a device and pull its NSS low
+ *
+ * @param [in] device Device to select
+ */
+static void system_spi_bus_set_up( const spi_device_t* device );
+
+/*!
+ * @brief Set the bus back to 8-bit frames and pull the NSS of a device high
+ *
+ * @param [in] device Device to deselect
+ */
+static void system_spi_bus_release( const spi_device_t* device );
+
+/*!
+ * @brief Start the next queued transaction, if the bus is free and not held
+ */
+static void system_spi_bus_start_next( void );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void system_spi_bus_select( const spi_device_t* device )
+{
+    system_spi_bus_is_held = true;
+
+    /* A transfer in progress cannot be cut: it is the only wait of the priority path */
+    while( system_spi_bus_running != NULL )
+    {
+        system_spi_wait_dma( device->spi );
+    }
+
+    system_spi_bus_set_up( device );
+}
+
+void system_spi_bus_deselect( const spi_device_t* device )
+{
+    system_spi_bus_release( device );
+
+    system_spi_bus_is_held = false;
+
+    if( system_spi_bus_head != NULL )
+    {
+        system_spi_bus_start_next( );
+    }
+}
+
+void system_spi_bus_submit( system_spi_bus_transaction_t* transaction )
+{
+    transaction->next = NULL;
+
+    __disable_irq( );
+    if( system_spi_bus_head == NULL )
+    {
+        system_spi_bus_head = transaction;
+    }
+    else
+    {
+        system_spi_bus_tail->next = transaction;
+    }
+    system_spi_bus_tail = transaction;
+    __enable_irq( );
+
+    system_spi_bus_start_next( );
+}
+
+void system_spi_bus_end( void )
+{
+    system_spi_bus_release( system_spi_bus_running->device );
+
+    system_spi_bus_running = NULL;
+    system_spi_bus_start_next( );
+}
+
+bool system_spi_bus_is_idle( void )
+{
+    return ( system_spi_bus_running == NULL ) && ( system_spi_bus_head == NULL );
+}
+
+void system_spi_bus_wait( SPI_TypeDef* spi )
+{
+    while( system_spi_bus_is_idle( ) == false )
+    {
+        system_spi_wait_dma( spi );
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void system_spi_bus_set_up( const spi_device_t* device )
+{
+    system_spi_set_prescaler( device->spi, device->prescaler );
+    system_spi_set_data_width( device->spi, device->data_width );
+    system_gpio_set_pin_state( device->nss, SYSTEM_GPIO_PIN_STATE_LOW );
+}
+
+static void system_spi_bus_release( const spi_device_t* device )
+{
+    system_spi_set_data_width( device->spi, LL_SPI_DATAWIDTH_8BIT );
+    system_gpio_set_pin_state( device->nss, SYSTEM_GPIO_PIN_STATE_HIGH );
+}
+
+static void system_spi_bus_start_next( void )
+{
+    system_spi_bus_transaction_t* transaction = NULL;
+
+    /* Called from the main loop and from the DMA completion interrupt: the queue is only touched with it masked */
+    __disable_irq( );
+    if( ( system_spi_bus_running == NULL ) && ( system_spi_bus_is_held == false ) && ( system_spi_bus_head != NULL ) )
+    {
+        transaction         = system_spi_bus_head;
+        system_spi_bus_head = transaction->next;
+        if( system_spi_bus_head == NULL )
+        {
+            system_spi_bus_tail = NULL;
+        }
+        system_spi_bus_running = transaction;
+    }
+    __enable_irq( );
+
+    if( transaction != NULL )
+    {
+        system_spi_bus_set_up( transaction->device );
+        transaction->start( transaction->context );
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -76,6 +76,11 @@ volatile static uint32_t ticker = 0;
 void system_time_init( void )
 {
     LL_SYSTICK_EnableIT( );
+
+    /* Start the DWT cycle counter, used to time the update phases */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 void system_time_wait_ms( uint32_t time_in_ms )
@@ -93,6 +98,16 @@ uint32_t system_time_GetTicker( void )
     return ticker;
 }
 
+uint32_t system_time_get_cycles( void )
+{
+    return DWT->CYCCNT;
+}
+
+uint32_t system_time_cycles_to_us( uint64_t cycles )
+{
+    return ( uint32_t ) ( cycles / ( SystemCoreClock / 1000000 ) );
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
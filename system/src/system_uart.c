@@ -37,6 +37,8 @@
  * --- DEPENDENCIES ------------------------------------------------------------
  */
 
+#include <stddef.h>
+
 #include "system_uart.h"
 
 /*
@@ -59,6 +61,8 @@
  * --- PRIVATE VARIABLES -------------------------------------------------------
  */
 
+static volatile system_uart_rx_callback_t system_uart_rx_callback = NULL;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
@@ -90,7 +94,7 @@ void system_uart_init( )
     GPIO_InitStruct.Alternate  = LL_GPIO_AF_7;
     LL_GPIO_Init( GPIOA, &GPIO_InitStruct );
 
-    USART_InitStruct.BaudRate            = 921600;
+    USART_InitStruct.BaudRate            = SYSTEM_UART_BAUDRATE;
     USART_InitStruct.DataWidth           = LL_USART_DATAWIDTH_8B;
     USART_InitStruct.StopBits            = LL_USART_STOPBITS_1;
     USART_InitStruct.Parity              = LL_USART_PARITY_NONE;
@@ -130,6 +134,51 @@ void system_uart_flush( void )
     LL_USART_RequestRxDataFlush( USART2 );
 }
 
+void system_uart_start_receive( system_uart_rx_callback_t callback )
+{
+    system_uart_rx_callback = callback;
+
+    LL_USART_RequestRxDataFlush( USART2 );
+    LL_USART_ClearFlag_ORE( USART2 );
+    LL_USART_EnableIT_RXNE( USART2 );
+
+    /* A byte lasts about 10 us at 921600 baud: the handler has to preempt the longer interrupts */
+    NVIC_SetPriority( USART2_IRQn, 0 );
+    NVIC_EnableIRQ( USART2_IRQn );
+}
+
+void system_uart_stop_receive( void )
+{
+    LL_USART_DisableIT_RXNE( USART2 );
+    NVIC_DisableIRQ( USART2_IRQn );
+
+    system_uart_rx_callback = NULL;
+}
+
+void system_uart_wait_for_receive( void )
+{
+    __WFI( );
+}
+
+void system_uart_irq_handler( void )
+{
+    /* A byte lost to an overrun is caught by the integrity check of the upper layer */
+    if( LL_USART_IsActiveFlag_ORE( USART2 ) != 0 )
+    {
+        LL_USART_ClearFlag_ORE( USART2 );
+    }
+
+    if( LL_USART_IsActiveFlag_RXNE( USART2 ) != 0 )
+    {
+        const uint8_t data = LL_USART_ReceiveData8( USART2 );
+
+        if( system_uart_rx_callback != NULL )
+        {
+            system_uart_rx_callback( data );
+        }
+    }
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
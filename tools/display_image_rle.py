@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+#
+# @file      display_image_rle.py
+#
+# @brief     Compress a PNG image into a palette and run-length encoded LVGL image
+#
+# The Clear BSD License
+# Copyright Semtech Corporation 2024. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted (subject to the limitations in the disclaimer
+# below) provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Semtech corporation nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+#
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+# THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+# CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+# NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# The pixels are reduced to RGB565, the format of the display, by truncation: an image already dithered to RGB565 is
+# kept as it is. Each row is then coded as runs of palette indexes, so that the display decodes any row on its own
+# while drawing (see display_image_rle.h for the format). The output is the C source of the LVGL image descriptor.
+#
+# Usage: display_image_rle.py <PNG image> <image name> <output C file>
+
+import struct
+import sys
+import zlib
+
+# Shared with display_image_rle.h
+PALETTE_SIZE_MAX = 64
+INDEX_MASK = 0x3F
+COUNT_SHIFT = 6
+SHORT_RUN_MAX = 3
+LONG_RUN_MIN = 4
+LONG_RUN_MAX = LONG_RUN_MIN + 255
+
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+# Bytes per pixel of the 8-bit colour types supported: grey, RGB, grey and alpha, RGBA
+PNG_CHANNELS = {0: 1, 2: 3, 4: 2, 6: 4}
+
+SOURCE_TEMPLATE = """/*!
+ * @file      {name}.c
+ *
+ * @brief     {name} image, palette and run-length encoded
+ *
+ * Generated by tools/display_image_rle.py from {source}, do not edit: {width}x{height} pixels, {colors} colors,
+ * {size} bytes instead of {raw_size} in RGB565.
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2024. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "display_image_rle.h"
+#include "{name}.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+static const lv_color_t {name}_palette[] = {{
+{palette}
+}};
+
+static const uint16_t {name}_row_offsets[] = {{
+{row_offsets}
+}};
+
+static const uint8_t {name}_runs[] = {{
+{runs}
+}};
+
+static const display_image_rle_t {name}_rle = {{
+    .palette     = {name}_palette,
+    .row_offsets = {name}_row_offsets,
+    .runs        = {name}_runs,
+}};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC VARIABLES --------------------------------------------------------
+ */
+
+const lv_img_dsc_t {name} = {{
+    .header.always_zero = 0,
+    .header.w           = {width},
+    .header.h           = {height},
+    .data_size          = {size},
+    .header.cf          = DISPLAY_IMAGE_RLE_CF,
+    .data               = ( const uint8_t* ) &{name}_rle,
+}};
+
+/* --- EOF ------------------------------------------------------------------ */
+"""
+
+
+def read_png(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError("not a PNG file")
+
+    offset = 8
+    idat = b""
+    header = None
+    while offset < len(data):
+        (length,) = struct.unpack(">I", data[offset : offset + 4])
+        chunk_type = data[offset + 4 : offset + 8]
+        chunk = data[offset + 8 : offset + 8 + length]
+        offset += 12 + length
+        if chunk_type == b"IHDR":
+            header = struct.unpack(">IIBBBBB", chunk)
+        elif chunk_type == b"IDAT":
+            idat += chunk
+        elif chunk_type == b"IEND":
+            break
+
+    if header is None:
+        raise ValueError("no IHDR chunk")
+
+    width, height, depth, color_type, _, _, interlace = header
+    if depth != 8 or color_type not in PNG_CHANNELS or interlace != 0:
+        raise ValueError("only 8-bit, non-interlaced grey, RGB and RGBA images are supported")
+
+    channels = PNG_CHANNELS[color_type]
+    stride = width * channels
+    raw = zlib.decompress(idat)
+
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        line_filter = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1 : (y + 1) * (stride + 1)])
+        for i in range(stride):
+            left = line[i - channels] if i >= channels else 0
+            up = previous[i]
+            up_left = previous[i - channels] if i >= channels else 0
+            if line_filter == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif line_filter == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif line_filter == 3:
+                line[i] = (line[i] + ((left + up) >> 1)) & 0xFF
+            elif line_filter == 4:
+                p = left + up - up_left
+                pa, pb, pc = abs(p - left), abs(p - up), abs(p - up_left)
+                predictor = left if (pa <= pb and pa <= pc) else (up if pb <= pc else up_left)
+                line[i] = (line[i] + predictor) & 0xFF
+        previous = line
+
+        row = []
+        for x in range(width):
+            pixel = line[x * channels : (x + 1) * channels]
+            if channels <= 2:
+                rgb = (pixel[0], pixel[0], pixel[0])
+            else:
+                rgb = tuple(pixel[:3])
+            if channels in (2, 4) and pixel[-1] != 0xFF:
+                raise ValueError("transparent pixel at ({}, {}): the image must be opaque".format(x, y))
+            row.append(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3))
+        rows.append(row)
+
+    return width, height, rows
+
+
+def encode_rows(rows, palette_index):
+    runs = bytearray()
+    row_offsets = []
+    for row in rows:
+        row_offsets.append(len(runs))
+        x = 0
+        while x < len(row):
+            end = x
+            while (end < len(row)) and (row[end] == row[x]) and (end - x < LONG_RUN_MAX):
+                end += 1
+            count = end - x
+            index = palette_index[row[x]]
+            if count <= SHORT_RUN_MAX:
+                runs.append((count << COUNT_SHIFT) | index)
+            else:
+                runs.append(index)
+                runs.append(count - LONG_RUN_MIN)
+            x = end
+
+    if len(runs) > 0xFFFF:
+        raise ValueError("image too large: the row offsets are 16-bit")
+
+    return runs, row_offsets
+
+
+def decode_row(runs, offset, width, colors):
+    row = []
+    while len(row) < width:
+        index = runs[offset] & INDEX_MASK
+        count = runs[offset] >> COUNT_SHIFT
+        offset += 1
+        if count == 0:
+            count = runs[offset] + LONG_RUN_MIN
+            offset += 1
+        row += [colors[index]] * count
+    return row
+
+
+def format_array(values, per_line, fmt):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + " ".join(fmt.format(v) + "," for v in values[i : i + per_line]))
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) != 4:
+        print("Usage: {} <PNG image> <image name> <output C file>".format(sys.argv[0]))
+        return 1
+
+    source, name, output = sys.argv[1:]
+    width, height, rows = read_png(source)
+
+    colors = sorted({pixel for row in rows for pixel in row})
+    if len(colors) > PALETTE_SIZE_MAX:
+        print("Error: {} colors, {} at most".format(len(colors), PALETTE_SIZE_MAX))
+        return 1
+    palette_index = {color: i for i, color in enumerate(colors)}
+
+    runs, row_offsets = encode_rows(rows, palette_index)
+
+    # Checked the way the display decodes it, before anything is written
+    for y, row in enumerate(rows):
+        if decode_row(runs, row_offsets[y], width, colors) != row:
+            print("Error: row {} does not decode back".format(y))
+            return 1
+
+    # Expanded back to 8 bits per channel, so that LV_COLOR_MAKE gives the RGB565 value again
+    palette = []
+    for color in colors:
+        r, g, b = (color >> 11) & 0x1F, (color >> 5) & 0x3F, color & 0x1F
+        palette.append((r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2))
+
+    size = len(colors) * 2 + len(row_offsets) * 2 + len(runs)
+
+    with open(output, "w") as f:
+        f.write(
+            SOURCE_TEMPLATE.format(
+                name=name,
+                source=source.replace("\\", "/"),
+                width=width,
+                height=height,
+                colors=len(colors),
+                size=size,
+                raw_size=width * height * 2,
+                palette="\n".join("    LV_COLOR_MAKE( 0x{:02x}, 0x{:02x}, 0x{:02x} ),".format(*c) for c in palette),
+                row_offsets=format_array(row_offsets, 12, "{:5d}"),
+                runs=format_array(list(runs), 16, "0x{:02x}"),
+            )
+        )
+
+    print("{}: {}x{} pixels, {} colors, {} bytes ({} in RGB565)".format(name, width, height, len(colors), size,
+                                                                        width * height * 2))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+#
+# @file      lr11xx_firmware_bundle.py
+#
+# @brief     Bundle several LR11XX firmware image headers into one
+#
+# The Clear BSD License
+# Copyright Semtech Corporation 2024. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted (subject to the limitations in the disclaimer
+# below) provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Semtech corporation nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+#
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+# THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+# CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+# NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# The updater tool built with a bundle embeds several images and flashes the one meant for the chip it finds, so that
+# one binary updates mixed batches of LR1110, LR1120 and LR1121 chips. The output header holds the images and the
+# index table of lr11xx_fw_bundle_entry_t read by lr11xx_update_firmware_from_bundle.
+#
+# Usage: lr11xx_firmware_bundle.py [--wire-order] <output header> <image header>...
+
+import os
+import re
+import sys
+import zlib
+
+# Size of the MCU flash, shared with the updater code
+FLASH_SIZE = 1024 * 1024
+
+VERSION = re.compile(r"^#define LR11XX_FIRMWARE_VERSION\s+(0x[0-9a-fA-F]+)", re.MULTILINE)
+UPDATE = re.compile(r"^#define LR11XX_FIRMWARE_UPDATE_TO\s+(\w+)", re.MULTILINE)
+ARRAY_DECLARATION = re.compile(r"^const uint32_t lr11xx_firmware_image\[[^\]]*\] = \{", re.MULTILINE)
+WORD = re.compile(r"0x([0-9a-fA-F]{8})")
+
+UPDATES = [
+    "LR1110_FIRMWARE_UPDATE_TO_TRX",
+    "LR1110_FIRMWARE_UPDATE_TO_MODEM_V1",
+    "LR1120_FIRMWARE_UPDATE_TO_TRX",
+    "LR1121_FIRMWARE_UPDATE_TO_TRX",
+    "LR1121_FIRMWARE_UPDATE_TO_MODEM_V2",
+]
+
+HEADER = """/*!
+ * \\file      %(name)s
+ *
+ * \\brief     Firmware bundle generated by tools/lr11xx_firmware_bundle.py from:
+%(sources)s *
+ * Do not edit: regenerate it from the image headers instead.
+ */
+
+#ifndef LR11XX_FIRMWARE_BUNDLE_DATA_H
+#define LR11XX_FIRMWARE_BUNDLE_DATA_H
+
+#include "lr11xx_firmware_update.h"
+
+/*!
+ * \\brief Number of images in the bundle
+ */
+#define LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT %(count)u
+
+"""
+
+IMAGE = """/*!
+ * \\brief Image of %(source)s
+ */
+const uint32_t lr11xx_firmware_bundle_image_%(index)u[] = {
+%(words)s
+};
+
+"""
+
+ENTRY = """    {
+        .update      = %(update)s,
+        .fw_expected = 0x%(version)08x,
+        .image       = { .words          = lr11xx_firmware_bundle_image_%(index)u,
+                         .length_in_word = %(length)u,
+                         .format         = %(format)s },
+        .crc         = 0x%(crc)08x,
+    },
+"""
+
+FOOTER = """/*!
+ * \\brief Index of the bundle: the updater flashes the first entry compatible with the chip
+ */
+const lr11xx_fw_bundle_entry_t lr11xx_firmware_bundle[LR11XX_FIRMWARE_BUNDLE_ENTRY_COUNT] = {
+%(entries)s};
+
+#endif  // LR11XX_FIRMWARE_BUNDLE_DATA_H
+"""
+
+
+def parse_header(header):
+    version = VERSION.search(header)
+    update = UPDATE.search(header)
+    declaration = ARRAY_DECLARATION.search(header)
+    if version is None or update is None or declaration is None:
+        raise ValueError("not an LR11XX firmware image header")
+    if "LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER" in header[: declaration.start()]:
+        raise ValueError("image in SPI byte order, give the original header")
+    if update.group(1) not in UPDATES:
+        raise ValueError("unknown update type %s" % update.group(1))
+
+    end = header.index("};", declaration.end())
+    words = [int(word, 16) for word in WORD.findall(header[declaration.end() : end])]
+
+    return update.group(1), int(version.group(1), 16), words
+
+
+def format_words(words, is_wire_order):
+    if is_wire_order:
+        words = [int.from_bytes(word.to_bytes(4, "big"), "little") for word in words]
+    lines = []
+    for offset in range(0, len(words), 8):
+        lines.append("    " + ", ".join("0x%08x" % word for word in words[offset : offset + 8]) + ",")
+    return "\n".join(lines)
+
+
+def bundle(output_path, sources, is_wire_order):
+    images = []
+    entries = []
+    seen = {}
+    total = 0
+
+    for index, path in enumerate(sources):
+        with open(path, "r") as source:
+            update, version, words = parse_header(source.read())
+
+        name = os.path.basename(path)
+        if update in seen:
+            sys.stderr.write("warning: %s is never selected, %s comes first for %s\n" % (name, seen[update], update))
+        seen.setdefault(update, name)
+
+        # CRC of the image as sent over SPI, that is of the released binary
+        crc = zlib.crc32(b"".join(word.to_bytes(4, "big") for word in words)) & 0xFFFFFFFF
+        total += len(words) * 4
+
+        images.append(IMAGE % {"source": name, "index": index, "words": format_words(words, is_wire_order)})
+        entries.append(
+            ENTRY
+            % {
+                "update": update,
+                "version": version,
+                "index": index,
+                "length": len(words),
+                "format": "LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER"
+                if is_wire_order
+                else "LR11XX_FIRMWARE_IMAGE_FORMAT_HOST_ORDER",
+                "crc": crc,
+            }
+        )
+        sys.stdout.write("%-32s %-36s 0x%08x %7u bytes CRC 0x%08x\n" % (name, update, version, len(words) * 4, crc))
+
+    sys.stdout.write("%u images, %u bytes out of the %u bytes of MCU flash\n" % (len(sources), total, FLASH_SIZE))
+    if total >= FLASH_SIZE:
+        raise ValueError("bundle larger than the MCU flash")
+
+    with open(output_path, "w") as output:
+        output.write(
+            HEADER
+            % {
+                "name": os.path.basename(output_path),
+                "sources": "".join(" *              %s\n" % os.path.basename(path) for path in sources),
+                "count": len(sources),
+            }
+        )
+        output.write("".join(images))
+        output.write(FOOTER % {"entries": "".join(entries)})
+
+
+def main(argv):
+    arguments = argv[1:]
+    is_wire_order = "--wire-order" in arguments
+    if is_wire_order:
+        arguments.remove("--wire-order")
+
+    if len(arguments) < 2 or len(arguments) > 256:
+        sys.stderr.write("Usage: %s [--wire-order] <output header> <image header>...\n" % argv[0])
+        return 1
+
+    try:
+        bundle(arguments[0], arguments[1:], is_wire_order)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("%s\n" % error)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
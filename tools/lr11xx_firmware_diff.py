@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+#
+# @file      lr11xx_firmware_diff.py
+#
+# @brief     Describe the LR1110 firmware a differential update starts from
+#
+# The Clear BSD License
+# Copyright Semtech Corporation 2024. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted (subject to the limitations in the disclaimer
+# below) provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Semtech corporation nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+#
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+# THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+# CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+# NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# The chip does not report what its flash pages hold: the updater compares the pages of the image it flashes with
+# the CRC of the pages of the base image, that is the firmware the chip is expected to run, and only erases and
+# rewrites the pages that differ. The output header holds the lr11xx_fw_diff_t read by lr11xx_update_firmware_diff.
+#
+# The flash hash the LR1110 bootloader reports once the new image is written cannot be computed from the encrypted
+# image: give the one printed by a first update with --hash. The untouched pages are only checked by that hash: without
+# it, the update erases and rewrites the whole flash.
+#
+# Usage: lr11xx_firmware_diff.py [--hash <32 hex digits>] <output header> <base image header> [<image header>]
+
+import os
+import re
+import sys
+import zlib
+
+# Flash page erased by the LR1110 bootloader, shared with the updater code
+PAGE_LENGTH = 1024
+PAGE_COUNT_MAX = 256
+HASH_LENGTH = 16
+
+VERSION = re.compile(r"^#define LR11XX_FIRMWARE_VERSION\s+(0x[0-9a-fA-F]+)", re.MULTILINE)
+UPDATE = re.compile(r"^#define LR11XX_FIRMWARE_UPDATE_TO\s+(\w+)", re.MULTILINE)
+ARRAY_DECLARATION = re.compile(r"^const uint32_t lr11xx_firmware_image\[[^\]]*\] = \{", re.MULTILINE)
+WORD = re.compile(r"0x([0-9a-fA-F]{8})")
+
+# Only the LR1110 bootloader erases the flash page by page
+UPDATES = [
+    "LR1110_FIRMWARE_UPDATE_TO_TRX",
+    "LR1110_FIRMWARE_UPDATE_TO_MODEM_V1",
+]
+
+HEADER = """/*!
+ * \\file      %(name)s
+ *
+ * \\brief     Differential update base generated by tools/lr11xx_firmware_diff.py from:
+ *              %(source)s
+ *
+ * Do not edit: regenerate it from the image header instead.
+ */
+
+#ifndef LR11XX_FIRMWARE_DIFF_DATA_H
+#define LR11XX_FIRMWARE_DIFF_DATA_H
+
+#include "lr11xx_firmware_update.h"
+
+/*!
+ * \\brief CRC of the %(page_length)u-byte flash pages of the base image, as sent over SPI
+ */
+const uint32_t lr11xx_firmware_diff_page_crc[%(page_count)u] = {
+%(crcs)s
+};
+
+/*!
+ * \\brief Firmware the differential update starts from
+ */
+const lr11xx_fw_diff_t lr11xx_firmware_diff = {
+    .update          = %(update)s,
+    .base_version    = 0x%(version)08x,
+    .base_page_crc   = lr11xx_firmware_diff_page_crc,
+    .base_page_count = %(page_count)u,
+    .hash            = { %(hash)s },
+};
+
+"""
+
+BASE_IMAGE = """#if defined( LR11XX_FIRMWARE_DIFF_WITH_BASE_IMAGE )
+/*!
+ * \\brief Base image, for the host build to program the simulated chips with
+ */
+const uint32_t lr11xx_firmware_diff_base_image[] = {
+%(words)s
+};
+
+#define LR11XX_FIRMWARE_DIFF_BASE_LENGTH_IN_WORD %(length)u
+#endif
+
+#endif  // LR11XX_FIRMWARE_DIFF_DATA_H
+"""
+
+
+def parse_header(header):
+    version = VERSION.search(header)
+    update = UPDATE.search(header)
+    declaration = ARRAY_DECLARATION.search(header)
+    if version is None or update is None or declaration is None:
+        raise ValueError("not an LR11XX firmware image header")
+    if "LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER" in header[: declaration.start()]:
+        raise ValueError("image in SPI byte order, give the original header")
+
+    end = header.index("};", declaration.end())
+    words = [int(word, 16) for word in WORD.findall(header[declaration.end() : end])]
+
+    return update.group(1), int(version.group(1), 16), words
+
+
+def page_crcs(words):
+    data = b"".join(word.to_bytes(4, "big") for word in words)
+    return [zlib.crc32(data[offset : offset + PAGE_LENGTH]) & 0xFFFFFFFF for offset in range(0, len(data), PAGE_LENGTH)]
+
+
+def format_words(words):
+    lines = []
+    for offset in range(0, len(words), 8):
+        lines.append("    " + ", ".join("0x%08x" % word for word in words[offset : offset + 8]) + ",")
+    return "\n".join(lines)
+
+
+def diff(output_path, base_path, image_path, expected_hash):
+    with open(base_path, "r") as source:
+        update, version, words = parse_header(source.read())
+    if update not in UPDATES:
+        raise ValueError("%s: %s, differential updates need the LR1110 bootloader" % (base_path, update))
+
+    crcs = page_crcs(words)
+    if len(crcs) > PAGE_COUNT_MAX:
+        raise ValueError("%s: image larger than the LR1110 flash" % base_path)
+    sys.stdout.write("%-32s %-36s 0x%08x %4u pages\n" % (os.path.basename(base_path), update, version, len(crcs)))
+
+    if image_path is not None:
+        with open(image_path, "r") as source:
+            image_update, image_version, image_words = parse_header(source.read())
+        if image_update not in UPDATES:
+            raise ValueError("%s: %s, differential updates need the LR1110 bootloader" % (image_path, image_update))
+        image_crcs = page_crcs(image_words)
+        changed = sum(
+            1
+            for page in range(max(len(crcs), len(image_crcs)))
+            if page >= len(crcs) or page >= len(image_crcs) or crcs[page] != image_crcs[page]
+        )
+        sys.stdout.write(
+            "%-32s %-36s 0x%08x %4u pages, %u changed\n"
+            % (os.path.basename(image_path), image_update, image_version, len(image_crcs), changed)
+        )
+
+    with open(output_path, "w") as output:
+        output.write(
+            HEADER
+            % {
+                "name": os.path.basename(output_path),
+                "source": os.path.basename(base_path),
+                "page_length": PAGE_LENGTH,
+                "page_count": len(crcs),
+                "crcs": format_words(crcs),
+                "update": update,
+                "version": version,
+                "hash": ", ".join("0x%02x" % byte for byte in expected_hash),
+            }
+        )
+        output.write(BASE_IMAGE % {"words": format_words(words), "length": len(words)})
+
+
+def main(argv):
+    arguments = argv[1:]
+    expected_hash = bytes(HASH_LENGTH)
+    if len(arguments) >= 2 and arguments[0] == "--hash":
+        try:
+            expected_hash = bytes.fromhex(arguments[1])
+        except ValueError:
+            expected_hash = b""
+        if len(expected_hash) != HASH_LENGTH:
+            sys.stderr.write("--hash takes %u hexadecimal digits\n" % (HASH_LENGTH * 2))
+            return 1
+        arguments = arguments[2:]
+
+    if len(arguments) < 2 or len(arguments) > 3:
+        sys.stderr.write(
+            "Usage: %s [--hash <32 hex digits>] <output header> <base image header> [<image header>]\n" % argv[0]
+        )
+        return 1
+
+    try:
+        diff(arguments[0], arguments[1], arguments[2] if len(arguments) == 3 else None, expected_hash)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("%s\n" % error)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
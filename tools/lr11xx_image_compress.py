@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+#
+# @file      lr11xx_image_compress.py
+#
+# @brief     Compress an LR11XX firmware image header
+#
+# The Clear BSD License
+# Copyright Semtech Corporation 2024. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted (subject to the limitations in the disclaimer
+# below) provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Semtech corporation nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+#
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+# THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+# CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+# NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# The image is compressed with a byte-oriented LZ77 scheme whose matches reach back 1 kB at most, so that the updater
+# decodes it block per block with a 1 kB window while flashing it (see lr11xx_firmware_lz.h for the format). An
+# output ending in .h is the image header with the array replaced by the compressed container, any other output is
+# the raw container.
+#
+# Usage: lr11xx_image_compress.py <image header> <output>
+
+import re
+import sys
+import zlib
+
+# Shared with lr11xx_firmware_lz.h
+MAGIC = b"LRLZ"
+FORMAT_VERSION = 1
+WINDOW_SIZE = 1024
+MATCH_MIN_LENGTH = 4
+
+# Candidates tried per position: more compress slightly better, and slower
+CHAIN_LENGTH = 16
+
+ARRAY_DECLARATION = re.compile(r"^const uint32_t lr11xx_firmware_image\[[^\]]*\] = \{", re.MULTILINE)
+WORD = re.compile(r"0x([0-9a-fA-F]{8})")
+
+COMPRESSED_DEFINITION = """/*!
+ * \\brief Firmware image compressed by tools/lr11xx_image_compress.py, to be decoded by lr11xx_firmware_lz
+ */
+#define LR11XX_FIRMWARE_IMAGE_COMPRESSED
+
+"""
+
+
+def encode_length(output, length):
+    while length >= 255:
+        output.append(255)
+        length -= 255
+    output.append(length)
+
+
+def encode_sequence(output, literals, match_length, match_offset):
+    literal_nibble = min(len(literals), 15)
+    match_nibble = min(match_length - MATCH_MIN_LENGTH, 15) if match_length else 0
+
+    output.append((literal_nibble << 4) | match_nibble)
+    if literal_nibble == 15:
+        encode_length(output, len(literals) - 15)
+    output.extend(literals)
+    if match_length:
+        output.extend(match_offset.to_bytes(2, "little"))
+        if match_nibble == 15:
+            encode_length(output, match_length - MATCH_MIN_LENGTH - 15)
+
+
+def compress(data):
+    output = bytearray()
+    chains = {}
+    literal_start = 0
+    position = 0
+
+    while position + MATCH_MIN_LENGTH <= len(data):
+        key = data[position : position + MATCH_MIN_LENGTH]
+        candidates = chains.setdefault(key, [])
+        best_length = 0
+        best_offset = 0
+
+        for candidate in reversed(candidates[-CHAIN_LENGTH:]):
+            if position - candidate > WINDOW_SIZE:
+                break
+            length = MATCH_MIN_LENGTH
+            while position + length < len(data) and data[candidate + length] == data[position + length]:
+                length += 1
+            if length > best_length:
+                best_length = length
+                best_offset = position - candidate
+
+        candidates.append(position)
+
+        if best_length == 0:
+            position += 1
+            continue
+
+        encode_sequence(output, data[literal_start:position], best_length, best_offset)
+        for skipped in range(position + 1, min(position + best_length, len(data) - MATCH_MIN_LENGTH + 1)):
+            chains.setdefault(data[skipped : skipped + MATCH_MIN_LENGTH], []).append(skipped)
+        position += best_length
+        literal_start = position
+
+    # The last sequence holds the remaining literals only
+    encode_sequence(output, data[literal_start:], 0, 0)
+
+    header = bytearray(MAGIC)
+    header += bytes([FORMAT_VERSION, 0])
+    header += WINDOW_SIZE.to_bytes(2, "little")
+    header += len(data).to_bytes(4, "little")
+    header += (zlib.crc32(data) & 0xFFFFFFFF).to_bytes(4, "little")
+
+    return bytes(header + output)
+
+
+def decompress(container):
+    length = int.from_bytes(container[8:12], "little")
+    output = bytearray()
+    offset = 16
+
+    def read_length(nibble):
+        nonlocal offset
+        if nibble == 15:
+            while True:
+                extension = container[offset]
+                offset += 1
+                nibble += extension
+                if extension != 255:
+                    break
+        return nibble
+
+    while len(output) < length:
+        token = container[offset]
+        offset += 1
+        literal_count = read_length(token >> 4)
+        output += container[offset : offset + literal_count]
+        offset += literal_count
+        if len(output) >= length:
+            break
+        match_offset = int.from_bytes(container[offset : offset + 2], "little")
+        offset += 2
+        for _ in range(read_length(token & 0x0F) + MATCH_MIN_LENGTH):
+            output.append(output[-match_offset])
+
+    return bytes(output)
+
+
+def read_image(header):
+    declaration = ARRAY_DECLARATION.search(header)
+    if declaration is None:
+        raise ValueError("lr11xx_firmware_image declaration not found")
+    if "LR11XX_FIRMWARE_IMAGE_FORMAT" in header[: declaration.start()]:
+        raise ValueError("image in SPI byte order, give the original header")
+
+    end = header.index("};", declaration.end())
+    words = WORD.findall(header[declaration.end() : end])
+
+    return declaration, end, b"".join(int(word, 16).to_bytes(4, "big") for word in words)
+
+
+def format_header(header, declaration, end, container):
+    # Keep the doc comment of the array attached to it
+    insert = header.rfind("/*!", 0, declaration.start())
+    if insert < 0 or header[header.index("*/", insert) + 2 : declaration.start()].strip() != "":
+        insert = declaration.start()
+
+    lines = []
+    for offset in range(0, len(container), 16):
+        lines.append("    " + ", ".join("0x%02x" % byte for byte in container[offset : offset + 16]) + ",")
+
+    return (
+        header[:insert]
+        + COMPRESSED_DEFINITION
+        + header[insert : declaration.start()]
+        + "const uint8_t lr11xx_firmware_image_lz[] = {\n"
+        + "\n".join(lines)
+        + "\n"
+        + header[end:]
+    )
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("Usage: %s <image header> <output>\n" % argv[0])
+        return 1
+
+    with open(argv[1], "r") as source:
+        header = source.read()
+
+    try:
+        declaration, end, image = read_image(header)
+    except ValueError as error:
+        sys.stderr.write("%s: %s\n" % (argv[1], error))
+        return 1
+
+    container = compress(image)
+    if decompress(container) != image:
+        sys.stderr.write("%s: round trip failed\n" % argv[1])
+        return 1
+
+    sys.stdout.write(
+        "%s: %u bytes compressed to %u bytes (ratio %.3f)\n"
+        % (argv[1], len(image), len(container), len(container) / len(image))
+    )
+
+    if argv[2].endswith(".h"):
+        with open(argv[2], "w") as output:
+            output.write(format_header(header, declaration, end, container))
+    else:
+        with open(argv[2], "wb") as output:
+            output.write(container)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
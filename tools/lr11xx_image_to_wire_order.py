@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# @file      lr11xx_image_to_wire_order.py
+#
+# @brief     Convert an LR11XX firmware image header to SPI byte order
+#
+# The Clear BSD License
+# Copyright Semtech Corporation 2024. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted (subject to the limitations in the disclaimer
+# below) provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Semtech corporation nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+#
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+# THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+# CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+# NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# The words of the image are byte-swapped so that, once stored in the memory of a little-endian MCU, the image reads
+# as the byte stream sent over SPI. The flash write then sends it without any intermediate copy.
+#
+# Usage: lr11xx_image_to_wire_order.py <image header> <output header>
+
+import re
+import sys
+
+ARRAY_DECLARATION = re.compile(r"^const uint32_t lr11xx_firmware_image\[[^\]]*\] = \{", re.MULTILINE)
+WORD = re.compile(r"0x([0-9a-fA-F]{8})")
+
+FORMAT_DEFINITION = """/*!
+ * \\brief Byte order of the firmware image: words pre-swapped to SPI byte order
+ */
+#define LR11XX_FIRMWARE_IMAGE_FORMAT LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER
+
+"""
+
+
+def swap_word(match):
+    word = int(match.group(1), 16)
+    return "0x%08x" % int.from_bytes(word.to_bytes(4, "big"), "little")
+
+
+def convert(header):
+    declaration = ARRAY_DECLARATION.search(header)
+    if declaration is None:
+        raise ValueError("lr11xx_firmware_image declaration not found")
+
+    end = header.index("};", declaration.end())
+    if "LR11XX_FIRMWARE_IMAGE_FORMAT" in header[: declaration.start()]:
+        raise ValueError("image is already in SPI byte order")
+
+    # Keep the doc comment of the array attached to it
+    insert = header.rfind("/*!", 0, declaration.start())
+    if insert < 0 or header[header.index("*/", insert) + 2 : declaration.start()].strip() != "":
+        insert = declaration.start()
+
+    words = WORD.sub(swap_word, header[declaration.end() : end])
+
+    return header[:insert] + FORMAT_DEFINITION + header[insert : declaration.end()] + words + header[end:]
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("Usage: %s <image header> <output header>\n" % argv[0])
+        return 1
+
+    with open(argv[1], "r") as source:
+        header = source.read()
+
+    try:
+        converted = convert(header)
+    except ValueError as error:
+        sys.stderr.write("%s: %s\n" % (argv[1], error))
+        return 1
+
+    with open(argv[2], "w") as output:
+        output.write(converted)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+#
+# @file      lr11xx_uart_stream.py
+#
+# @brief     Stream an LR11XX firmware image to the updater tool over its UART
+#
+# The Clear BSD License
+# Copyright Semtech Corporation 2024. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted (subject to the limitations in the disclaimer
+# below) provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Semtech corporation nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+#
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+# THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+# CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+# NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# The updater tool built with UART_STREAM=1 embeds no image: this script sends it the image of a firmware header, block
+# per block, and prints the console output of the board along with the update status.
+#
+# Requires pyserial.
+#
+# Usage: lr11xx_uart_stream.py <serial port> <image header> [baud rate]
+
+import re
+import struct
+import sys
+import time
+
+import serial
+
+SOF = 0xA5
+FRAME_START = 0x01
+FRAME_DATA = 0x02
+FRAME_ACK = 0x81
+FRAME_NAK = 0x82
+FRAME_DONE = 0x83
+
+# Must match LR11XX_FIRMWARE_IMAGE_BLOCK_LENGTH_IN_WORD
+BLOCK_LENGTH_IN_WORD = 64
+# Must match SYSTEM_UART_BAUDRATE
+DEFAULT_BAUD_RATE = 921600
+# Longer than the flash erase, which precedes the acknowledgment of START
+START_TIMEOUT_S = 30
+# Longer than the time the board takes to give up on a block
+DONE_TIMEOUT_S = 30
+
+# Order of lr11xx_fw_update_t
+UPDATES = [
+    "LR1110_FIRMWARE_UPDATE_TO_TRX",
+    "LR1110_FIRMWARE_UPDATE_TO_MODEM_V1",
+    "LR1120_FIRMWARE_UPDATE_TO_TRX",
+    "LR1121_FIRMWARE_UPDATE_TO_TRX",
+    "LR1121_FIRMWARE_UPDATE_TO_MODEM_V2",
+]
+STATUSES = ["OK", "WRONG CHIP TYPE", "ERROR", "ALREADY UP TO DATE"]
+
+VERSION = re.compile(r"^#define LR11XX_FIRMWARE_VERSION\s+(0x[0-9a-fA-F]+)", re.MULTILINE)
+UPDATE = re.compile(r"^#define LR11XX_FIRMWARE_UPDATE_TO\s+(\w+)", re.MULTILINE)
+ARRAY_DECLARATION = re.compile(r"^const uint32_t lr11xx_firmware_image\[[^\]]*\] = \{", re.MULTILINE)
+WORD = re.compile(r"0x([0-9a-fA-F]{8})")
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as lr11xx_uart_stream_crc_update"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def build_frame(frame_type, seq, payload):
+    body = struct.pack(">BBH", frame_type, seq & 0xFF, len(payload)) + payload
+    return bytes([SOF]) + body + struct.pack(">H", crc16(body))
+
+
+def parse_header(header):
+    version = VERSION.search(header)
+    update = UPDATE.search(header)
+    declaration = ARRAY_DECLARATION.search(header)
+    if version is None or update is None or declaration is None:
+        raise ValueError("not an LR11XX firmware image header")
+    if "LR11XX_FIRMWARE_IMAGE_FORMAT_WIRE_ORDER" in header[: declaration.start()]:
+        raise ValueError("image in SPI byte order, give the original header")
+    if update.group(1) not in UPDATES:
+        raise ValueError("unknown update type %s" % update.group(1))
+
+    end = header.index("};", declaration.end())
+    words = [int(word, 16) for word in WORD.findall(header[declaration.end() : end])]
+
+    return UPDATES.index(update.group(1)), int(version.group(1), 16), words
+
+
+class Link:
+    """Frames from the board, separated from its console output"""
+
+    def __init__(self, port):
+        self.port = port
+        self.buffer = bytearray()
+
+    def read_frame(self, timeout_s):
+        deadline = time.monotonic() + timeout_s
+        while True:
+            frame = self._parse()
+            if frame is not None:
+                return frame
+            if time.monotonic() > deadline:
+                return None
+            data = self.port.read(self.port.in_waiting or 1)
+            self.buffer += data
+
+    def _parse(self):
+        while self.buffer:
+            if self.buffer[0] != SOF:
+                end = self.buffer.find(bytes([SOF]))
+                end = len(self.buffer) if end < 0 else end
+                sys.stdout.write(self.buffer[:end].decode("ascii", "replace"))
+                sys.stdout.flush()
+                del self.buffer[:end]
+                continue
+            if len(self.buffer) < 5:
+                return None
+            frame_type, seq, length = struct.unpack(">BBH", self.buffer[1:5])
+            if length > 16:
+                # Not a frame header: skip the SOF
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < 5 + length + 2:
+                return None
+            body = bytes(self.buffer[1 : 5 + length])
+            (crc,) = struct.unpack(">H", self.buffer[5 + length : 7 + length])
+            del self.buffer[: 7 + length]
+            if crc == crc16(body):
+                return frame_type, seq, body[4:]
+        return None
+
+
+def stream(port, update, version, words):
+    link = Link(port)
+    blocks = []
+    for offset in range(0, len(words), BLOCK_LENGTH_IN_WORD):
+        blocks.append(b"".join(struct.pack(">I", word) for word in words[offset : offset + BLOCK_LENGTH_IN_WORD]))
+
+    port.write(build_frame(FRAME_START, 0, struct.pack(">BII", update, version, len(words))))
+
+    window = None
+    while window is None:
+        frame = link.read_frame(START_TIMEOUT_S)
+        if frame is None:
+            raise RuntimeError("no answer to START")
+        frame_type, seq, payload = frame
+        if frame_type == FRAME_ACK and seq == 0 and len(payload) == 1:
+            window = payload[0]
+        elif frame_type == FRAME_DONE:
+            return payload[0]
+
+    # Go-back-N: up to window blocks ahead of the last acknowledged one, resent from the one a NAK asks for
+    acked = 0
+    sent = 0
+    while True:
+        while sent < len(blocks) and sent < acked + window:
+            port.write(build_frame(FRAME_DATA, sent + 1, blocks[sent]))
+            sent += 1
+
+        frame = link.read_frame(DONE_TIMEOUT_S)
+        if frame is None:
+            raise RuntimeError("board stopped answering after %u blocks" % acked)
+        frame_type, seq, payload = frame
+        if frame_type == FRAME_ACK:
+            acked += (seq - acked) & 0xFF
+            sys.stderr.write("\r%u / %u blocks" % (acked, len(blocks)))
+        elif frame_type == FRAME_NAK:
+            sent = acked + ((seq - 1 - acked) & 0xFF)
+        elif frame_type == FRAME_DONE:
+            sys.stderr.write("\n")
+            return payload[0]
+
+
+def main(argv):
+    if len(argv) not in (3, 4):
+        sys.stderr.write("Usage: %s <serial port> <image header> [baud rate]\n" % argv[0])
+        return 1
+
+    with open(argv[2], "r") as source:
+        header = source.read()
+
+    try:
+        update, version, words = parse_header(header)
+    except ValueError as error:
+        sys.stderr.write("%s: %s\n" % (argv[2], error))
+        return 1
+
+    baud_rate = int(argv[3]) if len(argv) == 4 else DEFAULT_BAUD_RATE
+    with serial.Serial(argv[1], baud_rate, timeout=0.1) as port:
+        try:
+            status = stream(port, update, version, words)
+        except RuntimeError as error:
+            sys.stderr.write("%s\n" % error)
+            return 1
+
+    sys.stdout.write("Update status: %s\n" % (STATUSES[status] if status < len(STATUSES) else "0x%02x" % status))
+
+    return 0 if status in (0, 3) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))